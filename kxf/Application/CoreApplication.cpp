@@ -739,6 +739,7 @@ namespace kxf
 			}
 		}
 		m_TaskExecutor.Run();
+		m_TimerWheel.Run();
 
 		KXF_SCOPEDLOG.SetSuccess();
 		return true;
@@ -766,6 +767,7 @@ namespace kxf
 				m_NativeAppCleanedUp = true;
 			}
 		}
+		m_TimerWheel.Terminate();
 		m_TaskExecutor.Terminate();
 
 		KXF_SCOPEDLOG.SetSuccess();
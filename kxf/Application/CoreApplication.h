@@ -3,6 +3,7 @@
 #include "ICoreApplication.h"
 #include "CommandLineParser.h"
 #include "kxf/Core/Async/DefaultAsyncTaskExecutor.h"
+#include "kxf/Core/Async/TimerWheel.h"
 #include "kxf/Threading/LockGuard.h"
 #include "kxf/Threading/RecursiveRWLock.h"
 #include "kxf/EventSystem/EvtHandler.h"
@@ -96,6 +97,7 @@ namespace kxf
 			std::list<std::shared_ptr<IEventFilter>> m_EventFilters;
 
 			DefaultAsyncTaskExecutor m_TaskExecutor;
+			TimerWheel m_TimerWheel;
 			std::optional<int> m_ExitCode;
 
 			bool m_NativeAppInitialized = false;
@@ -305,6 +307,10 @@ namespace kxf
 			{
 				return m_TaskExecutor;
 			}
+			TimerWheel& GetTimerWheel() override
+			{
+				return m_TimerWheel;
+			}
 			std::shared_ptr<wxWidgets::Application> CreateWXApp() override;
 	};
 }
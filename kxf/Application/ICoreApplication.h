@@ -13,6 +13,7 @@ namespace kxf
 	class IEventFilter;
 	class IEventExecutor;
 	class IAsyncTaskExecutor;
+	class TimerWheel;
 	class CommandLineParser;
 }
 namespace kxf::wxWidgets
@@ -151,6 +152,7 @@ namespace kxf
 			virtual IEventFilter::Result FilterEvent(IEvent& event) = 0;
 
 			virtual IAsyncTaskExecutor& GetTaskExecutor() = 0;
+			virtual TimerWheel& GetTimerWheel() = 0;
 			virtual const ILocalizationPackage& GetLocalizationPackage() const = 0;
 
 			virtual std::shared_ptr<wxWidgets::Application> CreateWXApp() = 0;
@@ -10,6 +10,7 @@
 #include "Private/InStreamWrapper.h"
 #include "Private/OutStreamWrapper.h"
 #include "kxf/Core/ErrorCode.h"
+#include "kxf/Core/WildcardMatcher.h"
 #include "kxf/System/VariantProperty.h"
 #include "kxf/FileSystem/NativeFileSystem.h"
 #include "kxf/Utility/ScopeGuard.h"
@@ -152,7 +153,7 @@ namespace
 			FSPath m_Path;
 			FSPath m_Query;
 			FlagSet<FSActionFlag> m_Flags;
-			FlagSet<StringActionFlag> m_MatchFlags;
+			WildcardMatcher m_QueryMatcher;
 
 		private:
 			CallbackCommand DoItem(CallbackFunction<FileItem>& callback, FileItem item, const FSPath& directory, std::vector<FSPath>& childDirectories)
@@ -168,7 +169,7 @@ namespace
 					}
 
 					FSPath relativePath = fullPath.GetAfter(directory);
-					if (relativePath.MatchesWildcards(m_Query, m_MatchFlags))
+					if (m_QueryMatcher.Matches(static_cast<const String&>(relativePath)))
 					{
 						return callback.Invoke(item).GetLastCommand();
 					}
@@ -200,7 +201,9 @@ namespace
 			ArchiveDirectoryEnumerator(const Archive& archive, FSPath rootPath, FSPath query, FlagSet<FSActionFlag> flags)
 				:m_Archive(archive), m_Path(std::move(rootPath)), m_Query(std::move(query)), m_Flags(flags)
 			{
-				m_MatchFlags.Add(StringActionFlag::IgnoreCase, !flags.Contains(FSActionFlag::CaseSensitive));
+				FlagSet<StringActionFlag> matchFlags;
+				matchFlags.Add(StringActionFlag::IgnoreCase, !flags.Contains(FSActionFlag::CaseSensitive));
+				m_QueryMatcher.Compile(m_Query, matchFlags);
 			}
 
 		public:
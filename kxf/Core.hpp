@@ -7,6 +7,8 @@
 #include "kxf/Core/StdID.h"
 #include "kxf/Core/RegEx.h"
 #include "kxf/Core/String.h"
+#include "kxf/Core/WildcardMatcher.h"
+#include "kxf/Core/InternedString.h"
 #include "kxf/Core/Version.h"
 #include "kxf/Core/DateTime.h"
 #include "kxf/Core/Singleton.h"
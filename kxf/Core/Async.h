@@ -2,3 +2,5 @@
 #include "Async/Common.h"
 #include "Async/Coroutine.h"
 #include "Async/DelayedCall.h"
+#include "Async/TimerWheel.h"
+#include "Async/Task.h"
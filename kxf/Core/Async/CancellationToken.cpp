@@ -0,0 +1,61 @@
+#include "kxf-pch.h"
+#include "CancellationToken.h"
+
+namespace kxf
+{
+	void CancellationSource::Cancel(Private::CancellationState& state)
+	{
+		if (!state.IsCancelled.exchange(true, std::memory_order_acq_rel))
+		{
+			// Nothing can be linked to the state after the flag is set, so the list can be taken out of the lock
+			decltype(state.Linked) linked;
+			if (std::unique_lock lock(state.Lock); true)
+			{
+				linked = std::move(state.Linked);
+			}
+
+			for (const auto& item: linked)
+			{
+				if (auto linkedState = item.lock())
+				{
+					Cancel(*linkedState);
+				}
+			}
+		}
+	}
+
+	CancellationSource::CancellationSource()
+		:m_State(std::make_shared<Private::CancellationState>())
+	{
+	}
+	CancellationSource::CancellationSource(const CancellationToken& parent)
+		:m_State(std::make_shared<Private::CancellationState>())
+	{
+		if (auto& parentState = parent.m_State)
+		{
+			std::unique_lock lock(parentState->Lock);
+			if (parentState->IsCancelled.load(std::memory_order_acquire))
+			{
+				m_State->IsCancelled = true;
+			}
+			else
+			{
+				// Drop the links to the sources which are already gone before the list grows again
+				auto& linked = parentState->Linked;
+				if (linked.size() == linked.capacity())
+				{
+					std::erase_if(linked, [](const auto& item)
+					{
+						return item.expired();
+					});
+				}
+				linked.emplace_back(m_State);
+			}
+		}
+	}
+
+	void CancellationSource::Cancel()
+	{
+		Cancel(*m_State);
+	}
+}
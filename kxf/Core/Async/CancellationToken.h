@@ -0,0 +1,91 @@
+#pragma once
+#include "Common.h"
+#include <mutex>
+
+namespace kxf
+{
+	class CancellationSource;
+}
+
+namespace kxf::Private
+{
+	struct CancellationState final
+	{
+		std::atomic<bool> IsCancelled = false;
+
+		// Sources linked to this one, they're cancelled together with it
+		std::vector<std::weak_ptr<CancellationState>> Linked;
+		std::mutex Lock;
+	};
+}
+
+namespace kxf
+{
+	// Read-only view of a 'CancellationSource' which is passed to the code that should stop when the source is cancelled.
+	// Cancellation is cooperative: nothing is interrupted, the code polls the token and returns early. A default-constructed
+	// token is never cancelled.
+	class KXF_API CancellationToken final
+	{
+		friend class CancellationSource;
+
+		private:
+			std::shared_ptr<Private::CancellationState> m_State;
+
+		private:
+			CancellationToken(std::shared_ptr<Private::CancellationState> state) noexcept
+				:m_State(std::move(state))
+			{
+			}
+
+		public:
+			CancellationToken() noexcept = default;
+
+		public:
+			bool CanBeCancelled() const noexcept
+			{
+				return m_State != nullptr;
+			}
+			bool IsCancellationRequested() const noexcept
+			{
+				return m_State && m_State->IsCancelled.load(std::memory_order_acquire);
+			}
+
+		public:
+			explicit operator bool() const noexcept
+			{
+				return IsCancellationRequested();
+			}
+			bool operator!() const noexcept
+			{
+				return !IsCancellationRequested();
+			}
+	};
+
+	class KXF_API CancellationSource final
+	{
+		private:
+			std::shared_ptr<Private::CancellationState> m_State;
+
+		private:
+			static void Cancel(Private::CancellationState& state);
+
+		public:
+			CancellationSource();
+
+			// Linked source, it's cancelled when the parent token is cancelled but cancelling it doesn't affect the parent.
+			// Used to cancel a tree of the child tasks through the token of their parent.
+			CancellationSource(const CancellationToken& parent);
+
+		public:
+			CancellationToken GetToken() const noexcept
+			{
+				return m_State;
+			}
+			bool IsCancellationRequested() const noexcept
+			{
+				return m_State->IsCancelled.load(std::memory_order_acquire);
+			}
+
+			void Cancel();
+	};
+}
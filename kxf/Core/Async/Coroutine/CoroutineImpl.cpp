@@ -12,13 +12,21 @@ namespace kxf::Async
 
 	std::shared_ptr<CoroutineBase> CoroutineTimer::Relinquish()
 	{
-		Stop();
-		return std::move(m_Coroutine);
+		if (m_TimerID != 0 && ICoreApplication::GetInstance()->GetTimerWheel().Cancel(std::exchange(m_TimerID, 0)))
+		{
+			return std::move(m_Coroutine);
+		}
+		return nullptr;
 	}
 	void CoroutineTimer::Wait(std::shared_ptr<CoroutineBase> coroutine, const TimeSpan& time)
 	{
 		m_Coroutine = std::move(coroutine);
-		Start(time);
+
+		// Coroutine delays don't need to be exact, let the wheel coalesce them a little
+		m_TimerID = ICoreApplication::GetInstance()->GetTimerWheel().Schedule(time, [this]()
+		{
+			OnNotify();
+		}, TimeSpan::Milliseconds(4));
 	}
 }
 
@@ -137,9 +145,9 @@ namespace kxf::Async
 	{
 		m_Instruction = CoroutineBase::YieldStop();
 
-		if (m_DelayTimer.IsRunning())
+		if (auto coroutine = m_DelayTimer.Relinquish())
 		{
-			AbortExecution(m_DelayTimer.Relinquish());
+			AbortExecution(std::move(coroutine));
 		}
 	}
 	
@@ -1,7 +1,7 @@
 #pragma once
 #include "../Common.h"
 #include "kxf/RTTI/RTTI.h"
-#include "kxf/DateTime/SimpleTimer.h"
+#include "kxf/Core/Async/TimerWheel.h"
 #include "kxf/EventSystem/IndirectInvocationEvent.h"
 #include "YieldInstruction.h"
 #include <utility>
@@ -31,13 +31,16 @@ namespace kxf::Async
 {
 	class CoroutineBase;
 
-	class KXF_API CoroutineTimer final: public SimpleTimer
+	// Delay of a coroutine on the timer wheel of the application. The wheel owns the coroutine while it's waiting, whoever
+	// of the timer callback and 'Relinquish' gets to it first takes it.
+	class KXF_API CoroutineTimer final
 	{
 		private:
 			std::shared_ptr<CoroutineBase> m_Coroutine;
+			TimerWheel::TimerID m_TimerID = 0;
 
-		protected:
-			void OnNotify() override;
+		private:
+			void OnNotify();
 
 		public:
 			void Wait(std::shared_ptr<CoroutineBase> coroutine, const TimeSpan& time);
@@ -3,6 +3,7 @@
 #include "kxf/Core/IAsyncTask.h"
 #include "kxf/Core/IAsyncTaskExecutor.h"
 #include "kxf/Core/Any.h"
+#include "CancellationToken.h"
 #include "kxf/DateTime/TimeSpan.h"
 #include "kxf/System/SystemThread.h"
 
@@ -15,23 +16,29 @@ namespace kxf
 		private:
 			std::shared_ptr<IAsyncTaskExecutor> m_TaskExecutor;
 			AsyncTaskInfo m_TaskInfo;
+			CancellationSource m_Cancellation;
 			Any m_TaskResult;
 			std::atomic<bool> m_IsCompleted = false;
 			std::atomic<bool> m_IsTerminated = false;
-			std::atomic<bool> m_ShouldTerminate = false;
+
+			// 'TimeSpan' only has millisecond resolution which is too coarse for the queue latency statistics
+			std::chrono::steady_clock::time_point m_QueueTimestamp;
 
 			TimeSpan m_QueueTime;
 			TimeSpan m_StartupTime;
 			TimeSpan m_CompletionTime;
 			SystemThread m_ExecutingThread;
 
-			std::atomic<bool> m_ShouldWait = false;
 			std::condition_variable m_WaitCondition;
 			std::mutex m_WaitLock;
+			std::vector<std::move_only_function<void()>> m_CompletionHandlers;
+
+			// The executor's queues hold raw pointers, a queued task keeps itself alive until it's started
+			std::shared_ptr<DefaultAsyncTask> m_QueueReference;
 
 		public:
 			DefaultAsyncTask(AsyncTaskInfo taskInfo) noexcept
-				:m_TaskInfo(std::move(taskInfo))
+				:m_TaskInfo(std::move(taskInfo)), m_Cancellation(m_TaskInfo.GetCancellationToken())
 			{
 			}
 			DefaultAsyncTask(const DefaultAsyncTask&) = delete;
@@ -43,9 +50,9 @@ namespace kxf
 				return m_TaskExecutor;
 			}
 
-			void Terminate()
+			void Terminate() override
 			{
-				m_ShouldTerminate = true;
+				m_Cancellation.Cancel();
 			}
 			bool IsTerminated() const override
 			{
@@ -53,7 +60,11 @@ namespace kxf
 			}
 			bool ShouldTerminate() const override
 			{
-				return m_ShouldTerminate;
+				return m_Cancellation.IsCancellationRequested();
+			}
+			CancellationToken GetCancellationToken() const override
+			{
+				return m_Cancellation.GetToken();
 			}
 
 			void WaitCompletion() override
@@ -65,10 +76,9 @@ namespace kxf
 
 				if (std::unique_lock lock(m_WaitLock); true)
 				{
-					m_ShouldWait = true;
 					m_WaitCondition.wait(lock, [&]()
 					{
-						return !m_ShouldWait;
+						return m_IsCompleted || m_IsTerminated;
 					});
 				}
 			}
@@ -80,6 +90,17 @@ namespace kxf
 			{
 				return std::move(m_TaskResult);
 			}
+			bool AddCompletionHandler(std::move_only_function<void()> func) override
+			{
+				std::unique_lock lock(m_WaitLock);
+				if (m_IsCompleted || m_IsTerminated)
+				{
+					return false;
+				}
+
+				m_CompletionHandlers.emplace_back(std::move(func));
+				return true;
+			}
 
 			TimeSpan GetQueueTime() const
 			{
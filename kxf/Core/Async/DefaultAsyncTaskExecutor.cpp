@@ -1,12 +1,110 @@
 #include "kxf-pch.h"
 #include "DefaultAsyncTaskExecutor.h"
 #include "DefaultAsyncTask.h"
+#include "Private/WorkStealingDeque.h"
+#include <immintrin.h>
+
+namespace
+{
+	// Number of tasks taken from the LIFO slot in a row before the worker looks at its deque, so a pair of tasks which keep
+	// queueing each other can't starve the rest of the local tasks.
+	constexpr uint32_t g_MaxLIFOStreak = 3;
+
+	// How long the owner of a LIFO slot has to be busy with its current task before the other workers can take the task
+	// from the slot. Before that the owner is about to run it itself, while the data it needs is still in its cache.
+	constexpr std::chrono::microseconds g_LIFOStealDelay(100);
+
+	// The shared queue of the normal priority class is checked once per this many tasks even if there is local work, and the
+	// background one even if there are tasks of a higher class.
+	constexpr uint32_t g_InjectionCheckInterval = 61;
+	constexpr uint32_t g_BackgroundCheckInterval = 127;
+
+	// Failed searches before an idle worker parks, the first ones only pause the core and the rest yield the time slice
+	constexpr size_t g_SpinRounds = 32;
+	constexpr size_t g_PauseRounds = 16;
+
+	// Worker of the executor running on the current thread, to put the tasks queued from it into its own queue
+	thread_local const void* t_CurrentExecutor = nullptr;
+	thread_local void* t_CurrentWorker = nullptr;
+
+	size_t GetThreadShardHint() noexcept
+	{
+		thread_local const size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+		return hint;
+	}
+	int64_t GetDeadlineKey(const kxf::AsyncTaskInfo& taskInfo) noexcept
+	{
+		using TQueue = kxf::Private::ShardedTaskQueue<kxf::DefaultAsyncTask*>;
+
+		const auto deadline = taskInfo.GetDeadline();
+		return deadline.IsNull() ? TQueue::NoDeadline : deadline.GetValue();
+	}
+
+	void SpinWait(size_t round) noexcept
+	{
+		if (round < g_PauseRounds)
+		{
+			for (size_t i = 0; i < (size_t(1) << std::min<size_t>(round, 6)); i++)
+			{
+				_mm_pause();
+			}
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+namespace kxf
+{
+	struct DefaultAsyncTaskExecutor::Worker final
+	{
+		Private::WorkStealingDeque<DefaultAsyncTask*> Queue;
+		std::atomic<DefaultAsyncTask*> LIFOSlot = nullptr;
+		std::thread Thread;
+
+		// Steady clock time the current task has been started at, zero while the worker isn't running one
+		std::atomic<std::chrono::steady_clock::rep> TaskStartTime = 0;
+		size_t Index = 0;
+
+		// Written by the worker thread only
+		std::array<std::array<std::atomic<uint64_t>, ThreadPoolLatencyHistogram::BucketCount>, AsyncTaskInfo::PriorityCount> Latency = {};
+
+		uint32_t RandomState = 0;
+		uint32_t LIFOStreak = 0;
+		uint32_t Tick = 0;
+
+		uint32_t NextRandom() noexcept
+		{
+			// xorshift32
+			RandomState ^= RandomState << 13;
+			RandomState ^= RandomState >> 17;
+			RandomState ^= RandomState << 5;
+			return RandomState;
+		}
+		void AddLatency(AsyncTaskPriority priority, uint64_t microseconds) noexcept
+		{
+			auto& counter = Latency[static_cast<size_t>(priority)][ThreadPoolLatencyHistogram::GetBucketIndex(microseconds)];
+			counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+		void CollectLatency(AsyncTaskPriority priority, ThreadPoolLatencyHistogram& histogram) const noexcept
+		{
+			const auto& counters = Latency[static_cast<size_t>(priority)];
+			for (size_t i = 0; i < counters.size(); i++)
+			{
+				histogram.Add(i, counters[i].load(std::memory_order_relaxed));
+			}
+		}
+	};
+}
 
 namespace kxf
 {
 	void DefaultAsyncTaskExecutor::OnQueue(DefaultAsyncTask& task)
 	{
 		task.m_QueueTime = TimeSpan::Now();
+		task.m_QueueTimestamp = std::chrono::steady_clock::now();
 		task.m_TaskExecutor = QueryInterface<IAsyncTaskExecutor>();
 	}
 	void DefaultAsyncTaskExecutor::OnStartup(DefaultAsyncTask& task)
@@ -17,82 +115,337 @@ namespace kxf
 	void DefaultAsyncTaskExecutor::OnCompleted(DefaultAsyncTask& task, bool terminated)
 	{
 		task.m_CompletionTime = TimeSpan::Now();
-		task.m_IsCompleted = !terminated;
-		task.m_IsTerminated = terminated;
 
-		if (task.m_ShouldWait)
+		// Under the lock, otherwise a thread which has just checked the state in 'WaitCompletion' could miss the notification
+		decltype(task.m_CompletionHandlers) completionHandlers;
+		if (std::unique_lock lock(task.m_WaitLock); true)
+		{
+			task.m_IsCompleted = !terminated;
+			task.m_IsTerminated = terminated;
+			completionHandlers = std::move(task.m_CompletionHandlers);
+		}
+		task.m_WaitCondition.notify_all();
+
+		for (auto& func: completionHandlers)
 		{
-			task.m_WaitCondition.notify_all();
-			task.m_ShouldWait = false;
+			std::invoke(func);
 		}
 	}
 
-	void DefaultAsyncTaskExecutor::OnThread()
+	void DefaultAsyncTaskExecutor::Inject(DefaultAsyncTask& task, size_t shardHint)
 	{
-		bool shouldTerminate = false;
-		while (!shouldTerminate)
+		const auto& taskInfo = task.m_TaskInfo;
+		m_Queues[static_cast<size_t>(taskInfo.GetPriority())].Push(&task, GetDeadlineKey(taskInfo), shardHint);
+	}
+	DefaultAsyncTask* DefaultAsyncTaskExecutor::TakeQueued(AsyncTaskPriority priority, const Worker& worker)
+	{
+		auto& queue = m_Queues[static_cast<size_t>(priority)];
+		if (!queue.IsEmpty())
 		{
-			std::shared_ptr<DefaultAsyncTask> task;
-			if (std::unique_lock lock(m_TaskQueueLock); true)
+			return queue.Pop(worker.Index);
+		}
+		return nullptr;
+	}
+	DefaultAsyncTask* DefaultAsyncTaskExecutor::FindTask(Worker& worker)
+	{
+		const uint32_t tick = ++worker.Tick;
+		if (auto task = TakeQueued(AsyncTaskPriority::High, worker))
+		{
+			return task;
+		}
+		if (tick % g_BackgroundCheckInterval == 0)
+		{
+			if (auto task = TakeQueued(AsyncTaskPriority::Background, worker))
+			{
+				return task;
+			}
+		}
+
+		// The local tasks never have a deadline, so the shared ones which do go first
+		if (m_Queues[static_cast<size_t>(AsyncTaskPriority::Normal)].HasDeadlines())
+		{
+			if (auto task = TakeQueued(AsyncTaskPriority::Normal, worker))
+			{
+				return task;
+			}
+		}
+
+		if (worker.LIFOStreak < g_MaxLIFOStreak)
+		{
+			if (auto task = worker.LIFOSlot.exchange(nullptr, std::memory_order_acq_rel))
+			{
+				worker.LIFOStreak++;
+				return task;
+			}
+		}
+		else if (auto task = worker.LIFOSlot.exchange(nullptr, std::memory_order_acq_rel))
+		{
+			// Let the other workers have it
+			worker.Queue.Push(task);
+		}
+		worker.LIFOStreak = 0;
+
+		if (tick % g_InjectionCheckInterval == 0)
+		{
+			if (auto task = TakeQueued(AsyncTaskPriority::Normal, worker))
+			{
+				return task;
+			}
+		}
+		if (auto task = worker.Queue.Pop())
+		{
+			return task;
+		}
+		if (auto task = TakeQueued(AsyncTaskPriority::Normal, worker))
+		{
+			return task;
+		}
+		if (auto task = StealTask(worker))
+		{
+			return task;
+		}
+		return TakeQueued(AsyncTaskPriority::Background, worker);
+	}
+	DefaultAsyncTask* DefaultAsyncTaskExecutor::StealTask(Worker& worker)
+	{
+		// Start from a random victim so the thieves don't all go after the same worker
+		const size_t count = m_Workers.size();
+		const size_t first = worker.NextRandom() % count;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			Worker& victim = *m_Workers[(first + i) % count];
+			if (&victim != &worker)
 			{
-				m_TaskCondition.wait(lock, [&]()
+				if (auto task = victim.Queue.Steal())
 				{
-					shouldTerminate = m_ShouldTerminate;
-					return !m_TaskQueue.empty() || shouldTerminate;
-				});
+					return task;
+				}
+			}
+		}
 
-				if (!shouldTerminate)
+		// The LIFO slots are the last resort, and only of the workers stuck on their current task for long enough
+		std::optional<std::chrono::steady_clock::rep> now;
+		for (size_t i = 0; i < count; i++)
+		{
+			Worker& victim = *m_Workers[(first + i) % count];
+			if (&victim != &worker && victim.LIFOSlot.load(std::memory_order_relaxed))
+			{
+				if (!now)
 				{
-					task = std::move(m_TaskQueue.front());
-					m_TaskQueue.pop_back();
+					now = std::chrono::steady_clock::now().time_since_epoch().count();
 				}
+
+				const auto startTime = victim.TaskStartTime.load(std::memory_order_relaxed);
+				if (startTime != 0 && std::chrono::steady_clock::duration(*now - startTime) >= g_LIFOStealDelay)
+				{
+					if (auto task = victim.LIFOSlot.exchange(nullptr, std::memory_order_acq_rel))
+					{
+						return task;
+					}
+				}
+			}
+		}
+		return nullptr;
+	}
+	bool DefaultAsyncTaskExecutor::HasPendingTasks() const noexcept
+	{
+		for (const auto& queue: m_Queues)
+		{
+			if (!queue.IsEmpty())
+			{
+				return true;
+			}
+		}
+		for (const auto& worker: m_Workers)
+		{
+			if (!worker->Queue.IsEmpty() || worker->LIFOSlot.load(std::memory_order_relaxed))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void DefaultAsyncTaskExecutor::NotifyWorker()
+	{
+		// Pairs with the fence in 'ParkWorker': either the worker sees the new task before parking or we see it parked
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_ParkedCount.load(std::memory_order_relaxed) != 0)
+		{
+			std::unique_lock lock(m_ParkLock);
+			if (m_PendingWakeups < m_ParkedCount.load(std::memory_order_relaxed))
+			{
+				m_PendingWakeups++;
+				m_ParkCondition.notify_one();
 			}
+		}
+	}
+	void DefaultAsyncTaskExecutor::ParkWorker()
+	{
+		std::unique_lock lock(m_ParkLock);
+		m_ParkedCount.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
 
-			if (task)
+		if (!HasPendingTasks() && !m_ShouldTerminate)
+		{
+			m_ParkCondition.wait(lock, [&]()
+			{
+				return m_PendingWakeups != 0 || m_ShouldTerminate;
+			});
+			if (m_PendingWakeups != 0)
 			{
-				OnStartup(*task);
-				task->m_TaskResult = task->m_TaskInfo.Execute(task);
-				OnCompleted(*task, task->m_ShouldTerminate);
+				m_PendingWakeups--;
 			}
 		}
+		m_ParkedCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+	void DefaultAsyncTaskExecutor::Execute(Worker& worker, DefaultAsyncTask& task)
+	{
+		auto ptr = std::move(task.m_QueueReference);
+
+		OnStartup(*ptr);
+		const auto startTime = std::chrono::steady_clock::now();
+		const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(startTime - ptr->m_QueueTimestamp);
+		worker.AddLatency(ptr->m_TaskInfo.GetPriority(), static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)));
+
+		// A task cancelled while it was in the queue isn't started at all
+		worker.TaskStartTime.store(startTime.time_since_epoch().count(), std::memory_order_relaxed);
+		if (!ptr->ShouldTerminate())
+		{
+			ptr->m_TaskResult = ptr->m_TaskInfo.Execute(ptr);
+		}
+		worker.TaskStartTime.store(0, std::memory_order_relaxed);
+
+		OnCompleted(*ptr, ptr->ShouldTerminate());
+	}
+	void DefaultAsyncTaskExecutor::OnThread(Worker& worker)
+	{
+		t_CurrentExecutor = this;
+		t_CurrentWorker = &worker;
+
+		size_t idleRounds = 0;
+		while (!m_ShouldTerminate.load(std::memory_order_relaxed))
+		{
+			if (auto task = FindTask(worker))
+			{
+				idleRounds = 0;
+				Execute(worker, *task);
+			}
+			else if (idleRounds < g_SpinRounds)
+			{
+				SpinWait(idleRounds++);
+			}
+			else
+			{
+				idleRounds = 0;
+				ParkWorker();
+			}
+		}
+
+		t_CurrentExecutor = nullptr;
+		t_CurrentWorker = nullptr;
+	}
+
+	DefaultAsyncTaskExecutor::DefaultAsyncTaskExecutor() noexcept
+		:m_Concurrency(std::thread::hardware_concurrency())
+	{
+	}
+	DefaultAsyncTaskExecutor::DefaultAsyncTaskExecutor(size_t concurrency) noexcept
+		:m_Concurrency(concurrency)
+	{
+		if (concurrency == 0)
+		{
+			m_Concurrency = std::thread::hardware_concurrency();
+		}
+	}
+	DefaultAsyncTaskExecutor::~DefaultAsyncTaskExecutor()
+	{
+		Terminate();
+
+		// Release the tasks which were never started, their waiters see them as terminated. The completion handlers run only
+		// once the queues are drained and can't queue anything new, a coroutine resumed from them continues on this thread.
+		m_IsShuttingDown = true;
+
+		std::vector<std::shared_ptr<DefaultAsyncTask>> pending;
+		for (auto& queue: m_Queues)
+		{
+			while (auto task = queue.Pop(0))
+			{
+				pending.emplace_back(std::move(task->m_QueueReference));
+			}
+		}
+		for (auto& ptr: pending)
+		{
+			OnCompleted(*ptr, true);
+		}
 	}
 
 	// IAsyncTaskExecutor
 	void DefaultAsyncTaskExecutor::Run()
 	{
-		if (std::unique_lock lock(m_ThreadPoolLock); m_ThreadPool.empty())
+		if (std::unique_lock lock(m_ThreadPoolLock); m_Workers.empty())
 		{
-			m_ThreadPool.reserve(m_Concurrency);
+			// All the workers have to exist before any of them starts looking for the tasks to steal
+			m_Workers.reserve(m_Concurrency);
 			for (size_t i = 0; i < m_Concurrency; i++)
 			{
-				m_ThreadPool.emplace_back([this]()
+				auto& worker = m_Workers.emplace_back(std::make_unique<Worker>());
+				worker->Index = i;
+				worker->RandomState = static_cast<uint32_t>(i + 1) * 0x9E3779B9u;
+			}
+			for (auto& worker: m_Workers)
+			{
+				worker->Thread = std::thread([this, &worker = *worker]()
 				{
-					OnThread();
+					OnThread(worker);
 				});
 			}
 		}
 	}
 	void DefaultAsyncTaskExecutor::Terminate()
 	{
-		if (std::unique_lock lock(m_ThreadPoolLock); !m_ThreadPool.empty())
+		if (std::unique_lock lock(m_ThreadPoolLock); !m_Workers.empty())
 		{
 			m_ShouldTerminate = true;
 
 			// Wake up all threads
-			m_TaskCondition.notify_all();
+			if (std::unique_lock parkLock(m_ParkLock); true)
+			{
+				m_ParkCondition.notify_all();
+			}
 
 			// Join all threads
-			for (auto& thread: m_ThreadPool)
+			for (auto& worker: m_Workers)
+			{
+				worker->Thread.join();
+			}
+
+			// The tasks which haven't been started yet are kept for the next run, and so are the statistics
+			for (auto& worker: m_Workers)
 			{
-				thread.join();
+				if (auto task = worker->LIFOSlot.exchange(nullptr))
+				{
+					Inject(*task, worker->Index);
+				}
+				while (auto task = worker->Queue.Steal())
+				{
+					Inject(*task, worker->Index);
+				}
+
+				for (size_t i = 0; i < m_RetiredLatency.size(); i++)
+				{
+					worker->CollectLatency(static_cast<AsyncTaskPriority>(i), m_RetiredLatency[i]);
+				}
 			}
-			m_ThreadPool.clear();
+			m_Workers.clear();
+			m_PendingWakeups = 0;
 			m_ShouldTerminate = false;
 		}
 	}
 	bool DefaultAsyncTaskExecutor::IsRunning() const
 	{
-		if (std::unique_lock lock(m_ThreadPoolLock); !m_ThreadPool.empty())
+		if (std::unique_lock lock(m_ThreadPoolLock); !m_Workers.empty())
 		{
 			return true;
 		}
@@ -101,15 +454,32 @@ namespace kxf
 
 	std::shared_ptr<IAsyncTask> DefaultAsyncTaskExecutor::QueueTask(AsyncTaskInfo task)
 	{
-		if (task)
+		if (task && !m_IsShuttingDown)
 		{
-			std::shared_ptr<DefaultAsyncTask> ptr;
-			if (std::unique_lock lock(m_TaskQueueLock); true)
+			auto ptr = std::make_shared<DefaultAsyncTask>(std::move(task));
+			OnQueue(*ptr);
+			ptr->m_QueueReference = ptr;
+
+			const auto& taskInfo = ptr->m_TaskInfo;
+			if (t_CurrentExecutor == this && taskInfo.GetPriority() == AsyncTaskPriority::Normal && taskInfo.GetDeadline().IsNull())
+			{
+				// A task queued from another one is likely to use the data it has just produced, so it's run next on the same thread.
+				// The task which was in the slot before goes to the deque where the other workers can steal it.
+				auto& worker = *static_cast<Worker*>(t_CurrentWorker);
+				if (auto previous = worker.LIFOSlot.exchange(ptr.get(), std::memory_order_acq_rel))
+				{
+					worker.Queue.Push(previous);
+				}
+			}
+			else if (t_CurrentExecutor == this)
+			{
+				Inject(*ptr, static_cast<Worker*>(t_CurrentWorker)->Index);
+			}
+			else
 			{
-				ptr = m_TaskQueue.emplace_back(std::make_shared<DefaultAsyncTask>(std::move(task)));
-				OnQueue(*ptr);
+				Inject(*ptr, GetThreadShardHint());
 			}
-			m_TaskCondition.notify_one();
+			NotifyWorker();
 
 			return ptr;
 		}
@@ -128,7 +498,7 @@ namespace kxf
 			return false;
 		}
 
-		if (std::unique_lock lock(m_ThreadPoolLock); m_ThreadPool.empty())
+		if (std::unique_lock lock(m_ThreadPoolLock); m_Workers.empty())
 		{
 			m_Concurrency = concurrency;
 			return true;
@@ -144,4 +514,32 @@ namespace kxf
 		}
 		return nullptr;
 	}
+	size_t DefaultAsyncTaskExecutor::GetQueueDepth(AsyncTaskPriority priority) const
+	{
+		size_t depth = m_Queues[static_cast<size_t>(priority)].GetSize();
+		if (priority == AsyncTaskPriority::Normal)
+		{
+			std::unique_lock lock(m_ThreadPoolLock);
+			for (const auto& worker: m_Workers)
+			{
+				depth += worker->Queue.GetSize();
+				if (worker->LIFOSlot.load(std::memory_order_relaxed))
+				{
+					depth++;
+				}
+			}
+		}
+		return depth;
+	}
+	ThreadPoolLatencyHistogram DefaultAsyncTaskExecutor::GetLatencyHistogram(AsyncTaskPriority priority) const
+	{
+		std::unique_lock lock(m_ThreadPoolLock);
+
+		ThreadPoolLatencyHistogram histogram = m_RetiredLatency[static_cast<size_t>(priority)];
+		for (const auto& worker: m_Workers)
+		{
+			worker->CollectLatency(priority, histogram);
+		}
+		return histogram;
+	}
 }
@@ -3,9 +3,9 @@
 #include "kxf/Core/IAsyncTask.h"
 #include "kxf/Core/IAsyncTaskExecutor.h"
 #include "kxf/Threading/IThreadPool.h"
+#include "Private/ShardedTaskQueue.h"
 #include <thread>
 #include <mutex>
-#include <queue>
 
 namespace kxf
 {
@@ -14,44 +14,52 @@ namespace kxf
 
 namespace kxf
 {
+	// Work-stealing executor. Every worker has its own deque and a LIFO slot for the normal priority tasks queued from its
+	// thread, the tasks queued from any other thread and the ones with a different priority or a deadline go to the shared
+	// queue of their priority class. Idle workers steal from the others, spin for a while and only then park until a new task
+	// is queued. The task in a LIFO slot is left to its owner unless it's been busy with its current task for too long.
 	class KXF_API DefaultAsyncTaskExecutor final: public RTTI::DynamicImplementation<DefaultAsyncTaskExecutor, IAsyncTaskExecutor, IThreadPool>
 	{
 		private:
-			std::vector<std::thread> m_ThreadPool;
+			struct Worker;
+
+		private:
+			std::vector<std::unique_ptr<Worker>> m_Workers;
 			mutable std::mutex m_ThreadPoolLock;
 
-			std::vector<std::shared_ptr<DefaultAsyncTask>> m_TaskQueue;
-			std::condition_variable m_TaskCondition;
-			mutable std::mutex m_TaskQueueLock;
+			std::array<Private::ShardedTaskQueue<DefaultAsyncTask*>, AsyncTaskInfo::PriorityCount> m_Queues;
+			std::array<ThreadPoolLatencyHistogram, AsyncTaskInfo::PriorityCount> m_RetiredLatency;
+
+			std::condition_variable m_ParkCondition;
+			std::mutex m_ParkLock;
+			std::atomic<size_t> m_ParkedCount = 0;
+			size_t m_PendingWakeups = 0;
 
 			size_t m_Concurrency = 0;
 			std::atomic<bool> m_ShouldTerminate = false;
+			std::atomic<bool> m_IsShuttingDown = false;
 
 		private:
 			void OnQueue(DefaultAsyncTask& task);
 			void OnStartup(DefaultAsyncTask& task);
 			void OnCompleted(DefaultAsyncTask& task, bool terminated);
 
-			void OnThread();
+			void Inject(DefaultAsyncTask& task, size_t shardHint);
+			DefaultAsyncTask* TakeQueued(AsyncTaskPriority priority, const Worker& worker);
+			DefaultAsyncTask* FindTask(Worker& worker);
+			DefaultAsyncTask* StealTask(Worker& worker);
+			bool HasPendingTasks() const noexcept;
+
+			void NotifyWorker();
+			void ParkWorker();
+			void Execute(Worker& worker, DefaultAsyncTask& task);
+			void OnThread(Worker& worker);
 
 		public:
-			DefaultAsyncTaskExecutor() noexcept
-				:m_Concurrency(std::thread::hardware_concurrency())
-			{
-			}
-			DefaultAsyncTaskExecutor(size_t concurrency) noexcept
-				:m_Concurrency(concurrency)
-			{
-				if (concurrency == 0)
-				{
-					m_Concurrency = std::thread::hardware_concurrency();
-				}
-			}
+			DefaultAsyncTaskExecutor() noexcept;
+			DefaultAsyncTaskExecutor(size_t concurrency) noexcept;
 			DefaultAsyncTaskExecutor(const DefaultAsyncTaskExecutor&) = delete;
-			~DefaultAsyncTaskExecutor()
-			{
-				Terminate();
-			}
+			~DefaultAsyncTaskExecutor();
 
 		public:
 			// IAsyncTaskExecutor
@@ -71,6 +79,9 @@ namespace kxf
 
 			std::shared_ptr<IAsyncTask> AddTask(std::move_only_function<void()> task) override;
 
+			size_t GetQueueDepth(AsyncTaskPriority priority) const override;
+			ThreadPoolLatencyHistogram GetLatencyHistogram(AsyncTaskPriority priority) const override;
+
 		public:
 			DefaultAsyncTaskExecutor& operator=(const DefaultAsyncTaskExecutor&) = delete;
 	};
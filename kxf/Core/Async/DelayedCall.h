@@ -1,30 +1,19 @@
 #pragma once
 #include "Common.h"
-#include "Coroutine.h"
+#include "TimerWheel.h"
+#include "kxf/Application/ICoreApplication.h"
 
 namespace kxf::Async
 {
+	// Calls the function on the main thread after the delay, the timer can be cancelled through the timer wheel of the application
 	template<class TCallable>
 	requires(std::is_invocable_r_v<void, TCallable>)
-	static void DelayedCall(TCallable&& func, TimeSpan delay)
+	static TimerWheel::TimerID DelayedCall(TCallable&& func, TimeSpan delay, TimeSpan tolerance = {})
 	{
-		enum class State
+		auto app = ICoreApplication::GetInstance();
+		return app->GetTimerWheel().Schedule(delay, [app, func = std::forward<TCallable>(func)]() mutable
 		{
-			Wait,
-			Execute
-		};
-
-		Coroutine::Run([delay, func = std::forward<TCallable>(func)](Coroutine& coroutine)
-		{
-			if (coroutine.GetNextState<State::Execute>())
-			{
-				std::invoke(func);
-				return Coroutine::YieldStop();
-			}
-			else
-			{
-				return Coroutine::YieldWait(delay, State::Execute);
-			}
-		});
+			app->CallAfter(std::move(func));
+		}, tolerance);
 	}
 }
@@ -0,0 +1,98 @@
+#include "kxf-pch.h"
+#include "CoroutineFramePool.h"
+
+namespace
+{
+	// Size classes are multiples of the granularity up to 1 KB, larger frames aren't cached
+	constexpr size_t g_SizeClassGranularity = 64;
+	constexpr size_t g_SizeClassCount = 16;
+	constexpr size_t g_MaxCachedFrames = 64;
+
+	constexpr size_t GetSizeClass(size_t size) noexcept
+	{
+		return (size + g_SizeClassGranularity - 1) / g_SizeClassGranularity - 1;
+	}
+
+	class FrameCache final
+	{
+		private:
+			struct FreeFrame final
+			{
+				FreeFrame* Next = nullptr;
+			};
+
+		private:
+			std::array<FreeFrame*, g_SizeClassCount> m_Frames = {};
+			std::array<size_t, g_SizeClassCount> m_Count = {};
+
+		public:
+			FrameCache() noexcept = default;
+			FrameCache(const FrameCache&) = delete;
+			~FrameCache()
+			{
+				for (FreeFrame* frame: m_Frames)
+				{
+					while (frame)
+					{
+						::operator delete(std::exchange(frame, frame->Next));
+					}
+				}
+			}
+
+		public:
+			void* Allocate(size_t sizeClass) noexcept
+			{
+				if (FreeFrame* frame = m_Frames[sizeClass])
+				{
+					m_Frames[sizeClass] = frame->Next;
+					m_Count[sizeClass]--;
+
+					return frame;
+				}
+				return nullptr;
+			}
+			bool Free(void* ptr, size_t sizeClass) noexcept
+			{
+				if (m_Count[sizeClass] < g_MaxCachedFrames)
+				{
+					m_Frames[sizeClass] = new(ptr) FreeFrame{m_Frames[sizeClass]};
+					m_Count[sizeClass]++;
+
+					return true;
+				}
+				return false;
+			}
+
+		public:
+			FrameCache& operator=(const FrameCache&) = delete;
+	};
+	thread_local FrameCache t_FrameCache;
+}
+
+namespace kxf::Private
+{
+	void* AllocateCoroutineFrame(size_t size)
+	{
+		const size_t sizeClass = GetSizeClass(size);
+		if (sizeClass < g_SizeClassCount)
+		{
+			if (void* ptr = t_FrameCache.Allocate(sizeClass))
+			{
+				return ptr;
+			}
+
+			// Allocate the whole class so the frame can be reused for any size of the same class
+			return ::operator new((sizeClass + 1) * g_SizeClassGranularity);
+		}
+		return ::operator new(size);
+	}
+	void FreeCoroutineFrame(void* ptr, size_t size) noexcept
+	{
+		const size_t sizeClass = GetSizeClass(size);
+		if (sizeClass < g_SizeClassCount && t_FrameCache.Free(ptr, sizeClass))
+		{
+			return;
+		}
+		::operator delete(ptr);
+	}
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "../Common.h"
+
+namespace kxf::Private
+{
+	// Recycles the coroutine frames through per-thread free lists of a few size classes. A frame freed on another thread than
+	// the one it was allocated on joins the cache of the freeing thread, every list is capped and the rest goes to the heap.
+	KXF_API void* AllocateCoroutineFrame(size_t size);
+	KXF_API void FreeCoroutineFrame(void* ptr, size_t size) noexcept;
+}
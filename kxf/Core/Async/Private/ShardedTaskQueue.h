@@ -0,0 +1,135 @@
+#pragma once
+#include "../Common.h"
+#include <mutex>
+
+namespace kxf::Private
+{
+	// Multi-producer multi-consumer queue of the tasks of one priority class. Every shard is a binary heap ordered by deadline and
+	// then by insertion order, and publishes the key of its top item so a consumer picks the most urgent shard without taking any
+	// lock and only locks that one. Producers are spread over the shards by a hint, so the order is exact within a shard and only
+	// approximately earliest-deadline-first (or FIFO for the items without a deadline) across them.
+	template<class T>
+	requires(std::is_pointer_v<T>)
+	class ShardedTaskQueue final
+	{
+		public:
+			static constexpr size_t ShardCount = 8;
+			static constexpr int64_t NoDeadline = std::numeric_limits<int64_t>::max() - 1;
+
+		private:
+			static constexpr int64_t EmptyKey = std::numeric_limits<int64_t>::max();
+
+			struct Item final
+			{
+				int64_t Deadline = 0;
+				uint64_t Sequence = 0;
+				T Value = nullptr;
+
+				bool operator>(const Item& other) const noexcept
+				{
+					return Deadline != other.Deadline ? Deadline > other.Deadline : Sequence > other.Sequence;
+				}
+			};
+			struct alignas(std::hardware_destructive_interference_size) Shard final
+			{
+				std::atomic<int64_t> TopKey = EmptyKey;
+				std::atomic<size_t> Size = 0;
+
+				std::mutex Lock;
+				std::vector<Item> Heap;
+				uint64_t Sequence = 0;
+
+				void Publish() noexcept
+				{
+					TopKey.store(Heap.empty() ? EmptyKey : Heap.front().Deadline, std::memory_order_release);
+					Size.store(Heap.size(), std::memory_order_relaxed);
+				}
+			};
+
+		private:
+			std::array<Shard, ShardCount> m_Shards;
+
+		public:
+			ShardedTaskQueue() = default;
+			ShardedTaskQueue(const ShardedTaskQueue&) = delete;
+
+		public:
+			bool IsEmpty() const noexcept
+			{
+				for (const Shard& shard: m_Shards)
+				{
+					if (shard.TopKey.load(std::memory_order_acquire) != EmptyKey)
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+			bool HasDeadlines() const noexcept
+			{
+				for (const Shard& shard: m_Shards)
+				{
+					if (shard.TopKey.load(std::memory_order_relaxed) < NoDeadline)
+					{
+						return true;
+					}
+				}
+				return false;
+			}
+			size_t GetSize() const noexcept
+			{
+				size_t size = 0;
+				for (const Shard& shard: m_Shards)
+				{
+					size += shard.Size.load(std::memory_order_relaxed);
+				}
+				return size;
+			}
+
+			void Push(T value, int64_t deadline, size_t hint)
+			{
+				Shard& shard = m_Shards[hint % ShardCount];
+				std::unique_lock lock(shard.Lock);
+
+				shard.Heap.push_back(Item{std::min(deadline, NoDeadline), shard.Sequence++, value});
+				std::push_heap(shard.Heap.begin(), shard.Heap.end(), std::greater<>());
+				shard.Publish();
+			}
+			T Pop(size_t hint)
+			{
+				// Another consumer can empty the chosen shard between the scan and the lock, then the scan is repeated
+				while (true)
+				{
+					Shard* best = nullptr;
+					int64_t bestKey = EmptyKey;
+					for (size_t i = 0; i < ShardCount; i++)
+					{
+						Shard& shard = m_Shards[(hint + i) % ShardCount];
+						if (const int64_t key = shard.TopKey.load(std::memory_order_acquire); key < bestKey)
+						{
+							best = &shard;
+							bestKey = key;
+						}
+					}
+					if (!best)
+					{
+						return nullptr;
+					}
+
+					std::unique_lock lock(best->Lock);
+					if (!best->Heap.empty())
+					{
+						std::pop_heap(best->Heap.begin(), best->Heap.end(), std::greater<>());
+						T value = best->Heap.back().Value;
+						best->Heap.pop_back();
+						best->Publish();
+
+						return value;
+					}
+				}
+			}
+
+		public:
+			ShardedTaskQueue& operator=(const ShardedTaskQueue&) = delete;
+	};
+}
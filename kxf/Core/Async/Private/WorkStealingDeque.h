@@ -0,0 +1,143 @@
+#pragma once
+#include "../Common.h"
+
+namespace kxf::Private
+{
+	// Chase-Lev work-stealing deque, with the memory ordering from "Correct and Efficient Work-Stealing for Weak Memory Models"
+	// (Lê, Pop, Cohen, Zappa Nardelli). The owner thread pushes and pops at the bottom, any other thread can steal from the top.
+	// The ring buffer grows when full, the old buffers are kept until the deque is destroyed since a thief can still be reading them.
+	template<class T>
+	requires(std::is_pointer_v<T>)
+	class WorkStealingDeque final
+	{
+		private:
+			class Buffer final
+			{
+				private:
+					int64_t m_Capacity = 0;
+					std::unique_ptr<std::atomic<T>[]> m_Items;
+
+				public:
+					Buffer(int64_t capacity)
+						:m_Capacity(capacity), m_Items(std::make_unique<std::atomic<T>[]>(static_cast<size_t>(capacity)))
+					{
+					}
+
+				public:
+					int64_t GetCapacity() const noexcept
+					{
+						return m_Capacity;
+					}
+					T Get(int64_t index) const noexcept
+					{
+						return m_Items[index & (m_Capacity - 1)].load(std::memory_order_relaxed);
+					}
+					void Put(int64_t index, T item) noexcept
+					{
+						m_Items[index & (m_Capacity - 1)].store(item, std::memory_order_relaxed);
+					}
+
+					std::unique_ptr<Buffer> Grow(int64_t top, int64_t bottom) const
+					{
+						auto buffer = std::make_unique<Buffer>(m_Capacity * 2);
+						for (int64_t i = top; i != bottom; i++)
+						{
+							buffer->Put(i, Get(i));
+						}
+						return buffer;
+					}
+			};
+
+		private:
+			alignas(std::hardware_destructive_interference_size) std::atomic<int64_t> m_Top = 0;
+			alignas(std::hardware_destructive_interference_size) std::atomic<int64_t> m_Bottom = 0;
+			std::atomic<Buffer*> m_Buffer = nullptr;
+			std::vector<std::unique_ptr<Buffer>> m_Buffers;
+
+		public:
+			WorkStealingDeque(size_t capacity = 256)
+			{
+				m_Buffers.emplace_back(std::make_unique<Buffer>(static_cast<int64_t>(std::bit_ceil(std::max<size_t>(capacity, 2)))));
+				m_Buffer.store(m_Buffers.back().get(), std::memory_order_relaxed);
+			}
+			WorkStealingDeque(const WorkStealingDeque&) = delete;
+
+		public:
+			// Approximate when called from a thread other than the owner
+			bool IsEmpty() const noexcept
+			{
+				return m_Bottom.load(std::memory_order_relaxed) <= m_Top.load(std::memory_order_relaxed);
+			}
+			size_t GetSize() const noexcept
+			{
+				const int64_t size = m_Bottom.load(std::memory_order_relaxed) - m_Top.load(std::memory_order_relaxed);
+				return size > 0 ? static_cast<size_t>(size) : 0;
+			}
+
+			// Owner only
+			void Push(T item)
+			{
+				const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+				const int64_t top = m_Top.load(std::memory_order_acquire);
+
+				Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+				if (bottom - top > buffer->GetCapacity() - 1)
+				{
+					m_Buffers.emplace_back(buffer->Grow(top, bottom));
+					buffer = m_Buffers.back().get();
+					m_Buffer.store(buffer, std::memory_order_release);
+				}
+
+				buffer->Put(bottom, item);
+				std::atomic_thread_fence(std::memory_order_release);
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+			T Pop() noexcept
+			{
+				const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+				Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+				m_Bottom.store(bottom, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				int64_t top = m_Top.load(std::memory_order_relaxed);
+				if (top <= bottom)
+				{
+					T item = buffer->Get(bottom);
+					if (top == bottom)
+					{
+						// The last item, race with the thieves for it
+						if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						{
+							item = nullptr;
+						}
+						m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+					}
+					return item;
+				}
+
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			// Any thread, returns null if the deque is empty or another thread has taken the item first
+			T Steal() noexcept
+			{
+				int64_t top = m_Top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+				if (top < bottom)
+				{
+					T item = m_Buffer.load(std::memory_order_acquire)->Get(top);
+					if (m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					{
+						return item;
+					}
+				}
+				return nullptr;
+			}
+
+		public:
+			WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+	};
+}
@@ -0,0 +1,3 @@
+#pragma once
+#include "kxf/Core/Async/Task/Task.h"
+#include "kxf/Core/Async/Task/Awaitables.h"
@@ -0,0 +1,181 @@
+#pragma once
+#include "Task.h"
+#include "kxf/Core/IAsyncTask.h"
+#include "kxf/IO/IStream.h"
+
+namespace kxf::Async
+{
+	// Moves the awaiting coroutine to the executor, a task also keeps resuming on it after the following suspensions
+	class ResumeOn final
+	{
+		private:
+			IAsyncTaskExecutor& m_Executor;
+
+		public:
+			ResumeOn(IAsyncTaskExecutor& executor) noexcept
+				:m_Executor(executor)
+			{
+			}
+
+		public:
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			template<class TPromise>
+			void await_suspend(std::coroutine_handle<TPromise> handle)
+			{
+				if constexpr(std::is_base_of_v<Private::TaskPromiseBase, TPromise>)
+				{
+					handle.promise().SetExecutor(&m_Executor);
+				}
+				Private::ResumeCoroutine(handle, &m_Executor);
+			}
+
+			void await_resume() const noexcept
+			{
+			}
+	};
+
+	// Resumes the awaiting coroutine once the task is completed or terminated, the result is the task result
+	class AsyncTaskAwaiter final
+	{
+		private:
+			std::shared_ptr<IAsyncTask> m_Task;
+
+		public:
+			AsyncTaskAwaiter(std::shared_ptr<IAsyncTask> task) noexcept
+				:m_Task(std::move(task))
+			{
+			}
+
+		public:
+			bool await_ready() const
+			{
+				return m_Task->IsCompleted() || m_Task->IsTerminated();
+			}
+
+			template<class TPromise>
+			bool await_suspend(std::coroutine_handle<TPromise> handle)
+			{
+				// The handler can run on another thread before this returns, the awaiter mustn't be used after the call
+				return m_Task->AddCompletionHandler([handle, executor = Private::GetCoroutineExecutor(handle)]()
+				{
+					Private::ResumeCoroutine(handle, executor);
+				});
+			}
+
+			Any await_resume()
+			{
+				return m_Task->TakeResult();
+			}
+	};
+
+	// The streams only have the blocking interface, so the operation runs as a task on the given executor (usually a separate
+	// pool for the blocking I/O) and the awaiting coroutine is resumed on its own executor afterwards. The stream and the buffer
+	// must stay valid until the operation is completed. The result is 'LastRead'/'LastWrite', check the stream for the errors.
+	class StreamReadAwaiter final
+	{
+		private:
+			IAsyncTaskExecutor& m_Executor;
+			IInputStream& m_Stream;
+			std::span<std::byte> m_Buffer;
+			size_t m_Result = 0;
+
+		public:
+			StreamReadAwaiter(IAsyncTaskExecutor& executor, IInputStream& stream, std::span<std::byte> buffer) noexcept
+				:m_Executor(executor), m_Stream(stream), m_Buffer(buffer)
+			{
+			}
+
+		public:
+			bool await_ready() const noexcept
+			{
+				return m_Buffer.empty();
+			}
+
+			template<class TPromise>
+			bool await_suspend(std::coroutine_handle<TPromise> handle)
+			{
+				auto task = m_Executor.QueueTask([this, handle, executor = Private::GetCoroutineExecutor(handle)]()
+				{
+					m_Result = m_Stream.Read(m_Buffer.data(), m_Buffer.size()).LastRead().ToBytes<size_t>();
+					Private::ResumeCoroutine(handle, executor);
+				});
+				if (!task)
+				{
+					// The executor is being destroyed, do it here and don't suspend
+					m_Result = m_Stream.Read(m_Buffer.data(), m_Buffer.size()).LastRead().ToBytes<size_t>();
+					return false;
+				}
+				return true;
+			}
+
+			size_t await_resume() const noexcept
+			{
+				return m_Result;
+			}
+	};
+
+	class StreamWriteAwaiter final
+	{
+		private:
+			IAsyncTaskExecutor& m_Executor;
+			IOutputStream& m_Stream;
+			std::span<const std::byte> m_Buffer;
+			size_t m_Result = 0;
+
+		public:
+			StreamWriteAwaiter(IAsyncTaskExecutor& executor, IOutputStream& stream, std::span<const std::byte> buffer) noexcept
+				:m_Executor(executor), m_Stream(stream), m_Buffer(buffer)
+			{
+			}
+
+		public:
+			bool await_ready() const noexcept
+			{
+				return m_Buffer.empty();
+			}
+
+			template<class TPromise>
+			bool await_suspend(std::coroutine_handle<TPromise> handle)
+			{
+				auto task = m_Executor.QueueTask([this, handle, executor = Private::GetCoroutineExecutor(handle)]()
+				{
+					m_Result = m_Stream.Write(m_Buffer.data(), m_Buffer.size()).LastWrite().ToBytes<size_t>();
+					Private::ResumeCoroutine(handle, executor);
+				});
+				if (!task)
+				{
+					// The executor is being destroyed, do it here and don't suspend
+					m_Result = m_Stream.Write(m_Buffer.data(), m_Buffer.size()).LastWrite().ToBytes<size_t>();
+					return false;
+				}
+				return true;
+			}
+
+			size_t await_resume() const noexcept
+			{
+				return m_Result;
+			}
+	};
+
+	inline StreamReadAwaiter ReadAsync(IAsyncTaskExecutor& executor, IInputStream& stream, std::span<std::byte> buffer) noexcept
+	{
+		return {executor, stream, buffer};
+	}
+	inline StreamWriteAwaiter WriteAsync(IAsyncTaskExecutor& executor, IOutputStream& stream, std::span<const std::byte> buffer) noexcept
+	{
+		return {executor, stream, buffer};
+	}
+}
+
+namespace kxf
+{
+	// Found through ADL on 'std::shared_ptr<IAsyncTask>'
+	inline Async::AsyncTaskAwaiter operator co_await(std::shared_ptr<IAsyncTask> task) noexcept
+	{
+		return Async::AsyncTaskAwaiter(std::move(task));
+	}
+}
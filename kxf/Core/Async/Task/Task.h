@@ -0,0 +1,359 @@
+#pragma once
+#include "../Common.h"
+#include "../Private/CoroutineFramePool.h"
+#include "kxf/Core/IAsyncTaskExecutor.h"
+#include <coroutine>
+#include <condition_variable>
+#include <mutex>
+
+namespace kxf
+{
+	template<class T = void>
+	class Task;
+}
+
+namespace kxf::Private
+{
+	class TaskCompletionEvent final
+	{
+		private:
+			std::condition_variable m_Condition;
+			std::mutex m_Lock;
+			bool m_IsSet = false;
+
+		public:
+			void Set()
+			{
+				// Notified under the lock, the waiter destroys the event as soon as it can see it set
+				std::unique_lock lock(m_Lock);
+				m_IsSet = true;
+				m_Condition.notify_all();
+			}
+			void Wait()
+			{
+				std::unique_lock lock(m_Lock);
+				m_Condition.wait(lock, [&]()
+				{
+					return m_IsSet;
+				});
+			}
+	};
+
+	// An executor which is being destroyed rejects new tasks, the coroutine is resumed on the calling thread then so it can
+	// still complete. Its executor must not be used by it afterwards: a task must not outlive the executor it's affine to.
+	inline void ResumeCoroutine(std::coroutine_handle<> handle, IAsyncTaskExecutor* executor)
+	{
+		if (executor)
+		{
+			auto task = executor->QueueTask([handle]()
+			{
+				handle.resume();
+			});
+			if (task)
+			{
+				return;
+			}
+		}
+		handle.resume();
+	}
+
+	class TaskPromiseBase
+	{
+		template<class T>
+		friend class kxf::Task;
+
+		private:
+			struct FinalAwaiter final
+			{
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				template<class TPromise>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<TPromise> handle) noexcept
+				{
+					// Nothing of the frame can be touched after the event is set, the continuation is queued or the frame is destroyed
+					TaskPromiseBase& promise = handle.promise();
+					if (promise.m_Continuation)
+					{
+						// A task which has moved to another executor hands the awaiting coroutine back to its own one
+						if (promise.m_ContinuationExecutor && promise.m_ContinuationExecutor != promise.m_Executor)
+						{
+							ResumeCoroutine(promise.m_Continuation, promise.m_ContinuationExecutor);
+							return std::noop_coroutine();
+						}
+						return promise.m_Continuation;
+					}
+					else if (promise.m_IsDetached)
+					{
+						handle.destroy();
+					}
+					else if (auto event = promise.m_CompletionEvent)
+					{
+						event->Set();
+					}
+					return std::noop_coroutine();
+				}
+
+				void await_resume() const noexcept
+				{
+				}
+			};
+
+		protected:
+			std::coroutine_handle<> m_Continuation;
+			IAsyncTaskExecutor* m_ContinuationExecutor = nullptr;
+			IAsyncTaskExecutor* m_Executor = nullptr;
+			TaskCompletionEvent* m_CompletionEvent = nullptr;
+			std::exception_ptr m_Exception;
+			bool m_IsDetached = false;
+
+		protected:
+			void RethrowException()
+			{
+				if (m_Exception)
+				{
+					std::rethrow_exception(m_Exception);
+				}
+			}
+
+		public:
+			static void* operator new(size_t size)
+			{
+				return AllocateCoroutineFrame(size);
+			}
+			static void operator delete(void* ptr, size_t size) noexcept
+			{
+				FreeCoroutineFrame(ptr, size);
+			}
+
+		public:
+			std::suspend_always initial_suspend() const noexcept
+			{
+				return {};
+			}
+			FinalAwaiter final_suspend() const noexcept
+			{
+				return {};
+			}
+			void unhandled_exception() noexcept
+			{
+				m_Exception = std::current_exception();
+			}
+
+			// Executor the coroutine is resumed on after it's been suspended by a non-task awaitable,
+			// null to resume it on the thread which has completed the awaited operation.
+			IAsyncTaskExecutor* GetExecutor() const noexcept
+			{
+				return m_Executor;
+			}
+			void SetExecutor(IAsyncTaskExecutor* executor) noexcept
+			{
+				m_Executor = executor;
+			}
+	};
+
+	template<class T>
+	class TaskPromise final: public TaskPromiseBase
+	{
+		private:
+			std::optional<T> m_Result;
+
+		public:
+			Task<T> get_return_object() noexcept
+			{
+				return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+			}
+
+			template<class TValue>
+			requires(std::is_constructible_v<T, TValue>)
+			void return_value(TValue&& value)
+			{
+				m_Result.emplace(std::forward<TValue>(value));
+			}
+
+			T TakeResult()
+			{
+				RethrowException();
+				return std::move(*m_Result);
+			}
+	};
+
+	template<>
+	class TaskPromise<void> final: public TaskPromiseBase
+	{
+		public:
+			Task<void> get_return_object() noexcept;
+
+			void return_void() noexcept
+			{
+			}
+
+			void TakeResult()
+			{
+				RethrowException();
+			}
+	};
+
+	template<class TPromise>
+	IAsyncTaskExecutor* GetCoroutineExecutor(std::coroutine_handle<TPromise> handle) noexcept
+	{
+		if constexpr(std::is_base_of_v<TaskPromiseBase, TPromise>)
+		{
+			return handle.promise().GetExecutor();
+		}
+		else
+		{
+			return nullptr;
+		}
+	}
+}
+
+namespace kxf
+{
+	// Lazily started coroutine. Awaiting a task starts it on the awaiting thread and the awaiting coroutine is resumed from the
+	// task's final suspension point directly (symmetric transfer), so deep chains of tasks don't grow the stack. A task inherits
+	// the executor of the coroutine awaiting it, see 'Async::ResumeOn'.
+	template<class T>
+	class Task final
+	{
+		public:
+			using promise_type = Private::TaskPromise<T>;
+
+		private:
+			class Awaiter final
+			{
+				private:
+					std::coroutine_handle<promise_type> m_Handle;
+
+				public:
+					Awaiter(std::coroutine_handle<promise_type> handle) noexcept
+						:m_Handle(handle)
+					{
+					}
+
+				public:
+					bool await_ready() const noexcept
+					{
+						return m_Handle.done();
+					}
+
+					template<class TPromise>
+					std::coroutine_handle<> await_suspend(std::coroutine_handle<TPromise> awaiting) noexcept
+					{
+						auto& promise = m_Handle.promise();
+						promise.m_Continuation = awaiting;
+						promise.m_ContinuationExecutor = Private::GetCoroutineExecutor(awaiting);
+						if (!promise.m_Executor)
+						{
+							promise.m_Executor = promise.m_ContinuationExecutor;
+						}
+						return m_Handle;
+					}
+
+					T await_resume()
+					{
+						return m_Handle.promise().TakeResult();
+					}
+			};
+
+		private:
+			std::coroutine_handle<promise_type> m_Handle;
+
+		private:
+			static void Start(std::coroutine_handle<promise_type> handle, IAsyncTaskExecutor* executor)
+			{
+				handle.promise().m_Executor = executor;
+				Private::ResumeCoroutine(handle, executor);
+			}
+
+		public:
+			Task() noexcept = default;
+			explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+				:m_Handle(handle)
+			{
+			}
+			Task(Task&& other) noexcept
+				:m_Handle(std::exchange(other.m_Handle, {}))
+			{
+			}
+			Task(const Task&) = delete;
+			~Task()
+			{
+				if (m_Handle)
+				{
+					m_Handle.destroy();
+				}
+			}
+
+		public:
+			bool IsNull() const noexcept
+			{
+				return !m_Handle;
+			}
+			bool IsDone() const noexcept
+			{
+				return m_Handle && m_Handle.done();
+			}
+
+			// Starts the task on the executor, or on the calling thread if it's null, and blocks until it's completed.
+			// Must not be called from a thread of the same executor which the task needs to make progress.
+			T SyncWait(IAsyncTaskExecutor* executor = nullptr)
+			{
+				Private::TaskCompletionEvent event;
+				m_Handle.promise().m_CompletionEvent = &event;
+
+				Start(m_Handle, executor);
+				event.Wait();
+
+				return m_Handle.promise().TakeResult();
+			}
+
+			// Starts the task on the executor, or on the calling thread if it's null, and lets it destroy itself once it's
+			// completed. The result and any unhandled exception are discarded.
+			void Detach(IAsyncTaskExecutor* executor = nullptr)
+			{
+				auto handle = std::exchange(m_Handle, {});
+				handle.promise().m_IsDetached = true;
+				Start(handle, executor);
+			}
+
+		public:
+			explicit operator bool() const noexcept
+			{
+				return !IsNull();
+			}
+			bool operator!() const noexcept
+			{
+				return IsNull();
+			}
+
+			Awaiter operator co_await() const noexcept
+			{
+				return m_Handle;
+			}
+
+			Task& operator=(Task&& other) noexcept
+			{
+				if (this != &other)
+				{
+					if (m_Handle)
+					{
+						m_Handle.destroy();
+					}
+					m_Handle = std::exchange(other.m_Handle, {});
+				}
+				return *this;
+			}
+			Task& operator=(const Task&) = delete;
+	};
+}
+
+namespace kxf::Private
+{
+	inline Task<void> TaskPromise<void>::get_return_object() noexcept
+	{
+		return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+	}
+}
@@ -0,0 +1,311 @@
+#include "kxf-pch.h"
+#include "TimerWheel.h"
+
+namespace
+{
+	constexpr uint64_t g_NoEvent = std::numeric_limits<uint64_t>::max();
+
+	constexpr uint64_t MakeTimerID(uint32_t index, uint32_t generation) noexcept
+	{
+		return (static_cast<uint64_t>(generation) << 32)|(static_cast<uint64_t>(index) + 1);
+	}
+}
+
+namespace kxf
+{
+	uint64_t TimerWheel::GetCurrentTick() const noexcept
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_StartTime).count());
+	}
+	uint64_t TimerWheel::GetNextEventTick() const noexcept
+	{
+		// A slot of level N is processed every 64^(N + 1) ticks, when the current tick crosses its start
+		uint64_t next = g_NoEvent;
+		for (uint32_t level = 0; level < LevelCount; level++)
+		{
+			if (const uint64_t occupied = m_OccupiedSlots[level])
+			{
+				const uint32_t shift = level * LevelBits;
+				const uint64_t base = m_CurrentTick >> shift;
+
+				// Bit N of the rotated mask is the slot N + 1 positions after the current one
+				const uint64_t rotated = std::rotr(occupied, static_cast<int>((base + 1) % SlotCount));
+				const uint64_t distance = std::countr_zero(rotated) + 1;
+				next = std::min(next, (base + distance) << shift);
+			}
+		}
+		return next;
+	}
+
+	uint32_t TimerWheel::AllocateTimer()
+	{
+		if (m_FreeTimer != InvalidIndex)
+		{
+			const uint32_t index = m_FreeTimer;
+			m_FreeTimer = m_Timers[index].Next;
+			return index;
+		}
+
+		m_Timers.emplace_back();
+		return static_cast<uint32_t>(m_Timers.size() - 1);
+	}
+	void TimerWheel::FreeTimer(uint32_t index) noexcept
+	{
+		Timer& timer = m_Timers[index];
+		timer.Generation++;
+		timer.Slot = InvalidIndex;
+		timer.Previous = InvalidIndex;
+		timer.Next = m_FreeTimer;
+		m_FreeTimer = index;
+	}
+	void TimerWheel::Link(uint32_t index) noexcept
+	{
+		// Timers further than the wheel can cover are placed at its far end and placed again when they get there
+		constexpr uint64_t maxDelta = (uint64_t(1) << (LevelBits * LevelCount)) - 1;
+
+		Timer& timer = m_Timers[index];
+		const uint64_t delta = std::min(timer.Expiry - std::min(timer.Expiry, m_CurrentTick), maxDelta);
+		const uint32_t level = delta < SlotCount ? 0 : static_cast<uint32_t>((std::bit_width(delta) - 1) / LevelBits);
+		const uint32_t slot = static_cast<uint32_t>(((m_CurrentTick + delta) >> (level * LevelBits)) % SlotCount);
+
+		uint32_t& head = m_Slots[level * SlotCount + slot];
+		timer.Slot = level * SlotCount + slot;
+		timer.Previous = InvalidIndex;
+		timer.Next = head;
+		if (head != InvalidIndex)
+		{
+			m_Timers[head].Previous = index;
+		}
+		head = index;
+		m_OccupiedSlots[level] |= uint64_t(1) << slot;
+	}
+	void TimerWheel::Unlink(uint32_t index) noexcept
+	{
+		Timer& timer = m_Timers[index];
+		if (timer.Previous != InvalidIndex)
+		{
+			m_Timers[timer.Previous].Next = timer.Next;
+		}
+		else
+		{
+			m_Slots[timer.Slot] = timer.Next;
+			if (timer.Next == InvalidIndex)
+			{
+				m_OccupiedSlots[timer.Slot / SlotCount] &= ~(uint64_t(1) << (timer.Slot % SlotCount));
+			}
+		}
+		if (timer.Next != InvalidIndex)
+		{
+			m_Timers[timer.Next].Previous = timer.Previous;
+		}
+		timer.Slot = InvalidIndex;
+	}
+	uint32_t TimerWheel::TakeSlot(uint32_t slot) noexcept
+	{
+		m_OccupiedSlots[slot / SlotCount] &= ~(uint64_t(1) << (slot % SlotCount));
+		return std::exchange(m_Slots[slot], InvalidIndex);
+	}
+
+	void TimerWheel::ProcessTick(uint64_t tick)
+	{
+		// Move the timers of the upper level slots starting at this tick down, from the top so a timer can fall through several
+		// levels at once. None of them can land in the slot being emptied.
+		for (uint32_t level = LevelCount - 1; level != 0; level--)
+		{
+			const uint32_t shift = level * LevelBits;
+			if ((tick & ((uint64_t(1) << shift) - 1)) == 0)
+			{
+				uint32_t index = TakeSlot(level * SlotCount + static_cast<uint32_t>((tick >> shift) % SlotCount));
+				while (index != InvalidIndex)
+				{
+					const uint32_t next = m_Timers[index].Next;
+					Link(index);
+					index = next;
+				}
+			}
+		}
+
+		uint32_t index = TakeSlot(static_cast<uint32_t>(tick % SlotCount));
+		while (index != InvalidIndex)
+		{
+			Timer& timer = m_Timers[index];
+			const uint32_t next = timer.Next;
+
+			if (timer.Expiry > tick)
+			{
+				Link(index);
+			}
+			else
+			{
+				m_Expired.emplace_back(std::move(timer.Callback));
+				timer.Callback = nullptr;
+
+				FreeTimer(index);
+				m_PendingCount--;
+			}
+			index = next;
+		}
+	}
+	void TimerWheel::Advance(uint64_t tick)
+	{
+		// Jump straight to the next occupied slot, the empty ticks in between don't need any processing
+		while (m_CurrentTick < tick)
+		{
+			const uint64_t next = GetNextEventTick();
+			if (next > tick)
+			{
+				m_CurrentTick = tick;
+				break;
+			}
+
+			m_CurrentTick = next;
+			ProcessTick(next);
+		}
+	}
+	void TimerWheel::OnThread()
+	{
+		decltype(m_Expired) expired;
+
+		std::unique_lock lock(m_Lock);
+		while (!m_ShouldTerminate)
+		{
+			Advance(GetCurrentTick());
+			if (!m_Expired.empty())
+			{
+				// Swap the batches to keep both of the buffers allocated
+				std::swap(expired, m_Expired);
+
+				lock.unlock();
+				for (auto& func: expired)
+				{
+					std::invoke(func);
+				}
+				expired.clear();
+				lock.lock();
+
+				continue;
+			}
+
+			m_WakeupTick = GetNextEventTick();
+			if (m_WakeupTick == g_NoEvent)
+			{
+				m_Condition.wait(lock);
+			}
+			else
+			{
+				m_Condition.wait_until(lock, m_StartTime + std::chrono::milliseconds(m_WakeupTick));
+			}
+		}
+	}
+
+	TimerWheel::TimerWheel()
+		:m_StartTime(std::chrono::steady_clock::now())
+	{
+		m_Slots.fill(InvalidIndex);
+	}
+	TimerWheel::~TimerWheel()
+	{
+		Terminate();
+	}
+
+	void TimerWheel::Run()
+	{
+		if (std::unique_lock lock(m_Lock); !m_Thread.joinable())
+		{
+			m_Thread = std::thread([this]()
+			{
+				OnThread();
+			});
+		}
+	}
+	void TimerWheel::Terminate()
+	{
+		std::thread thread;
+		if (std::unique_lock lock(m_Lock); m_Thread.joinable())
+		{
+			m_ShouldTerminate = true;
+			m_Condition.notify_all();
+			thread = std::move(m_Thread);
+		}
+
+		// The timers which haven't fired yet are kept for the next run
+		if (thread.joinable())
+		{
+			thread.join();
+
+			std::unique_lock lock(m_Lock);
+			m_ShouldTerminate = false;
+			m_WakeupTick = g_NoEvent;
+		}
+	}
+	bool TimerWheel::IsRunning() const
+	{
+		std::unique_lock lock(m_Lock);
+		return m_Thread.joinable();
+	}
+
+	TimerWheel::TimerID TimerWheel::Schedule(TimeSpan delay, std::move_only_function<void()> func, TimeSpan tolerance)
+	{
+		if (!func)
+		{
+			return 0;
+		}
+
+		uint64_t expiry = GetCurrentTick() + static_cast<uint64_t>(std::max<int64_t>(delay.GetMilliseconds(), 0));
+		if (tolerance.GetMilliseconds() > 1)
+		{
+			// Round up to the largest power of two within the tolerance, so the close timers share the expiry tick
+			const uint64_t granularity = std::bit_floor(static_cast<uint64_t>(tolerance.GetMilliseconds()));
+			expiry = (expiry + granularity - 1) & ~(granularity - 1);
+		}
+
+		std::unique_lock lock(m_Lock);
+
+		// The current tick can lag behind while the thread is asleep, but never by less than a tick
+		expiry = std::max(expiry, m_CurrentTick + 1);
+
+		const uint32_t index = AllocateTimer();
+		Timer& timer = m_Timers[index];
+		timer.Callback = std::move(func);
+		timer.Expiry = expiry;
+		Link(index);
+		m_PendingCount++;
+
+		// Wake up the thread only if it sleeps past the new expiry
+		if (expiry < m_WakeupTick)
+		{
+			m_WakeupTick = expiry;
+			m_Condition.notify_one();
+		}
+		return MakeTimerID(index, timer.Generation);
+	}
+	bool TimerWheel::Cancel(TimerID id)
+	{
+		const uint64_t index = (id & std::numeric_limits<uint32_t>::max()) - 1;
+		const auto generation = static_cast<uint32_t>(id >> 32);
+
+		// The callback can own anything, so it's destroyed outside of the lock
+		std::move_only_function<void()> callback;
+		if (std::unique_lock lock(m_Lock); index < m_Timers.size())
+		{
+			Timer& timer = m_Timers[index];
+			if (timer.Generation == generation && timer.Slot != InvalidIndex)
+			{
+				Unlink(static_cast<uint32_t>(index));
+				callback = std::move(timer.Callback);
+				timer.Callback = nullptr;
+
+				FreeTimer(static_cast<uint32_t>(index));
+				m_PendingCount--;
+
+				return true;
+			}
+		}
+		return false;
+	}
+	size_t TimerWheel::GetPendingCount() const
+	{
+		std::unique_lock lock(m_Lock);
+		return m_PendingCount;
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "Common.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace kxf
+{
+	// Hierarchical timing wheel with millisecond ticks: six levels of 64 slots each, a level covers 64 times the range of the one
+	// below it. Scheduling and cancelling are constant time, a timer is moved to a lower level at most once per level as its
+	// expiry approaches. The expired timers are collected in batches and called on the thread of the wheel, which sleeps until
+	// the next occupied slot.
+	class KXF_API TimerWheel final
+	{
+		public:
+			// Zero is never a valid ID
+			using TimerID = uint64_t;
+
+		private:
+			static constexpr uint32_t LevelBits = 6;
+			static constexpr uint32_t SlotCount = 1 << LevelBits;
+			static constexpr uint32_t LevelCount = 6;
+			static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+			struct Timer final
+			{
+				std::move_only_function<void()> Callback;
+				uint64_t Expiry = 0;
+
+				// Links in the list of the slot or in the free list
+				uint32_t Previous = InvalidIndex;
+				uint32_t Next = InvalidIndex;
+				uint32_t Slot = InvalidIndex;
+				uint32_t Generation = 0;
+			};
+
+		private:
+			std::vector<Timer> m_Timers;
+			std::array<uint32_t, LevelCount * SlotCount> m_Slots;
+			std::array<uint64_t, LevelCount> m_OccupiedSlots = {};
+			uint32_t m_FreeTimer = InvalidIndex;
+			size_t m_PendingCount = 0;
+
+			const std::chrono::steady_clock::time_point m_StartTime;
+			uint64_t m_CurrentTick = 0;
+			uint64_t m_WakeupTick = std::numeric_limits<uint64_t>::max();
+			std::vector<std::move_only_function<void()>> m_Expired;
+
+			std::thread m_Thread;
+			mutable std::mutex m_Lock;
+			std::condition_variable m_Condition;
+			bool m_ShouldTerminate = false;
+
+		private:
+			uint64_t GetCurrentTick() const noexcept;
+			uint64_t GetNextEventTick() const noexcept;
+
+			uint32_t AllocateTimer();
+			void FreeTimer(uint32_t index) noexcept;
+			void Link(uint32_t index) noexcept;
+			void Unlink(uint32_t index) noexcept;
+			uint32_t TakeSlot(uint32_t slot) noexcept;
+
+			void ProcessTick(uint64_t tick);
+			void Advance(uint64_t tick);
+			void OnThread();
+
+		public:
+			TimerWheel();
+			TimerWheel(const TimerWheel&) = delete;
+			~TimerWheel();
+
+		public:
+			void Run();
+			void Terminate();
+			bool IsRunning() const;
+
+			// The callback is called on the thread of the wheel, it should only hand the work over: queue an event or a task.
+			// A timer with a tolerance can fire up to that much later, its expiry is aligned so the timers expiring around the
+			// same time are fired together.
+			TimerID Schedule(TimeSpan delay, std::move_only_function<void()> func, TimeSpan tolerance = {});
+
+			// Returns true if the timer has been cancelled before it fired, the callback is destroyed without being called
+			bool Cancel(TimerID id);
+			size_t GetPendingCount() const;
+
+		public:
+			TimerWheel& operator=(const TimerWheel&) = delete;
+	};
+}
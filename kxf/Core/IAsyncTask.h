@@ -8,6 +8,7 @@ namespace kxf
 	class TimeSpan;
 	class SystemThread;
 	class IAsyncTaskExecutor;
+	class CancellationToken;
 }
 
 namespace kxf
@@ -22,11 +23,16 @@ namespace kxf
 			virtual void Terminate() = 0;
 			virtual bool IsTerminated() const = 0;
 			virtual bool ShouldTerminate() const = 0;
+			virtual CancellationToken GetCancellationToken() const = 0;
 
 			virtual void WaitCompletion() = 0;
 			virtual bool IsCompleted() const = 0;
 			virtual Any TakeResult() = 0;
 
+			// Called once the task is completed or terminated, on the thread which has finished it. Returns false without storing
+			// the handler if the task has already finished.
+			virtual bool AddCompletionHandler(std::move_only_function<void()> func) = 0;
+
 			virtual TimeSpan GetQueueTime() const = 0;
 			virtual TimeSpan GetStartupTime() const = 0;
 			virtual TimeSpan GetCompletionTime() const = 0;
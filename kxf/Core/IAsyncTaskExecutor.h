@@ -1,6 +1,8 @@
 #pragma once
 #include "Common.h"
 #include "Any.h"
+#include "Async/CancellationToken.h"
+#include "kxf/DateTime/TimeSpan.h"
 #include "kxf/RTTI/RTTI.h"
 
 namespace kxf
@@ -8,12 +10,30 @@ namespace kxf
 	class IAsyncTask;
 }
 
+namespace kxf
+{
+	// Workers take the tasks of a higher class first, the lower ones still get a turn from time to time so they can't be
+	// starved completely.
+	enum class AsyncTaskPriority: uint8_t
+	{
+		Background = 0,
+		Normal,
+		High
+	};
+}
+
 namespace kxf
 {
 	class AsyncTaskInfo final
 	{
+		public:
+			static constexpr size_t PriorityCount = static_cast<size_t>(AsyncTaskPriority::High) + 1;
+
 		private:
 			std::move_only_function<Any(std::shared_ptr<IAsyncTask>)> m_Task;
+			CancellationToken m_CancellationToken;
+			TimeSpan m_Deadline;
+			AsyncTaskPriority m_Priority = AsyncTaskPriority::Normal;
 
 		public:
 			AsyncTaskInfo() noexcept = default;
@@ -28,6 +48,25 @@ namespace kxf
 			{
 			}
 
+			// Function taking the cancellation token of the task, with or without a result
+			template<class TFunc>
+			requires(std::is_invocable_v<TFunc, const CancellationToken&> && !std::is_invocable_v<TFunc, std::shared_ptr<IAsyncTask>>)
+			AsyncTaskInfo(TFunc&& func)
+			{
+				m_Task = [callable = std::move(func)](auto&& task) mutable -> Any
+				{
+					if constexpr(std::is_same_v<void, std::invoke_result_t<TFunc, const CancellationToken&>>)
+					{
+						std::invoke(callable, task->GetCancellationToken());
+						return {};
+					}
+					else
+					{
+						return std::invoke(callable, task->GetCancellationToken());
+					}
+				};
+			}
+
 			// Parameterless void function, no result
 			template<class TFunc>
 			requires(std::is_invocable_v<TFunc> && std::is_same_v<void, std::invoke_result_t<TFunc>>)
@@ -62,6 +101,40 @@ namespace kxf
 				return std::invoke(m_Task, std::move(task));
 			}
 
+			AsyncTaskPriority GetPriority() const noexcept
+			{
+				return m_Priority;
+			}
+			AsyncTaskInfo& SetPriority(AsyncTaskPriority priority) noexcept
+			{
+				m_Priority = priority;
+				return *this;
+			}
+
+			// Point in 'TimeSpan::Now()' time by which the task should be started. It's a hint for ordering only: the tasks
+			// of the same priority class are started earliest deadline first and before the ones without a deadline, a task
+			// which has missed its deadline still runs.
+			TimeSpan GetDeadline() const noexcept
+			{
+				return m_Deadline;
+			}
+			AsyncTaskInfo& SetDeadline(TimeSpan deadline) noexcept
+			{
+				m_Deadline = deadline;
+				return *this;
+			}
+
+			// The task is cancelled together with this token, pass the token of the current task to link a child task to it
+			const CancellationToken& GetCancellationToken() const noexcept
+			{
+				return m_CancellationToken;
+			}
+			AsyncTaskInfo& SetCancellationToken(CancellationToken token) noexcept
+			{
+				m_CancellationToken = std::move(token);
+				return *this;
+			}
+
 		public:
 			explicit operator bool() const noexcept
 			{
@@ -88,6 +161,7 @@ namespace kxf
 			virtual void Terminate() = 0;
 			virtual bool IsRunning() const = 0;
 
+			// Returns null if the task is empty or the executor no longer accepts new tasks because it's being destroyed
 			virtual std::shared_ptr<IAsyncTask> QueueTask(AsyncTaskInfo task) = 0;
 	};
 }
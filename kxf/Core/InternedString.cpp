@@ -0,0 +1,144 @@
+#include "kxf-pch.h"
+#include "InternedString.h"
+#include "kxf/Threading/ReadWriteLock.h"
+#include "kxf/Threading/LockGuard.h"
+
+namespace
+{
+	// Independent locks so threads interning unrelated strings rarely wait for each other
+	constexpr size_t g_ShardCount = 64;
+
+	size_t GetShardIndex(size_t hash) noexcept
+	{
+		// Hash tables of the shards use the low bits, so select the shard by the higher ones
+		return (hash >> 16) % g_ShardCount;
+	}
+	kxf::Private::InternedStringEntry* AddRef(kxf::Private::InternedStringEntry& entry) noexcept
+	{
+		entry.RefCount.fetch_add(1, std::memory_order_relaxed);
+		return &entry;
+	}
+}
+
+namespace kxf
+{
+	struct StringPool::Shard final
+	{
+		mutable ReadWriteLock Lock;
+		std::unordered_map<StringView, std::unique_ptr<Private::InternedStringEntry>> Items;
+	};
+
+	StringPool& StringPool::GetInstance()
+	{
+		static StringPool* instance = new StringPool();
+		return *instance;
+	}
+
+	StringPool::StringPool()
+		:m_Shards(std::make_unique<Shard[]>(g_ShardCount))
+	{
+	}
+	StringPool::~StringPool() noexcept = default;
+
+	void StringPool::Release(Private::InternedStringEntry& entry) noexcept
+	{
+		Shard& shard = m_Shards[GetShardIndex(entry.Hash)];
+
+		// The entry is destroyed outside of the lock
+		std::unique_ptr<Private::InternedStringEntry> removed;
+		if (WriteLockGuard lock(shard.Lock); true)
+		{
+			// 'Intern' and 'Find' add their references under the lock, so nothing can revive the entry once it's dropped to zero here
+			if (entry.RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				auto it = shard.Items.find(entry.Value.view());
+				removed = std::move(it->second);
+				shard.Items.erase(it);
+			}
+		}
+	}
+
+	InternedString StringPool::Intern(StringView value)
+	{
+		if (value.empty())
+		{
+			return {};
+		}
+
+		const size_t hash = std::hash<StringView>()(value);
+		Shard& shard = m_Shards[GetShardIndex(hash)];
+		{
+			ReadLockGuard lock(shard.Lock);
+			if (auto it = shard.Items.find(value); it != shard.Items.end())
+			{
+				return AddRef(*it->second);
+			}
+		}
+
+		WriteLockGuard lock(shard.Lock);
+		if (auto it = shard.Items.find(value); it != shard.Items.end())
+		{
+			return AddRef(*it->second);
+		}
+
+		// The key views the entry's own string, entries are never moved and are removed from the table before they're destroyed
+		auto entry = std::make_unique<Private::InternedStringEntry>();
+		entry->Value = String(value);
+		entry->Hash = hash;
+		entry->Pool = this;
+
+		const auto entryPtr = entry.get();
+		shard.Items.emplace(entryPtr->Value.view(), std::move(entry));
+
+		return entryPtr;
+	}
+	InternedString StringPool::Find(StringView value) const
+	{
+		if (!value.empty())
+		{
+			const Shard& shard = m_Shards[GetShardIndex(std::hash<StringView>()(value))];
+
+			ReadLockGuard lock(shard.Lock);
+			if (auto it = shard.Items.find(value); it != shard.Items.end())
+			{
+				return AddRef(*it->second);
+			}
+		}
+		return {};
+	}
+	size_t StringPool::GetCount() const
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < g_ShardCount; i++)
+		{
+			ReadLockGuard lock(m_Shards[i].Lock);
+			count += m_Shards[i].Items.size();
+		}
+		return count;
+	}
+}
+
+namespace kxf
+{
+	InternedString::InternedString(StringView value)
+		:InternedString(StringPool::GetInstance().Intern(value))
+	{
+	}
+
+	void InternedString::Release() noexcept
+	{
+		if (auto entry = std::exchange(m_Entry, nullptr))
+		{
+			// Only the last reference has to go through the pool, the rest are plain decrements
+			size_t count = entry->RefCount.load(std::memory_order_relaxed);
+			while (count > 1)
+			{
+				if (entry->RefCount.compare_exchange_weak(count, count - 1, std::memory_order_release, std::memory_order_relaxed))
+				{
+					return;
+				}
+			}
+			entry->Pool->Release(*entry);
+		}
+	}
+}
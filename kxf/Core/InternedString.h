@@ -0,0 +1,218 @@
+#pragma once
+#include "Common.h"
+#include "String.h"
+
+namespace kxf
+{
+	class StringPool;
+}
+
+namespace kxf::Private
+{
+	struct InternedStringEntry final
+	{
+		String Value;
+		size_t Hash = 0;
+
+		// Number of the handles, the entry is removed from its pool when the last one is destroyed
+		std::atomic<size_t> RefCount = 1;
+		StringPool* Pool = nullptr;
+	};
+}
+
+namespace kxf
+{
+	// Handle to a string stored in the 'StringPool'. Equal strings interned in the same pool share the same entry,
+	// so equality and hashing are done on the entry address rather than on the string contents. Ordering still
+	// compares the contents so containers sorted by interned strings keep their usual order. Empty string is
+	// represented by the null handle. The handles are reference-counted, the entry is removed from the pool along
+	// with the last one.
+	class KXF_API InternedString final
+	{
+		friend class StringPool;
+		friend struct std::hash<InternedString>;
+
+		private:
+			Private::InternedStringEntry* m_Entry = nullptr;
+
+		private:
+			// Takes over a reference the pool has already added
+			InternedString(Private::InternedStringEntry* entry) noexcept
+				:m_Entry(entry)
+			{
+			}
+
+			void AddRef() const noexcept
+			{
+				if (m_Entry)
+				{
+					m_Entry->RefCount.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+			void Release() noexcept;
+
+		public:
+			InternedString() noexcept = default;
+			InternedString(const InternedString& other) noexcept
+				:m_Entry(other.m_Entry)
+			{
+				AddRef();
+			}
+			InternedString(InternedString&& other) noexcept
+				:m_Entry(std::exchange(other.m_Entry, nullptr))
+			{
+			}
+			explicit InternedString(StringView value);
+			explicit InternedString(const String& value)
+				:InternedString(value.view())
+			{
+			}
+			explicit InternedString(const char* value)
+				:InternedString(String(value))
+			{
+			}
+			explicit InternedString(const wchar_t* value)
+				:InternedString(StringViewOf(value))
+			{
+			}
+			~InternedString() noexcept
+			{
+				Release();
+			}
+
+		public:
+			bool IsEmpty() const noexcept
+			{
+				return m_Entry == nullptr;
+			}
+			const String& GetString() const noexcept
+			{
+				return m_Entry ? m_Entry->Value : NullString;
+			}
+			StringView GetView() const noexcept
+			{
+				return m_Entry ? m_Entry->Value.view() : StringView();
+			}
+
+			// Hash of the string contents, same as 'std::hash<String>' would return for it
+			size_t GetContentHash() const noexcept
+			{
+				return m_Entry ? m_Entry->Hash : 0;
+			}
+
+		public:
+			explicit operator bool() const noexcept
+			{
+				return !IsEmpty();
+			}
+			bool operator!() const noexcept
+			{
+				return IsEmpty();
+			}
+
+			operator const String&() const noexcept
+			{
+				return GetString();
+			}
+
+			bool operator==(const InternedString& other) const noexcept
+			{
+				return m_Entry == other.m_Entry;
+			}
+			std::strong_ordering operator<=>(const InternedString& other) const noexcept
+			{
+				if (m_Entry == other.m_Entry)
+				{
+					return std::strong_ordering::equal;
+				}
+				return GetView() <=> other.GetView();
+			}
+
+			InternedString& operator=(const InternedString& other) noexcept
+			{
+				other.AddRef();
+				Release();
+				m_Entry = other.m_Entry;
+
+				return *this;
+			}
+			InternedString& operator=(InternedString&& other) noexcept
+			{
+				if (this != &other)
+				{
+					Release();
+					m_Entry = std::exchange(other.m_Entry, nullptr);
+				}
+				return *this;
+			}
+	};
+}
+
+namespace kxf
+{
+	class KXF_API StringPool final
+	{
+		friend class InternedString;
+
+		public:
+			// The global pool used by 'InternedString' constructors. It's never destroyed so handles
+			// held by static objects stay valid during the program shutdown.
+			static StringPool& GetInstance();
+
+		private:
+			struct Shard;
+
+		private:
+			std::unique_ptr<Shard[]> m_Shards;
+
+		private:
+			void Release(Private::InternedStringEntry& entry) noexcept;
+
+		public:
+			StringPool();
+			StringPool(const StringPool&) = delete;
+
+			// All the handles to the strings of the pool must be destroyed before it
+			~StringPool() noexcept;
+
+		public:
+			InternedString Intern(StringView value);
+			InternedString Find(StringView value) const;
+			size_t GetCount() const;
+
+		public:
+			StringPool& operator=(const StringPool&) = delete;
+	};
+}
+
+namespace std
+{
+	template<>
+	struct hash<kxf::InternedString> final
+	{
+		size_t operator()(const kxf::InternedString& value) const noexcept
+		{
+			return std::hash<const void*>()(value.m_Entry);
+		}
+	};
+}
+
+namespace kxf
+{
+	template<>
+	struct BinarySerializer<InternedString> final
+	{
+		uint64_t Serialize(IOutputStream& stream, const InternedString& value) const
+		{
+			return Serialization::WriteObject(stream, value.GetString());
+		}
+		uint64_t Deserialize(IInputStream& stream, InternedString& value) const
+		{
+			String buffer;
+			auto read = Serialization::ReadObject(stream, buffer);
+			value = InternedString(buffer);
+
+			return read;
+		}
+	};
+}
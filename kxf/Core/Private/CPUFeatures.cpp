@@ -0,0 +1,45 @@
+#include "kxf-pch.h"
+#include "CPUFeatures.h"
+#include <intrin.h>
+#include <immintrin.h>
+
+namespace
+{
+	kxf::FlagSet<kxf::Private::CPUFeature> DetectCPUFeatures() noexcept
+	{
+		using namespace kxf;
+		using Private::CPUFeature;
+
+		int info[4] = {};
+		::__cpuid(info, 0);
+		const int maxLeaf = info[0];
+
+		FlagSet<CPUFeature> features;
+		if (maxLeaf >= 1)
+		{
+			::__cpuid(info, 1);
+			features.Add(CPUFeature::SSE2, (info[3] & (1 << 26)) != 0);
+			features.Add(CPUFeature::SSSE3, (info[2] & (1 << 9)) != 0);
+			features.Add(CPUFeature::SSE41, (info[2] & (1 << 19)) != 0);
+
+			// AVX2 also requires the OS to save the upper halves of the YMM registers
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const bool avx = (info[2] & (1 << 28)) != 0;
+			if (osxsave && avx && (::_xgetbv(0) & 0x6) == 0x6 && maxLeaf >= 7)
+			{
+				::__cpuidex(info, 7, 0);
+				features.Add(CPUFeature::AVX2, (info[1] & (1 << 5)) != 0);
+			}
+		}
+		return features;
+	}
+}
+
+namespace kxf::Private
+{
+	FlagSet<CPUFeature> GetCPUFeatures() noexcept
+	{
+		static const FlagSet<CPUFeature> features = DetectCPUFeatures();
+		return features;
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "../Common.h"
+
+namespace kxf::Private
+{
+	enum class CPUFeature: uint32_t
+	{
+		None = 0,
+
+		SSE2 = FlagSetValue<CPUFeature>(0),
+		SSSE3 = FlagSetValue<CPUFeature>(1),
+		SSE41 = FlagSetValue<CPUFeature>(2),
+		AVX2 = FlagSetValue<CPUFeature>(3)
+	};
+}
+namespace kxf
+{
+	kxf_FlagSet_Declare(Private::CPUFeature);
+}
+
+namespace kxf::Private
+{
+	// Queried once and cached, safe to call from hot paths to select a SIMD kernel
+	KXF_API FlagSet<CPUFeature> GetCPUFeatures() noexcept;
+}
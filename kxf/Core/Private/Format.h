@@ -255,15 +255,15 @@ namespace kxf
 	template<class TFormat, class... Args>
 	String& String::Format(const TFormat& format, Args&&... arg)
 	{
-		Private::DoFormatTo(std::back_inserter(m_String), StringViewOf(format), std::forward<Args>(arg)...);
+		Private::DoFormatTo(std::back_inserter(*m_String), StringViewOf(format), std::forward<Args>(arg)...);
 		return *this;
 	}
 
 	template<class TFormat, class... Args>
 	String& String::FormatAt(size_t position, const TFormat& format, Args&&... arg)
 	{
-		position = std::clamp<size_t>(position, 0, m_String.size());
-		Private::DoFormatTo(std::inserter(m_String, m_String.begin() + position), StringViewOf(format), std::forward<Args>(arg)...);
+		position = std::clamp<size_t>(position, 0, m_String->size());
+		Private::DoFormatTo(std::inserter(*m_String, m_String->begin() + position), StringViewOf(format), std::forward<Args>(arg)...);
 
 		return *this;
 	}
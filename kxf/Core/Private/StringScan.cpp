@@ -0,0 +1,484 @@
+#include "kxf-pch.h"
+#include "StringScan.h"
+#include "StringSearch.h"
+#include "CPUFeatures.h"
+#include "kxf/Core/UniChar.h"
+#include <immintrin.h>
+
+namespace
+{
+	constexpr size_t npos = std::wstring_view::npos;
+
+	// Set of code units which can be matched exactly by the vector kernels. Case-insensitive sets are expanded
+	// to both lower and upper case variants of each ASCII letter, anything that can't be expanded this way is
+	// left for the scalar path.
+	class CharacterSet final
+	{
+		public:
+			static constexpr size_t MaxCount = 8;
+
+		private:
+			std::array<wchar_t, MaxCount> m_Items = {};
+			size_t m_Count = 0;
+
+		private:
+			bool Add(wchar_t c) noexcept
+			{
+				if (Contains(c))
+				{
+					return true;
+				}
+				else if (m_Count < m_Items.size())
+				{
+					m_Items[m_Count++] = c;
+					return true;
+				}
+				return false;
+			}
+
+		public:
+			bool Build(std::wstring_view characters, bool ignoreCase) noexcept
+			{
+				const auto& foldTable = kxf::Private::CaseFoldTable::GetInstance();
+				for (wchar_t c: characters)
+				{
+					if (ignoreCase)
+					{
+						if (!foldTable.IsASCIIFoldExact(c))
+						{
+							return false;
+						}
+
+						const wchar_t folded = foldTable.Fold(c);
+						if (!Add(folded))
+						{
+							return false;
+						}
+						if (folded >= L'a' && folded <= L'z' && !Add(folded - (L'a' - L'A')))
+						{
+							return false;
+						}
+					}
+					else if (!Add(c))
+					{
+						return false;
+					}
+				}
+				return m_Count != 0;
+			}
+
+			size_t GetCount() const noexcept
+			{
+				return m_Count;
+			}
+			bool Contains(wchar_t c) const noexcept
+			{
+				return std::find(m_Items.begin(), m_Items.begin() + m_Count, c) != m_Items.begin() + m_Count;
+			}
+
+		public:
+			wchar_t operator[](size_t index) const noexcept
+			{
+				return m_Items[index];
+			}
+	};
+
+	// Instruction set adapters for the kernels below. 'ToMask' returns two bits per 16-bit lane and one bit per byte for the byte variants.
+	struct ISA_SSE2 final
+	{
+		using Vector = __m128i;
+
+		static constexpr size_t Lanes = sizeof(Vector) / sizeof(wchar_t);
+		static constexpr size_t ByteLanes = sizeof(Vector);
+		static constexpr uint32_t FullMask = 0xFFFFu;
+
+		static Vector Load(const wchar_t* data) noexcept
+		{
+			return _mm_loadu_si128(reinterpret_cast<const Vector*>(data));
+		}
+		static Vector LoadBytes(const char* data) noexcept
+		{
+			return _mm_loadu_si128(reinterpret_cast<const Vector*>(data));
+		}
+		static Vector Broadcast(wchar_t c) noexcept
+		{
+			return _mm_set1_epi16(static_cast<short>(c));
+		}
+		static Vector BroadcastByte(char c) noexcept
+		{
+			return _mm_set1_epi8(c);
+		}
+		static Vector Equal(Vector left, Vector right) noexcept
+		{
+			return _mm_cmpeq_epi16(left, right);
+		}
+		static Vector EqualBytes(Vector left, Vector right) noexcept
+		{
+			return _mm_cmpeq_epi8(left, right);
+		}
+		static Vector Or(Vector left, Vector right) noexcept
+		{
+			return _mm_or_si128(left, right);
+		}
+		static Vector IsASCIIWhitespace(Vector value) noexcept
+		{
+			// Space or anything in [\t, \r] range, the latter is tested as 'saturate(c - \t - 4) == 0'
+			const Vector space = _mm_cmpeq_epi16(value, Broadcast(L' '));
+			const Vector control = _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(value, Broadcast(L'\t')), Broadcast(L'\r' - L'\t')), _mm_setzero_si128());
+			return _mm_or_si128(space, control);
+		}
+		static uint32_t ToMask(Vector value) noexcept
+		{
+			return static_cast<uint32_t>(_mm_movemask_epi8(value));
+		}
+	};
+	struct ISA_AVX2 final
+	{
+		using Vector = __m256i;
+
+		static constexpr size_t Lanes = sizeof(Vector) / sizeof(wchar_t);
+		static constexpr size_t ByteLanes = sizeof(Vector);
+		static constexpr uint32_t FullMask = 0xFFFFFFFFu;
+
+		static Vector Load(const wchar_t* data) noexcept
+		{
+			return _mm256_loadu_si256(reinterpret_cast<const Vector*>(data));
+		}
+		static Vector LoadBytes(const char* data) noexcept
+		{
+			return _mm256_loadu_si256(reinterpret_cast<const Vector*>(data));
+		}
+		static Vector Broadcast(wchar_t c) noexcept
+		{
+			return _mm256_set1_epi16(static_cast<short>(c));
+		}
+		static Vector BroadcastByte(char c) noexcept
+		{
+			return _mm256_set1_epi8(c);
+		}
+		static Vector Equal(Vector left, Vector right) noexcept
+		{
+			return _mm256_cmpeq_epi16(left, right);
+		}
+		static Vector EqualBytes(Vector left, Vector right) noexcept
+		{
+			return _mm256_cmpeq_epi8(left, right);
+		}
+		static Vector Or(Vector left, Vector right) noexcept
+		{
+			return _mm256_or_si256(left, right);
+		}
+		static Vector IsASCIIWhitespace(Vector value) noexcept
+		{
+			const Vector space = _mm256_cmpeq_epi16(value, Broadcast(L' '));
+			const Vector control = _mm256_cmpeq_epi16(_mm256_subs_epu16(_mm256_sub_epi16(value, Broadcast(L'\t')), Broadcast(L'\r' - L'\t')), _mm256_setzero_si256());
+			return _mm256_or_si256(space, control);
+		}
+		static uint32_t ToMask(Vector value) noexcept
+		{
+			return static_cast<uint32_t>(_mm256_movemask_epi8(value));
+		}
+	};
+
+	template<class TFunc>
+	size_t Dispatch(TFunc&& func) noexcept
+	{
+		using kxf::Private::CPUFeature;
+
+		if (kxf::Private::GetCPUFeatures().Contains(CPUFeature::AVX2))
+		{
+			return std::invoke(func, ISA_AVX2());
+		}
+		return std::invoke(func, ISA_SSE2());
+	}
+
+	size_t FirstLane(uint32_t mask) noexcept
+	{
+		return std::countr_zero(mask) / 2;
+	}
+	size_t LastLane(uint32_t mask) noexcept
+	{
+		return (std::bit_width(mask) - 1) / 2;
+	}
+
+	// Vector kernels
+	template<class ISA>
+	uint32_t MatchSet(const wchar_t* data, const typename ISA::Vector* needles, size_t count, uint32_t flip) noexcept
+	{
+		const auto value = ISA::Load(data);
+
+		auto matches = ISA::Equal(value, needles[0]);
+		for (size_t i = 1; i < count; i++)
+		{
+			matches = ISA::Or(matches, ISA::Equal(value, needles[i]));
+		}
+		return ISA::ToMask(matches) ^ flip;
+	}
+
+	template<class ISA>
+	size_t FindAnyKernel(const wchar_t* data, size_t offset, size_t length, const CharacterSet& set, bool negate) noexcept
+	{
+		typename ISA::Vector needles[CharacterSet::MaxCount];
+		for (size_t i = 0; i < set.GetCount(); i++)
+		{
+			needles[i] = ISA::Broadcast(set[i]);
+		}
+		const uint32_t flip = negate ? ISA::FullMask : 0;
+
+		size_t i = offset;
+		for (; i + ISA::Lanes <= length; i += ISA::Lanes)
+		{
+			if (const uint32_t mask = MatchSet<ISA>(data + i, needles, set.GetCount(), flip); mask != 0)
+			{
+				return i + FirstLane(mask);
+			}
+		}
+		for (; i < length; i++)
+		{
+			if (set.Contains(data[i]) != negate)
+			{
+				return i;
+			}
+		}
+		return npos;
+	}
+
+	template<class ISA>
+	size_t ReverseFindAnyKernel(const wchar_t* data, size_t end, const CharacterSet& set, bool negate) noexcept
+	{
+		typename ISA::Vector needles[CharacterSet::MaxCount];
+		for (size_t i = 0; i < set.GetCount(); i++)
+		{
+			needles[i] = ISA::Broadcast(set[i]);
+		}
+		const uint32_t flip = negate ? ISA::FullMask : 0;
+
+		size_t i = end;
+		while (i >= ISA::Lanes)
+		{
+			i -= ISA::Lanes;
+			if (const uint32_t mask = MatchSet<ISA>(data + i, needles, set.GetCount(), flip); mask != 0)
+			{
+				return i + LastLane(mask);
+			}
+		}
+		while (i != 0)
+		{
+			i--;
+			if (set.Contains(data[i]) != negate)
+			{
+				return i;
+			}
+		}
+		return npos;
+	}
+
+	// Vector kernels only classify ASCII whitespace, a lane that isn't one of those can still be a Unicode whitespace,
+	// so the first such lane is where the scalar loop takes over.
+	size_t FindNonWhitespaceScalar(const wchar_t* data, size_t offset, size_t length) noexcept
+	{
+		for (size_t i = offset; i < length; i++)
+		{
+			if (!kxf::UniChar(data[i]).IsWhitespace())
+			{
+				return i;
+			}
+		}
+		return npos;
+	}
+	size_t ReverseFindNonWhitespaceScalar(const wchar_t* data, size_t end) noexcept
+	{
+		for (size_t i = end; i != 0; i--)
+		{
+			if (!kxf::UniChar(data[i - 1]).IsWhitespace())
+			{
+				return i - 1;
+			}
+		}
+		return npos;
+	}
+
+	template<class ISA>
+	size_t FindNonWhitespaceKernel(const wchar_t* data, size_t length) noexcept
+	{
+		size_t i = 0;
+		for (; i + ISA::Lanes <= length; i += ISA::Lanes)
+		{
+			if (const uint32_t mask = ISA::ToMask(ISA::IsASCIIWhitespace(ISA::Load(data + i))) ^ ISA::FullMask; mask != 0)
+			{
+				return FindNonWhitespaceScalar(data, i + FirstLane(mask), length);
+			}
+		}
+		return FindNonWhitespaceScalar(data, i, length);
+	}
+
+	template<class ISA>
+	size_t ReverseFindNonWhitespaceKernel(const wchar_t* data, size_t length) noexcept
+	{
+		size_t i = length;
+		while (i >= ISA::Lanes)
+		{
+			i -= ISA::Lanes;
+			if (const uint32_t mask = ISA::ToMask(ISA::IsASCIIWhitespace(ISA::Load(data + i))) ^ ISA::FullMask; mask != 0)
+			{
+				return ReverseFindNonWhitespaceScalar(data, i + LastLane(mask) + 1);
+			}
+		}
+		return ReverseFindNonWhitespaceScalar(data, i);
+	}
+
+	template<class ISA>
+	size_t FindByteKernel(const char* data, size_t offset, size_t length, char c) noexcept
+	{
+		const auto needle = ISA::BroadcastByte(c);
+
+		// Two vectors per iteration, lines in text files are usually long enough for this to pay off
+		size_t i = offset;
+		for (; i + 2 * ISA::ByteLanes <= length; i += 2 * ISA::ByteLanes)
+		{
+			const auto first = ISA::EqualBytes(ISA::LoadBytes(data + i), needle);
+			const auto second = ISA::EqualBytes(ISA::LoadBytes(data + i + ISA::ByteLanes), needle);
+			if (ISA::ToMask(ISA::Or(first, second)) != 0)
+			{
+				if (const uint32_t mask = ISA::ToMask(first); mask != 0)
+				{
+					return i + std::countr_zero(mask);
+				}
+				return i + ISA::ByteLanes + std::countr_zero(ISA::ToMask(second));
+			}
+		}
+		for (; i + ISA::ByteLanes <= length; i += ISA::ByteLanes)
+		{
+			if (const uint32_t mask = ISA::ToMask(ISA::EqualBytes(ISA::LoadBytes(data + i), needle)); mask != 0)
+			{
+				return i + std::countr_zero(mask);
+			}
+		}
+		for (; i < length; i++)
+		{
+			if (data[i] == c)
+			{
+				return i;
+			}
+		}
+		return npos;
+	}
+
+	// Scalar fallback for sets which can't be matched exactly by comparing code units
+	bool ContainsCharacter(std::wstring_view characters, wchar_t c, bool ignoreCase) noexcept
+	{
+		if (ignoreCase)
+		{
+			const auto& foldTable = kxf::Private::CaseFoldTable::GetInstance();
+			for (wchar_t item: characters)
+			{
+				if (foldTable.IsEqual(item, c))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		return characters.find(c) != npos;
+	}
+}
+
+namespace kxf::Private
+{
+	size_t FindCharacter(std::wstring_view source, wchar_t c, size_t offset, bool ignoreCase) noexcept
+	{
+		return FindAnyCharacter(source, {&c, 1}, offset, ignoreCase, false);
+	}
+	size_t ReverseFindCharacter(std::wstring_view source, wchar_t c, size_t end, bool ignoreCase) noexcept
+	{
+		return ReverseFindAnyCharacter(source, {&c, 1}, end, ignoreCase, false);
+	}
+
+	size_t FindAnyCharacter(std::wstring_view source, std::wstring_view characters, size_t offset, bool ignoreCase, bool negate) noexcept
+	{
+		const size_t length = source.length();
+		if (offset >= length)
+		{
+			return npos;
+		}
+
+		if (CharacterSet set; length - offset >= ISA_SSE2::Lanes && set.Build(characters, ignoreCase))
+		{
+			return Dispatch([&]<class ISA>(ISA)
+			{
+				return FindAnyKernel<ISA>(source.data(), offset, length, set, negate);
+			});
+		}
+
+		for (size_t i = offset; i < length; i++)
+		{
+			if (ContainsCharacter(characters, source[i], ignoreCase) != negate)
+			{
+				return i;
+			}
+		}
+		return npos;
+	}
+	size_t ReverseFindAnyCharacter(std::wstring_view source, std::wstring_view characters, size_t end, bool ignoreCase, bool negate) noexcept
+	{
+		end = std::min(end, source.length());
+
+		if (CharacterSet set; end >= ISA_SSE2::Lanes && set.Build(characters, ignoreCase))
+		{
+			return Dispatch([&]<class ISA>(ISA)
+			{
+				return ReverseFindAnyKernel<ISA>(source.data(), end, set, negate);
+			});
+		}
+
+		for (size_t i = end; i != 0; i--)
+		{
+			if (ContainsCharacter(characters, source[i - 1], ignoreCase) != negate)
+			{
+				return i - 1;
+			}
+		}
+		return npos;
+	}
+
+	size_t FindNonWhitespace(std::wstring_view source) noexcept
+	{
+		if (source.length() >= ISA_SSE2::Lanes)
+		{
+			return Dispatch([&]<class ISA>(ISA)
+			{
+				return FindNonWhitespaceKernel<ISA>(source.data(), source.length());
+			});
+		}
+		return FindNonWhitespaceScalar(source.data(), 0, source.length());
+	}
+	size_t ReverseFindNonWhitespace(std::wstring_view source) noexcept
+	{
+		if (source.length() >= ISA_SSE2::Lanes)
+		{
+			return Dispatch([&]<class ISA>(ISA)
+			{
+				return ReverseFindNonWhitespaceKernel<ISA>(source.data(), source.length());
+			});
+		}
+		return ReverseFindNonWhitespaceScalar(source.data(), source.length());
+	}
+
+	size_t FindByte(std::string_view source, char c, size_t offset) noexcept
+	{
+		const size_t length = source.length();
+		if (offset >= length)
+		{
+			return npos;
+		}
+
+		if (length - offset >= ISA_SSE2::ByteLanes)
+		{
+			return Dispatch([&]<class ISA>(ISA)
+			{
+				return FindByteKernel<ISA>(source.data(), offset, length, c);
+			});
+		}
+		return source.find(c, offset);
+	}
+}
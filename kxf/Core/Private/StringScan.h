@@ -0,0 +1,31 @@
+#pragma once
+#include "../Common.h"
+#include <string_view>
+
+namespace kxf::Private
+{
+	// Vectorized character scanning over UTF-16 code units. Each function selects an AVX2 or SSE2 kernel
+	// at runtime (see 'GetCPUFeatures') and falls back to a scalar loop for short tails or when a character
+	// set can't be matched exactly by comparing code units (like case-insensitive non-ASCII characters).
+	// All functions return 'std::wstring_view::npos' if nothing is found.
+
+	// Index of the first occurrence of 'c' at or after 'offset'
+	size_t FindCharacter(std::wstring_view source, wchar_t c, size_t offset, bool ignoreCase) noexcept;
+
+	// Index of the last occurrence of 'c' before 'end'
+	size_t ReverseFindCharacter(std::wstring_view source, wchar_t c, size_t end, bool ignoreCase) noexcept;
+
+	// Index of the first character at or after 'offset' which is (or isn't, if 'negate' is set) in the 'characters' set
+	size_t FindAnyCharacter(std::wstring_view source, std::wstring_view characters, size_t offset, bool ignoreCase, bool negate = false) noexcept;
+
+	// Index of the last character before 'end' which is (or isn't, if 'negate' is set) in the 'characters' set
+	size_t ReverseFindAnyCharacter(std::wstring_view source, std::wstring_view characters, size_t end, bool ignoreCase, bool negate = false) noexcept;
+
+	// Index of the first (last) character which isn't a whitespace as defined by 'UniChar::IsWhitespace'
+	size_t FindNonWhitespace(std::wstring_view source) noexcept;
+	size_t ReverseFindNonWhitespace(std::wstring_view source) noexcept;
+
+	// Index of the first occurrence of the byte 'c' at or after 'offset' in a narrow buffer. Can be used to split UTF-8 text
+	// on ASCII delimiters since their values never occur inside of the multi-byte sequences.
+	size_t FindByte(std::string_view source, char c, size_t offset = 0) noexcept;
+}
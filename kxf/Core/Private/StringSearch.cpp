@@ -0,0 +1,265 @@
+#include "kxf-pch.h"
+#include "StringSearch.h"
+#include "StringScan.h"
+
+#include <Windows.h>
+#include "kxf/Win32/UndefMacros.h"
+
+namespace
+{
+	// Shift tables are indexed by the low byte of the folded character. Characters sharing the same
+	// low byte share the same bucket, which only makes the shift more conservative, never incorrect.
+	using ShiftTable = std::array<size_t, 256>;
+
+	size_t ToBucket(wchar_t c) noexcept
+	{
+		return static_cast<uint8_t>(c);
+	}
+}
+
+namespace kxf::Private
+{
+	const CaseFoldTable& CaseFoldTable::GetInstance() noexcept
+	{
+		static const CaseFoldTable instance;
+		return instance;
+	}
+
+	CaseFoldTable::CaseFoldTable() noexcept
+	{
+		// Build the table with the same function 'String::MakeLower' uses so case-insensitive
+		// search results stay consistent with the lowercase conversion.
+		for (size_t i = 0; i < std::size(m_Table); i++)
+		{
+			m_Table[i] = static_cast<wchar_t>(i);
+		}
+		::CharLowerBuffW(m_Table, static_cast<DWORD>(std::size(m_Table)));
+
+		for (size_t i = 0x80; i < std::size(m_Table); i++)
+		{
+			if (m_Table[i] < 0x80)
+			{
+				m_NonASCIIFolds.set(m_Table[i]);
+			}
+		}
+	}
+}
+
+namespace kxf::Private
+{
+	size_t FindNoCase(std::wstring_view source, std::wstring_view pattern, size_t offset) noexcept
+	{
+		const size_t sourceLength = source.length();
+		const size_t patternLength = pattern.length();
+
+		if (offset > sourceLength)
+		{
+			return std::wstring_view::npos;
+		}
+		if (patternLength == 0)
+		{
+			return offset;
+		}
+		if (patternLength > sourceLength - offset)
+		{
+			return std::wstring_view::npos;
+		}
+
+		const auto& foldTable = CaseFoldTable::GetInstance();
+		const wchar_t* data = source.data();
+		const wchar_t lastFolded = foldTable.Fold(pattern.back());
+
+		if (patternLength == 1)
+		{
+			for (size_t i = offset; i < sourceLength; i++)
+			{
+				if (foldTable.Fold(data[i]) == lastFolded)
+				{
+					return i;
+				}
+			}
+			return std::wstring_view::npos;
+		}
+
+		// Horspool shift: distance from the last occurrence of a character to the end of the pattern
+		ShiftTable shiftTable;
+		shiftTable.fill(patternLength);
+		for (size_t i = 0; i < patternLength - 1; i++)
+		{
+			shiftTable[ToBucket(foldTable.Fold(pattern[i]))] = patternLength - 1 - i;
+		}
+
+		const size_t lastPosition = sourceLength - patternLength;
+		for (size_t pos = offset; pos <= lastPosition;)
+		{
+			const wchar_t c = foldTable.Fold(data[pos + patternLength - 1]);
+			if (c == lastFolded && foldTable.IsEqual(data + pos, pattern.data(), patternLength - 1))
+			{
+				return pos;
+			}
+			pos += shiftTable[ToBucket(c)];
+		}
+		return std::wstring_view::npos;
+	}
+	size_t ReverseFindNoCase(std::wstring_view source, std::wstring_view pattern, size_t offset) noexcept
+	{
+		const size_t sourceLength = source.length();
+		const size_t patternLength = pattern.length();
+
+		if (patternLength == 0)
+		{
+			return std::min(offset, sourceLength);
+		}
+		if (patternLength > sourceLength)
+		{
+			return std::wstring_view::npos;
+		}
+
+		const auto& foldTable = CaseFoldTable::GetInstance();
+		const wchar_t* data = source.data();
+		const wchar_t firstFolded = foldTable.Fold(pattern.front());
+		size_t pos = std::min(offset, sourceLength - patternLength);
+
+		if (patternLength == 1)
+		{
+			for (size_t i = pos + 1; i != 0; i--)
+			{
+				if (foldTable.Fold(data[i - 1]) == firstFolded)
+				{
+					return i - 1;
+				}
+			}
+			return std::wstring_view::npos;
+		}
+
+		// Mirrored Horspool shift: distance from the first occurrence of a character to the start of the pattern
+		ShiftTable shiftTable;
+		shiftTable.fill(patternLength);
+		for (size_t i = patternLength - 1; i != 0; i--)
+		{
+			shiftTable[ToBucket(foldTable.Fold(pattern[i]))] = i;
+		}
+
+		for (;;)
+		{
+			const wchar_t c = foldTable.Fold(data[pos]);
+			if (c == firstFolded && foldTable.IsEqual(data + pos + 1, pattern.data() + 1, patternLength - 1))
+			{
+				return pos;
+			}
+
+			const size_t shift = shiftTable[ToBucket(c)];
+			if (pos < shift)
+			{
+				break;
+			}
+			pos -= shift;
+		}
+		return std::wstring_view::npos;
+	}
+}
+
+namespace kxf::Private
+{
+	bool MatchWildcardSegment(std::wstring_view text, std::wstring_view segment, bool ignoreCase) noexcept
+	{
+		if (text.length() != segment.length())
+		{
+			return false;
+		}
+
+		const auto& foldTable = CaseFoldTable::GetInstance();
+		for (size_t i = 0; i < segment.length(); i++)
+		{
+			const wchar_t c = segment[i];
+			if (c != L'?' && (ignoreCase ? !foldTable.IsEqual(c, text[i]) : c != text[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	size_t FindWildcardSegment(std::wstring_view text, std::wstring_view segment, size_t offset, bool ignoreCase, bool isLiteral) noexcept
+	{
+		if (isLiteral)
+		{
+			return ignoreCase ? FindNoCase(text, segment, offset) : text.find(segment, offset);
+		}
+		if (offset > text.length() || segment.length() > text.length() - offset)
+		{
+			return std::wstring_view::npos;
+		}
+
+		// Use the first non-'?' character as an anchor to skip through the text
+		const size_t anchor = segment.find_first_not_of(L'?');
+		if (anchor == std::wstring_view::npos)
+		{
+			return offset;
+		}
+
+		const size_t lastPosition = text.length() - segment.length();
+		for (size_t pos = offset; pos <= lastPosition; pos++)
+		{
+			const size_t anchorPos = FindCharacter(text.substr(0, lastPosition + anchor + 1), segment[anchor], pos + anchor, ignoreCase);
+			if (anchorPos == std::wstring_view::npos)
+			{
+				break;
+			}
+
+			pos = anchorPos - anchor;
+			if (MatchWildcardSegment(text.substr(pos, segment.length()), segment, ignoreCase))
+			{
+				return pos;
+			}
+		}
+		return std::wstring_view::npos;
+	}
+	bool MatchWildcards(std::wstring_view name, std::wstring_view expression, bool ignoreCase) noexcept
+	{
+		if (expression.empty())
+		{
+			return true;
+		}
+
+		// No stars, just a single segment that must match the entire name
+		const size_t firstStar = expression.find(L'*');
+		if (firstStar == std::wstring_view::npos)
+		{
+			return MatchWildcardSegment(name, expression, ignoreCase);
+		}
+
+		// Anchored head and tail segments
+		const size_t lastStar = expression.rfind(L'*');
+		const auto head = expression.substr(0, firstStar);
+		const auto tail = expression.substr(lastStar + 1);
+		if (name.length() < head.length() + tail.length() ||
+			!MatchWildcardSegment(name.substr(0, head.length()), head, ignoreCase) ||
+			!MatchWildcardSegment(name.substr(name.length() - tail.length()), tail, ignoreCase))
+		{
+			return false;
+		}
+
+		// Floating segments in between are matched greedily at their leftmost position
+		const auto window = name.substr(head.length(), name.length() - head.length() - tail.length());
+		auto middle = expression.substr(firstStar + 1, lastStar - firstStar);
+
+		size_t pos = 0;
+		while (!middle.empty())
+		{
+			const size_t star = middle.find(L'*');
+			const auto segment = middle.substr(0, star);
+			middle.remove_prefix(star + 1);
+
+			if (!segment.empty())
+			{
+				pos = FindWildcardSegment(window, segment, pos, ignoreCase, segment.find(L'?') == std::wstring_view::npos);
+				if (pos == std::wstring_view::npos)
+				{
+					return false;
+				}
+				pos += segment.length();
+			}
+		}
+		return true;
+	}
+}
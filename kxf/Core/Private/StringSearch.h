@@ -0,0 +1,67 @@
+#pragma once
+#include "../Common.h"
+#include <string_view>
+#include <bitset>
+
+namespace kxf::Private
+{
+	class CaseFoldTable final
+	{
+		public:
+			static const CaseFoldTable& GetInstance() noexcept;
+
+		private:
+			wchar_t m_Table[0x10000] = {};
+			std::bitset<0x80> m_NonASCIIFolds;
+
+		private:
+			CaseFoldTable() noexcept;
+
+		public:
+			wchar_t Fold(wchar_t c) const noexcept
+			{
+				return m_Table[static_cast<uint16_t>(c)];
+			}
+			bool IsASCIIFoldExact(wchar_t c) const noexcept
+			{
+				// True if the only characters that fold to the same value as 'c' are ASCII characters,
+				// which means that a case-insensitive search for 'c' can skip every non-ASCII character.
+				const wchar_t folded = Fold(c);
+				return folded < 0x80 && !m_NonASCIIFolds.test(folded);
+			}
+			bool IsEqual(wchar_t left, wchar_t right) const noexcept
+			{
+				return left == right || m_Table[static_cast<uint16_t>(left)] == m_Table[static_cast<uint16_t>(right)];
+			}
+			bool IsEqual(const wchar_t* left, const wchar_t* right, size_t length) const noexcept
+			{
+				for (size_t i = 0; i < length; i++)
+				{
+					if (!IsEqual(left[i], right[i]))
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+	};
+}
+
+namespace kxf::Private
+{
+	// Case-insensitive counterparts of 'std::wstring_view::find' and 'std::wstring_view::rfind'. Both functions
+	// fold characters on the fly using the 'CaseFoldTable' and skip through the source using a Boyer-Moore-Horspool
+	// shift table, so no temporary lowercased copies of either the source or the pattern are ever made.
+	size_t FindNoCase(std::wstring_view source, std::wstring_view pattern, size_t offset = 0) noexcept;
+	size_t ReverseFindNoCase(std::wstring_view source, std::wstring_view pattern, size_t offset = std::wstring_view::npos) noexcept;
+}
+
+namespace kxf::Private
+{
+	// Wildcard matching for '*' (any sequence of characters, including an empty one) and '?' (any single character).
+	// A segment is a part of the expression between two '*', it's matched by comparing each character except for '?'.
+	// Literal segments (the ones without any '?') are searched for using 'FindNoCase' or 'std::wstring_view::find'.
+	bool MatchWildcardSegment(std::wstring_view text, std::wstring_view segment, bool ignoreCase) noexcept;
+	size_t FindWildcardSegment(std::wstring_view text, std::wstring_view segment, size_t offset, bool ignoreCase, bool isLiteral) noexcept;
+	bool MatchWildcards(std::wstring_view name, std::wstring_view expression, bool ignoreCase) noexcept;
+}
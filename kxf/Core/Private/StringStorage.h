@@ -0,0 +1,252 @@
+#pragma once
+#include "../Common.h"
+#include <string>
+
+// Selects the storage used by 'kxf::String'. Changes the layout of 'kxf::String', so it must have
+// the same value for the library and for every module using it.
+//
+// 0: Every 'String' owns its own 'std::basic_string' (default).
+// 1: Copies of long strings share an immutable, atomically reference-counted buffer which is
+//    detached (copied) on the first non-const access. A string which has handed out a mutable
+//    reference (iterators, 'data', 'operator[]', 'impl_str') is copied deeply until it's reassigned.
+#ifndef KXF_STRING_SHARED_STORAGE
+#define KXF_STRING_SHARED_STORAGE 0
+#endif
+
+namespace kxf::Private
+{
+	template<class TChar>
+	class BasicLocalStringStorage final
+	{
+		public:
+			using string_type = std::basic_string<TChar>;
+
+		private:
+			string_type m_Value;
+
+		public:
+			BasicLocalStringStorage() noexcept = default;
+			BasicLocalStringStorage(const BasicLocalStringStorage&) = default;
+			BasicLocalStringStorage(BasicLocalStringStorage&&) noexcept = default;
+
+			template<class... Args>
+			requires(std::is_constructible_v<string_type, Args...>)
+			BasicLocalStringStorage(Args&&... arg)
+				:m_Value(std::forward<Args>(arg)...)
+			{
+			}
+
+		public:
+			const string_type& operator*() const& noexcept
+			{
+				return m_Value;
+			}
+			string_type& operator*() & noexcept
+			{
+				return m_Value;
+			}
+			const string_type* operator->() const noexcept
+			{
+				return &m_Value;
+			}
+			string_type* operator->() noexcept
+			{
+				return &m_Value;
+			}
+
+			BasicLocalStringStorage& operator=(const BasicLocalStringStorage&) = default;
+			BasicLocalStringStorage& operator=(BasicLocalStringStorage&&) noexcept = default;
+	};
+
+	template<class TChar>
+	class BasicSharedStringStorage final
+	{
+		public:
+			using string_type = std::basic_string<TChar>;
+
+			// Strings shorter than that are cheaper to copy than to share, this also keeps
+			// everything that fits into the 'std::basic_string' inline buffer unshared.
+			static constexpr size_t ShareThreshold = 32;
+
+		private:
+			struct SharedBuffer final
+			{
+				std::atomic<size_t> RefCount = 1;
+				string_type Value;
+
+				SharedBuffer(const string_type& value)
+					:Value(value)
+				{
+				}
+			};
+
+			static void AddRef(SharedBuffer* buffer) noexcept
+			{
+				buffer->RefCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			static void Release(SharedBuffer* buffer) noexcept
+			{
+				if (buffer && buffer->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					delete buffer;
+				}
+			}
+
+		private:
+			// The object is either local, in which case 'm_Local' holds the value and 'm_Shared' is an optional
+			// snapshot of it handed out to copies, or shared, in which case the value is in 'm_Shared' only.
+			// A leaked object can be changed through a reference kept outside, so it never publishes a snapshot.
+			string_type m_Local;
+			mutable std::atomic<SharedBuffer*> m_Shared = nullptr;
+			bool m_IsLocal = true;
+			bool m_IsLeaked = false;
+
+		private:
+			void CopyFrom(const BasicSharedStringStorage& other)
+			{
+				SharedBuffer* shared = other.m_Shared.load(std::memory_order_acquire);
+				if (other.m_IsLeaked)
+				{
+					m_Local = other.Get();
+					return;
+				}
+				if (!shared && other.m_Local.length() >= ShareThreshold)
+				{
+					// Publish a snapshot of the other string so this and all its following copies can share it.
+					// The other string keeps its local value, so no one reading it concurrently is affected.
+					auto created = new SharedBuffer(other.m_Local);
+					if (other.m_Shared.compare_exchange_strong(shared, created, std::memory_order_acq_rel, std::memory_order_acquire))
+					{
+						shared = created;
+					}
+					else
+					{
+						delete created;
+					}
+				}
+
+				if (shared)
+				{
+					AddRef(shared);
+					m_Shared.store(shared, std::memory_order_relaxed);
+					m_IsLocal = false;
+				}
+				else
+				{
+					m_Local = other.m_Local;
+				}
+			}
+			void MoveFrom(BasicSharedStringStorage& other) noexcept
+			{
+				m_Local = std::move(other.m_Local);
+				m_Shared.store(other.m_Shared.exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+				m_IsLocal = std::exchange(other.m_IsLocal, true);
+
+				// Moving invalidates the references into the other string
+				m_IsLeaked = false;
+				other.m_IsLeaked = false;
+			}
+			void Reset() noexcept
+			{
+				Release(m_Shared.exchange(nullptr, std::memory_order_acq_rel));
+				m_Local.clear();
+				m_IsLocal = true;
+				m_IsLeaked = false;
+			}
+
+			string_type& Detach()
+			{
+				if (SharedBuffer* shared = m_Shared.exchange(nullptr, std::memory_order_acq_rel))
+				{
+					if (!m_IsLocal)
+					{
+						// Take over the buffer if we're the last owner, copy it otherwise
+						if (shared->RefCount.load(std::memory_order_acquire) == 1)
+						{
+							m_Local = std::move(shared->Value);
+						}
+						else
+						{
+							m_Local = shared->Value;
+						}
+						m_IsLocal = true;
+					}
+					Release(shared);
+				}
+				return m_Local;
+			}
+			const string_type& Get() const noexcept
+			{
+				return m_IsLocal ? m_Local : m_Shared.load(std::memory_order_relaxed)->Value;
+			}
+
+		public:
+			BasicSharedStringStorage() noexcept = default;
+			BasicSharedStringStorage(const BasicSharedStringStorage& other)
+			{
+				CopyFrom(other);
+			}
+			BasicSharedStringStorage(BasicSharedStringStorage&& other) noexcept
+			{
+				MoveFrom(other);
+			}
+
+			template<class... Args>
+			requires(std::is_constructible_v<string_type, Args...>)
+			BasicSharedStringStorage(Args&&... arg)
+				:m_Local(std::forward<Args>(arg)...)
+			{
+			}
+
+			~BasicSharedStringStorage() noexcept
+			{
+				Release(m_Shared.load(std::memory_order_relaxed));
+			}
+
+		public:
+			const string_type& operator*() const& noexcept
+			{
+				return Get();
+			}
+			// The reference can be kept and used to change the string later, so it's never shared again
+			string_type& operator*() &
+			{
+				m_IsLeaked = true;
+				return Detach();
+			}
+			const string_type* operator->() const noexcept
+			{
+				return &Get();
+			}
+			// For a single call only, the pointer must not be kept
+			string_type* operator->()
+			{
+				return &Detach();
+			}
+
+			BasicSharedStringStorage& operator=(const BasicSharedStringStorage& other)
+			{
+				if (this != &other)
+				{
+					Reset();
+					CopyFrom(other);
+				}
+				return *this;
+			}
+			BasicSharedStringStorage& operator=(BasicSharedStringStorage&& other) noexcept
+			{
+				if (this != &other)
+				{
+					Reset();
+					MoveFrom(other);
+				}
+				return *this;
+			}
+	};
+
+	#if KXF_STRING_SHARED_STORAGE
+	using StringStorage = BasicSharedStringStorage<wchar_t>;
+	#else
+	using StringStorage = BasicLocalStringStorage<wchar_t>;
+	#endif
+}
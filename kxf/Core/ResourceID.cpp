@@ -3,6 +3,14 @@
 
 namespace kxf
 {
+	void ResourceID::InitKey()
+	{
+		if (!m_Value.IsNull())
+		{
+			m_Key = InternedString(m_Value.BuildURI());
+		}
+	}
+
 	String ResourceID::GetPath() const
 	{
 		String result = m_Value.GetServer();
@@ -1,5 +1,6 @@
 #pragma once
 #include "Common.h"
+#include "InternedString.h"
 #include "kxf/Network/URI.h"
 
 namespace kxf
@@ -10,30 +11,36 @@ namespace kxf
 
 		private:
 			URI m_Value;
+			InternedString m_Key;
+
+		private:
+			void InitKey();
 
 		public:
 			ResourceID() noexcept = default;
 
 			template<class T>
 			requires(std::is_integral_v<T> || std::is_enum_v<T>)
-			ResourceID(T id) noexcept
+			ResourceID(T id)
 			{
 				m_Value.Create(kxf::ToString(id));
+				InitKey();
 			}
 
-			ResourceID(URI id) noexcept
+			ResourceID(URI id)
 				:m_Value(std::move(id))
 			{
+				InitKey();
 			}
-			ResourceID(const String& id) noexcept
+			ResourceID(const String& id)
 				:ResourceID(URI(id))
 			{
 			}
-			ResourceID(const char* id) noexcept
+			ResourceID(const char* id)
 				:ResourceID(URI(id))
 			{
 			}
-			ResourceID(const wchar_t* id) noexcept
+			ResourceID(const wchar_t* id)
 				:ResourceID(URI(id))
 			{
 			}
@@ -81,6 +88,12 @@ namespace kxf
 				return m_Value.BuildURI();
 			}
 
+			// Interned form of the full URI, for the maps which can be keyed by the exact text of the ID
+			const InternedString& GetKey() const noexcept
+			{
+				return m_Key;
+			}
+
 		public:
 			explicit operator bool() const
 			{
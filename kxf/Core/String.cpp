@@ -2,6 +2,8 @@
 #include "String.h"
 #include "RegEx.h"
 #include "IEncodingConverter.h"
+#include "Private/StringSearch.h"
+#include "Private/StringScan.h"
 #include "kxf/IO/IStream.h"
 #include "kxf/Utility/Common.h"
 #include "kxf/wxWidgets/String.h"
@@ -118,7 +120,7 @@ namespace
 
 				while (nameIndex < name.length())
 				{
-					if (IsNameInExpressionImpl(expression.substr(expressionIndex), name.substr(nameIndex), ignoreCase, dotChar, starChar, questionChar, DOS_STAR, DOS_QM, DOS_DOT))
+					if (IsNameInExpressionImpl(name.substr(nameIndex), expression.substr(expressionIndex), ignoreCase, dotChar, starChar, questionChar, DOS_STAR, DOS_QM, DOS_DOT))
 					{
 						return true;
 					}
@@ -146,7 +148,7 @@ namespace
 					endReached = nameIndex >= name.length() || nameIndex == lastDot;
 					if (!endReached)
 					{
-						if (IsNameInExpressionImpl(expression.substr(expressionIndex), name.substr(nameIndex), ignoreCase, dotChar, starChar, questionChar, DOS_STAR, DOS_QM, DOS_DOT))
+						if (IsNameInExpressionImpl(name.substr(nameIndex), expression.substr(expressionIndex), ignoreCase, dotChar, starChar, questionChar, DOS_STAR, DOS_QM, DOS_DOT))
 						{
 							return true;
 						}
@@ -387,7 +389,12 @@ namespace kxf
 	}
 	bool String::DoMatchesWildcards(std::wstring_view name, std::wstring_view expression, FlagSet<StringActionFlag> flags) noexcept
 	{
-		return IsNameInExpression(name, expression, flags & StringActionFlag::IgnoreCase);
+		// DOS wildcards need the full matcher, plain '*' and '?' expressions can use the segment matcher
+		if (expression.find_first_of(kxfS("<>\"")) != std::wstring_view::npos)
+		{
+			return IsNameInExpression(name, expression, flags & StringActionFlag::IgnoreCase);
+		}
+		return Private::MatchWildcards(name, expression, flags & StringActionFlag::IgnoreCase);
 	}
 
 	// Conversions
@@ -472,21 +479,7 @@ namespace kxf
 	// String length
 	bool String::IsEmptyOrWhitespace() const noexcept
 	{
-		if (m_String.empty())
-		{
-			return true;
-		}
-		else
-		{
-			for (UniChar c: m_String)
-			{
-				if (!c.IsWhitespace())
-				{
-					return false;
-				}
-			}
-			return true;
-		}
+		return Private::FindNonWhitespace(*m_String) == npos;
 	}
 
 	// Comparison
@@ -507,7 +500,7 @@ namespace kxf
 		{
 			if (rest)
 			{
-				*rest = m_String.substr(pos, pattern.length());
+				*rest = m_String->substr(pos, pattern.length());
 			}
 			return true;
 		}
@@ -527,11 +520,11 @@ namespace kxf
 		}
 
 		const size_t pos = ReverseFind(pattern, flags);
-		if (pos == m_String.length() - pattern.length())
+		if (pos == m_String->length() - pattern.length())
 		{
 			if (rest)
 			{
-				*rest = m_String.substr(pos, npos);
+				*rest = m_String->substr(pos, npos);
 			}
 			return true;
 		}
@@ -545,20 +538,22 @@ namespace kxf
 	}
 	String::String(wxString&& other) noexcept
 	{
-		wxWidgets::MoveWxString(m_String, std::move(other));
+		string_type value;
+		wxWidgets::MoveWxString(value, std::move(other));
+		m_String = std::move(value);
 	}
 
 	// Conversions
 	std::string String::ToUTF8() const
 	{
-		return EncodingConverter_UTF8.ToMultiByte(m_String);
+		return EncodingConverter_UTF8.ToMultiByte(*m_String);
 	}
 	std::string String::ToASCII(char replaceWith) const
 	{
 		std::string ascii;
-		ascii.reserve(m_String.length());
+		ascii.reserve(m_String->length());
 
-		for (UniChar c: m_String)
+		for (UniChar c: *m_String)
 		{
 			ascii += c.ToASCII().value_or(replaceWith);
 		}
@@ -566,32 +561,32 @@ namespace kxf
 	}
 	std::string String::ToLocalEncoding() const
 	{
-		return EncodingConverter_Local.ToMultiByte(m_String);
+		return EncodingConverter_Local.ToMultiByte(*m_String);
 	}
 	std::string String::ToEncoding(IEncodingConverter& encodingConverter) const
 	{
-		return encodingConverter.ToMultiByte(m_String);
+		return encodingConverter.ToMultiByte(*m_String);
 	}
 
 	// Concatenation
 	String& String::DoAppend(std::string_view other)
 	{
 		auto converted = FromUnknownEncoding(other);
-		m_String.append(converted.view());
+		m_String->append(converted.view());
 
 		return *this;
 	}
 	String& String::DoPrepend(std::string_view other)
 	{
 		auto converted = FromUnknownEncoding(other);
-		m_String.insert(0, converted.view());
+		m_String->insert(0, converted.view());
 
 		return *this;
 	}
 	String& String::DoInsert(size_t pos, std::string_view other)
 	{
 		auto converted = FromUnknownEncoding(other);
-		m_String.insert(pos, converted.view());
+		m_String->insert(pos, converted.view());
 
 		return *this;
 	}
@@ -672,14 +667,14 @@ namespace kxf
 	}
 
 	// Case conversion
-	String& String::MakeLower() noexcept
+	String& String::MakeLower()
 	{
-		::CharLowerBuffW(m_String.data(), m_String.size());
+		::CharLowerBuffW(m_String->data(), m_String->size());
 		return *this;
 	}
-	String& String::MakeUpper() noexcept
+	String& String::MakeUpper()
 	{
-		::CharUpperBuffW(m_String.data(), m_String.size());
+		::CharUpperBuffW(m_String->data(), m_String->size());
 		return *this;
 	}
 
@@ -691,31 +686,28 @@ namespace kxf
 	}
 	size_t String::DoFind(std::wstring_view pattern, size_t offset, FlagSet<StringActionFlag> flags, bool reverse) const
 	{
-		if (!m_String.empty())
+		if (!m_String->empty())
 		{
 			if (flags & StringActionFlag::IgnoreCase)
 			{
-				auto sourceL = ToLower();
-				auto patternL = String(pattern).MakeLower();
-
 				if (reverse)
 				{
-					return sourceL.m_String.rfind(patternL.view(), offset);
+					return Private::ReverseFindNoCase(*m_String, pattern, offset);
 				}
 				else
 				{
-					return sourceL.m_String.find(patternL.view(), offset);
+					return Private::FindNoCase(*m_String, pattern, offset);
 				}
 			}
 			else
 			{
 				if (reverse)
 				{
-					return m_String.rfind(pattern, offset);
+					return m_String->rfind(pattern, offset);
 				}
 				else
 				{
-					return m_String.find(pattern, offset);
+					return m_String->find(pattern, offset);
 				}
 			}
 		}
@@ -723,42 +715,27 @@ namespace kxf
 	}
 	size_t String::DoFind(UniChar pattern, size_t offset, FlagSet<StringActionFlag> flags, bool reverse) const noexcept
 	{
-		if (m_String.empty())
+		// Characters outside of BMP can't be matched by a single code unit
+		if (m_String->empty() || !pattern.IsBasic())
 		{
 			return npos;
 		}
 
+		const XChar c = pattern.GetAs<XChar>();
+		const bool ignoreCase = flags.Contains(StringActionFlag::IgnoreCase);
 		if (reverse)
 		{
-			if (offset >= m_String.length())
+			// For reverse search the offset is counted from the end of the string
+			if (offset >= m_String->length())
 			{
 				offset = 0;
 			}
-
-			for (size_t i = m_String.length() - 1 - offset; i != 0; i--)
-			{
-				if (Compare(m_String[i], pattern, flags) == 0)
-				{
-					return i;
-				}
-			}
+			return Private::ReverseFindCharacter(*m_String, c, m_String->length() - offset, ignoreCase);
 		}
 		else
 		{
-			if (offset >= m_String.length())
-			{
-				return npos;
-			}
-
-			for (size_t i = offset; i < m_String.length(); i++)
-			{
-				if (Compare(m_String[i], pattern, flags) == 0)
-				{
-					return i;
-				}
-			}
+			return Private::FindCharacter(*m_String, c, offset, ignoreCase);
 		}
-		return npos;
 	}
 
 	size_t String::DoReplace(std::string_view pattern, std::string_view replacement, size_t offset, FlagSet<StringActionFlag> flags, bool reverse)
@@ -782,45 +759,42 @@ namespace kxf
 		const size_t replacementLength = replacement.length();
 		const size_t patternLength = pattern.length();
 
-		if (m_String.empty() || patternLength == 0 || offset >= m_String.length())
+		if (m_String->empty() || patternLength == 0 || offset >= m_String->length())
 		{
 			return 0;
 		}
 
-		size_t replacementCount = 0;
-		size_t pos = wxString::npos;
-
-		String sourceL;
-		String patternL;
-		if (flags & StringActionFlag::IgnoreCase)
-		{
-			sourceL = ToLower();
-			patternL = String(pattern).MakeLower();
-
-			if (reverse)
-			{
-				pos = sourceL.m_String.rfind(patternL.view(), offset);
-			}
-			else
-			{
-				pos = sourceL.m_String.find(patternL.view(), offset);
-			}
-		}
-		else
+		auto FindNext = [&](size_t from) -> size_t
 		{
-			if (reverse)
+			if (flags & StringActionFlag::IgnoreCase)
 			{
-				pos = m_String.rfind(pattern, offset);
+				if (reverse)
+				{
+					return Private::ReverseFindNoCase(*m_String, pattern, from);
+				}
+				else
+				{
+					return Private::FindNoCase(*m_String, pattern, from);
+				}
 			}
 			else
 			{
-				pos = m_String.find(pattern, offset);
+				if (reverse)
+				{
+					return m_String->rfind(pattern, from);
+				}
+				else
+				{
+					return m_String->find(pattern, from);
+				}
 			}
-		}
+		};
 
-		while (pos != wxString::npos)
+		size_t replacementCount = 0;
+		size_t pos = FindNext(offset);
+		while (pos != npos)
 		{
-			m_String.replace(pos, patternLength, replacement.data(), replacement.length());
+			m_String->replace(pos, patternLength, replacement.data(), replacement.length());
 			replacementCount++;
 
 			if (flags & StringActionFlag::FirstMatchOnly)
@@ -828,38 +802,31 @@ namespace kxf
 				return replacementCount;
 			}
 
-			if (flags & StringActionFlag::IgnoreCase)
+			if (reverse)
 			{
-				if (reverse)
+				if (pos < patternLength)
 				{
-					pos = sourceL.m_String.rfind(patternL.view(), pos + replacementLength);
-				}
-				else
-				{
-					pos = sourceL.m_String.find(patternL.view(), pos + replacementLength);
+					break;
 				}
+				pos = FindNext(pos - patternLength);
 			}
 			else
 			{
-				if (reverse)
-				{
-					pos = m_String.rfind(pattern, pos + replacementLength);
-				}
-				else
-				{
-					pos = m_String.find(pattern, pos + replacementLength);
-				}
+				pos = FindNext(pos + replacementLength);
 			}
 		}
 		return replacementCount;
 	}
-	size_t String::DoReplace(UniChar pattern, UniChar replacement, size_t offset, FlagSet<StringActionFlag> flags, bool reverse) noexcept
+	size_t String::DoReplace(UniChar pattern, UniChar replacement, size_t offset, FlagSet<StringActionFlag> flags, bool reverse)
 	{
-		if (m_String.empty() || offset >= m_String.length())
+		if (m_String->empty() || offset >= m_String->length())
 		{
 			return 0;
 		}
 
+		XChar* data = m_String->data();
+		const size_t length = m_String->length();
+
 		size_t replacementCount = 0;
 		auto TestAndReplace = [&](XChar& c)
 		{
@@ -875,9 +842,9 @@ namespace kxf
 
 		if (reverse)
 		{
-			for (size_t i = m_String.length() - 1 - offset; i != 0; i--)
+			for (size_t i = length - 1 - offset; i != 0; i--)
 			{
-				if (!TestAndReplace(m_String[i]))
+				if (!TestAndReplace(data[i]))
 				{
 					return replacementCount;
 				}
@@ -885,9 +852,9 @@ namespace kxf
 		}
 		else
 		{
-			for (size_t i = offset; i < m_String.length(); i++)
+			for (size_t i = offset; i < length; i++)
 			{
-				if (!TestAndReplace(m_String[i]))
+				if (!TestAndReplace(data[i]))
 				{
 					return replacementCount;
 				}
@@ -899,14 +866,14 @@ namespace kxf
 	String& String::ReplaceRange(size_t offset, size_t length, std::string_view replacement)
 	{
 		auto converted = FromUnknownEncoding(replacement);
-		m_String.replace(offset, length, converted.view());
+		m_String->replace(offset, length, converted.view());
 
 		return *this;
 	}
 	String& String::ReplaceRange(iterator first, iterator last, std::string_view replacement)
 	{
 		auto converted = FromUnknownEncoding(replacement);
-		m_String.replace(first, last, converted.view());
+		m_String->replace(first, last, converted.view());
 
 		return *this;
 	}
@@ -924,14 +891,7 @@ namespace kxf
 	}
 	bool String::DoContainsAnyOfCharacters(std::wstring_view pattern, FlagSet<StringActionFlag> flags) const noexcept
 	{
-		for (auto c: pattern)
-		{
-			if (DoFind(c, 0, flags, false) != npos)
-			{
-				return true;
-			}
-		}
-		return false;
+		return Private::FindAnyCharacter(*m_String, pattern, 0, flags.Contains(StringActionFlag::IgnoreCase)) != npos;
 	}
 
 	// Conversion to numbers
@@ -968,11 +928,11 @@ namespace kxf
 	}
 	std::optional<bool> String::ParseBoolean() const noexcept
 	{
-		if (m_String == kxfSV("true") || m_String == kxfSV("TRUE"))
+		if (*m_String == kxfSV("true") || *m_String == kxfSV("TRUE"))
 		{
 			return true;
 		}
-		else if (m_String == kxfSV("false") || m_String == kxfSV("FALSE"))
+		else if (*m_String == kxfSV("false") || *m_String == kxfSV("FALSE"))
 		{
 			return false;
 		}
@@ -993,59 +953,30 @@ namespace kxf
 	// Miscellaneous
 	size_t String::TrimScan(const String& chars, FlagSet<StringActionFlag> flags, bool left) const
 	{
-		auto ScanChar = [&chars, &flags](size_t& count, UniChar c)
+		size_t pos = npos;
+		if (chars.IsEmpty())
 		{
-			if (chars.IsEmpty())
+			pos = left ? Private::FindNonWhitespace(*m_String) : Private::ReverseFindNonWhitespace(*m_String);
+		}
+		else
+		{
+			const bool ignoreCase = flags.Contains(StringActionFlag::IgnoreCase);
+			if (left)
 			{
-				if (c.IsWhitespace())
-				{
-					count++;
-					return CallbackCommand::Continue;
-				}
-				else
-				{
-					return CallbackCommand::Terminate;
-				}
+				pos = Private::FindAnyCharacter(*m_String, chars.view(), 0, ignoreCase, true);
 			}
 			else
 			{
-				bool found = false;
-				for (auto charsC: chars)
-				{
-					if (flags.Contains(StringActionFlag::IgnoreCase) ? c.CompareNoCase(charsC) == 0 : c.Compare(charsC) == 0)
-					{
-						count++;
-						found = true;
-						break;
-					}
-				}
-				return found ? CallbackCommand::Continue : CallbackCommand::Terminate;
-			}
-		};
-
-		size_t count = 0;
-		if (left)
-		{
-			for (auto it = m_String.begin(); it != m_String.end(); ++it)
-			{
-				if (ScanChar(count, *it) == CallbackCommand::Terminate)
-				{
-					break;
-				}
+				pos = Private::ReverseFindAnyCharacter(*m_String, chars.view(), m_String->length(), ignoreCase, true);
 			}
 		}
-		else
+
+		// Everything is trimmed if nothing outside of the set was found
+		if (pos == npos)
 		{
-			for (auto it = m_String.rbegin(); it != m_String.rend(); ++it)
-			{
-				if (ScanChar(count, *it) == CallbackCommand::Terminate)
-				{
-					break;
-				}
-			}
+			return m_String->length();
 		}
-
-		return count;
+		return left ? pos : m_String->length() - pos - 1;
 	}
 	String& String::TrimLeft(const String& chars, FlagSet<StringActionFlag> flags)
 	{
@@ -1076,15 +1007,15 @@ namespace kxf
 
 	String& String::EscapeCString(CallbackFunction<UniChar> func)
 	{
-		if (!m_String.empty())
+		if (!m_String->empty())
 		{
-			for (size_t i = 0; i < m_String.length(); i++)
+			for (size_t i = 0; i < m_String->length(); i++)
 			{
-				auto c = m_String[i];
+				auto c = (*m_String)[i];
 				auto DoEscape = [&]()
 				{
 					XChar buffer[2] = {'\\', c};
-					m_String.replace(i, 1, StringViewOf(buffer));
+					m_String->replace(i, 1, StringViewOf(buffer));
 
 					i++;
 				};
@@ -1132,13 +1063,13 @@ namespace kxf
 	}
 	String& String::UnescapeCString()
 	{
-		if (!m_String.empty())
+		if (!m_String->empty())
 		{
-			for (auto it = m_String.begin(); it != m_String.end(); ++it)
+			for (auto it = m_String->begin(); it != m_String->end(); ++it)
 			{
-				if (*it == '\\' && (it + 1) != m_String.end())
+				if (*it == '\\' && (it + 1) != m_String->end())
 				{
-					m_String.erase(it);
+					m_String->erase(it);
 				}
 			}
 		}
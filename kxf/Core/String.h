@@ -5,6 +5,7 @@
 #include "kxf/Serialization/BinarySerializer.h"
 #include "kxf/Utility/TypeTraits.h"
 #include "Private/String.h"
+#include "Private/StringStorage.h"
 #include <format>
 #include <string>
 #include <string_view>
@@ -300,7 +301,7 @@ namespace kxf
 			}
 
 		private:
-			string_type m_String;
+			Private::StringStorage m_String;
 
 		public:
 			String() = default;
@@ -367,39 +368,39 @@ namespace kxf
 			// String length
 			bool IsEmpty() const noexcept
 			{
-				return m_String.empty();
+				return m_String->empty();
 			}
 			bool IsEmptyOrWhitespace() const noexcept;
 			size_t GetLength() const noexcept
 			{
-				return m_String.length();
+				return m_String->length();
 			}
 			size_t GetCapacity() const noexcept
 			{
-				return m_String.capacity();
+				return m_String->capacity();
 			}
 
 			// Character access
-			XChar* GetData() noexcept
+			XChar* GetData()
 			{
-				return m_String.data();
+				return impl_str().data();
 			}
 			const XChar* GetData() const noexcept
 			{
-				return m_String.data();
+				return m_String->data();
 			}
 
-			string_type& impl_str() & noexcept
+			string_type& impl_str() &
 			{
-				return m_String;
+				return *m_String;
 			}
 			const string_type& impl_str() const& noexcept
 			{
-				return m_String;
+				return *m_String;
 			}
-			string_type impl_str() && noexcept
+			string_type impl_str() &&
 			{
-				return std::move(m_String);
+				return std::move(*m_String);
 			}
 
 			ConvertedCStrBuffer nc_str() const
@@ -412,29 +413,29 @@ namespace kxf
 			}
 			UnownedWStrBuffer wc_str() const
 			{
-				return StringViewOf(m_String);
+				return StringViewOf(*m_String);
 			}
 			UnownedWStrBuffer xc_str() const
 			{
-				return StringViewOf(m_String);
+				return StringViewOf(*m_String);
 			}
 
 			std::basic_string<XChar> str() const noexcept
 			{
-				return m_String;
+				return *m_String;
 			}
 			std::basic_string_view<XChar> view() const noexcept
 			{
-				return StringViewOf(m_String);
+				return StringViewOf(*m_String);
 			}
 
-			XChar& operator[](size_t i) noexcept
+			XChar& operator[](size_t i)
 			{
-				return m_String[i];
+				return impl_str()[i];
 			}
 			const XChar& operator[](size_t i) const noexcept
 			{
-				return m_String[i];
+				return (*m_String)[i];
 			}
 
 			// Conversions
@@ -448,12 +449,12 @@ namespace kxf
 			String& DoAppend(std::string_view other);
 			String& DoAppend(std::wstring_view other)
 			{
-				m_String.append(other);
+				m_String->append(other);
 				return *this;
 			}
 			String& DoAppend(UniChar c, size_t count = 1)
 			{
-				m_String.append(count, c.GetAs<XChar>());
+				m_String->append(count, c.GetAs<XChar>());
 				return *this;
 			}
 
@@ -492,12 +493,12 @@ namespace kxf
 			String& DoPrepend(std::string_view other);
 			String& DoPrepend(std::wstring_view other)
 			{
-				m_String.insert(0, other.data(), other.length());
+				m_String->insert(0, other.data(), other.length());
 				return *this;
 			}
 			String& DoPrepend(UniChar c, size_t count = 1)
 			{
-				m_String.insert(0, count, c.GetAs<XChar>());
+				m_String->insert(0, count, c.GetAs<XChar>());
 				return *this;
 			}
 			
@@ -518,12 +519,12 @@ namespace kxf
 			String& DoInsert(size_t pos, std::string_view other);
 			String& DoInsert(size_t pos, std::wstring_view other)
 			{
-				m_String.insert(pos, other);
+				m_String->insert(pos, other);
 				return *this;
 			}
 			String& DoInsert(size_t pos, UniChar c, size_t count = 1)
 			{
-				m_String.insert(pos, count, c.GetAs<XChar>());
+				m_String->insert(pos, count, c.GetAs<XChar>());
 				return *this;
 			}
 			
@@ -655,31 +656,31 @@ namespace kxf
 			// Substring extraction
 			String SubMid(size_t offset, size_t count = String::npos) const
 			{
-				if (offset < m_String.length())
+				if (offset < m_String->length())
 				{
-					return m_String.substr(offset, count);
+					return m_String->substr(offset, count);
 				}
 				return {};
 			}
 			String SubLeft(size_t count) const
 			{
-				return m_String.substr(0, count);
+				return m_String->substr(0, count);
 			}
 			String SubRight(size_t count) const
 			{
-				size_t offset = m_String.length() - count;
-				if (offset < m_String.length())
+				size_t offset = m_String->length() - count;
+				if (offset < m_String->length())
 				{
-					return m_String.substr(offset, count);
+					return m_String->substr(offset, count);
 				}
 				return {};
 			}
 			String SubRange(size_t from, size_t to) const
 			{
-				size_t length = m_String.length();
+				size_t length = m_String->length();
 				if (from < to && from < length && to < length)
 				{
-					return m_String.substr(from, to - from + 1);
+					return m_String->substr(from, to - from + 1);
 				}
 				return {};
 			}
@@ -703,8 +704,8 @@ namespace kxf
 			}
 
 			// Case conversion
-			String& MakeLower() noexcept;
-			String& MakeUpper() noexcept;
+			String& MakeLower();
+			String& MakeUpper();
 			String ToLower() const
 			{
 				return String(*this).MakeLower();
@@ -714,11 +715,12 @@ namespace kxf
 				return String(*this).MakeUpper();
 			}
 
-			String& MakeCapitalized() noexcept
+			String& MakeCapitalized()
 			{
-				if (!m_String.empty())
+				if (!m_String->empty())
 				{
-					m_String[0] = UniChar(m_String[0]).ToUpperCase().GetAs<XChar>();
+					XChar& c = m_String->front();
+					c = UniChar(c).ToUpperCase().GetAs<XChar>();
 				}
 				return *this;
 			}
@@ -765,7 +767,7 @@ namespace kxf
 			size_t DoReplace(std::string_view pattern, std::wstring_view replacement, size_t offset, FlagSet<StringActionFlag> flags, bool reverse = false);
 			size_t DoReplace(std::wstring_view pattern, std::string_view replacement, size_t offset, FlagSet<StringActionFlag> flags, bool reverse = false);
 			size_t DoReplace(std::wstring_view pattern, std::wstring_view replacement, size_t offset, FlagSet<StringActionFlag> flags, bool reverse = false);
-			size_t DoReplace(UniChar c, UniChar replacement, size_t offset, FlagSet<StringActionFlag> flags, bool reverse = false) noexcept;
+			size_t DoReplace(UniChar c, UniChar replacement, size_t offset, FlagSet<StringActionFlag> flags, bool reverse = false);
 			size_t DoReplace(UniChar c, std::string_view replacement, size_t offset, FlagSet<StringActionFlag> flags, bool reverse = false) noexcept
 			{
 				const char pattern[2] = {c.GetAs<char>(), 0};
@@ -801,25 +803,25 @@ namespace kxf
 
 			String& ReplaceRange(size_t offset, size_t length, const String& replacement)
 			{
-				m_String.replace(offset, length, replacement.view());
+				m_String->replace(offset, length, replacement.view());
 				return *this;
 			}
 			String& ReplaceRange(size_t offset, size_t length, std::string_view replacement);
 			String& ReplaceRange(size_t offset, size_t length, std::wstring_view replacement)
 			{
-				m_String.replace(offset, length, replacement);
+				m_String->replace(offset, length, replacement);
 				return *this;
 			}
 
 			String& ReplaceRange(iterator first, iterator last, const String& replacement)
 			{
-				m_String.replace(first, last, replacement.view());
+				m_String->replace(first, last, replacement.view());
 				return *this;
 			}
 			String& ReplaceRange(iterator first, iterator last, std::string_view replacement);
 			String& ReplaceRange(iterator first, iterator last, std::wstring_view replacement)
 			{
-				m_String.replace(first, last, replacement);
+				m_String->replace(first, last, replacement);
 				return *this;
 			}
 
@@ -907,7 +909,7 @@ namespace kxf
 		public:
 			bool IsASCII() const noexcept
 			{
-				for (const auto& c: m_String)
+				for (const auto& c: *m_String)
 				{
 					if (!UniChar(c).IsASCII())
 					{
@@ -918,32 +920,32 @@ namespace kxf
 			}
 			String& Remove(size_t offset, size_t count)
 			{
-				if (count != 0 && offset < m_String.length())
+				if (count != 0 && offset < m_String->length())
 				{
-					m_String.erase(offset, count);
+					m_String->erase(offset, count);
 				}
 				return *this;
 			}
 			String& RemoveRight(size_t count)
 			{
-				size_t offset = m_String.length() - count;
-				if (count != 0 && offset < m_String.length())
+				size_t offset = m_String->length() - count;
+				if (count != 0 && offset < m_String->length())
 				{
-					m_String.erase(offset, count);
+					m_String->erase(offset, count);
 				}
 				return *this;
 			}
 			String& Truncate(size_t length)
 			{
-				if (length < m_String.length())
+				if (length < m_String->length())
 				{
-					m_String.resize(length);
+					m_String->resize(length);
 				}
 				return *this;
 			}
 			String& Clear()
 			{
-				m_String.clear();
+				m_String->clear();
 				return *this;
 			}
 
@@ -964,132 +966,132 @@ namespace kxf
 			String& UnescapeCString();
 
 			// Iterator interface
-			iterator begin() noexcept
+			iterator begin()
 			{
-				return m_String.begin();
+				return impl_str().begin();
 			}
-			iterator end() noexcept
+			iterator end()
 			{
-				return m_String.end();
+				return impl_str().end();
 			}
 			const_iterator begin() const noexcept
 			{
-				return m_String.begin();
+				return m_String->begin();
 			}
 			const_iterator end() const noexcept
 			{
-				return m_String.end();
+				return m_String->end();
 			}
 			const_iterator cbegin() const noexcept
 			{
-				return m_String.cbegin();
+				return m_String->cbegin();
 			}
 			const_iterator cend() const noexcept
 			{
-				return m_String.cend();
+				return m_String->cend();
 			}
 			
-			reverse_iterator rbegin() noexcept
+			reverse_iterator rbegin()
 			{
-				return m_String.rbegin();
+				return impl_str().rbegin();
 			}
-			reverse_iterator rend() noexcept
+			reverse_iterator rend()
 			{
-				return m_String.rend();
+				return impl_str().rend();
 			}
 			const_reverse_iterator rbegin() const noexcept
 			{
-				return m_String.rbegin();
+				return m_String->rbegin();
 			}
 			const_reverse_iterator rend() const noexcept
 			{
-				return m_String.rend();
+				return m_String->rend();
 			}
 			const_reverse_iterator crend() const noexcept
 			{
-				return m_String.crend();
+				return m_String->crend();
 			}
 			const_reverse_iterator crbegin() const noexcept
 			{
-				return m_String.crbegin();
+				return m_String->crbegin();
 			}
 
 			// STL interface (incomplete)
 			bool empty() const noexcept
 			{
-				return m_String.empty();
+				return m_String->empty();
 			}
 			size_t size() const noexcept
 			{
-				return m_String.size();
+				return m_String->size();
 			}
 			size_t length() const noexcept
 			{
-				return m_String.length();
+				return m_String->length();
 			}
 			size_t capacity() const noexcept
 			{
-				return m_String.capacity();
+				return m_String->capacity();
 			}
 			size_t max_size() const noexcept
 			{
-				return m_String.max_size();
+				return m_String->max_size();
 			}
-			void clear() noexcept
+			void clear()
 			{
-				m_String.clear();
+				m_String->clear();
 			}
 			void reserve(size_t capacity)
 			{
-				m_String.reserve(capacity);
+				m_String->reserve(capacity);
 			}
 			void resize(size_t capacity, XChar c = 0)
 			{
-				m_String.resize(capacity, c);
+				m_String->resize(capacity, c);
 			}
 			void assign(const XChar* data, size_t length = npos)
 			{
-				m_String.assign(data, Private::CalcStringLength(data, length));
+				m_String->assign(data, Private::CalcStringLength(data, length));
 			}
 			void shrink_to_fit()
 			{
-				m_String.shrink_to_fit();
+				m_String->shrink_to_fit();
 			}
 
-			XChar* data() noexcept
+			XChar* data()
 			{
-				return m_String.data();
+				return impl_str().data();
 			}
 			const XChar* data() const noexcept
 			{
-				return m_String.data();
+				return m_String->data();
 			}
 
 			const XChar& at(size_t i) const
 			{
-				return m_String.at(i);
+				return m_String->at(i);
 			}
 			XChar& at(size_t i)
 			{
-				return m_String.at(i);
+				return impl_str().at(i);
 			}
 
 			const XChar& front() const
 			{
-				return m_String.front();
+				return m_String->front();
 			}
 			XChar& front()
 			{
-				return m_String.front();
+				return impl_str().front();
 			}
 
 			const XChar& back() const
 			{
-				return m_String.back();
+				return m_String->back();
 			}
 			XChar& back()
 			{
-				return m_String.back();
+				return impl_str().back();
 			}
 
 		public:
@@ -1097,9 +1099,9 @@ namespace kxf
 			String& operator=(String&&) noexcept = default;
 
 			// Conversion
-			operator std::basic_string<XChar>() && noexcept
+			operator std::basic_string<XChar>() &&
 			{
-				return std::move(m_String);
+				return std::move(*m_String);
 			}
 			operator wxString() const;
 
@@ -0,0 +1,121 @@
+#include "kxf-pch.h"
+#include "WildcardMatcher.h"
+#include "Private/StringSearch.h"
+
+namespace kxf
+{
+	bool WildcardMatcher::Compile(const String& expression, FlagSet<StringActionFlag> flags)
+	{
+		m_Expression = expression;
+		m_Segments.clear();
+		m_Flags = flags;
+		m_LeadingStar = false;
+		m_TrailingStar = false;
+		m_IsCompiled = true;
+
+		// DOS wildcards have their own matching rules, leave them to the generic matcher
+		m_IsDOSExpression = m_Expression.ContainsAnyOfCharacters(kxfS("<>\""));
+		if (m_IsDOSExpression || m_Expression.IsEmpty())
+		{
+			return true;
+		}
+
+		if (m_Flags.Contains(StringActionFlag::IgnoreCase))
+		{
+			const auto& foldTable = Private::CaseFoldTable::GetInstance();
+			for (XChar& c: m_Expression)
+			{
+				c = foldTable.Fold(c);
+			}
+		}
+
+		const StringView view = m_Expression.view();
+		m_LeadingStar = view.front() == '*';
+		m_TrailingStar = view.back() == '*';
+
+		// Split into segments between stars, the empty ones produced by consecutive stars are dropped
+		size_t offset = 0;
+		while (offset <= view.length())
+		{
+			size_t star = view.find('*', offset);
+			if (star == StringView::npos)
+			{
+				star = view.length();
+			}
+
+			const auto segment = view.substr(offset, star - offset);
+			if (!segment.empty())
+			{
+				m_Segments.emplace_back(Segment{offset, segment.length(), segment.find('?') == StringView::npos});
+			}
+			offset = star + 1;
+		}
+		return true;
+	}
+	bool WildcardMatcher::Matches(StringView name) const noexcept
+	{
+		if (!m_IsCompiled)
+		{
+			return false;
+		}
+		if (m_IsDOSExpression)
+		{
+			return String::MatchesWildcards(name, m_Expression, m_Flags);
+		}
+		if (m_Expression.IsEmpty())
+		{
+			return true;
+		}
+
+		const bool ignoreCase = m_Flags.Contains(StringActionFlag::IgnoreCase);
+		if (m_Segments.empty())
+		{
+			// Only stars
+			return true;
+		}
+		if (!m_LeadingStar && !m_TrailingStar && m_Segments.size() == 1)
+		{
+			return Private::MatchWildcardSegment(name, GetSegment(m_Segments.front()), ignoreCase);
+		}
+
+		// Anchored head and tail segments
+		auto first = m_Segments.begin();
+		auto last = m_Segments.end();
+		if (!m_LeadingStar)
+		{
+			const auto head = GetSegment(*first);
+			if (name.length() < head.length() || !Private::MatchWildcardSegment(name.substr(0, head.length()), head, ignoreCase))
+			{
+				return false;
+			}
+
+			name.remove_prefix(head.length());
+			++first;
+		}
+		if (!m_TrailingStar)
+		{
+			const auto tail = GetSegment(*(last - 1));
+			if (name.length() < tail.length() || !Private::MatchWildcardSegment(name.substr(name.length() - tail.length()), tail, ignoreCase))
+			{
+				return false;
+			}
+
+			name.remove_suffix(tail.length());
+			--last;
+		}
+
+		// Floating segments in between are matched greedily at their leftmost position
+		size_t pos = 0;
+		for (auto it = first; it != last; ++it)
+		{
+			const auto segment = GetSegment(*it);
+			pos = Private::FindWildcardSegment(name, segment, pos, ignoreCase, it->IsLiteral);
+			if (pos == StringView::npos)
+			{
+				return false;
+			}
+			pos += segment.length();
+		}
+		return true;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "Common.h"
+#include "String.h"
+
+namespace kxf
+{
+	// Precompiled form of a wildcard expression for matching many names against the same expression.
+	// The expression is split into segments between '*' once and pre-folded for case-insensitive matching.
+	// Matches the same names as 'String::MatchesWildcards' called with the same expression and flags.
+	class KXF_API WildcardMatcher final
+	{
+		private:
+			struct Segment final
+			{
+				size_t Offset = 0;
+				size_t Length = 0;
+				bool IsLiteral = false;
+			};
+
+		private:
+			String m_Expression;
+			std::vector<Segment> m_Segments;
+			FlagSet<StringActionFlag> m_Flags;
+			bool m_LeadingStar = false;
+			bool m_TrailingStar = false;
+			bool m_IsDOSExpression = false;
+			bool m_IsCompiled = false;
+
+		private:
+			StringView GetSegment(const Segment& segment) const noexcept
+			{
+				return m_Expression.view().substr(segment.Offset, segment.Length);
+			}
+
+		public:
+			WildcardMatcher() noexcept = default;
+			WildcardMatcher(const String& expression, FlagSet<StringActionFlag> flags = {})
+			{
+				Compile(expression, flags);
+			}
+
+		public:
+			bool IsNull() const noexcept
+			{
+				return !m_IsCompiled;
+			}
+			bool Compile(const String& expression, FlagSet<StringActionFlag> flags = {});
+
+			bool Matches(StringView name) const noexcept;
+			bool Matches(const String& name) const noexcept
+			{
+				return Matches(name.view());
+			}
+
+		public:
+			explicit operator bool() const noexcept
+			{
+				return !IsNull();
+			}
+			bool operator!() const noexcept
+			{
+				return IsNull();
+			}
+	};
+}
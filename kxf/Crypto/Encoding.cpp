@@ -4,13 +4,402 @@
 #include "kxf/Core/UniChar.h"
 #include "kxf/Core/DataSize.h"
 #include "kxf/IO/IStream.h"
-
-#include <wx/base64.h>
-#include "kxf/Win32/UndefMacros.h"
+#include "kxf/IO/IDirectStream.h"
+#include "Private/EncodingKernels.h"
 
 namespace
 {
-	constexpr size_t g_StreamBlockSize = kxf::DataSize::FromKB(64).ToBytes();
+	using namespace kxf;
+	using namespace kxf::Crypto;
+
+	constexpr size_t g_StreamBlockSize = DataSize::FromKB(64).ToBytes();
+	constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+	bool IsWhitespace(uint8_t c) noexcept
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	// Streaming codecs, each call to 'Update' takes the next block of the input and writes everything that can be completed
+	// with it into a buffer of at least 'GetMaxOutput' bytes, returning the number of bytes written or 'npos' if the input is invalid.
+	// 'Finish' writes what's left, up to 'MaxTail' bytes.
+	class Base64Encoder final
+	{
+		public:
+			static constexpr size_t MaxTail = 4;
+
+		private:
+			Base64Alphabet m_Alphabet = Base64Alphabet::Standard;
+			uint8_t m_Tail[3] = {};
+			size_t m_TailSize = 0;
+
+		public:
+			Base64Encoder(Base64Alphabet alphabet) noexcept
+				:m_Alphabet(alphabet)
+			{
+			}
+
+		public:
+			size_t GetMaxOutput(size_t size) const noexcept
+			{
+				return (m_TailSize + size) / 3 * 4;
+			}
+			size_t Update(std::span<const uint8_t> data, std::span<uint8_t> buffer) noexcept
+			{
+				size_t written = 0;
+				if (m_TailSize != 0)
+				{
+					const size_t count = std::min(data.size(), 3 - m_TailSize);
+					std::memcpy(m_Tail + m_TailSize, data.data(), count);
+					m_TailSize += count;
+					data = data.subspan(count);
+
+					if (m_TailSize != 3)
+					{
+						return 0;
+					}
+					written = Crypto::Private::Base64EncodeBlocks(m_Tail, buffer, m_Alphabet).Written;
+					m_TailSize = 0;
+				}
+
+				const auto result = Crypto::Private::Base64EncodeBlocks(data, buffer.subspan(written), m_Alphabet);
+				m_TailSize = data.size() - result.Read;
+				std::memcpy(m_Tail, data.data() + result.Read, m_TailSize);
+
+				return written + result.Written;
+			}
+			size_t Finish(std::span<uint8_t> buffer) noexcept
+			{
+				if (m_TailSize == 0)
+				{
+					return 0;
+				}
+
+				const char* alphabet = Crypto::Private::GetBase64Alphabet(m_Alphabet);
+				const uint32_t value = (uint32_t(m_Tail[0]) << 16)|(m_TailSize > 1 ? uint32_t(m_Tail[1]) << 8 : 0);
+
+				// The URL-safe alphabet has no padding, the buffer can be sized for the significant characters only
+				const size_t count = m_TailSize + 1;
+				const size_t length = m_Alphabet == Base64Alphabet::URLSafe ? count : 4;
+
+				buffer[0] = alphabet[(value >> 18) & 0x3F];
+				buffer[1] = alphabet[(value >> 12) & 0x3F];
+				if (m_TailSize > 1)
+				{
+					buffer[2] = alphabet[(value >> 6) & 0x3F];
+				}
+				for (size_t i = count; i < length; i++)
+				{
+					buffer[i] = '=';
+				}
+
+				m_TailSize = 0;
+				return length;
+			}
+	};
+	class Base64Decoder final
+	{
+		public:
+			static constexpr size_t MaxTail = 2;
+
+		private:
+			Base64Alphabet m_Alphabet = Base64Alphabet::Standard;
+			uint8_t m_Group[4] = {};
+			size_t m_GroupSize = 0;
+			size_t m_Padding = 0;
+			bool m_Completed = false;
+
+		private:
+			size_t Flush(uint8_t* buffer) noexcept
+			{
+				const uint32_t value = (uint32_t(m_Group[0]) << 18)|(uint32_t(m_Group[1]) << 12)|(uint32_t(m_Group[2]) << 6)|uint32_t(m_Group[3]);
+				const size_t count = m_GroupSize - 1;
+				for (size_t i = 0; i < count; i++)
+				{
+					buffer[i] = static_cast<uint8_t>(value >> (16 - i * 8));
+				}
+
+				m_Group[0] = m_Group[1] = m_Group[2] = m_Group[3] = 0;
+				m_GroupSize = 0;
+				return count;
+			}
+
+		public:
+			Base64Decoder(Base64Alphabet alphabet) noexcept
+				:m_Alphabet(alphabet)
+			{
+			}
+
+		public:
+			size_t GetMaxOutput(size_t size) const noexcept
+			{
+				return (m_GroupSize + m_Padding + size) / 4 * 3;
+			}
+			size_t Update(std::span<const uint8_t> data, std::span<uint8_t> buffer) noexcept
+			{
+				size_t written = 0;
+				size_t i = 0;
+				while (i != data.size())
+				{
+					// Whole groups go to the vector kernel, the scalar loop below only deals with whitespace, padding and invalid input
+					if (m_GroupSize == 0 && m_Padding == 0 && !m_Completed)
+					{
+						const auto result = Crypto::Private::Base64DecodeBlocks(data.subspan(i), buffer.subspan(written), m_Alphabet);
+						i += result.Read;
+						written += result.Written;
+
+						if (i == data.size())
+						{
+							break;
+						}
+					}
+
+					const uint8_t c = data[i++];
+					if (IsWhitespace(c))
+					{
+						continue;
+					}
+					else if (m_Completed)
+					{
+						return npos;
+					}
+					else if (c == '=')
+					{
+						// The padding can only complete a group of two or three characters
+						if (m_GroupSize < 2)
+						{
+							return npos;
+						}
+						if (m_GroupSize + ++m_Padding == 4)
+						{
+							written += Flush(buffer.data() + written);
+							m_Completed = true;
+						}
+						continue;
+					}
+
+					const int value = Crypto::Private::DecodeBase64Char(c, m_Alphabet);
+					if (value < 0 || m_Padding != 0)
+					{
+						return npos;
+					}
+
+					m_Group[m_GroupSize++] = static_cast<uint8_t>(value);
+					if (m_GroupSize == 4)
+					{
+						written += Flush(buffer.data() + written);
+					}
+				}
+				return written;
+			}
+			size_t Finish(std::span<uint8_t> buffer) noexcept
+			{
+				if (m_GroupSize == 1)
+				{
+					return npos;
+				}
+				else if (m_GroupSize != 0)
+				{
+					return Flush(buffer.data());
+				}
+				return 0;
+			}
+	};
+
+	class HexEncoder final
+	{
+		public:
+			static constexpr size_t MaxTail = 0;
+
+		private:
+			bool m_UpperCase = false;
+
+		public:
+			HexEncoder(bool upperCase) noexcept
+				:m_UpperCase(upperCase)
+			{
+			}
+
+		public:
+			size_t GetMaxOutput(size_t size) const noexcept
+			{
+				return size * 2;
+			}
+			size_t Update(std::span<const uint8_t> data, std::span<uint8_t> buffer) noexcept
+			{
+				return Crypto::Private::HexEncodeBlocks(data, buffer, m_UpperCase).Written;
+			}
+			size_t Finish(std::span<uint8_t> buffer) noexcept
+			{
+				return 0;
+			}
+	};
+	class HexDecoder final
+	{
+		public:
+			static constexpr size_t MaxTail = 0;
+
+		private:
+			int m_High = -1;
+
+		public:
+			size_t GetMaxOutput(size_t size) const noexcept
+			{
+				return (size + (m_High >= 0 ? 1 : 0)) / 2;
+			}
+			size_t Update(std::span<const uint8_t> data, std::span<uint8_t> buffer) noexcept
+			{
+				size_t written = 0;
+				size_t i = 0;
+				while (i != data.size())
+				{
+					if (m_High < 0)
+					{
+						const auto result = Crypto::Private::HexDecodeBlocks(data.subspan(i), buffer.subspan(written));
+						i += result.Read;
+						written += result.Written;
+
+						if (i == data.size())
+						{
+							break;
+						}
+					}
+
+					const uint8_t c = data[i++];
+					if (IsWhitespace(c))
+					{
+						continue;
+					}
+
+					const int value = Crypto::Private::DecodeHexChar(c);
+					if (value < 0)
+					{
+						return npos;
+					}
+					else if (m_High < 0)
+					{
+						m_High = value;
+					}
+					else
+					{
+						buffer[written++] = static_cast<uint8_t>((m_High << 4)|value);
+						m_High = -1;
+					}
+				}
+				return written;
+			}
+			size_t Finish(std::span<uint8_t> buffer) noexcept
+			{
+				return m_High < 0 ? 0 : npos;
+			}
+	};
+
+	template<class TCodec>
+	size_t TransformSpan(TCodec&& codec, std::span<const uint8_t> data, std::span<uint8_t> buffer) noexcept
+	{
+		const size_t written = codec.Update(data, buffer);
+		if (written != npos)
+		{
+			const size_t tail = codec.Finish(buffer.subspan(written));
+			if (tail != npos)
+			{
+				return written + tail;
+			}
+		}
+		return npos;
+	}
+
+	template<class TCodec>
+	bool TransformStream(TCodec&& codec, IInputStream& inputStream, IOutputStream& outputStream)
+	{
+		// The output is written straight into the buffer of a direct stream when it can provide one of the required size
+		auto directOutput = outputStream.QueryInterface<IDirectOutputStream>();
+		std::vector<uint8_t> outputBuffer;
+
+		auto Write = [&](std::span<const uint8_t> data)
+		{
+			const size_t required = codec.GetMaxOutput(data.size());
+			if (directOutput)
+			{
+				if (auto buffer = directOutput->GetWriteBuffer(required); buffer.size() == required)
+				{
+					const size_t written = codec.Update(data, buffer);
+					return written != npos && directOutput->Commit(written) == written;
+				}
+			}
+
+			if (outputBuffer.size() < required)
+			{
+				outputBuffer.resize(required);
+			}
+			const size_t written = codec.Update(data, outputBuffer);
+			return written != npos && outputStream.WriteAll(outputBuffer.data(), written);
+		};
+
+		// Memory and mapped streams are encoded from their own memory
+		if (auto directInput = inputStream.QueryInterface<IDirectInputStream>())
+		{
+			for (auto data = directInput->GetReadBuffer(); !data.empty(); data = directInput->GetReadBuffer())
+			{
+				data = data.subspan(0, std::min(data.size(), g_StreamBlockSize));
+				if (!Write(data))
+				{
+					return false;
+				}
+				directInput->Consume(data.size());
+			}
+		}
+		else
+		{
+			auto buffer = std::make_unique<uint8_t[]>(g_StreamBlockSize);
+			while (true)
+			{
+				const DataSize read = inputStream.Read(buffer.get(), g_StreamBlockSize).LastRead();
+				if (!read.IsPositive())
+				{
+					if (inputStream.GetLastError() != StreamErrorCode::EndOfStream && inputStream.GetLastError().IsFail())
+					{
+						return false;
+					}
+					break;
+				}
+				if (!Write({buffer.get(), static_cast<size_t>(read.ToBytes())}))
+				{
+					return false;
+				}
+
+				if (inputStream.GetLastError() == StreamErrorCode::EndOfStream)
+				{
+					break;
+				}
+				else if (inputStream.GetLastError().IsFail())
+				{
+					return false;
+				}
+			}
+		}
+
+		uint8_t tail[std::max<size_t>(std::decay_t<TCodec>::MaxTail, 1)] = {};
+		const size_t written = codec.Finish(tail);
+		return written != npos && (written == 0 || outputStream.WriteAll(tail, written));
+	}
+
+	std::span<const uint8_t> ToBytes(std::span<const std::byte> data) noexcept
+	{
+		return {reinterpret_cast<const uint8_t*>(data.data()), data.size()};
+	}
+	std::span<const uint8_t> ToBytes(std::string_view data) noexcept
+	{
+		return {reinterpret_cast<const uint8_t*>(data.data()), data.size()};
+	}
+	std::span<uint8_t> ToBuffer(std::span<std::byte> buffer) noexcept
+	{
+		return {reinterpret_cast<uint8_t*>(buffer.data()), buffer.size()};
+	}
+	std::span<uint8_t> ToBuffer(std::span<char> buffer) noexcept
+	{
+		return {reinterpret_cast<uint8_t*>(buffer.data()), buffer.size()};
+	}
 }
 
 namespace kxf::Crypto
@@ -55,68 +444,123 @@ namespace kxf::Crypto
 		return count;
 	}
 
-	bool Base64Encode(IInputStream& inputStream, IOutputStream& outputStream)
+	size_t Base64EncodedSize(size_t size, Base64Alphabet alphabet) noexcept
+	{
+		if (alphabet == Base64Alphabet::URLSafe)
+		{
+			return size / 3 * 4 + (size % 3 != 0 ? size % 3 + 1 : 0);
+		}
+		return (size + 2) / 3 * 4;
+	}
+	size_t Base64DecodedSize(size_t length) noexcept
 	{
-		const size_t size = wxBase64EncodedSize(g_StreamBlockSize);
-		wxMemoryBuffer buffer(size);
+		return (length + 3) / 4 * 3;
+	}
 
-		uint8_t readBuffer[g_StreamBlockSize] = {};
-		while (inputStream.CanRead())
+	size_t Base64Encode(std::span<const std::byte> data, std::span<char> buffer, Base64Alphabet alphabet) noexcept
+	{
+		if (buffer.size() >= Base64EncodedSize(data.size(), alphabet))
 		{
-			if (inputStream.Read(readBuffer, std::size(readBuffer)).LastRead() != 0)
-			{
-				buffer.AppendData(readBuffer, inputStream.LastRead().ToBytes());
-			}
-			else
-			{
-				break;
-			}
+			return TransformSpan(Base64Encoder(alphabet), ToBytes(data), ToBuffer(buffer));
+		}
+		return 0;
+	}
+	std::string Base64Encode(std::span<const std::byte> data, Base64Alphabet alphabet)
+	{
+		std::string result;
+		result.resize(Base64EncodedSize(data.size(), alphabet));
+		Base64Encode(data, result, alphabet);
 
-			if (buffer.GetDataLen() == size)
+		return result;
+	}
+	std::optional<size_t> Base64Decode(std::string_view text, std::span<std::byte> buffer, Base64Alphabet alphabet) noexcept
+	{
+		if (buffer.size() >= Base64DecodedSize(text.size()))
+		{
+			if (const size_t written = TransformSpan(Base64Decoder(alphabet), ToBytes(text), ToBuffer(buffer)); written != npos)
 			{
-				auto utf8 = wxBase64Encode(buffer).ToUTF8();
-				if (outputStream.WriteAll(utf8.data(), utf8.length()))
-				{
-					return true;
-				}
-				else
-				{
-					break;
-				}
+				return written;
 			}
 		}
-		return false;
+		return {};
 	}
-	bool Base64Decode(IInputStream& inputStream, IOutputStream& outputStream)
+	std::optional<std::vector<std::byte>> Base64Decode(std::string_view text, Base64Alphabet alphabet)
 	{
-		const size_t size = wxBase64DecodedSize(g_StreamBlockSize);
-		wxMemoryBuffer buffer(size);
+		std::vector<std::byte> result;
+		result.resize(Base64DecodedSize(text.size()));
 
-		uint8_t readBuffer[g_StreamBlockSize] = {};
-		while (inputStream.CanRead())
+		if (auto written = Base64Decode(text, result, alphabet))
 		{
-			if (inputStream.Read(readBuffer, std::size(readBuffer)).LastRead() != 0)
-			{
-				buffer.AppendData(readBuffer, inputStream.LastRead().ToBytes());
-			}
-			else
-			{
-				break;
-			}
+			result.resize(*written);
+			return result;
+		}
+		return {};
+	}
+
+	bool Base64Encode(IInputStream& inputStream, IOutputStream& outputStream, Base64Alphabet alphabet)
+	{
+		return TransformStream(Base64Encoder(alphabet), inputStream, outputStream);
+	}
+	bool Base64Decode(IInputStream& inputStream, IOutputStream& outputStream, Base64Alphabet alphabet)
+	{
+		return TransformStream(Base64Decoder(alphabet), inputStream, outputStream);
+	}
+
+	size_t HexEncodedSize(size_t size) noexcept
+	{
+		return size * 2;
+	}
+	size_t HexDecodedSize(size_t length) noexcept
+	{
+		return length / 2;
+	}
+
+	size_t HexEncode(std::span<const std::byte> data, std::span<char> buffer, bool upperCase) noexcept
+	{
+		if (buffer.size() >= HexEncodedSize(data.size()))
+		{
+			return TransformSpan(HexEncoder(upperCase), ToBytes(data), ToBuffer(buffer));
+		}
+		return 0;
+	}
+	std::string HexEncode(std::span<const std::byte> data, bool upperCase)
+	{
+		std::string result;
+		result.resize(HexEncodedSize(data.size()));
+		HexEncode(data, result, upperCase);
 
-			if (buffer.GetDataLen() == size)
+		return result;
+	}
+	std::optional<size_t> HexDecode(std::string_view text, std::span<std::byte> buffer) noexcept
+	{
+		if (buffer.size() >= HexDecodedSize(text.size()))
+		{
+			if (const size_t written = TransformSpan(HexDecoder(), ToBytes(text), ToBuffer(buffer)); written != npos)
 			{
-				wxMemoryBuffer outBuffer = wxBase64Decode(reinterpret_cast<const char*>(buffer.GetData()), buffer.GetDataLen(), wxBase64DecodeMode_SkipWS);
-				if (outputStream.WriteAll(outBuffer.GetData(), outBuffer.GetDataLen()))
-				{
-					return true;
-				}
-				else
-				{
-					break;
-				}
+				return written;
 			}
 		}
-		return false;
+		return {};
+	}
+	std::optional<std::vector<std::byte>> HexDecode(std::string_view text)
+	{
+		std::vector<std::byte> result;
+		result.resize(HexDecodedSize(text.size()));
+
+		if (auto written = HexDecode(text, result))
+		{
+			result.resize(*written);
+			return result;
+		}
+		return {};
+	}
+
+	bool HexEncode(IInputStream& inputStream, IOutputStream& outputStream, bool upperCase)
+	{
+		return TransformStream(HexEncoder(upperCase), inputStream, outputStream);
+	}
+	bool HexDecode(IInputStream& inputStream, IOutputStream& outputStream)
+	{
+		return TransformStream(HexDecoder(), inputStream, outputStream);
 	}
 }
@@ -1,11 +1,45 @@
 #pragma once
 #include "Common.h"
 
+namespace kxf::Crypto
+{
+	enum class Base64Alphabet
+	{
+		// RFC 4648, section 4: '+' and '/' with the padding
+		Standard,
+
+		// RFC 4648, section 5: '-' and '_' without the padding
+		URLSafe
+	};
+}
+
 namespace kxf::Crypto
 {
 	KXF_API_CRYPTO size_t Rot13(String& data) noexcept;
 	KXF_API_CRYPTO size_t UwUize(String& data) noexcept;
 
-	KXF_API_CRYPTO bool Base64Encode(IInputStream& inputStream, IOutputStream& outputStream);
-	KXF_API_CRYPTO bool Base64Decode(IInputStream& inputStream, IOutputStream& outputStream);
+	// Base64 and hex codecs. The decoders skip whitespace, accept Base64 with or without the padding and fail on any other
+	// character outside of the alphabet. The span versions write nothing unless the buffer is at least '*EncodedSize' or
+	// '*DecodedSize' long and return the number of characters or bytes written, the stream versions work in fixed-size blocks.
+	KXF_API_CRYPTO size_t Base64EncodedSize(size_t size, Base64Alphabet alphabet = Base64Alphabet::Standard) noexcept;
+	KXF_API_CRYPTO size_t Base64DecodedSize(size_t length) noexcept;
+
+	KXF_API_CRYPTO size_t Base64Encode(std::span<const std::byte> data, std::span<char> buffer, Base64Alphabet alphabet = Base64Alphabet::Standard) noexcept;
+	KXF_API_CRYPTO std::string Base64Encode(std::span<const std::byte> data, Base64Alphabet alphabet = Base64Alphabet::Standard);
+	KXF_API_CRYPTO std::optional<size_t> Base64Decode(std::string_view text, std::span<std::byte> buffer, Base64Alphabet alphabet = Base64Alphabet::Standard) noexcept;
+	KXF_API_CRYPTO std::optional<std::vector<std::byte>> Base64Decode(std::string_view text, Base64Alphabet alphabet = Base64Alphabet::Standard);
+
+	KXF_API_CRYPTO bool Base64Encode(IInputStream& inputStream, IOutputStream& outputStream, Base64Alphabet alphabet = Base64Alphabet::Standard);
+	KXF_API_CRYPTO bool Base64Decode(IInputStream& inputStream, IOutputStream& outputStream, Base64Alphabet alphabet = Base64Alphabet::Standard);
+
+	KXF_API_CRYPTO size_t HexEncodedSize(size_t size) noexcept;
+	KXF_API_CRYPTO size_t HexDecodedSize(size_t length) noexcept;
+
+	KXF_API_CRYPTO size_t HexEncode(std::span<const std::byte> data, std::span<char> buffer, bool upperCase = false) noexcept;
+	KXF_API_CRYPTO std::string HexEncode(std::span<const std::byte> data, bool upperCase = false);
+	KXF_API_CRYPTO std::optional<size_t> HexDecode(std::string_view text, std::span<std::byte> buffer) noexcept;
+	KXF_API_CRYPTO std::optional<std::vector<std::byte>> HexDecode(std::string_view text);
+
+	KXF_API_CRYPTO bool HexEncode(IInputStream& inputStream, IOutputStream& outputStream, bool upperCase = false);
+	KXF_API_CRYPTO bool HexDecode(IInputStream& inputStream, IOutputStream& outputStream);
 };
@@ -0,0 +1,477 @@
+#include "kxf-pch.h"
+#include "EncodingKernels.h"
+#include "kxf/Core/Private/CPUFeatures.h"
+#include <immintrin.h>
+
+namespace
+{
+	using kxf::Crypto::Base64Alphabet;
+	using kxf::Crypto::Private::KernelResult;
+
+	constexpr char g_Base64Standard[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	constexpr char g_Base64URLSafe[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+	constexpr char g_HexLower[] = "0123456789abcdef";
+	constexpr char g_HexUpper[] = "0123456789ABCDEF";
+
+	using DecodeTable = std::array<int8_t, 256>;
+	constexpr DecodeTable MakeDecodeTable(const char* alphabet, size_t count) noexcept
+	{
+		DecodeTable table = {};
+		for (auto& item: table)
+		{
+			item = -1;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			table[static_cast<uint8_t>(alphabet[i])] = static_cast<int8_t>(i);
+		}
+		return table;
+	}
+	constexpr DecodeTable g_Base64StandardTable = MakeDecodeTable(g_Base64Standard, 64);
+	constexpr DecodeTable g_Base64URLSafeTable = MakeDecodeTable(g_Base64URLSafe, 64);
+	constexpr DecodeTable g_HexTable = []()
+	{
+		DecodeTable table = MakeDecodeTable(g_HexLower, 16);
+		for (size_t i = 10; i < 16; i++)
+		{
+			table[static_cast<uint8_t>(g_HexUpper[i])] = static_cast<int8_t>(i);
+		}
+		return table;
+	}();
+
+	// Characters for the indices 62 and 63, the rest of the alphabet is the same for both variants
+	char Get62(Base64Alphabet alphabet) noexcept
+	{
+		return alphabet == Base64Alphabet::URLSafe ? '-' : '+';
+	}
+	char Get63(Base64Alphabet alphabet) noexcept
+	{
+		return alphabet == Base64Alphabet::URLSafe ? '_' : '/';
+	}
+
+	// Scalar kernels
+	void Base64EncodeScalar(std::span<const uint8_t> source, std::span<uint8_t> buffer, Base64Alphabet alphabet, KernelResult& result) noexcept
+	{
+		const char* table = kxf::Crypto::Private::GetBase64Alphabet(alphabet);
+		while (source.size() - result.Read >= 3 && buffer.size() - result.Written >= 4)
+		{
+			const uint8_t* in = source.data() + result.Read;
+			uint8_t* out = buffer.data() + result.Written;
+			const uint32_t value = (uint32_t(in[0]) << 16)|(uint32_t(in[1]) << 8)|uint32_t(in[2]);
+
+			out[0] = table[(value >> 18) & 0x3F];
+			out[1] = table[(value >> 12) & 0x3F];
+			out[2] = table[(value >> 6) & 0x3F];
+			out[3] = table[value & 0x3F];
+
+			result.Read += 3;
+			result.Written += 4;
+		}
+	}
+	void Base64DecodeScalar(std::span<const uint8_t> source, std::span<uint8_t> buffer, Base64Alphabet alphabet, KernelResult& result) noexcept
+	{
+		const DecodeTable& table = alphabet == Base64Alphabet::URLSafe ? g_Base64URLSafeTable : g_Base64StandardTable;
+		while (source.size() - result.Read >= 4 && buffer.size() - result.Written >= 3)
+		{
+			const uint8_t* in = source.data() + result.Read;
+			const int a = table[in[0]];
+			const int b = table[in[1]];
+			const int c = table[in[2]];
+			const int d = table[in[3]];
+			if ((a|b|c|d) < 0)
+			{
+				break;
+			}
+
+			const uint32_t value = (uint32_t(a) << 18)|(uint32_t(b) << 12)|(uint32_t(c) << 6)|uint32_t(d);
+			uint8_t* out = buffer.data() + result.Written;
+			out[0] = static_cast<uint8_t>(value >> 16);
+			out[1] = static_cast<uint8_t>(value >> 8);
+			out[2] = static_cast<uint8_t>(value);
+
+			result.Read += 4;
+			result.Written += 3;
+		}
+	}
+	void HexEncodeScalar(std::span<const uint8_t> source, std::span<uint8_t> buffer, bool upperCase, KernelResult& result) noexcept
+	{
+		const char* table = upperCase ? g_HexUpper : g_HexLower;
+		while (result.Read != source.size() && buffer.size() - result.Written >= 2)
+		{
+			const uint8_t value = source[result.Read++];
+			buffer[result.Written++] = table[value >> 4];
+			buffer[result.Written++] = table[value & 0x0F];
+		}
+	}
+	void HexDecodeScalar(std::span<const uint8_t> source, std::span<uint8_t> buffer, KernelResult& result) noexcept
+	{
+		while (source.size() - result.Read >= 2 && result.Written != buffer.size())
+		{
+			const int high = g_HexTable[source[result.Read]];
+			const int low = g_HexTable[source[result.Read + 1]];
+			if ((high|low) < 0)
+			{
+				break;
+			}
+
+			buffer[result.Written++] = static_cast<uint8_t>((high << 4)|low);
+			result.Read += 2;
+		}
+	}
+
+	// SSSE3 kernels. Base64 encoding follows Wojciech Muła's algorithm: the bytes of every triple are shuffled into a 32-bit lane,
+	// the four 6-bit indices are extracted with two multiplications and translated into characters by adding a per-range offset.
+	__m128i InRange_SSE2(__m128i value, char first, char last) noexcept
+	{
+		return _mm_and_si128(_mm_cmpgt_epi8(value, _mm_set1_epi8(first - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(last + 1), value));
+	}
+	__m256i InRange_AVX2(__m256i value, char first, char last) noexcept
+	{
+		return _mm256_and_si256(_mm256_cmpgt_epi8(value, _mm256_set1_epi8(first - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(last + 1), value));
+	}
+	__m128i MakeBase64ShiftTable(Base64Alphabet alphabet) noexcept
+	{
+		constexpr char digit = '0' - 52;
+		return _mm_setr_epi8('a' - 26, digit, digit, digit, digit, digit, digit, digit, digit, digit, digit,
+							 static_cast<char>(Get62(alphabet) - 62), static_cast<char>(Get63(alphabet) - 63), 'A', 0, 0);
+	}
+
+	void Base64Encode_SSSE3(std::span<const uint8_t> source, std::span<uint8_t> buffer, Base64Alphabet alphabet, KernelResult& result) noexcept
+	{
+		const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+		const __m128i shiftTable = MakeBase64ShiftTable(alphabet);
+
+		// 12 bytes are encoded per iteration but 16 are loaded
+		while (source.size() - result.Read >= 16 && buffer.size() - result.Written >= 16)
+		{
+			__m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + result.Read));
+			in = _mm_shuffle_epi8(in, shuffle);
+
+			const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+			const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+			const __m128i indices = _mm_or_si128(t0, t1);
+
+			// 0 for the lower case letters, 1-10 for the digits, 11 and 12 for the last two characters and 13 for the upper case letters
+			__m128i ranges = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+			ranges = _mm_or_si128(ranges, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+
+			const __m128i out = _mm_add_epi8(_mm_shuffle_epi8(shiftTable, ranges), indices);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer.data() + result.Written), out);
+
+			result.Read += 12;
+			result.Written += 16;
+		}
+	}
+	void Base64Decode_SSSE3(std::span<const uint8_t> source, std::span<uint8_t> buffer, Base64Alphabet alphabet, KernelResult& result) noexcept
+	{
+		const char c62 = Get62(alphabet);
+		const char c63 = Get63(alphabet);
+		const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+		// 16 characters are decoded into 12 bytes per iteration but 16 are stored
+		while (source.size() - result.Read >= 16 && buffer.size() - result.Written >= 16)
+		{
+			const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + result.Read));
+			const __m128i upper = InRange_SSE2(in, 'A', 'Z');
+			const __m128i lower = InRange_SSE2(in, 'a', 'z');
+			const __m128i digit = InRange_SSE2(in, '0', '9');
+			const __m128i is62 = _mm_cmpeq_epi8(in, _mm_set1_epi8(c62));
+			const __m128i is63 = _mm_cmpeq_epi8(in, _mm_set1_epi8(c63));
+
+			// Characters above 0x7F are negative and fall out of all the ranges
+			const __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, is62)), is63);
+			if (_mm_movemask_epi8(valid) != 0xFFFF)
+			{
+				break;
+			}
+
+			__m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+			shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+			shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+			shift = _mm_or_si128(shift, _mm_and_si128(is62, _mm_set1_epi8(static_cast<char>(62 - c62))));
+			shift = _mm_or_si128(shift, _mm_and_si128(is63, _mm_set1_epi8(static_cast<char>(63 - c63))));
+			const __m128i values = _mm_add_epi8(in, shift);
+
+			// Merge the 6-bit values into 12-bit pairs and then into 24-bit groups, one in each 32-bit lane
+			const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+			const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer.data() + result.Written), _mm_shuffle_epi8(groups, pack));
+
+			result.Read += 16;
+			result.Written += 12;
+		}
+	}
+	void HexEncode_SSSE3(std::span<const uint8_t> source, std::span<uint8_t> buffer, bool upperCase, KernelResult& result) noexcept
+	{
+		const __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(upperCase ? g_HexUpper : g_HexLower));
+		const __m128i mask = _mm_set1_epi8(0x0F);
+
+		while (source.size() - result.Read >= 16 && buffer.size() - result.Written >= 32)
+		{
+			const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + result.Read));
+			const __m128i high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+			const __m128i low = _mm_shuffle_epi8(table, _mm_and_si128(in, mask));
+
+			auto out = reinterpret_cast<__m128i*>(buffer.data() + result.Written);
+			_mm_storeu_si128(out, _mm_unpacklo_epi8(high, low));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi8(high, low));
+
+			result.Read += 16;
+			result.Written += 32;
+		}
+	}
+	void HexDecode_SSSE3(std::span<const uint8_t> source, std::span<uint8_t> buffer, KernelResult& result) noexcept
+	{
+		auto Translate = [](__m128i in, __m128i& values) noexcept
+		{
+			const __m128i digit = InRange_SSE2(in, '0', '9');
+			const __m128i upper = InRange_SSE2(in, 'A', 'F');
+			const __m128i lower = InRange_SSE2(in, 'a', 'f');
+
+			__m128i shift = _mm_and_si128(digit, _mm_set1_epi8(-'0'));
+			shift = _mm_or_si128(shift, _mm_and_si128(upper, _mm_set1_epi8(10 - 'A')));
+			shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(10 - 'a')));
+
+			values = _mm_add_epi8(in, shift);
+			return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(digit, upper), lower)) == 0xFFFF;
+		};
+
+		// The pairs of nibbles are merged into 16-bit lanes and then packed into bytes
+		const __m128i weights = _mm_set1_epi16(0x0110);
+		while (source.size() - result.Read >= 32 && buffer.size() - result.Written >= 16)
+		{
+			auto in = reinterpret_cast<const __m128i*>(source.data() + result.Read);
+
+			__m128i values0;
+			__m128i values1;
+			if (!Translate(_mm_loadu_si128(in), values0) || !Translate(_mm_loadu_si128(in + 1), values1))
+			{
+				break;
+			}
+
+			const __m128i out = _mm_packus_epi16(_mm_maddubs_epi16(values0, weights), _mm_maddubs_epi16(values1, weights));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer.data() + result.Written), out);
+
+			result.Read += 32;
+			result.Written += 16;
+		}
+	}
+
+	// AVX2 kernels, the same algorithms with both 128-bit lanes processing their own part of the block
+	void Base64Encode_AVX2(std::span<const uint8_t> source, std::span<uint8_t> buffer, Base64Alphabet alphabet, KernelResult& result) noexcept
+	{
+		const __m256i shuffle = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+												10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+		const __m256i shiftTable = _mm256_broadcastsi128_si256(MakeBase64ShiftTable(alphabet));
+
+		// Each lane gets 12 bytes of its own, the upper lane is loaded from the 12th byte, so 28 bytes have to be readable
+		while (source.size() - result.Read >= 28 && buffer.size() - result.Written >= 32)
+		{
+			const uint8_t* ptr = source.data() + result.Read;
+			__m256i in = _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)));
+			in = _mm256_inserti128_si256(in, _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 12)), 1);
+			in = _mm256_shuffle_epi8(in, shuffle);
+
+			const __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+			const __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+			const __m256i indices = _mm256_or_si256(t0, t1);
+
+			__m256i ranges = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+			ranges = _mm256_or_si256(ranges, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+
+			const __m256i out = _mm256_add_epi8(_mm256_shuffle_epi8(shiftTable, ranges), indices);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer.data() + result.Written), out);
+
+			result.Read += 24;
+			result.Written += 32;
+		}
+	}
+	void Base64Decode_AVX2(std::span<const uint8_t> source, std::span<uint8_t> buffer, Base64Alphabet alphabet, KernelResult& result) noexcept
+	{
+		const char c62 = Get62(alphabet);
+		const char c63 = Get63(alphabet);
+		const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+											  2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		const __m256i join = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+		// 32 characters are decoded into 24 bytes per iteration but 32 are stored
+		while (source.size() - result.Read >= 32 && buffer.size() - result.Written >= 32)
+		{
+			const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source.data() + result.Read));
+			const __m256i upper = InRange_AVX2(in, 'A', 'Z');
+			const __m256i lower = InRange_AVX2(in, 'a', 'z');
+			const __m256i digit = InRange_AVX2(in, '0', '9');
+			const __m256i is62 = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(c62));
+			const __m256i is63 = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(c63));
+
+			const __m256i valid = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, is62)), is63);
+			if (static_cast<uint32_t>(_mm256_movemask_epi8(valid)) != 0xFFFFFFFFu)
+			{
+				break;
+			}
+
+			__m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(is62, _mm256_set1_epi8(static_cast<char>(62 - c62))));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(is63, _mm256_set1_epi8(static_cast<char>(63 - c63))));
+			const __m256i values = _mm256_add_epi8(in, shift);
+
+			const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+			const __m256i groups = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+			const __m256i out = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(groups, pack), join);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer.data() + result.Written), out);
+
+			result.Read += 32;
+			result.Written += 24;
+		}
+	}
+	void HexEncode_AVX2(std::span<const uint8_t> source, std::span<uint8_t> buffer, bool upperCase, KernelResult& result) noexcept
+	{
+		const __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(upperCase ? g_HexUpper : g_HexLower)));
+		const __m256i mask = _mm256_set1_epi8(0x0F);
+
+		while (source.size() - result.Read >= 32 && buffer.size() - result.Written >= 64)
+		{
+			const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source.data() + result.Read));
+			const __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+			const __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(in, mask));
+
+			// Unpacking works within the lanes, so the halves have to be put back in order
+			const __m256i first = _mm256_unpacklo_epi8(high, low);
+			const __m256i second = _mm256_unpackhi_epi8(high, low);
+
+			auto out = reinterpret_cast<__m256i*>(buffer.data() + result.Written);
+			_mm256_storeu_si256(out, _mm256_permute2x128_si256(first, second, 0x20));
+			_mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(first, second, 0x31));
+
+			result.Read += 32;
+			result.Written += 64;
+		}
+	}
+	void HexDecode_AVX2(std::span<const uint8_t> source, std::span<uint8_t> buffer, KernelResult& result) noexcept
+	{
+		auto Translate = [](__m256i in, __m256i& values) noexcept
+		{
+			const __m256i digit = InRange_AVX2(in, '0', '9');
+			const __m256i upper = InRange_AVX2(in, 'A', 'F');
+			const __m256i lower = InRange_AVX2(in, 'a', 'f');
+
+			__m256i shift = _mm256_and_si256(digit, _mm256_set1_epi8(-'0'));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(upper, _mm256_set1_epi8(10 - 'A')));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(10 - 'a')));
+
+			values = _mm256_add_epi8(in, shift);
+			return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(digit, upper), lower))) == 0xFFFFFFFFu;
+		};
+
+		const __m256i weights = _mm256_set1_epi16(0x0110);
+		while (source.size() - result.Read >= 64 && buffer.size() - result.Written >= 32)
+		{
+			auto in = reinterpret_cast<const __m256i*>(source.data() + result.Read);
+
+			__m256i values0;
+			__m256i values1;
+			if (!Translate(_mm256_loadu_si256(in), values0) || !Translate(_mm256_loadu_si256(in + 1), values1))
+			{
+				break;
+			}
+
+			// Packing interleaves the lanes of both inputs
+			const __m256i out = _mm256_packus_epi16(_mm256_maddubs_epi16(values0, weights), _mm256_maddubs_epi16(values1, weights));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer.data() + result.Written), _mm256_permute4x64_epi64(out, 0xD8));
+
+			result.Read += 64;
+			result.Written += 32;
+		}
+	}
+
+	template<class TAVX2, class TSSSE3, class TScalar>
+	KernelResult Dispatch(TAVX2&& avx2, TSSSE3&& ssse3, TScalar&& scalar) noexcept
+	{
+		using kxf::Private::CPUFeature;
+
+		KernelResult result;
+		const auto features = kxf::Private::GetCPUFeatures();
+		if (features.Contains(CPUFeature::AVX2))
+		{
+			std::invoke(avx2, result);
+		}
+		else if (features.Contains(CPUFeature::SSSE3))
+		{
+			std::invoke(ssse3, result);
+		}
+		std::invoke(scalar, result);
+
+		return result;
+	}
+}
+
+namespace kxf::Crypto::Private
+{
+	KernelResult Base64EncodeBlocks(std::span<const uint8_t> source, std::span<uint8_t> buffer, Base64Alphabet alphabet) noexcept
+	{
+		return Dispatch([&](KernelResult& result)
+		{
+			Base64Encode_AVX2(source, buffer, alphabet, result);
+		}, [&](KernelResult& result)
+		{
+			Base64Encode_SSSE3(source, buffer, alphabet, result);
+		}, [&](KernelResult& result)
+		{
+			Base64EncodeScalar(source, buffer, alphabet, result);
+		});
+	}
+	KernelResult Base64DecodeBlocks(std::span<const uint8_t> source, std::span<uint8_t> buffer, Base64Alphabet alphabet) noexcept
+	{
+		return Dispatch([&](KernelResult& result)
+		{
+			Base64Decode_AVX2(source, buffer, alphabet, result);
+		}, [&](KernelResult& result)
+		{
+			Base64Decode_SSSE3(source, buffer, alphabet, result);
+		}, [&](KernelResult& result)
+		{
+			Base64DecodeScalar(source, buffer, alphabet, result);
+		});
+	}
+	KernelResult HexEncodeBlocks(std::span<const uint8_t> source, std::span<uint8_t> buffer, bool upperCase) noexcept
+	{
+		return Dispatch([&](KernelResult& result)
+		{
+			HexEncode_AVX2(source, buffer, upperCase, result);
+		}, [&](KernelResult& result)
+		{
+			HexEncode_SSSE3(source, buffer, upperCase, result);
+		}, [&](KernelResult& result)
+		{
+			HexEncodeScalar(source, buffer, upperCase, result);
+		});
+	}
+	KernelResult HexDecodeBlocks(std::span<const uint8_t> source, std::span<uint8_t> buffer) noexcept
+	{
+		return Dispatch([&](KernelResult& result)
+		{
+			HexDecode_AVX2(source, buffer, result);
+		}, [&](KernelResult& result)
+		{
+			HexDecode_SSSE3(source, buffer, result);
+		}, [&](KernelResult& result)
+		{
+			HexDecodeScalar(source, buffer, result);
+		});
+	}
+
+	const char* GetBase64Alphabet(Base64Alphabet alphabet) noexcept
+	{
+		return alphabet == Base64Alphabet::URLSafe ? g_Base64URLSafe : g_Base64Standard;
+	}
+	int DecodeBase64Char(uint8_t c, Base64Alphabet alphabet) noexcept
+	{
+		return (alphabet == Base64Alphabet::URLSafe ? g_Base64URLSafeTable : g_Base64StandardTable)[c];
+	}
+	int DecodeHexChar(uint8_t c) noexcept
+	{
+		return g_HexTable[c];
+	}
+}
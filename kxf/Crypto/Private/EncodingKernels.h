@@ -0,0 +1,32 @@
+#pragma once
+#include "../Common.h"
+#include "../Encoding.h"
+
+namespace kxf::Crypto::Private
+{
+	// Bulk kernels of the Base64 and hex codecs. Each one processes as many whole blocks as fit into both the source and
+	// the buffer, using an AVX2 or SSSE3 kernel selected at runtime (see 'kxf::Private::GetCPUFeatures') and a scalar loop
+	// for the rest. Partial blocks, padding and whitespace are left for the caller.
+	struct KernelResult final
+	{
+		size_t Read = 0;
+		size_t Written = 0;
+	};
+
+	// Three bytes to four characters
+	KernelResult Base64EncodeBlocks(std::span<const uint8_t> source, std::span<uint8_t> buffer, Base64Alphabet alphabet) noexcept;
+
+	// Four characters to three bytes, stops at the first group which has a character outside of the alphabet
+	KernelResult Base64DecodeBlocks(std::span<const uint8_t> source, std::span<uint8_t> buffer, Base64Alphabet alphabet) noexcept;
+
+	// One byte to two characters
+	KernelResult HexEncodeBlocks(std::span<const uint8_t> source, std::span<uint8_t> buffer, bool upperCase) noexcept;
+
+	// Two characters to one byte, stops at the first pair which has a character that isn't a hex digit
+	KernelResult HexDecodeBlocks(std::span<const uint8_t> source, std::span<uint8_t> buffer) noexcept;
+
+	// Scalar translation of a single character, -1 if it's not in the alphabet
+	const char* GetBase64Alphabet(Base64Alphabet alphabet) noexcept;
+	int DecodeBase64Char(uint8_t c, Base64Alphabet alphabet) noexcept;
+	int DecodeHexChar(uint8_t c) noexcept;
+}
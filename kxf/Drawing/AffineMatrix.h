@@ -276,21 +276,11 @@ namespace kxf
 		public:
 			uint64_t Serialize(IOutputStream& stream, const TMatrix& value) const
 			{
-				return Serialization::WriteObject(stream, value.m_11) +
-					Serialization::WriteObject(stream, value.m_12) +
-					Serialization::WriteObject(stream, value.m_21) +
-					Serialization::WriteObject(stream, value.m_22) +
-					Serialization::WriteObject(stream, value.m_tx) +
-					Serialization::WriteObject(stream, value.m_ty);
+				return Serialization::WriteObjects(stream, value.m_11, value.m_12, value.m_21, value.m_22, value.m_tx, value.m_ty);
 			}
 			uint64_t Deserialize(IInputStream& stream, TMatrix& value) const
 			{
-				return Serialization::ReadObject(stream, value.m_11) +
-					Serialization::ReadObject(stream, value.m_12) +
-					Serialization::ReadObject(stream, value.m_21) +
-					Serialization::ReadObject(stream, value.m_22) +
-					Serialization::ReadObject(stream, value.m_tx) +
-					Serialization::ReadObject(stream, value.m_ty);
+				return Serialization::ReadObjects(stream, value.m_11, value.m_12, value.m_21, value.m_22, value.m_tx, value.m_ty);
 			}
 	};
 }
@@ -601,17 +601,11 @@ namespace kxf
 	{
 		uint64_t Serialize(IOutputStream& stream, const Color& value) const
 		{
-			return Serialization::WriteObject(stream, value.m_Value.Red) +
-				Serialization::WriteObject(stream, value.m_Value.Green) +
-				Serialization::WriteObject(stream, value.m_Value.Blue) +
-				Serialization::WriteObject(stream, value.m_Value.Alpha);
+			return Serialization::WriteObjects(stream, value.m_Value.Red, value.m_Value.Green, value.m_Value.Blue, value.m_Value.Alpha);
 		}
 		uint64_t Deserialize(IInputStream& stream, Color& value) const
 		{
-			return Serialization::ReadObject(stream, value.m_Value.Red) +
-				Serialization::ReadObject(stream, value.m_Value.Green) +
-				Serialization::ReadObject(stream, value.m_Value.Blue) +
-				Serialization::ReadObject(stream, value.m_Value.Alpha);
+			return Serialization::ReadObjects(stream, value.m_Value.Red, value.m_Value.Green, value.m_Value.Blue, value.m_Value.Alpha);
 		}
 	};
 }
@@ -1308,11 +1308,11 @@ namespace kxf
 		public:
 			uint64_t Serialize(IOutputStream& stream, const TPoint& value) const
 			{
-				return Serialization::WriteObject(stream, value.GetX()) + Serialization::WriteObject(stream, value.GetY());
+				return Serialization::WriteObjects(stream, value.GetX(), value.GetY());
 			}
 			uint64_t Deserialize(IInputStream& stream, TPoint& value) const
 			{
-				return Serialization::ReadObject(stream, value.X()) + Serialization::ReadObject(stream, value.Y());
+				return Serialization::ReadObjects(stream, value.X(), value.Y());
 			}
 	};
 
@@ -1325,11 +1325,11 @@ namespace kxf
 		public:
 			uint64_t Serialize(IOutputStream& stream, const TSize& value) const
 			{
-				return Serialization::WriteObject(stream, value.GetWidth()) + Serialization::WriteObject(stream, value.GetHeight());
+				return Serialization::WriteObjects(stream, value.GetWidth(), value.GetHeight());
 			}
 			uint64_t Deserialize(IInputStream& stream, TSize& value) const
 			{
-				return Serialization::ReadObject(stream, value.Width()) + Serialization::ReadObject(stream, value.Height());
+				return Serialization::ReadObjects(stream, value.Width(), value.Height());
 			}
 	};
 
@@ -1342,17 +1342,11 @@ namespace kxf
 		public:
 			uint64_t Serialize(IOutputStream& stream, const TRect& value) const
 			{
-				return Serialization::WriteObject(stream, value.GetX()) +
-					Serialization::WriteObject(stream, value.GetY()) +
-					Serialization::WriteObject(stream, value.GetWidth()) +
-					Serialization::WriteObject(stream, value.GetHeight());
+				return Serialization::WriteObjects(stream, value.GetX(), value.GetY(), value.GetWidth(), value.GetHeight());
 			}
 			uint64_t Deserialize(IInputStream& stream, TRect& value) const
 			{
-				return Serialization::ReadObject(stream, value.X()) +
-					Serialization::ReadObject(stream, value.Y()) +
-					Serialization::ReadObject(stream, value.Width()) +
-					Serialization::ReadObject(stream, value.Height());
+				return Serialization::ReadObjects(stream, value.X(), value.Y(), value.Width(), value.Height());
 			}
 	};
 }
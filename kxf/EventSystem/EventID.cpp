@@ -26,11 +26,11 @@ namespace kxf
 				return std::hash<UniversallyUniqueID>()(*value);
 			}
 		}
-		else if (auto value = std::get_if<String>(&m_ID))
+		else if (auto value = std::get_if<InternedString>(&m_ID))
 		{
 			if (!value->IsEmpty())
 			{
-				return std::hash<String>()(*value);
+				return std::hash<InternedString>()(*value);
 			}
 		}
 		return 0;
@@ -55,10 +55,10 @@ namespace kxf
 			written += WriteIndex();
 			written += Serialization::WriteObject(stream, *value);
 		}
-		else if (auto value = std::get_if<String>(&m_ID))
+		else if (auto value = std::get_if<InternedString>(&m_ID))
 		{
 			written += WriteIndex();
-			written += Serialization::WriteObject(stream, *value);
+			written += Serialization::WriteObject(stream, value->GetString());
 		}
 		else
 		{
@@ -95,7 +95,7 @@ namespace kxf
 			}
 			case 2:
 			{
-				String value;
+				InternedString value;
 				read += Serialization::ReadObject(stream, value);
 				m_ID = std::move(value);
 
@@ -123,7 +123,7 @@ namespace kxf
 		{
 			return value->IsNull();
 		}
-		else if (auto value = std::get_if<String>(&m_ID))
+		else if (auto value = std::get_if<InternedString>(&m_ID))
 		{
 			return value->IsEmpty();
 		}
@@ -148,12 +148,20 @@ namespace kxf
 	}
 	const String& EventID::AsString() const noexcept
 	{
-		if (auto value = std::get_if<String>(&m_ID))
+		if (auto value = std::get_if<InternedString>(&m_ID))
 		{
-			return *value;
+			return value->GetString();
 		}
 		return NullString;
 	}
+	InternedString EventID::AsInternedString() const noexcept
+	{
+		if (auto value = std::get_if<InternedString>(&m_ID))
+		{
+			return *value;
+		}
+		return {};
+	}
 
 	bool EventID::IsWXID() const noexcept
 	{
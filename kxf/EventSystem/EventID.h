@@ -1,6 +1,7 @@
 #pragma once
 #include "Common.h"
 #include "kxf/Core/String.h"
+#include "kxf/Core/InternedString.h"
 #include "kxf/Core/UniversallyUniqueID.h"
 #include "kxf/Serialization/BinarySerializer.h"
 #include "kxf/Utility/Memory.h"
@@ -20,7 +21,7 @@ namespace kxf
 		friend struct BinarySerializer<EventID>;
 
 		private:
-			std::variant<int64_t, UniversallyUniqueID, String> m_ID;
+			std::variant<int64_t, UniversallyUniqueID, InternedString> m_ID;
 			const std::type_info* m_TypeInfo = nullptr;
 
 		private:
@@ -60,17 +61,21 @@ namespace kxf
 			{
 			}
 			
-			// String
-			EventID(String id) noexcept
+			// String, interned so that comparing and hashing string IDs doesn't touch the string contents
+			EventID(InternedString id) noexcept
 				:m_ID(std::move(id))
 			{
 			}
-			EventID(const char* id) noexcept
-				:m_ID(String(id))
+			EventID(const String& id)
+				:m_ID(InternedString(id))
 			{
 			}
-			EventID(const wchar_t* id) noexcept
-				:m_ID(String(id))
+			EventID(const char* id)
+				:m_ID(InternedString(id))
+			{
+			}
+			EventID(const wchar_t* id)
+				:m_ID(InternedString(id))
 			{
 			}
 
@@ -86,6 +91,7 @@ namespace kxf
 			int64_t AsInt() const noexcept;
 			UniversallyUniqueID AsUniqueID() const noexcept;
 			const String& AsString() const noexcept;
+			InternedString AsInternedString() const noexcept;
 
 			bool HasEventClassInfo() const noexcept
 			{
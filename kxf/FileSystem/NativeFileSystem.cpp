@@ -8,6 +8,7 @@
 #include "kxf/System/SystemInformation.h"
 #include "kxf/System/HandlePtr.h"
 #include "kxf/IO/NativeFileStream.h"
+#include "kxf/IO/MappedFileStream.h"
 #include "kxf/Utility/Common.h"
 #include "kxf/Utility/String.h"
 #include "kxf/Utility/ScopeGuard.h"
@@ -17,6 +18,29 @@ namespace
 {
 	using namespace kxf;
 
+	std::shared_ptr<IStream> MakeFileStream(NativeFileStream fileStream, FlagSet<IOStreamAccess> access, FlagSet<IOStreamFlag> streamFlags)
+	{
+		if (streamFlags.Contains(IOStreamFlag::MemoryMapped))
+		{
+			auto mappedStream = std::make_shared<MappedFileStream>(std::move(fileStream), access);
+			if (*mappedStream)
+			{
+				return mappedStream->QueryInterface<IStream>();
+			}
+			return nullptr;
+		}
+		return std::make_shared<NativeFileStream>(std::move(fileStream))->QueryInterface<IStream>();
+	}
+	FlagSet<IOStreamAccess> MapFileStreamAccess(FlagSet<IOStreamAccess> access, FlagSet<IOStreamFlag> streamFlags) noexcept
+	{
+		// A writable mapping requires the file to be readable as well
+		if (streamFlags.Contains(IOStreamFlag::MemoryMapped))
+		{
+			access.Add(IOStreamAccess::Read, access.Contains(IOStreamAccess::Write));
+		}
+		return access;
+	}
+
 	bool OpenFileByID(const StorageVolume& volume,
 					  const UniversallyUniqueID& fileID,
 					  NativeFileStream& fileStream,
@@ -641,7 +665,7 @@ namespace kxf
 		FileSystem::Private::PathResolver pathResolver(*this);
 		return pathResolver.DoWithResolvedPath1(path, [&](const FSPath& path) -> std::shared_ptr<IStream>
 		{
-			NativeFileStream fileStream(path, access, disposition, share, streamFlags);
+			NativeFileStream fileStream(path, MapFileStreamAccess(access, streamFlags), disposition, share, streamFlags);
 			if (!fileStream && flags.Contains(FSActionFlag::CreateDirectoryTree) && fileStream.GetLastNativeError().IsSameAs<Win32Error>(ERROR_PATH_NOT_FOUND))
 			{
 				if (streamFlags.Contains(IOStreamFlag::AllowDirectories))
@@ -653,12 +677,12 @@ namespace kxf
 					CreateDirectory(path.GetParent(), flags.ExtractIfMatches(FSActionFlag::Recursive));
 				}
 
-				fileStream.Open(path, access, disposition, share, streamFlags);
+				fileStream.Open(path, MapFileStreamAccess(access, streamFlags), disposition, share, streamFlags);
 			}
 
 			if (fileStream)
 			{
-				return std::make_shared<NativeFileStream>(std::move(fileStream))->QueryInterface<IStream>();
+				return MakeFileStream(std::move(fileStream), access, streamFlags);
 			}
 			return nullptr;
 		});
@@ -697,9 +721,9 @@ namespace kxf
 		}
 
 		NativeFileStream fileStream;
-		if (OpenFileByID(m_LookupVolume, id, fileStream, access, disposition, share, streamFlags))
+		if (OpenFileByID(m_LookupVolume, id, fileStream, MapFileStreamAccess(access, streamFlags), disposition, share, streamFlags))
 		{
-			return std::make_shared<NativeFileStream>(std::move(fileStream))->QueryInterface<IStream>();
+			return MakeFileStream(std::move(fileStream), access, streamFlags);
 		}
 		return nullptr;
 	}
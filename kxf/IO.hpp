@@ -5,3 +5,6 @@
 #include "kxf/IO/StreamDelegate.h"
 #include "kxf/IO/StreamReaderWriter.h"
 #include "kxf/IO/MemoryStream.h"
+#include "kxf/IO/BufferedStream.h"
+#include "kxf/IO/StreamTransfer.h"
+#include "kxf/IO/LineReader.h"
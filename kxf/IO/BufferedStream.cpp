@@ -0,0 +1,337 @@
+#include "kxf-pch.h"
+#include "BufferedStream.h"
+
+namespace kxf
+{
+	void BufferedInputStream::UpdateLastError()
+	{
+		StreamError lastError = m_Stream->GetLastError();
+
+		// The target stream may have already reached its end, but this one didn't until the buffer is consumed
+		if (lastError == StreamErrorCode::EndOfStream && GetBufferedSize() != 0)
+		{
+			m_LastError = StreamErrorCode::Success;
+		}
+		else
+		{
+			m_LastError = std::move(lastError);
+		}
+	}
+	size_t BufferedInputStream::FillBuffer(size_t minSize)
+	{
+		minSize = std::min(minSize, m_Buffer.size());
+		if (GetBufferedSize() >= minSize)
+		{
+			return GetBufferedSize();
+		}
+
+		// Move the unconsumed data to the front so the rest of the buffer can be filled in one go
+		if (m_BufferPosition != 0)
+		{
+			std::memmove(m_Buffer.data(), m_Buffer.data() + m_BufferPosition, GetBufferedSize());
+			m_BufferEnd -= m_BufferPosition;
+			m_BufferPosition = 0;
+		}
+
+		while (m_BufferEnd < minSize)
+		{
+			const DataSize lastRead = m_Stream->Read(m_Buffer.data() + m_BufferEnd, m_Buffer.size() - m_BufferEnd).LastRead();
+			if (!lastRead.IsPositive())
+			{
+				break;
+			}
+
+			m_BufferEnd += static_cast<size_t>(lastRead.ToBytes());
+			if (m_StreamOffset.IsValid())
+			{
+				m_StreamOffset += lastRead;
+			}
+			if (m_Stream->GetLastError().IsFail())
+			{
+				break;
+			}
+		}
+		UpdateLastError();
+
+		return GetBufferedSize();
+	}
+	DataSize BufferedInputStream::GetStreamOffset() const
+	{
+		if (!m_StreamOffset.IsValid())
+		{
+			m_StreamOffset = m_Stream->TellI();
+		}
+		return m_StreamOffset;
+	}
+
+	BufferedInputStream::BufferedInputStream(std::shared_ptr<IInputStream> stream, size_t bufferSize)
+		:m_Stream(std::move(stream)), m_Buffer(std::max<size_t>(bufferSize, 1))
+	{
+	}
+
+	// IStream
+	void BufferedInputStream::Close()
+	{
+		DropBuffer();
+		m_StreamOffset = {};
+		m_LastRead = {};
+		m_LastError = StreamErrorCode::Success;
+
+		m_Stream->Close();
+	}
+
+	// IInputStream
+	std::optional<uint8_t> BufferedInputStream::Peek()
+	{
+		if (FillBuffer(1) != 0)
+		{
+			return m_Buffer[m_BufferPosition];
+		}
+		return {};
+	}
+	IInputStream& BufferedInputStream::Read(void* buffer, size_t size)
+	{
+		if (!buffer)
+		{
+			m_LastRead = {};
+			m_LastError = StreamErrorCode::ReadError;
+			return *this;
+		}
+
+		// Serve as much as we can from the buffer first
+		uint8_t* destination = static_cast<uint8_t*>(buffer);
+		size_t readTotal = std::min(size, GetBufferedSize());
+		std::memcpy(destination, m_Buffer.data() + m_BufferPosition, readTotal);
+		m_BufferPosition += readTotal;
+		m_LastError = StreamErrorCode::Success;
+
+		if (readTotal < size)
+		{
+			DropBuffer();
+
+			const size_t remaining = size - readTotal;
+			if (remaining >= m_Buffer.size())
+			{
+				// Large reads go directly into the caller's buffer, copying them through ours won't save any calls
+				const DataSize lastRead = m_Stream->Read(destination + readTotal, remaining).LastRead();
+				if (lastRead.IsPositive())
+				{
+					readTotal += static_cast<size_t>(lastRead.ToBytes());
+					if (m_StreamOffset.IsValid())
+					{
+						m_StreamOffset += lastRead;
+					}
+				}
+				UpdateLastError();
+			}
+			else if (FillBuffer(remaining) != 0)
+			{
+				const size_t count = std::min(remaining, GetBufferedSize());
+				std::memcpy(destination + readTotal, m_Buffer.data() + m_BufferPosition, count);
+
+				m_BufferPosition += count;
+				readTotal += count;
+			}
+		}
+
+		m_LastRead = readTotal;
+		return *this;
+	}
+
+	DataSize BufferedInputStream::TellI() const
+	{
+		const DataSize offset = GetStreamOffset();
+		if (offset.IsValid())
+		{
+			return offset.ToBytes() - static_cast<int64_t>(GetBufferedSize());
+		}
+		return offset;
+	}
+	DataSize BufferedInputStream::SeekI(DataSize offset, IOStreamSeek seek)
+	{
+		// Find out how far the new position is from the current one if we can do that without asking the target stream
+		std::optional<int64_t> distance;
+		if (seek == IOStreamSeek::FromCurrent)
+		{
+			distance = offset.ToBytes();
+		}
+		else if (seek == IOStreamSeek::FromStart && m_StreamOffset.IsValid())
+		{
+			distance = offset.ToBytes() - TellI().ToBytes();
+		}
+
+		// Keep the buffer if the new position is still inside it
+		if (distance && *distance >= -static_cast<int64_t>(m_BufferPosition) && *distance <= static_cast<int64_t>(GetBufferedSize()))
+		{
+			m_BufferPosition = static_cast<size_t>(static_cast<int64_t>(m_BufferPosition) + *distance);
+			m_LastError = StreamErrorCode::Success;
+
+			return TellI();
+		}
+
+		// The target stream is ahead of us by the size of the buffered data
+		if (seek == IOStreamSeek::FromCurrent)
+		{
+			offset = offset.ToBytes() - static_cast<int64_t>(GetBufferedSize());
+		}
+
+		DropBuffer();
+		m_StreamOffset = m_Stream->SeekI(offset, seek);
+		m_LastError = m_StreamOffset.IsValid() ? StreamError::Success() : m_Stream->GetLastError();
+
+		return m_StreamOffset;
+	}
+
+	// IDirectInputStream
+	std::span<const uint8_t> BufferedInputStream::GetReadBuffer()
+	{
+		FillBuffer(1);
+		return {m_Buffer.data() + m_BufferPosition, GetBufferedSize()};
+	}
+	size_t BufferedInputStream::Consume(size_t size) noexcept
+	{
+		const size_t count = std::min(size, GetBufferedSize());
+		m_BufferPosition += count;
+
+		return count;
+	}
+
+	// BufferedInputStream
+	std::span<const uint8_t> BufferedInputStream::Peek(size_t size)
+	{
+		FillBuffer(size);
+		return {m_Buffer.data() + m_BufferPosition, std::min(size, GetBufferedSize())};
+	}
+}
+
+namespace kxf
+{
+	BufferedOutputStream::BufferedOutputStream(std::shared_ptr<IOutputStream> stream, size_t bufferSize)
+		:m_Stream(std::move(stream)), m_Buffer(std::max<size_t>(bufferSize, 1))
+	{
+	}
+	BufferedOutputStream::~BufferedOutputStream()
+	{
+		if (m_Stream)
+		{
+			FlushBuffer();
+		}
+	}
+
+	// IStream
+	void BufferedOutputStream::Close()
+	{
+		FlushBuffer();
+		m_LastWrite = {};
+
+		m_Stream->Close();
+	}
+
+	DataSize BufferedOutputStream::GetSize() const
+	{
+		// Pending data can extend the stream past its current size
+		const DataSize size = m_Stream->GetSize();
+		if (m_BufferPosition != 0 && size.IsValid())
+		{
+			return std::max(size, TellO());
+		}
+		return size;
+	}
+
+	// IOutputStream
+	IOutputStream& BufferedOutputStream::Write(const void* buffer, size_t size)
+	{
+		if (!buffer)
+		{
+			m_LastWrite = {};
+			m_LastError = StreamErrorCode::WriteError;
+			return *this;
+		}
+
+		const uint8_t* source = static_cast<const uint8_t*>(buffer);
+		if (size <= m_Buffer.size() - m_BufferPosition)
+		{
+			std::memcpy(m_Buffer.data() + m_BufferPosition, source, size);
+			m_BufferPosition += size;
+
+			m_LastWrite = size;
+			m_LastError = StreamErrorCode::Success;
+			return *this;
+		}
+
+		// Doesn't fit, write out the pending data first
+		if (!FlushBuffer())
+		{
+			m_LastWrite = 0;
+			return *this;
+		}
+
+		if (size >= m_Buffer.size())
+		{
+			// Large writes go directly to the target stream
+			m_LastWrite = m_Stream->Write(source, size).LastWrite();
+			m_LastError = m_Stream->GetLastError();
+		}
+		else
+		{
+			std::memcpy(m_Buffer.data(), source, size);
+			m_BufferPosition = size;
+
+			m_LastWrite = size;
+			m_LastError = StreamErrorCode::Success;
+		}
+		return *this;
+	}
+
+	DataSize BufferedOutputStream::TellO() const
+	{
+		const DataSize offset = m_Stream->TellO();
+		if (offset.IsValid())
+		{
+			return offset.ToBytes() + static_cast<int64_t>(m_BufferPosition);
+		}
+		return offset;
+	}
+	DataSize BufferedOutputStream::SeekO(DataSize offset, IOStreamSeek seek)
+	{
+		// Querying the current position doesn't require writing anything out
+		if (seek == IOStreamSeek::FromCurrent && offset == 0)
+		{
+			return TellO();
+		}
+
+		if (FlushBuffer())
+		{
+			return m_Stream->SeekO(offset, seek);
+		}
+		return {};
+	}
+
+	bool BufferedOutputStream::Flush()
+	{
+		return FlushBuffer() && m_Stream->Flush();
+	}
+	bool BufferedOutputStream::SetAllocationSize(DataSize allocationSize)
+	{
+		return FlushBuffer() && m_Stream->SetAllocationSize(allocationSize);
+	}
+
+	// BufferedOutputStream
+	bool BufferedOutputStream::FlushBuffer()
+	{
+		if (m_BufferPosition != 0)
+		{
+			// The pending data is discarded even if it wasn't written entirely, there is no way to retry it sensibly
+			const bool success = m_Stream->WriteAll(m_Buffer.data(), m_BufferPosition);
+			m_BufferPosition = 0;
+
+			m_LastError = m_Stream->GetLastError();
+			if (!success && m_LastError.IsSuccess())
+			{
+				m_LastError = StreamErrorCode::WriteError;
+			}
+			return success;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,204 @@
+#pragma once
+#include "Common.h"
+#include "IStream.h"
+#include "IDirectStream.h"
+
+namespace kxf
+{
+	class KXF_API BufferedInputStream final: public RTTI::Implementation<BufferedInputStream, IInputStream, IDirectInputStream>
+	{
+		public:
+			static constexpr size_t DefaultBufferSize = DataSize::FromKB(64).ToBytes();
+
+		private:
+			std::shared_ptr<IInputStream> m_Stream;
+			std::vector<uint8_t> m_Buffer;
+
+			// Unconsumed data is in [m_BufferPosition, m_BufferEnd), the target stream is positioned right after 'm_BufferEnd'
+			size_t m_BufferPosition = 0;
+			size_t m_BufferEnd = 0;
+
+			// Cached position of the target stream, so seeking within the buffer doesn't need to query it.
+			// The target stream must not be used directly while it's wrapped, or this will get out of sync.
+			mutable DataSize m_StreamOffset;
+
+			DataSize m_LastRead;
+			StreamError m_LastError = StreamErrorCode::Success;
+
+		private:
+			size_t GetBufferedSize() const noexcept
+			{
+				return m_BufferEnd - m_BufferPosition;
+			}
+			void DropBuffer() noexcept
+			{
+				m_BufferPosition = 0;
+				m_BufferEnd = 0;
+			}
+			void UpdateLastError();
+
+			size_t FillBuffer(size_t minSize);
+			DataSize GetStreamOffset() const;
+
+		public:
+			BufferedInputStream(std::shared_ptr<IInputStream> stream, size_t bufferSize = DefaultBufferSize);
+			BufferedInputStream(IInputStream& stream, size_t bufferSize = DefaultBufferSize)
+				:BufferedInputStream(RTTI::assume_non_owned(stream), bufferSize)
+			{
+			}
+			BufferedInputStream(const BufferedInputStream&) = delete;
+
+		public:
+			// IStream
+			void Close() override;
+
+			StreamError GetLastError() const override
+			{
+				return m_LastError;
+			}
+			void SetLastError(StreamError lastError) override
+			{
+				m_LastError = std::move(lastError);
+			}
+
+			bool IsSeekable() const override
+			{
+				return m_Stream->IsSeekable();
+			}
+			DataSize GetSize() const override
+			{
+				return m_Stream->GetSize();
+			}
+
+			// IInputStream
+			bool CanRead() const override
+			{
+				return GetBufferedSize() != 0 || m_Stream->CanRead();
+			}
+
+			DataSize LastRead() const override
+			{
+				return m_LastRead;
+			}
+			void SetLastRead(DataSize lastRead) override
+			{
+				m_LastRead = lastRead;
+			}
+
+			std::optional<uint8_t> Peek() override;
+			IInputStream& Read(void* buffer, size_t size) override;
+			using IInputStream::Read;
+
+			DataSize TellI() const override;
+			DataSize SeekI(DataSize offset, IOStreamSeek seek) override;
+
+			// IDirectInputStream
+			// Returns all the currently buffered data, refilling the buffer first if it's empty. Use 'Consume'
+			// to advance the stream past the bytes actually used.
+			std::span<const uint8_t> GetReadBuffer() override;
+			size_t Consume(size_t size) noexcept override;
+
+			// BufferedInputStream
+			IInputStream& GetTargetStream() const noexcept
+			{
+				return *m_Stream;
+			}
+			size_t GetBufferSize() const noexcept
+			{
+				return m_Buffer.size();
+			}
+
+			// Returns a view of the next 'size' bytes without consuming them. The view can be shorter if the stream
+			// ends earlier and is never longer than the buffer size. It's valid until the next non-const call.
+			std::span<const uint8_t> Peek(size_t size);
+
+		public:
+			BufferedInputStream& operator=(const BufferedInputStream&) = delete;
+	};
+}
+
+namespace kxf
+{
+	class KXF_API BufferedOutputStream final: public RTTI::Implementation<BufferedOutputStream, IOutputStream>
+	{
+		public:
+			static constexpr size_t DefaultBufferSize = DataSize::FromKB(64).ToBytes();
+
+		private:
+			std::shared_ptr<IOutputStream> m_Stream;
+			std::vector<uint8_t> m_Buffer;
+
+			// Pending data is in [0, m_BufferPosition), it goes into the target stream at its current position
+			size_t m_BufferPosition = 0;
+
+			DataSize m_LastWrite;
+			StreamError m_LastError = StreamErrorCode::Success;
+
+		public:
+			BufferedOutputStream(std::shared_ptr<IOutputStream> stream, size_t bufferSize = DefaultBufferSize);
+			BufferedOutputStream(IOutputStream& stream, size_t bufferSize = DefaultBufferSize)
+				:BufferedOutputStream(RTTI::assume_non_owned(stream), bufferSize)
+			{
+			}
+			BufferedOutputStream(const BufferedOutputStream&) = delete;
+			~BufferedOutputStream();
+
+		public:
+			// IStream
+			void Close() override;
+
+			StreamError GetLastError() const override
+			{
+				return m_LastError;
+			}
+			void SetLastError(StreamError lastError) override
+			{
+				m_LastError = std::move(lastError);
+			}
+
+			bool IsSeekable() const override
+			{
+				return m_Stream->IsSeekable();
+			}
+			DataSize GetSize() const override;
+
+			// IOutputStream
+			DataSize LastWrite() const override
+			{
+				return m_LastWrite;
+			}
+			void SetLastWrite(DataSize lastWrite) override
+			{
+				m_LastWrite = lastWrite;
+			}
+
+			IOutputStream& Write(const void* buffer, size_t size) override;
+			using IOutputStream::Write;
+
+			DataSize TellO() const override;
+			DataSize SeekO(DataSize offset, IOStreamSeek seek) override;
+
+			bool Flush() override;
+			bool SetAllocationSize(DataSize allocationSize) override;
+
+			// BufferedOutputStream
+			IOutputStream& GetTargetStream() const noexcept
+			{
+				return *m_Stream;
+			}
+			size_t GetBufferSize() const noexcept
+			{
+				return m_Buffer.size();
+			}
+			size_t GetPendingSize() const noexcept
+			{
+				return m_BufferPosition;
+			}
+
+			// Writes the pending data into the target stream without flushing the target stream itself
+			bool FlushBuffer();
+
+		public:
+			BufferedOutputStream& operator=(const BufferedOutputStream&) = delete;
+	};
+}
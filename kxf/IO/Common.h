@@ -36,7 +36,10 @@ namespace kxf
 		None = 0,
 
 		Normal = 1 << 0,
-		AllowDirectories = 1 << 1
+		AllowDirectories = 1 << 1,
+
+		// Access the file through a memory mapping ('MappedFileStream') instead of read/write calls
+		MemoryMapped = 1 << 2
 	};
 	kxf_FlagSet_Declare(IOStreamFlag);
 
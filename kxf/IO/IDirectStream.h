@@ -0,0 +1,35 @@
+#pragma once
+#include "Common.h"
+#include "kxf/RTTI/RTTI.h"
+
+namespace kxf
+{
+	// Input stream which can expose its data in place, without copying it into the caller's buffer
+	class KXF_API IDirectInputStream: public RTTI::Interface<IDirectInputStream>
+	{
+		kxf_RTTI_DeclareIID(IDirectInputStream, {0xf933d57a, 0x70e3, 0x4d04, {0xa2, 0x57, 0x89, 0xfc, 0x51, 0x16, 0x3b, 0x58}});
+
+		public:
+			// Returns contiguous data starting at the current position without consuming it. The span can be shorter than
+			// the rest of the stream and is valid until the next non-const call. An empty span means there is no more data,
+			// 'GetLastError' tells the end of the stream from a failure.
+			virtual std::span<const uint8_t> GetReadBuffer() = 0;
+
+			// Advances the stream past 'size' bytes of the data returned by 'GetReadBuffer', returns the actual number of bytes skipped
+			virtual size_t Consume(size_t size) = 0;
+	};
+
+	// Output stream which can provide a buffer to write its data into in place
+	class KXF_API IDirectOutputStream: public RTTI::Interface<IDirectOutputStream>
+	{
+		kxf_RTTI_DeclareIID(IDirectOutputStream, {0x658a1fc1, 0xc5ed, 0x4ff0, {0xb5, 0xba, 0xd1, 0x6e, 0x8c, 0x33, 0x2b, 0x29}});
+
+		public:
+			// Returns a buffer for up to 'size' bytes at the current position. The span can be shorter (or empty) if the
+			// stream can't grow. Nothing is written until 'Commit' is called, the buffer is valid until the next non-const call.
+			virtual std::span<uint8_t> GetWriteBuffer(size_t size) = 0;
+
+			// Makes the first 'size' bytes of the buffer returned by 'GetWriteBuffer' part of the stream and advances past them
+			virtual size_t Commit(size_t size) = 0;
+	};
+}
@@ -1,38 +1,12 @@
 #include "kxf-pch.h"
 #include "IStream.h"
-
-namespace
-{
-	constexpr size_t g_BufferSize = kxf::DataSize::FromKB(64).ToBytes();
-}
+#include "StreamTransfer.h"
 
 namespace kxf
 {
 	IInputStream& IInputStream::Read(IOutputStream& other)
 	{
-		DataSize readTotal = 0;
-		uint8_t buffer[g_BufferSize];
-
-		while (true)
-		{
-			DataSize read = Read(buffer, std::size(buffer)).LastRead();
-			if (!read || read == 0)
-			{
-				break;
-			}
-			else if (other.Write(buffer, read.ToBytes()).LastWrite() != read)
-			{
-				break;
-			}
-
-			readTotal += read;
-			if (GetLastError() == StreamErrorCode::EndOfStream)
-			{
-				break;
-			}
-		}
-		SetLastRead(readTotal);
-
+		SetLastRead(IO::Transfer(*this, other).Transferred);
 		return *this;
 	}
 	bool IInputStream::ReadAll(void* buffer, size_t size)
@@ -54,9 +28,9 @@ namespace kxf
 			// Return successfully if we read exactly the requested number of bytes (normally the ">" case
 			// should never occur and so we could use "==" test, but be safe and avoid overflowing size even
 			// in case of bugs in 'LastRead').
-			if (lastRead >= size)
+			if (lastRead >= size - bufferOffset)
 			{
-				size = 0;
+				bufferOffset = size;
 				break;
 			}
 
@@ -71,7 +45,33 @@ namespace kxf
 		}
 		SetLastRead(readTotal);
 
-		return size == bufferOffset;
+		return bufferOffset == size;
+	}
+	IInputStream& IInputStream::ReadV(std::span<const std::span<std::byte>> buffers)
+	{
+		DataSize readTotal = 0;
+		for (const auto& buffer: buffers)
+		{
+			if (buffer.empty())
+			{
+				continue;
+			}
+
+			const DataSize read = Read(buffer.data(), buffer.size()).LastRead();
+			if (!read.IsValid())
+			{
+				break;
+			}
+
+			readTotal += read;
+			if (read.ToBytes() != static_cast<int64_t>(buffer.size()))
+			{
+				break;
+			}
+		}
+		SetLastRead(readTotal);
+
+		return *this;
 	}
 }
 
@@ -91,16 +91,16 @@ namespace kxf
 
 		while (true)
 		{
-			const DataSize lastWrite = Write(buffer, size).LastWrite();
+			const DataSize lastWrite = Write(static_cast<const uint8_t*>(buffer) + bufferOffset, size - bufferOffset).LastWrite();
 			if (!lastWrite || lastWrite == 0)
 			{
 				break;
 			}
 			writtenTotal += lastWrite;
 
-			if (lastWrite >= size)
+			if (lastWrite >= size - bufferOffset)
 			{
-				size = 0;
+				bufferOffset = size;
 				break;
 			}
 			bufferOffset += lastWrite.ToBytes();
@@ -113,6 +113,32 @@ namespace kxf
 		}
 		SetLastWrite(writtenTotal);
 
-		return size == bufferOffset;
+		return bufferOffset == size;
+	}
+	IOutputStream& IOutputStream::WriteV(std::span<const std::span<const std::byte>> buffers)
+	{
+		DataSize writtenTotal = 0;
+		for (const auto& buffer: buffers)
+		{
+			if (buffer.empty())
+			{
+				continue;
+			}
+
+			const DataSize written = Write(buffer.data(), buffer.size()).LastWrite();
+			if (!written.IsValid())
+			{
+				break;
+			}
+
+			writtenTotal += written;
+			if (written.ToBytes() != static_cast<int64_t>(buffer.size()))
+			{
+				break;
+			}
+		}
+		SetLastWrite(writtenTotal);
+
+		return *this;
 	}
 }
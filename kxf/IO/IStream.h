@@ -60,6 +60,10 @@ namespace kxf
 			virtual IInputStream& Read(IOutputStream& other);
 			virtual bool ReadAll(void* buffer, size_t size);
 
+			// Scatter read: fills the buffers in order and stops at the first one which couldn't be filled entirely.
+			// 'LastRead' is set to the total number of bytes read.
+			virtual IInputStream& ReadV(std::span<const std::span<std::byte>> buffers);
+
 			virtual DataSize TellI() const = 0;
 			virtual DataSize SeekI(DataSize offset, IOStreamSeek seek) = 0;
 			DataSize RewindI()
@@ -86,6 +90,10 @@ namespace kxf
 			virtual IOutputStream& Write(IInputStream& other);
 			virtual bool WriteAll(const void* buffer, size_t size);
 
+			// Gather write: writes the buffers in order as if they were a single contiguous buffer and stops at the
+			// first one which couldn't be written entirely. 'LastWrite' is set to the total number of bytes written.
+			virtual IOutputStream& WriteV(std::span<const std::span<const std::byte>> buffers);
+
 			virtual DataSize TellO() const = 0;
 			virtual DataSize SeekO(DataSize offset, IOStreamSeek seek) = 0;
 			DataSize RewindO()
@@ -0,0 +1,173 @@
+#include "kxf-pch.h"
+#include "LineReader.h"
+#include "kxf/Core/IEncodingConverter.h"
+#include "kxf/Core/Private/StringScan.h"
+
+namespace
+{
+	constexpr size_t npos = std::string_view::npos;
+	constexpr std::string_view g_BOM = "\xEF\xBB\xBF";
+}
+
+namespace kxf::IO
+{
+	size_t LineReader::FillBuffer()
+	{
+		if (m_DirectStream)
+		{
+			// Everything up to the end of the current read buffer has been either returned or copied by now
+			m_DirectStream->Consume(m_Data.size());
+			m_DataOffset += m_Data.size();
+			m_Position = 0;
+
+			const auto buffer = m_DirectStream->GetReadBuffer();
+			m_Data = {reinterpret_cast<const char*>(buffer.data()), buffer.size()};
+
+			return m_Data.size();
+		}
+
+		// Move the unfinished line to the front, the buffer is grown if the line doesn't leave any space for the new data
+		const size_t rest = m_Data.size() - m_Position;
+		if (m_Position != 0 && rest != 0)
+		{
+			std::memmove(m_Buffer.data(), m_Buffer.data() + m_Position, rest);
+		}
+		m_DataOffset += m_Position;
+		m_Position = 0;
+
+		if (rest == m_Buffer.size())
+		{
+			m_Buffer.resize(std::max<size_t>(m_Buffer.size() * 2, DefaultBufferSize));
+		}
+
+		size_t read = 0;
+		if (!m_Stream->GetLastError().IsFail())
+		{
+			if (const DataSize lastRead = m_Stream->Read(m_Buffer.data() + rest, m_Buffer.size() - rest).LastRead(); lastRead.IsPositive())
+			{
+				read = static_cast<size_t>(lastRead.ToBytes());
+			}
+		}
+		m_Data = {m_Buffer.data(), rest + read};
+
+		return read;
+	}
+	bool LineReader::ReadSpanningLine(std::string_view& line)
+	{
+		// The line continues in the next read buffers of the direct stream, so it has to be collected into our own buffer
+		m_LineOffset = m_DataOffset + m_Position;
+		m_Buffer.assign(m_Data.substr(m_Position));
+		m_Position = m_Data.size();
+
+		while (FillBuffer() != 0)
+		{
+			if (const size_t index = Private::FindByte(m_Data, '\n'); index != npos)
+			{
+				m_Buffer.append(m_Data.substr(0, index));
+				m_Position = index + 1;
+
+				line = OnLine(m_Buffer);
+				return true;
+			}
+			m_Buffer.append(m_Data);
+			m_Position = m_Data.size();
+		}
+
+		return OnLastLine(m_Buffer, line);
+	}
+	std::string_view LineReader::OnLine(std::string_view line) noexcept
+	{
+		// The first line is always contiguous by now, so the BOM is removed here even if it's been split between the reads
+		if (m_LineCount == 0 && m_LineOffset == 0 && line.starts_with(g_BOM))
+		{
+			line.remove_prefix(g_BOM.size());
+			m_LineOffset = g_BOM.size();
+		}
+		if (line.ends_with('\r'))
+		{
+			line.remove_suffix(1);
+		}
+		m_LineCount++;
+
+		return line;
+	}
+	bool LineReader::OnLastLine(std::string_view data, std::string_view& line) noexcept
+	{
+		// Text without a line break at the end still has its last line, unless there is nothing but the BOM
+		if (data.empty() || (m_LineCount == 0 && m_LineOffset == 0 && data == g_BOM))
+		{
+			return false;
+		}
+
+		line = OnLine(data);
+		return true;
+	}
+
+	LineReader::LineReader(IInputStream& stream, size_t bufferSize)
+		:m_Stream(&stream), m_DirectStream(stream.QueryInterface<IDirectInputStream>())
+	{
+		if (!m_DirectStream)
+		{
+			m_Buffer.resize(std::max<size_t>(bufferSize, 1));
+		}
+	}
+
+	bool LineReader::ReadLineUTF8(std::string_view& line)
+	{
+		if (m_IsStart)
+		{
+			m_IsStart = false;
+			if (m_Stream)
+			{
+				FillBuffer();
+			}
+		}
+
+		size_t scanFrom = m_Position;
+		while (true)
+		{
+			if (const size_t index = Private::FindByte(m_Data, '\n', scanFrom); index != npos)
+			{
+				m_LineOffset = m_DataOffset + m_Position;
+				line = OnLine(m_Data.substr(m_Position, index - m_Position));
+				m_Position = index + 1;
+
+				return true;
+			}
+			else if (m_DirectStream)
+			{
+				return ReadSpanningLine(line);
+			}
+
+			// Only the new data needs to be scanned after the buffer is refilled
+			const size_t rest = m_Data.size() - m_Position;
+			if (!m_Stream || FillBuffer() == 0)
+			{
+				m_LineOffset = m_DataOffset + m_Position;
+				const std::string_view lastLine = m_Data.substr(m_Position);
+				m_Position = m_Data.size();
+
+				return OnLastLine(lastLine, line);
+			}
+			scanFrom = m_Position + rest;
+		}
+	}
+	bool LineReader::ReadLine(StringView& line)
+	{
+		std::string_view utf8;
+		if (ReadLineUTF8(utf8))
+		{
+			// UTF-16 text never has more code units than its UTF-8 form has bytes
+			if (m_WideBuffer.size() < utf8.size())
+			{
+				m_WideBuffer.resize(utf8.size());
+			}
+
+			const size_t length = EncodingConverter_UTF8.ToWideChar(std::as_bytes(std::span(utf8)), std::span(m_WideBuffer.data(), m_WideBuffer.size()));
+			line = StringView(m_WideBuffer.data(), length);
+
+			return true;
+		}
+		return false;
+	}
+}
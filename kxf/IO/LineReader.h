@@ -0,0 +1,70 @@
+#pragma once
+#include "Common.h"
+#include "IStream.h"
+#include "IDirectStream.h"
+
+namespace kxf::IO
+{
+	// Splits UTF-8 text into lines without converting the whole text first. Both LF and CRLF line breaks are recognized and
+	// aren't included into the lines, a UTF-8 BOM at the start is skipped. The lines are returned as views which are valid
+	// until the next read: either right into the source memory (memory sources and direct streams, like memory and mapped
+	// file streams) or into a buffer reused for all the lines. Reading from a stream reads ahead of the lines returned.
+	class KXF_API LineReader final
+	{
+		public:
+			static constexpr size_t DefaultBufferSize = DataSize::FromKB(64).ToBytes();
+
+		private:
+			IInputStream* m_Stream = nullptr;
+			std::shared_ptr<IDirectInputStream> m_DirectStream;
+
+			// Currently scanned data, either the memory source, the read buffer of the direct stream or the part of 'm_Buffer'
+			// filled from the stream. The offset is the number of source bytes before it.
+			std::string_view m_Data;
+			size_t m_Position = 0;
+			uint64_t m_DataOffset = 0;
+
+			// Read buffer for regular streams, also holds the lines spanning multiple read buffers of the direct streams
+			std::string m_Buffer;
+			std::wstring m_WideBuffer;
+
+			uint64_t m_LineOffset = 0;
+			size_t m_LineCount = 0;
+			bool m_IsStart = true;
+
+		private:
+			size_t FillBuffer();
+			bool ReadSpanningLine(std::string_view& line);
+			std::string_view OnLine(std::string_view line) noexcept;
+			bool OnLastLine(std::string_view data, std::string_view& line) noexcept;
+
+		public:
+			LineReader(IInputStream& stream, size_t bufferSize = DefaultBufferSize);
+			LineReader(std::string_view data) noexcept
+				:m_Data(data)
+			{
+			}
+			LineReader(std::span<const std::byte> data) noexcept
+				:m_Data(reinterpret_cast<const char*>(data.data()), data.size())
+			{
+			}
+			LineReader(const LineReader&) = delete;
+
+		public:
+			bool ReadLineUTF8(std::string_view& line);
+			bool ReadLine(StringView& line);
+
+			// Number of the lines read so far and the offset of the last one from the start of the source (in bytes, including the BOM)
+			size_t GetLineCount() const noexcept
+			{
+				return m_LineCount;
+			}
+			uint64_t GetLineOffset() const noexcept
+			{
+				return m_LineOffset;
+			}
+
+		public:
+			LineReader& operator=(const LineReader&) = delete;
+	};
+}
@@ -0,0 +1,508 @@
+#include "kxf-pch.h"
+#include "MappedFileStream.h"
+
+#include <Windows.h>
+#include "kxf/Win32/UndefMacros.h"
+
+namespace
+{
+	using namespace kxf;
+
+	int64_t GetAllocationGranularity() noexcept
+	{
+		static const int64_t granularity = []()
+		{
+			SYSTEM_INFO info = {};
+			::GetSystemInfo(&info);
+
+			return static_cast<int64_t>(info.dwAllocationGranularity);
+		}();
+		return granularity;
+	}
+
+	// Failed paging I/O on a mapped view (a network share going offline, a removed drive, and so on) is reported
+	// by raising 'EXCEPTION_IN_PAGE_ERROR' on the access instead of failing a call, so every copy must be guarded.
+	bool CopyMappedMemory(void* destination, const void* source, size_t size) noexcept
+	{
+		__try
+		{
+			std::memcpy(destination, source, size);
+			return true;
+		}
+		__except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+		{
+			return false;
+		}
+	}
+}
+
+namespace kxf
+{
+	bool MappedFileStream::DoClose()
+	{
+		if (DoIsOpened())
+		{
+			if (IsWritable() && m_View)
+			{
+				::FlushViewOfFile(m_View, 0);
+			}
+			DoCloseMapping();
+
+			// Drop the space reserved ahead of the writes
+			if (IsWritable())
+			{
+				m_File.SeekO(m_Size, IOStreamSeek::FromStart);
+				m_File.SetAllocationSize(m_Size);
+			}
+			m_File.Close();
+			m_File = {};
+
+			m_AccessMode = {};
+			m_Size = 0;
+			m_Position = 0;
+			m_LastRead = {};
+			m_LastWrite = {};
+			m_LastError = StreamErrorCode::Success;
+
+			return true;
+		}
+		return false;
+	}
+
+	bool MappedFileStream::DoCreateMapping(int64_t size)
+	{
+		DoCloseMapping();
+
+		// Empty files can't be mapped, the mapping will be created on the first write
+		if (size == 0)
+		{
+			return true;
+		}
+
+		// Creating a writable mapping larger than the file extends the file
+		LARGE_INTEGER mappingSize = {};
+		mappingSize.QuadPart = size;
+
+		m_MappingHandle = ::CreateFileMappingW(m_File.GetHandle(), nullptr, IsWritable() ? PAGE_READWRITE : PAGE_READONLY, mappingSize.HighPart, mappingSize.LowPart, nullptr);
+		if (m_MappingHandle)
+		{
+			m_MappingSize = size;
+			return true;
+		}
+		return false;
+	}
+	void MappedFileStream::DoCloseMapping() noexcept
+	{
+		DoUnmapView();
+
+		if (m_MappingHandle)
+		{
+			::CloseHandle(m_MappingHandle);
+			m_MappingHandle = nullptr;
+		}
+		m_MappingSize = 0;
+	}
+	bool MappedFileStream::DoGrow(int64_t size)
+	{
+		// Grow geometrically so a sequence of small appending writes doesn't recreate the mapping every time
+		const int64_t oldSize = m_MappingSize;
+		const int64_t newSize = std::max({size, oldSize + oldSize / 2, GetAllocationGranularity()});
+
+		if (DoCreateMapping(newSize) || DoCreateMapping(size))
+		{
+			return true;
+		}
+
+		DoCreateMapping(oldSize);
+		return false;
+	}
+
+	bool MappedFileStream::DoMapView(int64_t offset, size_t minSize) const
+	{
+		if (m_View && offset >= m_ViewOffset && offset + static_cast<int64_t>(minSize) <= m_ViewOffset + static_cast<int64_t>(m_ViewSize))
+		{
+			return true;
+		}
+		if (!m_MappingHandle || offset < 0 || offset >= m_MappingSize)
+		{
+			return false;
+		}
+		DoUnmapView();
+
+		// Map the whole file if it's small enough, otherwise a window starting at the closest allowed offset before the requested one
+		int64_t viewOffset = 0;
+		int64_t viewSize = m_MappingSize;
+		if (m_MappingSize > static_cast<int64_t>(m_MaxViewSize))
+		{
+			viewOffset = offset - offset % GetAllocationGranularity();
+			viewSize = std::max(static_cast<int64_t>(m_MaxViewSize), offset - viewOffset + static_cast<int64_t>(minSize));
+			viewSize = std::min(viewSize, m_MappingSize - viewOffset);
+		}
+
+		LARGE_INTEGER mapOffset = {};
+		mapOffset.QuadPart = viewOffset;
+
+		void* view = ::MapViewOfFile(m_MappingHandle, IsWritable() ? FILE_MAP_WRITE : FILE_MAP_READ, mapOffset.HighPart, mapOffset.LowPart, static_cast<SIZE_T>(viewSize));
+		if (view)
+		{
+			m_View = static_cast<uint8_t*>(view);
+			m_ViewOffset = viewOffset;
+			m_ViewSize = static_cast<size_t>(viewSize);
+			UpdateStreamBuffer();
+
+			return true;
+		}
+		return false;
+	}
+	void MappedFileStream::DoUnmapView() const noexcept
+	{
+		if (m_View)
+		{
+			::UnmapViewOfFile(m_View);
+
+			m_View = nullptr;
+			m_ViewOffset = 0;
+			m_ViewSize = 0;
+			m_StreamBuffer = {};
+		}
+	}
+	void MappedFileStream::UpdateStreamBuffer() const noexcept
+	{
+		if (m_View)
+		{
+			const auto data = GetMappedData();
+			m_StreamBuffer.AttachStorage(data.data(), data.size());
+			m_StreamBuffer.SetStorageFixed();
+		}
+	}
+
+	size_t MappedFileStream::DoRead(int64_t offset, void* buffer, size_t size) const
+	{
+		size_t readTotal = 0;
+		while (readTotal < size && offset + static_cast<int64_t>(readTotal) < m_Size)
+		{
+			const int64_t current = offset + static_cast<int64_t>(readTotal);
+			if (!DoMapView(current, 1))
+			{
+				break;
+			}
+
+			const size_t viewOffset = static_cast<size_t>(current - m_ViewOffset);
+			const size_t count = static_cast<size_t>(std::min({static_cast<int64_t>(size - readTotal), static_cast<int64_t>(m_ViewSize - viewOffset), m_Size - current}));
+			if (!CopyMappedMemory(static_cast<uint8_t*>(buffer) + readTotal, m_View + viewOffset, count))
+			{
+				break;
+			}
+			readTotal += count;
+		}
+		return readTotal;
+	}
+	size_t MappedFileStream::DoWrite(int64_t offset, const void* buffer, size_t size)
+	{
+		const int64_t end = offset + static_cast<int64_t>(size);
+		if (end > m_MappingSize && !DoGrow(end))
+		{
+			return 0;
+		}
+
+		size_t writtenTotal = 0;
+		while (writtenTotal < size)
+		{
+			const int64_t current = offset + static_cast<int64_t>(writtenTotal);
+			if (!DoMapView(current, 1))
+			{
+				break;
+			}
+
+			const size_t viewOffset = static_cast<size_t>(current - m_ViewOffset);
+			const size_t count = std::min(size - writtenTotal, m_ViewSize - viewOffset);
+			if (!CopyMappedMemory(m_View + viewOffset, static_cast<const uint8_t*>(buffer) + writtenTotal, count))
+			{
+				break;
+			}
+			writtenTotal += count;
+		}
+
+		if (offset + static_cast<int64_t>(writtenTotal) > m_Size)
+		{
+			m_Size = offset + static_cast<int64_t>(writtenTotal);
+			UpdateStreamBuffer();
+		}
+		return writtenTotal;
+	}
+
+	// IInputStream
+	std::optional<uint8_t> MappedFileStream::Peek()
+	{
+		uint8_t value = 0;
+		if (DoRead(m_Position, &value, sizeof(value)) == sizeof(value))
+		{
+			return value;
+		}
+		return {};
+	}
+	IInputStream& MappedFileStream::Read(void* buffer, size_t size)
+	{
+		if (!buffer || !DoIsOpened())
+		{
+			m_LastRead = {};
+			m_LastError = StreamErrorCode::ReadError;
+			return *this;
+		}
+
+		const size_t read = DoRead(m_Position, buffer, size);
+		m_Position += read;
+		m_LastRead = read;
+
+		if (read == size)
+		{
+			m_LastError = StreamErrorCode::Success;
+		}
+		else
+		{
+			m_LastError = m_Position >= m_Size ? StreamErrorCode::EndOfStream : StreamErrorCode::ReadError;
+		}
+		return *this;
+	}
+
+	DataSize MappedFileStream::SeekI(DataSize offset, IOStreamSeek seek)
+	{
+		if (DoIsOpened())
+		{
+			int64_t position = -1;
+			switch (seek)
+			{
+				case IOStreamSeek::FromStart:
+				{
+					position = offset.ToBytes();
+					break;
+				}
+				case IOStreamSeek::FromCurrent:
+				{
+					position = m_Position + offset.ToBytes();
+					break;
+				}
+				case IOStreamSeek::FromEnd:
+				{
+					position = m_Size + offset.ToBytes();
+					break;
+				}
+			};
+
+			// Seeking past the end is allowed, the gap is filled with zeros on the next write
+			if (position >= 0)
+			{
+				m_Position = position;
+				m_LastError = StreamErrorCode::Success;
+
+				return m_Position;
+			}
+		}
+
+		m_LastError = StreamError::Fail();
+		return {};
+	}
+
+	// IOutputStream
+	IOutputStream& MappedFileStream::Write(const void* buffer, size_t size)
+	{
+		if (!IsWritable())
+		{
+			m_LastWrite = 0;
+			m_LastError = StreamErrorCode::ReadOnly;
+			return *this;
+		}
+		if (!buffer || !DoIsOpened())
+		{
+			m_LastWrite = {};
+			m_LastError = StreamErrorCode::WriteError;
+			return *this;
+		}
+
+		const size_t written = DoWrite(m_Position, buffer, size);
+		m_Position += written;
+		m_LastWrite = written;
+		m_LastError = written == size ? StreamErrorCode::Success : StreamErrorCode::WriteError;
+
+		return *this;
+	}
+
+	bool MappedFileStream::Flush()
+	{
+		if (IsWritable() && m_View)
+		{
+			if (!::FlushViewOfFile(m_View, 0))
+			{
+				m_LastError = StreamErrorCode::WriteError;
+				return false;
+			}
+		}
+		return DoIsOpened() && m_File.Flush();
+	}
+	bool MappedFileStream::SetAllocationSize(DataSize allocationSize)
+	{
+		if (!IsWritable())
+		{
+			m_LastError = StreamErrorCode::ReadOnly;
+			return false;
+		}
+		if (!DoIsOpened() || allocationSize.IsNegative())
+		{
+			m_LastError = StreamError::Fail();
+			return false;
+		}
+
+		// A file can't be truncated while it's mapped, so close the mapping and recreate it for the new size.
+		// Growing it this way also means the following writes up to that size won't need to remap anything.
+		const int64_t size = allocationSize.ToBytes();
+		DoCloseMapping();
+
+		m_File.SeekO(size, IOStreamSeek::FromStart);
+		const bool resized = m_File.SetAllocationSize(size);
+		if (resized)
+		{
+			m_Size = size;
+		}
+
+		if (DoCreateMapping(resized ? size : m_Size) && resized)
+		{
+			m_LastError = StreamErrorCode::Success;
+			return true;
+		}
+		m_LastError = StreamError::Fail();
+		return false;
+	}
+
+	// IMemoryStream
+	MemoryStreamBuffer MappedFileStream::DetachStreamBuffer()
+	{
+		// The mapping can't outlive the stream, so the detached buffer owns a copy of the entire stream
+		MemoryStreamBuffer streamBuffer;
+		if (DoIsOpened())
+		{
+			streamBuffer.CreateStorage(static_cast<size_t>(m_Size));
+			streamBuffer.ResizeStorage(DoRead(0, streamBuffer.GetBufferStart(), static_cast<size_t>(m_Size)));
+		}
+		DoClose();
+
+		return streamBuffer;
+	}
+	void MappedFileStream::AttachStreamBuffer(MemoryStreamBuffer streamBuffer)
+	{
+		// Replaces the stream content with the content of the buffer
+		const size_t size = streamBuffer.GetBufferSize();
+		if (SetAllocationSize(size))
+		{
+			m_Position = 0;
+			if (DoWrite(0, streamBuffer.GetBufferStart(), size) != size)
+			{
+				m_LastError = StreamErrorCode::WriteError;
+			}
+		}
+	}
+
+	size_t MappedFileStream::CopyToBuffer(void* buffer, size_t size) const
+	{
+		return buffer ? DoRead(0, buffer, size) : 0;
+	}
+
+	// IDirectInputStream
+	std::span<const uint8_t> MappedFileStream::GetReadBuffer()
+	{
+		if (DoIsOpened() && m_Position < m_Size && DoMapView(m_Position, 1))
+		{
+			const size_t viewOffset = static_cast<size_t>(m_Position - m_ViewOffset);
+			const size_t count = static_cast<size_t>(std::min(static_cast<int64_t>(m_ViewSize - viewOffset), m_Size - m_Position));
+
+			m_LastError = StreamErrorCode::Success;
+			return {m_View + viewOffset, count};
+		}
+
+		// An empty span is the end of the stream only when the position is there, otherwise the view couldn't be mapped
+		m_LastError = DoIsOpened() && m_Position >= m_Size ? StreamErrorCode::EndOfStream : StreamErrorCode::ReadError;
+		return {};
+	}
+	size_t MappedFileStream::Consume(size_t size)
+	{
+		const size_t count = static_cast<size_t>(std::clamp<int64_t>(m_Size - m_Position, 0, static_cast<int64_t>(size)));
+		m_Position += count;
+
+		return count;
+	}
+
+	// MappedFileStream
+	bool MappedFileStream::Open(const FSPath& path, FlagSet<IOStreamAccess> access, IOStreamDisposition disposition, FlagSet<IOStreamShare> share, FlagSet<IOStreamFlag> flags)
+	{
+		// A writable mapping requires the file to be readable as well
+		FlagSet<IOStreamAccess> fileAccess = access;
+		fileAccess.Add(IOStreamAccess::Read, access.Contains(IOStreamAccess::Write));
+
+		return Open(NativeFileStream(path, fileAccess, disposition, share, flags), access);
+	}
+	bool MappedFileStream::Open(NativeFileStream fileStream, FlagSet<IOStreamAccess> access)
+	{
+		DoClose();
+
+		if (fileStream)
+		{
+			const DataSize size = fileStream.GetSize();
+			if (size.IsValid())
+			{
+				m_File = std::move(fileStream);
+				m_AccessMode = access;
+				m_Size = size.ToBytes();
+				m_Position = 0;
+
+				if (DoCreateMapping(m_Size))
+				{
+					m_LastError = StreamErrorCode::Success;
+					return true;
+				}
+
+				m_File = {};
+				m_AccessMode = {};
+				m_Size = 0;
+			}
+		}
+
+		m_LastError = StreamError::Fail();
+		return false;
+	}
+
+	std::span<const uint8_t> MappedFileStream::MapData(DataSize offset, size_t size)
+	{
+		const int64_t start = offset.ToBytes();
+		if (start >= 0 && start < m_Size)
+		{
+			size = static_cast<size_t>(std::min(static_cast<int64_t>(size), m_Size - start));
+			if (DoMapView(start, size))
+			{
+				return {m_View + (start - m_ViewOffset), size};
+			}
+		}
+		return {};
+	}
+	std::span<uint8_t> MappedFileStream::MapWritableData(DataSize offset, size_t size)
+	{
+		const int64_t start = offset.ToBytes();
+		if (IsWritable() && start >= 0 && size != 0)
+		{
+			const int64_t end = start + static_cast<int64_t>(size);
+			if (end > m_MappingSize && !DoGrow(end))
+			{
+				return {};
+			}
+
+			if (DoMapView(start, size))
+			{
+				if (end > m_Size)
+				{
+					m_Size = end;
+					UpdateStreamBuffer();
+				}
+				return {m_View + (start - m_ViewOffset), size};
+			}
+		}
+		return {};
+	}
+}
@@ -0,0 +1,231 @@
+#pragma once
+#include "Common.h"
+#include "kxf/IO/IStream.h"
+#include "kxf/IO/IMemoryStream.h"
+#include "kxf/IO/IDirectStream.h"
+#include "kxf/IO/IStreamOnFileSystem.h"
+#include "kxf/IO/MemoryStreamBuffer.h"
+#include "kxf/IO/NativeFileStream.h"
+
+namespace kxf
+{
+	class KXF_API MappedFileStream final: public RTTI::Implementation<MappedFileStream, IInputStream, IOutputStream, IMemoryStream, IStreamOnFileSystem, IDirectInputStream>
+	{
+		public:
+			// Files up to this size are mapped entirely, larger ones are accessed through a sliding view of this size
+			static constexpr size_t DefaultViewSize = sizeof(void*) >= 8 ? DataSize::FromGB(1).ToBytes() : DataSize::FromMB(64).ToBytes();
+
+		private:
+			NativeFileStream m_File;
+			void* m_MappingHandle = nullptr;
+			FlagSet<IOStreamAccess> m_AccessMode;
+			size_t m_MaxViewSize = DefaultViewSize;
+
+			// Logical size of the stream and the size of the file mapping, which is larger when
+			// the file has been grown ahead of the writes. The file is truncated back on close.
+			int64_t m_Size = 0;
+			int64_t m_MappingSize = 0;
+			int64_t m_Position = 0;
+
+			// Currently mapped view, it's moved lazily as the stream is accessed. The memory stream buffer
+			// is always attached to the part of the view which is inside the logical size of the stream.
+			mutable uint8_t* m_View = nullptr;
+			mutable int64_t m_ViewOffset = 0;
+			mutable size_t m_ViewSize = 0;
+			mutable MemoryStreamBuffer m_StreamBuffer;
+
+			DataSize m_LastRead;
+			DataSize m_LastWrite;
+			StreamError m_LastError = StreamErrorCode::Success;
+
+		private:
+			bool IsWritable() const noexcept
+			{
+				return m_AccessMode.Contains(IOStreamAccess::Write);
+			}
+			bool DoIsOpened() const noexcept
+			{
+				return m_File.GetHandle() != nullptr;
+			}
+			bool DoClose();
+
+			bool DoCreateMapping(int64_t size);
+			void DoCloseMapping() noexcept;
+			bool DoGrow(int64_t size);
+
+			bool DoMapView(int64_t offset, size_t minSize) const;
+			void DoUnmapView() const noexcept;
+			void UpdateStreamBuffer() const noexcept;
+
+			size_t DoRead(int64_t offset, void* buffer, size_t size) const;
+			size_t DoWrite(int64_t offset, const void* buffer, size_t size);
+
+		public:
+			MappedFileStream() noexcept = default;
+			MappedFileStream(const FSPath& path,
+							 FlagSet<IOStreamAccess> access,
+							 IOStreamDisposition disposition,
+							 FlagSet<IOStreamShare> share,
+							 FlagSet<IOStreamFlag> flags = IOStreamFlag::None
+			)
+			{
+				Open(path, access, disposition, share, flags);
+			}
+			MappedFileStream(NativeFileStream fileStream, FlagSet<IOStreamAccess> access)
+			{
+				Open(std::move(fileStream), access);
+			}
+			MappedFileStream(const MappedFileStream&) = delete;
+			~MappedFileStream()
+			{
+				DoClose();
+			}
+
+		public:
+			// IStream
+			void Close() override
+			{
+				DoClose();
+			}
+
+			StreamError GetLastError() const override
+			{
+				return m_LastError;
+			}
+			void SetLastError(StreamError lastError) override
+			{
+				m_LastError = std::move(lastError);
+			}
+
+			bool IsSeekable() const override
+			{
+				return true;
+			}
+			DataSize GetSize() const override
+			{
+				return DoIsOpened() ? DataSize(m_Size) : DataSize();
+			}
+
+			// IInputStream
+			bool CanRead() const override
+			{
+				return DoIsOpened() && m_Position < m_Size;
+			}
+
+			DataSize LastRead() const override
+			{
+				return m_LastRead;
+			}
+			void SetLastRead(DataSize lastRead) override
+			{
+				m_LastRead = lastRead;
+			}
+
+			std::optional<uint8_t> Peek() override;
+			IInputStream& Read(void* buffer, size_t size) override;
+			using IInputStream::Read;
+
+			DataSize TellI() const override
+			{
+				return DoIsOpened() ? DataSize(m_Position) : DataSize();
+			}
+			DataSize SeekI(DataSize offset, IOStreamSeek seek) override;
+
+			// IOutputStream
+			DataSize LastWrite() const override
+			{
+				return m_LastWrite;
+			}
+			void SetLastWrite(DataSize lastWrite) override
+			{
+				m_LastWrite = lastWrite;
+			}
+
+			IOutputStream& Write(const void* buffer, size_t size) override;
+			using IOutputStream::Write;
+
+			DataSize TellO() const override
+			{
+				return TellI();
+			}
+			DataSize SeekO(DataSize offset, IOStreamSeek seek) override
+			{
+				return SeekI(offset, seek);
+			}
+
+			bool Flush() override;
+			bool SetAllocationSize(DataSize allocationSize) override;
+
+			// IMemoryStream
+			MemoryStreamBuffer DetachStreamBuffer() override;
+			void AttachStreamBuffer(MemoryStreamBuffer streamBuffer) override;
+
+			MemoryStreamBuffer& GetStreamBuffer() override
+			{
+				return m_StreamBuffer;
+			}
+			const MemoryStreamBuffer& GetStreamBuffer() const override
+			{
+				return m_StreamBuffer;
+			}
+
+			size_t CopyToBuffer(void* buffer, size_t size) const override;
+
+			// IStreamOnFileSystem
+			FSPath GetFilePath() const override
+			{
+				return m_File.GetFilePath();
+			}
+			UniversallyUniqueID GetFileUniqueID() const override
+			{
+				return m_File.GetFileUniqueID();
+			}
+
+			// IDirectInputStream
+			// Exposes the current view, the same caveats as for 'MapData' apply.
+			std::span<const uint8_t> GetReadBuffer() override;
+			size_t Consume(size_t size) override;
+
+			// MappedFileStream
+			bool Open(const FSPath& path,
+					  FlagSet<IOStreamAccess> access,
+					  IOStreamDisposition disposition,
+					  FlagSet<IOStreamShare> share,
+					  FlagSet<IOStreamFlag> flags = IOStreamFlag::None
+			);
+			bool Open(NativeFileStream fileStream, FlagSet<IOStreamAccess> access);
+
+			size_t GetMaxViewSize() const noexcept
+			{
+				return m_MaxViewSize;
+			}
+			void SetMaxViewSize(size_t size) noexcept
+			{
+				m_MaxViewSize = std::max<size_t>(size, 1);
+			}
+
+			// Direct access to the mapped data. The returned span covers up to 'size' bytes starting at 'offset' (fewer
+			// if the stream ends earlier) and stays valid until the next call which can move the view, that is any read,
+			// write, 'Map*' or resize call. The writable variant extends the stream if the range goes past its end.
+			std::span<const uint8_t> MapData(DataSize offset, size_t size);
+			std::span<uint8_t> MapWritableData(DataSize offset, size_t size);
+
+			// The part of the currently mapped view which is inside the stream
+			std::span<const uint8_t> GetMappedData() const noexcept
+			{
+				return {m_View, static_cast<size_t>(std::clamp<int64_t>(m_Size - m_ViewOffset, 0, static_cast<int64_t>(m_ViewSize)))};
+			}
+
+		public:
+			explicit operator bool() const
+			{
+				return DoIsOpened();
+			}
+			bool operator!() const
+			{
+				return !DoIsOpened();
+			}
+
+			MappedFileStream& operator=(const MappedFileStream&) = delete;
+	};
+}
@@ -13,13 +13,106 @@ namespace kxf
 		:m_StreamBuffer(std::move(stream.GetStreamBuffer()))
 	{
 	}
+
+	// IInputStream
+	IInputStream& MemoryInputStream::ReadV(std::span<const std::span<std::byte>> buffers) noexcept
+	{
+		size_t readTotal = 0;
+		for (const auto& buffer: buffers)
+		{
+			const size_t read = m_StreamBuffer.Read(buffer.data(), buffer.size());
+			readTotal += read;
+
+			if (read != buffer.size())
+			{
+				break;
+			}
+		}
+
+		m_LastRead = readTotal;
+		return *this;
+	}
 }
 
 namespace kxf
 {
+	// IOutputStream
+	IOutputStream& MemoryOutputStream::WriteV(std::span<const std::span<const std::byte>> buffers)
+	{
+		// Grow the storage once for all the buffers
+		size_t totalSize = 0;
+		for (const auto& buffer: buffers)
+		{
+			totalSize += buffer.size();
+		}
+		if (totalSize > m_StreamBuffer.GetBytesLeft())
+		{
+			m_StreamBuffer.ReserveStorage(m_StreamBuffer.Tell() + totalSize);
+		}
+
+		size_t writtenTotal = 0;
+		for (const auto& buffer: buffers)
+		{
+			const size_t written = m_StreamBuffer.Write(buffer.data(), buffer.size());
+			writtenTotal += written;
+
+			if (written != buffer.size())
+			{
+				break;
+			}
+		}
+
+		m_LastWrite = writtenTotal;
+		return *this;
+	}
+
 	// IReadableOutputStream
 	std::shared_ptr<IInputStream> MemoryOutputStream::CreateInputStream() const
 	{
 		return std::make_shared<MemoryInputStream>(m_StreamBuffer.GetBufferStart(), m_StreamBuffer.GetBufferEnd());
 	}
+
+	// IDirectOutputStream
+	std::span<uint8_t> MemoryOutputStream::GetWriteBuffer(size_t size)
+	{
+		if (size > m_StreamBuffer.GetBytesLeft())
+		{
+			// Extend the buffer temporarily, it's trimmed back to what was actually written on commit
+			const size_t currentSize = m_StreamBuffer.GetBufferSize();
+			if (m_StreamBuffer.ResizeStorage(m_StreamBuffer.Tell() + size) && !m_UncommittedSize)
+			{
+				m_UncommittedSize = currentSize;
+			}
+		}
+
+		if (!m_StreamBuffer.IsNull())
+		{
+			return {static_cast<uint8_t*>(m_StreamBuffer.GetBufferCurrent()), std::min(size, m_StreamBuffer.GetBytesLeft())};
+		}
+		return {};
+	}
+	size_t MemoryOutputStream::Commit(size_t size)
+	{
+		const size_t count = std::min(size, m_StreamBuffer.GetBytesLeft());
+		m_StreamBuffer.Seek(static_cast<intptr_t>(count), IOStreamSeek::FromCurrent);
+
+		if (m_UncommittedSize)
+		{
+			const size_t position = m_StreamBuffer.Tell();
+			if (position < *m_UncommittedSize)
+			{
+				m_StreamBuffer.ResizeStorage(*m_UncommittedSize);
+			}
+			else
+			{
+				m_StreamBuffer.TruncateStorage();
+			}
+			m_StreamBuffer.Seek(static_cast<intptr_t>(position), IOStreamSeek::FromStart);
+			m_UncommittedSize = {};
+		}
+
+		m_LastWrite = count;
+		m_LastError = StreamErrorCode::Success;
+		return count;
+	}
 }
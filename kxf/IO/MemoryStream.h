@@ -2,6 +2,7 @@
 #include "Common.h"
 #include "IStream.h"
 #include "IMemoryStream.h"
+#include "IDirectStream.h"
 #include "MemoryStreamBuffer.h"
 
 namespace kxf
@@ -12,7 +13,7 @@ namespace kxf
 
 namespace kxf
 {
-	class KXF_API MemoryInputStream final: public RTTI::Implementation<MemoryInputStream, IInputStream, IMemoryStream>
+	class KXF_API MemoryInputStream final: public RTTI::Implementation<MemoryInputStream, IInputStream, IMemoryStream, IDirectInputStream>
 	{
 		private:
 			MemoryStreamBuffer m_StreamBuffer;
@@ -118,6 +119,7 @@ namespace kxf
 				m_LastRead = m_StreamBuffer.Read(buffer, size);
 				return *this;
 			}
+			IInputStream& ReadV(std::span<const std::span<std::byte>> buffers) noexcept override;
 			using IInputStream::Read;
 
 			DataSize TellI() const noexcept override
@@ -157,6 +159,23 @@ namespace kxf
 				return effectiveSize;
 			}
 
+			// IDirectInputStream
+			std::span<const uint8_t> GetReadBuffer() noexcept override
+			{
+				if (!m_StreamBuffer.IsNull())
+				{
+					return {static_cast<const uint8_t*>(m_StreamBuffer.GetBufferCurrent()), m_StreamBuffer.GetBytesLeft()};
+				}
+				return {};
+			}
+			size_t Consume(size_t size) noexcept override
+			{
+				const size_t count = std::min(size, m_StreamBuffer.GetBytesLeft());
+				m_StreamBuffer.Seek(static_cast<intptr_t>(count), IOStreamSeek::FromCurrent);
+
+				return count;
+			}
+
 		public:
 			MemoryInputStream& operator=(const MemoryInputStream&) = delete;
 			MemoryInputStream& operator=(MemoryInputStream&& other) noexcept
@@ -172,18 +191,22 @@ namespace kxf
 
 namespace kxf
 {
-	class KXF_API MemoryOutputStream final: public RTTI::Implementation<MemoryInputStream, IOutputStream, IMemoryStream, IReadableOutputStream>
+	class KXF_API MemoryOutputStream final: public RTTI::Implementation<MemoryInputStream, IOutputStream, IMemoryStream, IReadableOutputStream, IDirectOutputStream>
 	{
 		private:
 			MemoryStreamBuffer m_StreamBuffer;
 			DataSize m_LastWrite;
 			StreamError m_LastError = StreamErrorCode::Success;
 
+			// Size of the buffer before it was extended by 'GetWriteBuffer', the unused part is trimmed on 'Commit'
+			std::optional<size_t> m_UncommittedSize;
+
 		private:
 			void ResetState(StreamErrorCode errorCode = StreamErrorCode::Success)
 			{
 				m_LastWrite = {};
 				m_LastError = errorCode;
+				m_UncommittedSize = {};
 				m_StreamBuffer.Rewind();
 			}
 
@@ -222,6 +245,7 @@ namespace kxf
 				m_StreamBuffer = {};
 				m_LastWrite = {};
 				m_LastError = StreamErrorCode::Success;
+				m_UncommittedSize = {};
 			}
 
 			StreamError GetLastError() const noexcept override
@@ -257,6 +281,7 @@ namespace kxf
 				m_LastWrite = m_StreamBuffer.Write(buffer, size);
 				return *this;
 			}
+			IOutputStream& WriteV(std::span<const std::span<const std::byte>> buffers) override;
 			using IOutputStream::Write;
 
 			DataSize TellO() const noexcept override
@@ -308,6 +333,10 @@ namespace kxf
 			// IReadableOutputStream
 			std::shared_ptr<IInputStream> CreateInputStream() const override;
 
+			// IDirectOutputStream
+			std::span<uint8_t> GetWriteBuffer(size_t size) override;
+			size_t Commit(size_t size) override;
+
 		public:
 			MemoryOutputStream& operator=(const MemoryOutputStream&) = delete;
 			MemoryOutputStream& operator=(MemoryOutputStream&& other) noexcept
@@ -315,6 +344,7 @@ namespace kxf
 				m_StreamBuffer = std::move(other.m_StreamBuffer);
 				m_LastWrite = std::move(other.m_LastWrite);
 				m_LastError = std::move(other.m_LastError);
+				m_UncommittedSize = std::exchange(other.m_UncommittedSize, std::nullopt);
 
 				return *this;
 			}
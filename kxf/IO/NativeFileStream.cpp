@@ -11,6 +11,10 @@ namespace
 {
 	using namespace kxf;
 
+	// 'ReadFileScatter' and 'WriteFileGather' only work with unbuffered overlapped handles and page-sized buffers,
+	// so vectored I/O on regular handles is done by coalescing small buffers into chunks of this size instead.
+	constexpr size_t g_VectoredChunkSize = DataSize::FromKB(16).ToBytes();
+
 	int64_t SeekByHandle(HANDLE handle, DataSize offset, IOStreamSeek seekMode) noexcept
 	{
 		DWORD seekModeWin = std::numeric_limits<DWORD>::max();
@@ -223,6 +227,79 @@ namespace kxf
 		return *this;
 	}
 
+	IInputStream& NativeFileStream::ReadV(std::span<const std::span<std::byte>> buffers)
+	{
+		uint8_t chunk[g_VectoredChunkSize];
+		size_t readTotal = 0;
+		size_t requestedTotal = 0;
+		bool success = true;
+
+		auto DoRead = [&](void* buffer, size_t size)
+		{
+			// A single call can't read more than a DWORD can hold, so larger buffers are read in parts
+			size_t read = 0;
+			do
+			{
+				const DWORD portion = static_cast<DWORD>(std::min<size_t>(size - read, std::numeric_limits<DWORD>::max()));
+
+				DWORD lastRead = 0;
+				if (!::ReadFile(m_Handle, static_cast<uint8_t*>(buffer) + read, portion, &lastRead, nullptr))
+				{
+					m_LastError = Win32Error::GetLastError();
+				}
+
+				read += lastRead;
+				success = lastRead == portion;
+			}
+			while (success && read < size);
+
+			requestedTotal += size;
+			readTotal += read;
+			return read;
+		};
+
+		m_LastError = Win32Error::Success();
+		for (size_t i = 0; i < buffers.size() && success;)
+		{
+			if (buffers[i].size() >= std::size(chunk))
+			{
+				// Large buffers are read into directly
+				DoRead(buffers[i].data(), buffers[i].size());
+				i++;
+			}
+			else
+			{
+				// Read as many consecutive small buffers as fit into the chunk with a single call and scatter them
+				size_t groupEnd = i;
+				size_t groupSize = 0;
+				while (groupEnd < buffers.size() && groupSize + buffers[groupEnd].size() <= std::size(chunk))
+				{
+					groupSize += buffers[groupEnd].size();
+					groupEnd++;
+				}
+
+				const size_t lastRead = groupSize != 0 ? DoRead(chunk, groupSize) : 0;
+
+				size_t chunkOffset = 0;
+				for (; i < groupEnd && chunkOffset < lastRead; i++)
+				{
+					const size_t count = std::min<size_t>(buffers[i].size(), lastRead - chunkOffset);
+					std::memcpy(buffers[i].data(), chunk + chunkOffset, count);
+					chunkOffset += count;
+				}
+				i = groupEnd;
+			}
+		}
+		if (!success && m_LastError.IsSuccess())
+		{
+			m_LastError = ERROR_HANDLE_EOF;
+		}
+
+		m_LastRead = readTotal;
+		m_StreamOffset = GetOffsetByHandle(m_Handle);
+		return *this;
+	}
+
 	DataSize NativeFileStream::TellI() const
 	{
 		return GetOffsetByHandle(m_Handle);
@@ -258,6 +335,84 @@ namespace kxf
 		}
 		return *this;
 	}
+	IOutputStream& NativeFileStream::WriteV(std::span<const std::span<const std::byte>> buffers)
+	{
+		uint8_t chunk[g_VectoredChunkSize];
+		size_t chunkSize = 0;
+		size_t writtenTotal = 0;
+		bool success = true;
+
+		auto DoWrite = [&](const void* buffer, size_t size)
+		{
+			// Same as for reading, a single call can't write more than a DWORD can hold
+			size_t written = 0;
+			do
+			{
+				const DWORD portion = static_cast<DWORD>(std::min<size_t>(size - written, std::numeric_limits<DWORD>::max()));
+
+				DWORD lastWrite = 0;
+				success = ::WriteFile(m_Handle, static_cast<const uint8_t*>(buffer) + written, portion, &lastWrite, nullptr);
+				if (!success)
+				{
+					m_LastError = Win32Error::GetLastError();
+				}
+
+				written += lastWrite;
+				success = success && lastWrite == portion;
+			}
+			while (success && written < size);
+
+			writtenTotal += written;
+			return success;
+		};
+		auto FlushChunk = [&]()
+		{
+			if (chunkSize != 0)
+			{
+				DoWrite(chunk, chunkSize);
+				chunkSize = 0;
+			}
+			return success;
+		};
+
+		m_LastError = Win32Error::Success();
+		for (const auto& buffer: buffers)
+		{
+			if (buffer.size() > std::size(chunk) - chunkSize)
+			{
+				if (!FlushChunk())
+				{
+					break;
+				}
+
+				// Large buffers are written directly
+				if (buffer.size() >= std::size(chunk))
+				{
+					if (!DoWrite(buffer.data(), buffer.size()))
+					{
+						break;
+					}
+					continue;
+				}
+			}
+
+			std::memcpy(chunk + chunkSize, buffer.data(), buffer.size());
+			chunkSize += buffer.size();
+		}
+		if (success)
+		{
+			FlushChunk();
+		}
+		if (!success && m_LastError.IsSuccess())
+		{
+			m_LastError = ERROR_WRITE_FAULT;
+		}
+
+		m_LastWrite = writtenTotal;
+		m_StreamOffset = GetOffsetByHandle(m_Handle);
+		return *this;
+	}
+
 	DataSize NativeFileStream::TellO() const
 	{
 		return GetOffsetByHandle(m_Handle);
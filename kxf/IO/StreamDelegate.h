@@ -140,8 +140,8 @@ namespace kxf
 			}
 			IInputStream& Read(IOutputStream& other) override
 			{
-				m_Stream->Read(other);
-				return *this;
+				// Go through our own 'Read' so derived streams transforming the data (like decompressors) are used
+				return IInputStream::Read(other);
 			}
 			bool ReadAll(void* buffer, size_t size) override
 			{
@@ -192,8 +192,7 @@ namespace kxf
 			}
 			IOutputStream& Write(IInputStream& other) override
 			{
-				m_Stream->Write(other);
-				return *this;
+				return IOutputStream::Write(other);
 			}
 			bool WriteAll(const void* buffer, size_t size) override
 			{
@@ -79,6 +79,15 @@ namespace kxf::IO
 			{
 				return m_Stream.ReadAll(buffer, size);
 			}
+			bool ReadBuffers(std::span<const std::span<std::byte>> buffers)
+			{
+				size_t size = 0;
+				for (const auto& buffer: buffers)
+				{
+					size += buffer.size();
+				}
+				return m_Stream.ReadV(buffers).LastRead() == size;
+			}
 			
 			template<class T>
 			bool ReadObject(T& object)
@@ -87,6 +96,17 @@ namespace kxf::IO
 
 				return ReadBuffer(std::addressof(object), sizeof(object));
 			}
+
+			// Reads all the objects with a single vectored read
+			template<class... T>
+			bool ReadObjects(T&... objects)
+			{
+				static_assert(sizeof...(T) != 0, "InputStreamReader::ReadObjects: at least one object is required");
+				static_assert((std::is_trivially_copyable_v<T> && ...), "T must be trivially copyable");
+
+				const std::span<std::byte> buffers[] = {std::as_writable_bytes(std::span<T, 1>(std::addressof(objects), 1))...};
+				return ReadBuffers(buffers);
+			}
 			
 			template<class T>
 			T ReadObject()
@@ -269,6 +289,15 @@ namespace kxf::IO
 			{
 				return m_Stream.WriteAll(buffer, size);
 			}
+			bool WriteBuffers(std::span<const std::span<const std::byte>> buffers)
+			{
+				size_t size = 0;
+				for (const auto& buffer: buffers)
+				{
+					size += buffer.size();
+				}
+				return m_Stream.WriteV(buffers).LastWrite() == size;
+			}
 
 			template<class T>
 			bool WriteObject(const T& object)
@@ -277,6 +306,17 @@ namespace kxf::IO
 
 				return WriteBuffer(std::addressof(object), sizeof(T));
 			}
+
+			// Writes all the objects with a single vectored write
+			template<class... T>
+			bool WriteObjects(const T&... objects)
+			{
+				static_assert(sizeof...(T) != 0, "OutputStreamWriter::WriteObjects: at least one object is required");
+				static_assert((std::is_trivially_copyable_v<T> && ...), "T must be trivially copyable");
+
+				const std::span<const std::byte> buffers[] = {std::as_bytes(std::span<const T, 1>(std::addressof(objects), 1))...};
+				return WriteBuffers(buffers);
+			}
 			
 			template<class T, size_t count>
 			bool WriteArray(const std::array<T, count>& values)
@@ -0,0 +1,174 @@
+#include "kxf-pch.h"
+#include "StreamTransfer.h"
+#include "IDirectStream.h"
+#include "kxf/DateTime/TimeClock.h"
+
+namespace
+{
+	using namespace kxf;
+
+	constexpr size_t g_BufferSize = DataSize::FromKB(64).ToBytes();
+
+	size_t GetChunkSize(uint64_t remaining, size_t size) noexcept
+	{
+		return static_cast<size_t>(std::min<uint64_t>(remaining, size));
+	}
+	bool IsEndOfStream(const IInputStream& stream)
+	{
+		return stream.GetLastError() == StreamErrorCode::EndOfStream;
+	}
+
+	uint64_t TransferDirectRead(IInputStream& source, IDirectInputStream& directSource, IOutputStream& destination, uint64_t remaining, bool& completed)
+	{
+		uint64_t transferred = 0;
+		while (remaining != 0)
+		{
+			// No data is the end of the source only if it says so, a failed read or mapping is reported as an error
+			const auto data = directSource.GetReadBuffer();
+			if (data.empty())
+			{
+				completed = IsEndOfStream(source) || source.GetLastError().IsSuccess();
+				break;
+			}
+
+			// Compression and file streams will consume the data right from the source memory
+			const size_t count = GetChunkSize(remaining, data.size());
+			const bool success = destination.WriteAll(data.data(), count);
+			const DataSize written = destination.LastWrite();
+
+			if (written.IsPositive())
+			{
+				const size_t consumed = directSource.Consume(static_cast<size_t>(written.ToBytes()));
+				transferred += consumed;
+				remaining -= consumed;
+			}
+			if (!success)
+			{
+				completed = false;
+				break;
+			}
+		}
+		return transferred;
+	}
+	uint64_t TransferDirectWrite(IInputStream& source, IDirectOutputStream& directDestination, uint64_t remaining, bool& completed)
+	{
+		uint64_t transferred = 0;
+		while (remaining != 0)
+		{
+			// Use the remaining size of the source if it's known to avoid growing the destination more than once
+			size_t chunkSize = g_BufferSize;
+			if (const DataSize size = source.GetSize(), offset = source.TellI(); size.IsValid() && offset.IsValid() && size > offset)
+			{
+				chunkSize = GetChunkSize(static_cast<uint64_t>((size - offset).ToBytes()), std::numeric_limits<size_t>::max());
+			}
+
+			const auto buffer = directDestination.GetWriteBuffer(GetChunkSize(remaining, chunkSize));
+			if (buffer.empty())
+			{
+				completed = false;
+				break;
+			}
+
+			const DataSize read = source.Read(buffer.data(), buffer.size()).LastRead();
+			const size_t readSize = read.IsPositive() ? static_cast<size_t>(read.ToBytes()) : 0;
+			const size_t committed = directDestination.Commit(readSize);
+			transferred += committed;
+			remaining -= committed;
+
+			// Same as for the copy: nothing read is the end of the source only if it hasn't failed
+			if (committed != readSize)
+			{
+				completed = false;
+				break;
+			}
+			else if (IsEndOfStream(source))
+			{
+				break;
+			}
+			else if (source.GetLastError().IsFail())
+			{
+				completed = false;
+				break;
+			}
+			else if (readSize == 0)
+			{
+				break;
+			}
+		}
+		return transferred;
+	}
+	uint64_t TransferCopy(IInputStream& source, IOutputStream& destination, uint64_t remaining, bool& completed)
+	{
+		uint64_t transferred = 0;
+		auto buffer = std::make_unique<uint8_t[]>(g_BufferSize);
+
+		while (remaining != 0)
+		{
+			const DataSize read = source.Read(buffer.get(), GetChunkSize(remaining, g_BufferSize)).LastRead();
+			if (!read.IsPositive())
+			{
+				completed = IsEndOfStream(source) || source.GetLastError().IsSuccess();
+				break;
+			}
+
+			const bool success = destination.WriteAll(buffer.get(), static_cast<size_t>(read.ToBytes()));
+			const DataSize written = destination.LastWrite();
+			if (written.IsPositive())
+			{
+				transferred += written.ToBytes();
+				remaining -= written.ToBytes();
+			}
+
+			if (!success)
+			{
+				completed = false;
+				break;
+			}
+			else if (IsEndOfStream(source))
+			{
+				break;
+			}
+			else if (source.GetLastError().IsFail())
+			{
+				completed = false;
+				break;
+			}
+		}
+		return transferred;
+	}
+}
+
+namespace kxf::IO
+{
+	StreamTransferResult Transfer(IInputStream& source, IOutputStream& destination, DataSize limit)
+	{
+		StreamTransferResult result;
+		const TimeSpan startTime = TimeSpan::Now(HighResolutionClock());
+
+		const uint64_t remaining = limit.IsValid() ? static_cast<uint64_t>(std::max<int64_t>(limit.ToBytes(), 0)) : std::numeric_limits<uint64_t>::max();
+		bool completed = true;
+		uint64_t transferred = 0;
+
+		if (auto directSource = source.QueryInterface<IDirectInputStream>())
+		{
+			result.Method = StreamTransferMethod::DirectRead;
+			transferred = TransferDirectRead(source, *directSource, destination, remaining, completed);
+		}
+		else if (auto directDestination = destination.QueryInterface<IDirectOutputStream>())
+		{
+			result.Method = StreamTransferMethod::DirectWrite;
+			transferred = TransferDirectWrite(source, *directDestination, remaining, completed);
+		}
+		else
+		{
+			result.Method = StreamTransferMethod::Copy;
+			transferred = TransferCopy(source, destination, remaining, completed);
+		}
+
+		result.Transferred = static_cast<int64_t>(transferred);
+		result.Elapsed = TimeSpan::Now(HighResolutionClock()) - startTime;
+		result.Completed = completed;
+
+		return result;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "Common.h"
+#include "IStream.h"
+#include "kxf/DateTime/TimeSpan.h"
+
+namespace kxf
+{
+	enum class StreamTransferMethod
+	{
+		None = -1,
+
+		// Through an intermediate buffer
+		Copy,
+
+		// Straight from the source data exposed through 'IDirectInputStream'
+		DirectRead,
+
+		// Straight into the destination buffer provided through 'IDirectOutputStream'
+		DirectWrite
+	};
+
+	struct StreamTransferResult final
+	{
+		DataSize Transferred = 0;
+		TimeSpan Elapsed;
+		StreamTransferMethod Method = StreamTransferMethod::None;
+		bool Completed = false;
+
+		// Bytes per second
+		DataSize GetThroughput() const noexcept
+		{
+			const int64_t milliseconds = std::max<int64_t>(Elapsed.GetMilliseconds(), 1);
+			return Transferred.ToBytes() * 1000 / milliseconds;
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return Completed;
+		}
+		bool operator!() const noexcept
+		{
+			return !Completed;
+		}
+	};
+}
+
+namespace kxf::IO
+{
+	// Copies up to 'limit' bytes (everything until the end of the source if the limit is invalid) from the current position
+	// of the source stream to the current position of the destination stream. If either of the streams exposes its memory
+	// the data is transferred without an intermediate buffer, otherwise this is equivalent to 'IOutputStream::Write(IInputStream&)'.
+	// The result is completed if the source has been exhausted or the limit has been reached without errors.
+	KXF_API StreamTransferResult Transfer(IInputStream& source, IOutputStream& destination, DataSize limit = {});
+}
@@ -3,8 +3,10 @@
 
 #include "kxf/Serialization/BinarySerializer.h"
 #include "kxf/Serialization/XDocument.h"
+#include "kxf/Serialization/XDocumentSchema.h"
 #include "kxf/Serialization/XML.h"
 #include "kxf/Serialization/INI.h"
 #include "kxf/Serialization/HTML.h"
 #include "kxf/Serialization/JSON.h"
 #include "kxf/Serialization/TextDocument.h"
+#include "kxf/Serialization/DocumentLoader.h"
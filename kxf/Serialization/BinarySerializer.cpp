@@ -5,6 +5,11 @@
 
 namespace
 {
+	// Maximum length of a LEB128-encoded 64-bit integer
+	constexpr size_t g_MaxVarIntLength = 10;
+
+	thread_local kxf::Serialization::EncodingScope* g_EncodingScope = nullptr;
+
 	uint64_t WriteBuffer(kxf::IOutputStream& stream, const void* buffer, size_t length)
 	{
 		uint64_t written = stream.Write(buffer, length).LastWrite().ToBytes();
@@ -23,6 +28,86 @@ namespace
 		}
 		return read;
 	}
+
+	size_t EncodeVarInt(uint64_t value, uint8_t* buffer) noexcept
+	{
+		size_t length = 0;
+		while (value >= 0x80)
+		{
+			buffer[length++] = static_cast<uint8_t>(value | 0x80);
+			value >>= 7;
+		}
+		buffer[length++] = static_cast<uint8_t>(value);
+
+		return length;
+	}
+	uint64_t WriteVarInt(kxf::IOutputStream& stream, uint64_t value)
+	{
+		uint8_t buffer[g_MaxVarIntLength] = {};
+		return WriteBuffer(stream, buffer, EncodeVarInt(value, buffer));
+	}
+	uint64_t ReadVarInt(kxf::IInputStream& stream, uint64_t& value)
+	{
+		value = 0;
+		for (size_t i = 0; i < g_MaxVarIntLength; i++)
+		{
+			uint8_t byte = 0;
+			ReadBuffer(stream, &byte, sizeof(byte));
+
+			// The last byte can only hold the one remaining bit
+			if (i == g_MaxVarIntLength - 1 && byte > 1)
+			{
+				break;
+			}
+
+			value |= static_cast<uint64_t>(byte & 0x7f) << (i * 7);
+			if ((byte & 0x80) == 0)
+			{
+				return i + 1;
+			}
+		}
+		throw kxf::BinarySerializerException("Invalid variable-length integer");
+	}
+
+	constexpr uint64_t ZigZagEncode(int64_t value) noexcept
+	{
+		return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+	}
+	constexpr int64_t ZigZagDecode(uint64_t value) noexcept
+	{
+		return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+	}
+
+	// Writes the count the same way 'BinarySerializer<uint64_t>' would and the buffer right after it
+	uint64_t WriteCountedBuffer(kxf::IOutputStream& stream, uint64_t count, const void* buffer, size_t length)
+	{
+		using namespace kxf;
+
+		uint8_t countBuffer[g_MaxVarIntLength] = {};
+		size_t countLength = sizeof(count);
+		if (Serialization::GetEncoding(stream) == BinarySerializerEncoding::Compact)
+		{
+			countLength = EncodeVarInt(count, countBuffer);
+		}
+		else
+		{
+			std::memcpy(countBuffer, &count, sizeof(count));
+		}
+
+		const std::span<const std::byte> buffers[] = {std::as_bytes(std::span(countBuffer, countLength)), {static_cast<const std::byte*>(buffer), length}};
+		return Private::WriteBinaryBuffers(stream, buffers);
+	}
+
+	template<class T>
+	size_t GetTotalLength(std::span<const std::span<T>> buffers) noexcept
+	{
+		size_t length = 0;
+		for (const auto& buffer: buffers)
+		{
+			length += buffer.size();
+		}
+		return length;
+	}
 }
 
 namespace kxf
@@ -49,8 +134,60 @@ namespace kxf
 	}
 }
 
+namespace kxf::Serialization
+{
+	const void* EncodingScope::GetStreamObject(const IInputStream& stream) noexcept
+	{
+		return dynamic_cast<const void*>(&stream);
+	}
+	const void* EncodingScope::GetStreamObject(const IOutputStream& stream) noexcept
+	{
+		return dynamic_cast<const void*>(&stream);
+	}
+	BinarySerializerEncoding EncodingScope::FindEncoding(const void* stream) noexcept
+	{
+		for (const EncodingScope* scope = g_EncodingScope; scope; scope = scope->m_Previous)
+		{
+			if (!scope->m_Stream || scope->m_Stream == stream)
+			{
+				return scope->m_Encoding;
+			}
+		}
+		return BinarySerializerEncoding::Native;
+	}
+
+	void EncodingScope::Enter() noexcept
+	{
+		m_Previous = g_EncodingScope;
+		g_EncodingScope = this;
+	}
+	EncodingScope::~EncodingScope() noexcept
+	{
+		g_EncodingScope = m_Previous;
+	}
+}
+
 namespace kxf::Private
 {
+	uint64_t WriteBinaryBuffers(IOutputStream& stream, std::span<const std::span<const std::byte>> buffers)
+	{
+		uint64_t written = stream.WriteV(buffers).LastWrite().ToBytes();
+		if (written != GetTotalLength(buffers))
+		{
+			throw kxf::BinarySerializerException("Could not write the required amount of bytes");
+		}
+		return written;
+	}
+	uint64_t ReadBinaryBuffers(IInputStream& stream, std::span<const std::span<std::byte>> buffers)
+	{
+		uint64_t read = stream.ReadV(buffers).LastRead().ToBytes();
+		if (read != GetTotalLength(buffers))
+		{
+			throw kxf::BinarySerializerException("Could not read the required amount of bytes");
+		}
+		return read;
+	}
+
 	uint64_t BufferBinarySerializer::DoWriteBuffer(IOutputStream& stream, const void* buffer, size_t length) const
 	{
 		return WriteBuffer(stream, buffer, length);
@@ -59,13 +196,68 @@ namespace kxf::Private
 	{
 		return ReadBuffer(stream, buffer, length);
 	}
+	uint64_t BufferBinarySerializer::DoWriteCountedBuffer(IOutputStream& stream, uint64_t count, const void* buffer, size_t length) const
+	{
+		return WriteCountedBuffer(stream, count, buffer, length);
+	}
+	void BufferBinarySerializer::DoValidateItemCount(IInputStream& stream, uint64_t count, size_t itemSize) const
+	{
+		if (count > std::numeric_limits<size_t>::max() / std::max<size_t>(itemSize, 1))
+		{
+			throw BinarySerializerException("Invalid item count");
+		}
+
+		// Catches corrupted counts before a huge allocation is made for them
+		const DataSize size = stream.GetSize();
+		const DataSize offset = stream.TellI();
+		if (size.IsValid() && offset.IsValid() && offset <= size && count * itemSize > static_cast<uint64_t>((size - offset).ToBytes()))
+		{
+			throw BinarySerializerException("Invalid item count");
+		}
+	}
 
 	uint64_t IntBinarySerializer::DoSerializeInteger(IOutputStream& stream, const void* buffer, size_t length, bool isSigned) const
 	{
+		if (length > 1 && length <= sizeof(uint64_t) && Serialization::GetEncoding(stream) == BinarySerializerEncoding::Compact)
+		{
+			// Widen the value to 64 bits with respect to its sign first, the representation is little-endian
+			uint64_t value = 0;
+			std::memcpy(&value, buffer, length);
+
+			if (isSigned)
+			{
+				const size_t shift = (sizeof(uint64_t) - length) * 8;
+				value = ZigZagEncode(static_cast<int64_t>(value << shift) >> shift);
+			}
+			return WriteVarInt(stream, value);
+		}
 		return WriteBuffer(stream, buffer, length);
 	}
 	uint64_t IntBinarySerializer::DoDeserializeInteger(IInputStream& stream, void* buffer, size_t length, bool isSigned) const
 	{
+		if (length > 1 && length <= sizeof(uint64_t) && Serialization::GetEncoding(stream) == BinarySerializerEncoding::Compact)
+		{
+			uint64_t value = 0;
+			const uint64_t read = ReadVarInt(stream, value);
+
+			const size_t bits = length * 8;
+			if (isSigned)
+			{
+				const int64_t signedValue = ZigZagDecode(value);
+				if (bits < 64 && (signedValue < -(int64_t(1) << (bits - 1)) || signedValue >= (int64_t(1) << (bits - 1))))
+				{
+					throw BinarySerializerException("Integer value is out of range");
+				}
+				value = static_cast<uint64_t>(signedValue);
+			}
+			else if (bits < 64 && (value >> bits) != 0)
+			{
+				throw BinarySerializerException("Integer value is out of range");
+			}
+
+			std::memcpy(buffer, &value, length);
+			return read;
+		}
 		return ReadBuffer(stream, buffer, length);
 	}
 
@@ -80,7 +272,7 @@ namespace kxf::Private
 
 	uint64_t StringBinarySerializer::DoSerializeString(IOutputStream& stream, const void* buffer, size_t length) const
 	{
-		return Serialization::WriteObject(stream, static_cast<uint64_t>(length)) + WriteBuffer(stream, buffer, length);
+		return WriteCountedBuffer(stream, length, buffer, length);
 	}
 	uint64_t StringBinarySerializer::DoDeserializeString(IInputStream& stream, void* buffer, size_t& length) const
 	{
@@ -1,10 +1,14 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <type_traits>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <array>
 #include <vector>
+#include <span>
 
 namespace kxf
 {
@@ -18,6 +22,16 @@ namespace kxf
 	template<class TValue>
 	struct BinarySerializer;
 
+	enum class BinarySerializerEncoding
+	{
+		// Integers and lengths are stored with their native width
+		Native = 0,
+
+		// Integers wider than one byte and all lengths are stored as LEB128 variable-length integers,
+		// signed values are zigzag-encoded first. Floating point values and byte-sized types are unaffected.
+		Compact
+	};
+
 	class BinarySerializerException: public std::runtime_error
 	{
 		public:
@@ -28,6 +42,68 @@ namespace kxf
 			BinarySerializerException(const String& message);
 	};
 }
+namespace kxf::Serialization
+{
+	// Selects the encoding used by all the serializers for the lifetime of the object, either for every stream
+	// or only for the given one. Scopes are per thread and must be destroyed in the reverse order of creation.
+	// A stream is identified by its most derived object, so the scope applies to it through any of its interfaces.
+	class KXF_API EncodingScope final
+	{
+		private:
+			const void* m_Stream = nullptr;
+			EncodingScope* m_Previous = nullptr;
+			BinarySerializerEncoding m_Encoding = BinarySerializerEncoding::Native;
+
+		private:
+			static const void* GetStreamObject(const IInputStream& stream) noexcept;
+			static const void* GetStreamObject(const IOutputStream& stream) noexcept;
+			static BinarySerializerEncoding FindEncoding(const void* stream) noexcept;
+
+			void Enter() noexcept;
+
+		public:
+			EncodingScope(BinarySerializerEncoding encoding) noexcept
+				:m_Encoding(encoding)
+			{
+				Enter();
+			}
+			EncodingScope(const IInputStream& stream, BinarySerializerEncoding encoding) noexcept
+				:m_Stream(GetStreamObject(stream)), m_Encoding(encoding)
+			{
+				Enter();
+			}
+			EncodingScope(const IOutputStream& stream, BinarySerializerEncoding encoding) noexcept
+				:m_Stream(GetStreamObject(stream)), m_Encoding(encoding)
+			{
+				Enter();
+			}
+			EncodingScope(const EncodingScope&) = delete;
+			~EncodingScope() noexcept;
+
+		public:
+			static BinarySerializerEncoding GetEncoding(const IInputStream& stream) noexcept
+			{
+				return FindEncoding(GetStreamObject(stream));
+			}
+			static BinarySerializerEncoding GetEncoding(const IOutputStream& stream) noexcept
+			{
+				return FindEncoding(GetStreamObject(stream));
+			}
+
+		public:
+			EncodingScope& operator=(const EncodingScope&) = delete;
+	};
+
+	inline BinarySerializerEncoding GetEncoding(const IInputStream& stream) noexcept
+	{
+		return EncodingScope::GetEncoding(stream);
+	}
+	inline BinarySerializerEncoding GetEncoding(const IOutputStream& stream) noexcept
+	{
+		return EncodingScope::GetEncoding(stream);
+	}
+}
+
 namespace kxf::Serialization
 {
 	template<class TValue>
@@ -61,6 +137,9 @@ namespace kxf::Serialization
 		return BinarySerializer<std::wstring_view>().Serialize(stream, std::wstring_view(value, N - 1));
 	}
 
+	template<class... TValues>
+	uint64_t WriteObjects(IOutputStream& stream, const TValues&... values);
+
 	template<class TValue>
 	uint64_t ReadObject(IInputStream& stream, TValue& value)
 	{
@@ -91,11 +170,109 @@ namespace kxf::Serialization
 
 namespace kxf::Private
 {
+	// Writes or reads all the buffers with a single vectored call, throws if any of them couldn't be transferred entirely
+	uint64_t WriteBinaryBuffers(IOutputStream& stream, std::span<const std::span<const std::byte>> buffers);
+	uint64_t ReadBinaryBuffers(IInputStream& stream, std::span<const std::span<std::byte>> buffers);
+
+	// True for the types whose serialized form is exactly their in-memory representation
+	template<class T>
+	constexpr bool IsRawBinarySerializable() noexcept
+	{
+		if constexpr(std::is_enum_v<T>)
+		{
+			return IsRawBinarySerializable<std::underlying_type_t<T>>();
+		}
+		else
+		{
+			return std::is_same_v<T, bool> || std::is_same_v<T, float> || std::is_same_v<T, double> ||
+				std::is_same_v<T, uint8_t> || std::is_same_v<T, int8_t> ||
+				std::is_same_v<T, uint16_t> || std::is_same_v<T, int16_t> ||
+				std::is_same_v<T, uint32_t> || std::is_same_v<T, int32_t> ||
+				std::is_same_v<T, uint64_t> || std::is_same_v<T, int64_t>;
+		}
+	}
+
+	// True for the types stored differently with the compact encoding
+	template<class T>
+	constexpr bool IsVarIntBinarySerializable() noexcept
+	{
+		if constexpr(std::is_enum_v<T>)
+		{
+			return IsVarIntBinarySerializable<std::underlying_type_t<T>>();
+		}
+		else
+		{
+			return std::is_integral_v<T> && sizeof(T) > 1;
+		}
+	}
+
+	// True for the element types whose sequences are copied as a single block of memory. Booleans are excluded
+	// since not every byte value is a valid 'bool' (and 'std::vector<bool>' has no contiguous storage).
+	template<class T>
+	constexpr bool IsBulkBinarySerializable() noexcept
+	{
+		return std::is_trivially_copyable_v<T> && !std::is_same_v<std::remove_cv_t<T>, bool>;
+	}
+
 	class BufferBinarySerializer
 	{
 		protected:
 			uint64_t DoWriteBuffer(IOutputStream& stream, const void* buffer, size_t length) const;
 			uint64_t DoReadBuffer(IInputStream& stream, void* buffer, size_t length) const;
+
+			// Writes the item count (as any other length, see 'BinarySerializerEncoding') followed by the items themselves as one vectored write
+			uint64_t DoWriteCountedBuffer(IOutputStream& stream, uint64_t count, const void* buffer, size_t length) const;
+
+			// Throws if the stream is known to have less data left than 'count' items of 'itemSize' bytes each
+			void DoValidateItemCount(IInputStream& stream, uint64_t count, size_t itemSize) const;
+
+		protected:
+			template<class T>
+			uint64_t SerializeItems(IOutputStream& stream, std::span<const T> items) const
+			{
+				if constexpr(IsBulkBinarySerializable<T>())
+				{
+					return DoWriteCountedBuffer(stream, items.size(), items.data(), items.size_bytes());
+				}
+				else
+				{
+					uint64_t written = Serialization::WriteObject(stream, static_cast<uint64_t>(items.size()));
+					for (const auto& item: items)
+					{
+						written += Serialization::WriteObject(stream, item);
+					}
+					return written;
+				}
+			}
+
+			template<class T>
+			uint64_t DeserializeItemCount(IInputStream& stream, uint64_t& count) const
+			{
+				const uint64_t read = Serialization::ReadObject(stream, count);
+				if constexpr(IsBulkBinarySerializable<T>())
+				{
+					DoValidateItemCount(stream, count, sizeof(T));
+				}
+				return read;
+			}
+
+			template<class T>
+			uint64_t DeserializeItems(IInputStream& stream, std::span<T> items) const
+			{
+				if constexpr(IsBulkBinarySerializable<T>())
+				{
+					return DoReadBuffer(stream, items.data(), items.size_bytes());
+				}
+				else
+				{
+					uint64_t read = 0;
+					for (auto& item: items)
+					{
+						read += Serialization::ReadObject(stream, item);
+					}
+					return read;
+				}
+			}
 	};
 
 	class IntBinarySerializer
@@ -387,41 +564,17 @@ namespace kxf
 	{
 		uint64_t Serialize(IOutputStream& stream, const std::array<T, N>& value) const
 		{
-			uint64_t written = Serialization::WriteObject(stream, static_cast<uint64_t>(N));
-			if constexpr(std::is_trivially_copyable_v<T>)
-			{
-				written += DoWriteBuffer(stream, value.data(), N * sizeof(T));
-			}
-			else
-			{
-				for (const auto& item: value)
-				{
-					written += Serialization::WriteObject(stream, item);
-				}
-			}
-			return written;
+			return SerializeItems(stream, std::span<const T>(value));
 		}
 		uint64_t Deserialize(IInputStream& stream, std::array<T, N>& value) const
 		{
 			uint64_t length = 0;
-			uint64_t read = Serialization::ReadObject(stream, length);
+			uint64_t read = DeserializeItemCount<T>(stream, length);
 			if (length != N)
 			{
 				throw BinarySerializerException("Invalid item count");
 			}
-
-			if constexpr(std::is_trivially_copyable_v<T>)
-			{
-				read += DoReadBuffer(stream, value.data(), N * sizeof(T));
-			}
-			else
-			{
-				for (auto& item: value)
-				{
-					read += Serialization::ReadObject(stream, item);
-				}
-			}
-			return read;
+			return read + DeserializeItems(stream, std::span<T>(value));
 		}
 	};
 
@@ -430,38 +583,100 @@ namespace kxf
 	{
 		uint64_t Serialize(IOutputStream& stream, const std::vector<T>& value) const
 		{
-			uint64_t written = Serialization::WriteObject(stream, static_cast<uint64_t>(value.size()));
-			if constexpr(std::is_trivially_copyable_v<T>)
+			if constexpr(std::is_same_v<T, bool>)
 			{
-				written += DoWriteBuffer(stream, value.data(), value.size() * sizeof(T));
-			}
-			else
-			{
-				for (const auto& item: value)
+				uint64_t written = Serialization::WriteObject(stream, static_cast<uint64_t>(value.size()));
+				for (bool item: value)
 				{
 					written += Serialization::WriteObject(stream, item);
 				}
+				return written;
+			}
+			else
+			{
+				return SerializeItems(stream, std::span<const T>(value));
 			}
-			return written;
 		}
 		uint64_t Deserialize(IInputStream& stream, std::vector<T>& value) const
 		{
 			uint64_t length = 0;
-			uint64_t read = Serialization::ReadObject(stream, length);
+			uint64_t read = DeserializeItemCount<T>(stream, length);
 
-			value.resize(static_cast<size_t>(length));
-			if constexpr(std::is_trivially_copyable_v<T>)
+			if constexpr(std::is_same_v<T, bool>)
 			{
-				read += DoReadBuffer(stream, value.data(), length * sizeof(T));
-			}
-			else
-			{
-				for (auto& item: value)
+				value.clear();
+				value.reserve(static_cast<size_t>(length));
+				for (uint64_t i = 0; i < length; i++)
 				{
+					bool item = false;
 					read += Serialization::ReadObject(stream, item);
+					value.push_back(item);
 				}
+				return read;
 			}
-			return read;
+			else
+			{
+				value.resize(static_cast<size_t>(length));
+				return read + DeserializeItems(stream, std::span<T>(value));
+			}
+		}
+	};
+
+	// Spans are serialized the same way as vectors, deserialization requires the span to have the exact size of the stored sequence
+	template<class T, size_t Extent>
+	struct BinarySerializer<std::span<T, Extent>> final: private Private::BufferBinarySerializer
+	{
+		uint64_t Serialize(IOutputStream& stream, const std::span<T, Extent>& value) const
+		{
+			return SerializeItems(stream, std::span<const std::remove_cv_t<T>>(value));
+		}
+		uint64_t Deserialize(IInputStream& stream, const std::span<T, Extent>& value) const requires(!std::is_const_v<T>)
+		{
+			uint64_t length = 0;
+			uint64_t read = DeserializeItemCount<T>(stream, length);
+			if (length != value.size())
+			{
+				throw BinarySerializerException("Invalid item count");
+			}
+			return read + DeserializeItems(stream, std::span<T>(value));
 		}
 	};
 }
+
+namespace kxf::Serialization
+{
+	template<class... TValues>
+	uint64_t WriteObjects(IOutputStream& stream, const TValues&... values)
+	{
+		static_assert(sizeof...(TValues) != 0, "Serialization::WriteObjects: at least one value is required");
+
+		if constexpr((Private::IsRawBinarySerializable<TValues>() && ...))
+		{
+			// Primitive values are stored as is, so all of them can be written with a single vectored call,
+			// unless the compact encoding is going to change the representation of some of them.
+			if (!(Private::IsVarIntBinarySerializable<TValues>() || ...) || GetEncoding(stream) == BinarySerializerEncoding::Native)
+			{
+				const std::span<const std::byte> buffers[] = {std::as_bytes(std::span<const TValues, 1>(std::addressof(values), 1))...};
+				return Private::WriteBinaryBuffers(stream, buffers);
+			}
+		}
+		return (WriteObject(stream, values) + ...);
+	}
+
+	template<class... TValues>
+	uint64_t ReadObjects(IInputStream& stream, TValues&... values)
+	{
+		static_assert(sizeof...(TValues) != 0, "Serialization::ReadObjects: at least one value is required");
+
+		// Booleans are excluded since reading arbitrary bytes into them directly isn't safe
+		if constexpr(((Private::IsRawBinarySerializable<TValues>() && !std::is_same_v<TValues, bool>) && ...))
+		{
+			if (!(Private::IsVarIntBinarySerializable<TValues>() || ...) || GetEncoding(stream) == BinarySerializerEncoding::Native)
+			{
+				const std::span<std::byte> buffers[] = {std::as_writable_bytes(std::span<TValues, 1>(std::addressof(values), 1))...};
+				return Private::ReadBinaryBuffers(stream, buffers);
+			}
+		}
+		return (ReadObject(stream, values) + ...);
+	}
+}
@@ -0,0 +1,343 @@
+#include "kxf-pch.h"
+#include "DocumentLoader.h"
+#include "XML/XMLDocument.h"
+#include "JSON/JSONDocument.h"
+#include "INI/INIDocument.h"
+#include "kxf/IO/IStream.h"
+#include "kxf/FileSystem/NativeFileSystem.h"
+#include "kxf/Application/ICoreApplication.h"
+
+namespace
+{
+	using namespace kxf;
+
+	String NormalizeExtension(const String& extension)
+	{
+		String result = extension;
+		if (result.StartsWith('.'))
+		{
+			result.Remove(0, 1);
+		}
+		return result.MakeLower();
+	}
+
+	const char* GetStatusText(DocumentLoadStatus status) noexcept
+	{
+		switch (status)
+		{
+			case DocumentLoadStatus::Loaded:
+			{
+				return "loaded";
+			}
+			case DocumentLoadStatus::UnknownFormat:
+			{
+				return "unknown document format";
+			}
+			case DocumentLoadStatus::OpenFailed:
+			{
+				return "unable to open the file";
+			}
+			case DocumentLoadStatus::ParseFailed:
+			{
+				return "unable to parse the document";
+			}
+			case DocumentLoadStatus::Canceled:
+			{
+				return "canceled";
+			}
+		};
+		return "not loaded";
+	}
+}
+
+namespace kxf
+{
+	String DocumentLoaderResult::FormatErrors() const
+	{
+		String result;
+		for (const auto& item: Documents)
+		{
+			if (!item.IsLoaded())
+			{
+				if (!result.IsEmpty())
+				{
+					result += '\n';
+				}
+				result += Format("{}: {}", item.Path.GetFullPath(), GetStatusText(item.Status));
+			}
+		}
+		return result;
+	}
+}
+
+namespace kxf
+{
+	// State shared between the tasks of a single load
+	class DocumentLoader::Operation final
+	{
+		private:
+			std::vector<Item> m_Items;
+			std::shared_ptr<IFileSystem> m_FileSystem;
+			FlagSet<DocumentLoaderFlag> m_Flags;
+			ResultCallback m_OnLoaded;
+
+			std::mutex m_Lock;
+			std::vector<DocumentLoadResult> m_Results;
+			std::vector<bool> m_IsDone;
+			size_t m_NextToDeliver = 0;
+			size_t m_FailedCount = 0;
+			bool m_IsDelivering = false;
+
+			std::atomic<size_t> m_NextToLoad = 0;
+			std::atomic<bool> m_HasFailed = false;
+			std::promise<DocumentLoaderResult> m_Promise;
+
+		private:
+			std::shared_ptr<IInputStream> OpenFile(const FSPath& path) const
+			{
+				if (m_Flags.Contains(DocumentLoaderFlag::MemoryMapped))
+				{
+					// Mapping fails for empty files, they're opened the usual way below
+					if (auto stream = m_FileSystem->CreateStream(path, IOStreamAccess::Read, IOStreamDisposition::OpenExisting, IOStreamShare::Read, IOStreamFlag::MemoryMapped))
+					{
+						return stream->QueryInterface<IInputStream>();
+					}
+				}
+				return m_FileSystem->OpenToRead(path);
+			}
+			DocumentLoadResult DoLoad(const Item& item) const
+			{
+				DocumentLoadResult result;
+				result.Path = item.Path;
+
+				if (m_Flags.Contains(DocumentLoaderFlag::StopOnError) && m_HasFailed)
+				{
+					result.Status = DocumentLoadStatus::Canceled;
+				}
+				else if (auto document = item.Factory ? item.Factory() : nullptr; !document)
+				{
+					result.Status = DocumentLoadStatus::UnknownFormat;
+				}
+				else if (auto stream = OpenFile(item.Path); !stream)
+				{
+					result.Status = DocumentLoadStatus::OpenFailed;
+				}
+				else if (!document->LoadDocument(*stream))
+				{
+					result.Status = DocumentLoadStatus::ParseFailed;
+				}
+				else
+				{
+					result.Document = std::move(document);
+					result.Status = DocumentLoadStatus::Loaded;
+				}
+				return result;
+			}
+			void OnCompleted(size_t index, DocumentLoadResult result)
+			{
+				std::unique_lock lock(m_Lock);
+				if (!result.IsLoaded())
+				{
+					m_FailedCount++;
+					m_HasFailed = true;
+				}
+				m_Results[index] = std::move(result);
+				m_IsDone[index] = true;
+
+				// Only one thread delivers the results at a time, the others leave their results for it to pick up
+				if (m_IsDelivering)
+				{
+					return;
+				}
+
+				m_IsDelivering = true;
+				while (m_NextToDeliver < m_Results.size() && m_IsDone[m_NextToDeliver])
+				{
+					const DocumentLoadResult& item = m_Results[m_NextToDeliver++];
+					if (m_OnLoaded)
+					{
+						lock.unlock();
+						std::invoke(m_OnLoaded, item);
+						lock.lock();
+					}
+				}
+				m_IsDelivering = false;
+
+				if (m_NextToDeliver == m_Results.size())
+				{
+					DocumentLoaderResult loaderResult;
+					loaderResult.Documents = std::move(m_Results);
+					loaderResult.FailedCount = m_FailedCount;
+					m_NextToDeliver = std::numeric_limits<size_t>::max();
+
+					lock.unlock();
+					m_Promise.set_value(std::move(loaderResult));
+				}
+			}
+
+		public:
+			Operation(std::vector<Item> items, std::shared_ptr<IFileSystem> fileSystem, FlagSet<DocumentLoaderFlag> flags, ResultCallback onLoaded)
+				:m_Items(std::move(items)), m_FileSystem(std::move(fileSystem)), m_Flags(flags), m_OnLoaded(std::move(onLoaded))
+			{
+				m_Results.resize(m_Items.size());
+				m_IsDone.resize(m_Items.size(), false);
+			}
+
+		public:
+			size_t GetCount() const noexcept
+			{
+				return m_Items.size();
+			}
+			std::future<DocumentLoaderResult> GetFuture()
+			{
+				return m_Promise.get_future();
+			}
+
+			// Takes the next document which no one has started to load yet, returns false if there are none left
+			bool LoadNext()
+			{
+				const size_t index = m_NextToLoad.fetch_add(1, std::memory_order_relaxed);
+				if (index < m_Items.size())
+				{
+					Load(index);
+					return true;
+				}
+				return false;
+			}
+			void Load(size_t index)
+			{
+				DocumentLoadResult result;
+				try
+				{
+					result = DoLoad(m_Items[index]);
+				}
+				catch (...)
+				{
+					// The result must be delivered anyway or the whole operation would never complete
+					result.Path = m_Items[index].Path;
+					result.Status = DocumentLoadStatus::ParseFailed;
+				}
+				OnCompleted(index, std::move(result));
+			}
+			void Finish()
+			{
+				m_Promise.set_value({});
+			}
+	};
+}
+
+namespace kxf
+{
+	const DocumentLoader::DocumentFactory* DocumentLoader::FindFormat(const FSPath& path) const
+	{
+		if (auto it = m_Formats.find(NormalizeExtension(path.GetExtension())); it != m_Formats.end())
+		{
+			return &it->second;
+		}
+		return nullptr;
+	}
+
+	DocumentLoader::DocumentLoader(std::shared_ptr<IAsyncTaskExecutor> taskExecutor, std::shared_ptr<IFileSystem> fileSystem, FlagSet<DocumentLoaderFlag> flags)
+		:m_TaskExecutor(std::move(taskExecutor)), m_FileSystem(std::move(fileSystem)), m_Flags(flags)
+	{
+		if (!m_TaskExecutor)
+		{
+			if (auto app = ICoreApplication::GetInstance())
+			{
+				m_TaskExecutor = RTTI::assume_non_owned(app->GetTaskExecutor());
+			}
+		}
+		if (!m_FileSystem)
+		{
+			m_FileSystem = std::make_shared<NativeFileSystem>();
+		}
+	}
+
+	void DocumentLoader::AddFormat(const String& extension, DocumentFactory factory)
+	{
+		if (factory)
+		{
+			m_Formats.insert_or_assign(NormalizeExtension(extension), std::move(factory));
+		}
+		else
+		{
+			m_Formats.erase(NormalizeExtension(extension));
+		}
+	}
+	void DocumentLoader::AddDefaultFormats()
+	{
+		AddFormat<XMLDocument>("xml");
+		AddFormat<JSONDocument>("json");
+		AddFormat<INIDocument>("ini");
+	}
+
+	size_t DocumentLoader::AddDocument(FSPath path, DocumentFactory factory)
+	{
+		Item& item = m_Items.emplace_back();
+		item.Path = std::move(path);
+		item.Factory = std::move(factory);
+
+		return m_Items.size() - 1;
+	}
+
+	std::shared_ptr<DocumentLoader::Operation> DocumentLoader::StartOperation(ResultCallback onLoaded)
+	{
+		// Resolve the formats now, so the loader itself can be changed or destroyed while the documents are being loaded
+		std::vector<Item> items = m_Items;
+		for (Item& item: items)
+		{
+			if (!item.Factory)
+			{
+				if (auto factory = FindFormat(item.Path))
+				{
+					item.Factory = *factory;
+				}
+			}
+		}
+
+		auto operation = std::make_shared<Operation>(std::move(items), m_FileSystem, m_Flags, std::move(onLoaded));
+		if (operation->GetCount() == 0)
+		{
+			operation->Finish();
+		}
+		else if (m_TaskExecutor && m_TaskExecutor->IsRunning())
+		{
+			// Every task loads one document, whichever is next at the time it runs
+			for (size_t i = 0; i < operation->GetCount(); i++)
+			{
+				m_TaskExecutor->QueueTask([operation]()
+				{
+					operation->LoadNext();
+				});
+			}
+		}
+		return operation;
+	}
+
+	std::future<DocumentLoaderResult> DocumentLoader::LoadAsync(ResultCallback onLoaded)
+	{
+		auto operation = StartOperation(std::move(onLoaded));
+		auto future = operation->GetFuture();
+
+		if (!m_TaskExecutor || !m_TaskExecutor->IsRunning())
+		{
+			// No executor to run on, load everything on the calling thread
+			while (operation->LoadNext())
+			{
+			}
+		}
+		return future;
+	}
+	DocumentLoaderResult DocumentLoader::Load(ResultCallback onLoaded)
+	{
+		auto operation = StartOperation(std::move(onLoaded));
+		auto future = operation->GetFuture();
+
+		// If this is a thread of the executor, the queued tasks may be stuck behind the current one. Whatever is left for them
+		// when they run is loaded here, so only the documents which are already being loaded elsewhere are waited for.
+		while (operation->LoadNext())
+		{
+		}
+		return future.get();
+	}
+}
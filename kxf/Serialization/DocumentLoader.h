@@ -0,0 +1,152 @@
+#pragma once
+#include "Common.h"
+#include "XDocument.h"
+#include "kxf/FileSystem/FSPath.h"
+#include "kxf/FileSystem/IFileSystem.h"
+#include "kxf/Core/IAsyncTaskExecutor.h"
+#include <future>
+
+namespace kxf
+{
+	enum class DocumentLoaderFlag: uint32_t
+	{
+		None = 0,
+
+		// Read the files through memory mappings, the documents are parsed right from the mapped memory when they support it
+		MemoryMapped = 1u << 0,
+
+		// Don't start loading any more documents after the first failure, the rest of them is reported as canceled
+		StopOnError = 1u << 1
+	};
+	kxf_FlagSet_Declare(DocumentLoaderFlag);
+
+	enum class DocumentLoadStatus
+	{
+		None = -1,
+
+		Loaded,
+		UnknownFormat,
+		OpenFailed,
+		ParseFailed,
+		Canceled
+	};
+
+	struct DocumentLoadResult final
+	{
+		FSPath Path;
+		std::shared_ptr<IXDocument> Document;
+		DocumentLoadStatus Status = DocumentLoadStatus::None;
+
+		bool IsLoaded() const noexcept
+		{
+			return Status == DocumentLoadStatus::Loaded;
+		}
+	};
+
+	struct DocumentLoaderResult final
+	{
+		// In the same order the documents were added to the loader
+		std::vector<DocumentLoadResult> Documents;
+		size_t FailedCount = 0;
+
+		bool IsSuccess() const noexcept
+		{
+			return FailedCount == 0;
+		}
+		String FormatErrors() const;
+
+		explicit operator bool() const noexcept
+		{
+			return IsSuccess();
+		}
+		bool operator!() const noexcept
+		{
+			return !IsSuccess();
+		}
+	};
+}
+
+namespace kxf
+{
+	// Loads a set of files into documents in parallel, each file is opened and parsed by a separate task of the executor.
+	// The results are always delivered in the order the documents were added regardless of the order they finish in.
+	class KXF_API DocumentLoader final
+	{
+		public:
+			using DocumentFactory = std::function<std::shared_ptr<IXDocument>()>;
+			using ResultCallback = std::move_only_function<void(const DocumentLoadResult&)>;
+
+		private:
+			struct Item final
+			{
+				FSPath Path;
+				DocumentFactory Factory;
+			};
+			class Operation;
+
+		private:
+			std::shared_ptr<IAsyncTaskExecutor> m_TaskExecutor;
+			std::shared_ptr<IFileSystem> m_FileSystem;
+			FlagSet<DocumentLoaderFlag> m_Flags;
+
+			std::unordered_map<String, DocumentFactory> m_Formats;
+			std::vector<Item> m_Items;
+
+		private:
+			const DocumentFactory* FindFormat(const FSPath& path) const;
+			std::shared_ptr<Operation> StartOperation(ResultCallback onLoaded);
+
+		public:
+			DocumentLoader(std::shared_ptr<IAsyncTaskExecutor> taskExecutor = {}, std::shared_ptr<IFileSystem> fileSystem = {}, FlagSet<DocumentLoaderFlag> flags = DocumentLoaderFlag::MemoryMapped);
+			DocumentLoader(const DocumentLoader&) = delete;
+			DocumentLoader(DocumentLoader&&) noexcept = default;
+			~DocumentLoader() = default;
+
+		public:
+			FlagSet<DocumentLoaderFlag> GetFlags() const noexcept
+			{
+				return m_Flags;
+			}
+			void SetFlags(FlagSet<DocumentLoaderFlag> flags) noexcept
+			{
+				m_Flags = flags;
+			}
+
+			// Factories for files added without an explicit one, selected by the file extension (case insensitive, without the dot)
+			void AddFormat(const String& extension, DocumentFactory factory);
+			void AddDefaultFormats();
+
+			template<std::derived_from<IXDocument> TDocument>
+			void AddFormat(const String& extension)
+			{
+				AddFormat(extension, []() -> std::shared_ptr<IXDocument>
+				{
+					return std::make_shared<TDocument>();
+				});
+			}
+
+			// Returns the index of the document in the results
+			size_t AddDocument(FSPath path, DocumentFactory factory = {});
+			size_t GetDocumentCount() const noexcept
+			{
+				return m_Items.size();
+			}
+			void ClearDocuments() noexcept
+			{
+				m_Items.clear();
+			}
+
+			// The callback is invoked once per document in the order the documents were added, as soon as the document and
+			// all the ones before it are done. Calls are never concurrent but they can come from any of the executor threads, or from
+			// the thread calling 'Load'.
+			std::future<DocumentLoaderResult> LoadAsync(ResultCallback onLoaded = {});
+
+			// The calling thread loads the documents along with the executor and only waits for the ones already being loaded
+			// by the other threads, so it can be called from a task of the same executor.
+			DocumentLoaderResult Load(ResultCallback onLoaded = {});
+
+		public:
+			DocumentLoader& operator=(const DocumentLoader&) = delete;
+			DocumentLoader& operator=(DocumentLoader&&) noexcept = default;
+	};
+}
@@ -1,5 +1,6 @@
 #include "kxf-pch.h"
 #include "HTMLDocument.h"
+#include "Private/TagTokenizer.h"
 #include "kxf/IO/IStream.h"
 
 #pragma warning(disable: 4005) // macro redefinition
@@ -33,6 +34,68 @@ namespace
 	}
 }
 
+namespace kxf::HTML::Private
+{
+	std::string_view GetElementName(const GumboNode* node, std::string& buffer);
+	const GumboVector* GetChildren(const GumboNode* node);
+}
+
+namespace
+{
+	// Finds the element whose start tag is at the given offset of the parsed text
+	GumboNode* FindElementAt(GumboNode* root, size_t offset)
+	{
+		auto IsElementAt = [&](const GumboNode* node)
+		{
+			return node->type == GUMBO_NODE_ELEMENT && node->v.element.original_tag.length != 0 && node->v.element.start_pos.offset == offset;
+		};
+
+		// The parser keeps the elements in source order, so the element is in the subtree of the last child starting before it
+		for (GumboNode* node = root; node;)
+		{
+			if (IsElementAt(node))
+			{
+				return node;
+			}
+
+			GumboNode* next = nullptr;
+			if (auto children = kxf::HTML::Private::GetChildren(node))
+			{
+				for (size_t i = 0; i < children->length; i++)
+				{
+					auto child = static_cast<GumboNode*>(children->data[i]);
+					if (child->type == GUMBO_NODE_ELEMENT && child->v.element.start_pos.offset <= offset)
+					{
+						next = child;
+					}
+				}
+			}
+			node = next;
+		}
+
+		// Except for the misplaced table content it moves elsewhere, which needs a full walk
+		std::vector<GumboNode*> stack = {root};
+		while (!stack.empty())
+		{
+			GumboNode* node = stack.back();
+			stack.pop_back();
+
+			if (IsElementAt(node))
+			{
+				return node;
+			}
+			if (auto children = kxf::HTML::Private::GetChildren(node))
+			{
+				for (size_t i = children->length; i != 0; i--)
+				{
+					stack.push_back(static_cast<GumboNode*>(children->data[i - 1]));
+				}
+			}
+		}
+		return nullptr;
+	}
+}
+
 namespace kxf
 {
 	class HTMLDocument::ImplOptions final: public GumboOptions
@@ -55,6 +118,20 @@ namespace kxf
 		// Make sure it's allocated on the heap so it won't cause any issues if the object is moved
 		m_Buffer.reserve(64);
 
+		if (m_Flags.Contains(HTMLDocumentFlag::LazyParse))
+		{
+			// HTMLDocumentNode
+			m_Node = nullptr;
+			m_Document = this;
+
+			m_IsParsePending = true;
+			return true;
+		}
+		return DoParse();
+	}
+	bool HTMLDocument::DoParse()
+	{
+		m_IsParsePending = false;
 		m_ParserOutput = gumbo_parse_with_options(m_ParserOptions.get(), m_Buffer.data(), m_Buffer.size());
 		if (m_ParserOutput)
 		{
@@ -73,6 +150,17 @@ namespace kxf
 			gumbo_destroy_output(m_ParserOptions.get(), CastOutput(m_ParserOutput));
 			m_ParserOutput = nullptr;
 		}
+		for (auto& [begin, subtree]: m_Subtrees)
+		{
+			gumbo_destroy_output(m_ParserOptions.get(), CastOutput(subtree.ParserOutput));
+		}
+		for (Subtree& subtree: m_RetiredSubtrees)
+		{
+			gumbo_destroy_output(m_ParserOptions.get(), CastOutput(subtree.ParserOutput));
+		}
+		m_Subtrees.clear();
+		m_RetiredSubtrees.clear();
+		m_IsParsePending = false;
 		m_Buffer.clear();
 
 		// HTMLDocumentNode
@@ -80,8 +168,137 @@ namespace kxf
 		m_Document = nullptr;
 	}
 
+	HTMLDocument::Subtree* HTMLDocument::DoAddSubtree(const HTML::Private::TagToken& token, size_t end)
+	{
+		// The parser drops the table parts found outside of a table, so they need their context recreated
+		std::string_view context;
+		if (token.Name == "td" || token.Name == "th")
+		{
+			context = "<table><tbody><tr>";
+		}
+		else if (token.Name == "tr")
+		{
+			context = "<table><tbody>";
+		}
+		else if (token.Name == "col")
+		{
+			context = "<table><colgroup>";
+		}
+		else if (token.Name == "tbody" || token.Name == "thead" || token.Name == "tfoot" || token.Name == "caption" || token.Name == "colgroup")
+		{
+			context = "<table>";
+		}
+
+		// The parsed nodes refer to the text they were parsed from, so it's kept alongside. The buffer is kept on the heap
+		// (never in the small string storage) so the subtree can be moved around.
+		Subtree subtree;
+		subtree.Begin = token.Begin;
+		subtree.End = end;
+		subtree.Buffer.reserve(std::max<size_t>(64, context.size() + end - token.Begin));
+		subtree.Buffer.append(context);
+		subtree.Buffer.append(m_Buffer, token.Begin, end - token.Begin);
+
+		subtree.ParserOutput = gumbo_parse_with_options(m_ParserOptions.get(), subtree.Buffer.data(), subtree.Buffer.size());
+		if (!subtree.ParserOutput)
+		{
+			return nullptr;
+		}
+
+		GumboNode* root = FindElementAt(CastOutput(subtree.ParserOutput)->document, context.size());
+		std::string nameBuffer;
+		if (!root || HTML::Private::GetElementName(root, nameBuffer) != token.Name)
+		{
+			gumbo_destroy_output(m_ParserOptions.get(), CastOutput(subtree.ParserOutput));
+			return nullptr;
+		}
+
+		// Make it the root of its own subtree, the rest of the parsed text doesn't belong to it
+		root->parent = nullptr;
+		root->index_within_parent = 0;
+		subtree.Root = root;
+		subtree.RootOffset = context.size();
+
+		// The subtrees this one encloses aren't needed for the lookups anymore, but their nodes can still be in use
+		auto it = m_Subtrees.lower_bound(token.Begin);
+		while (it != m_Subtrees.end() && it->first < end)
+		{
+			m_RetiredSubtrees.emplace_back(std::move(it->second));
+			it = m_Subtrees.erase(it);
+		}
+		return &m_Subtrees.insert_or_assign(token.Begin, std::move(subtree)).first->second;
+	}
+	const void* HTMLDocument::DoParseSubtree(const HTML::Private::TagToken& token, size_t end, const HTMLSelector& selector)
+	{
+		auto FindIn = [&](const Subtree& subtree) -> const void*
+		{
+			GumboNode* node = FindElementAt(static_cast<GumboNode*>(subtree.Root), subtree.RootOffset + token.Begin - subtree.Begin);
+
+			std::string nameBuffer;
+			if (node && HTML::Private::GetElementName(node, nameBuffer) == token.Name && selector.MatchNode(node))
+			{
+				return node;
+			}
+			return nullptr;
+		};
+
+		// An element inside of an already parsed subtree (an enclosing match of this query or any element found by an earlier one)
+		// is taken from there, so the nested matches and the repeated queries don't parse the same text again.
+		if (auto it = m_Subtrees.upper_bound(token.Begin); it != m_Subtrees.begin() && std::prev(it)->second.End >= end)
+		{
+			if (auto node = FindIn(std::prev(it)->second))
+			{
+				return node;
+			}
+		}
+
+		if (const Subtree* subtree = DoAddSubtree(token, end))
+		{
+			return FindIn(*subtree);
+		}
+		return nullptr;
+	}
+	CallbackResult<void> HTMLDocument::DoQuerySelectorSource(const HTMLSelector& selector, CallbackFunction<HTMLDocumentNode> func)
+	{
+		HTML::Private::TagTokenizer tokenizer(m_Buffer);
+		HTML::Private::TagToken token;
+
+		// The elements are parsed and reported one at a time, so a query which stops early doesn't parse the rest of them
+		size_t reportedCount = 0;
+		while (tokenizer.Next(token))
+		{
+			if (!token.IsEndTag && selector.MatchToken(token))
+			{
+				auto node = DoParseSubtree(token, tokenizer.FindElementEnd(token), selector);
+				if (!node)
+				{
+					// The parser disagrees with the scanner, so the rest of the query runs on the whole document. The elements
+					// reported so far are the first ones it finds too, they're skipped.
+					DoParse();
+					QuerySelectorAll(selector, [&](HTMLDocumentNode node)
+					{
+						if (reportedCount != 0)
+						{
+							reportedCount--;
+							return CallbackCommand::Continue;
+						}
+						return func.Invoke(std::move(node)).ShouldTerminate() ? CallbackCommand::Terminate : CallbackCommand::Continue;
+					});
+					return func.Finalize();
+				}
+
+				reportedCount++;
+				if (func.Invoke(HTMLDocumentNode(*this, node)).ShouldTerminate())
+				{
+					break;
+				}
+			}
+		}
+		return func.Finalize();
+	}
+
 	// HTMLDocument
-	HTMLDocument::HTMLDocument()
+	HTMLDocument::HTMLDocument(FlagSet<HTMLDocumentFlag> flags)
+		:m_Flags(flags)
 	{
 		m_ParserOptions = std::make_unique<ImplOptions>(kGumboDefaultOptions, *this);
 	}
@@ -93,7 +310,11 @@ namespace kxf
 	// IXDocument
 	bool HTMLDocument::IsNull() const
 	{
-		if (!m_Buffer.empty() && m_ParserOutput)
+		if (m_IsParsePending)
+		{
+			return m_Buffer.empty();
+		}
+		else if (!m_Buffer.empty() && m_ParserOutput)
 		{
 			return AnyErrorOfType(CastOutput(m_ParserOutput), GUMBO_ERR_PARSER);
 		}
@@ -131,16 +352,31 @@ namespace kxf
 		return SerializeSubtree();
 	}
 
+	bool HTMLDocument::Parse()
+	{
+		if (m_IsParsePending)
+		{
+			return DoParse();
+		}
+		return !IsNull();
+	}
+
 	HTMLDocument& HTMLDocument::operator=(HTMLDocument&& other) noexcept
 	{
+		DoUnload();
+
 		// HTMLDocumentNode
 		m_Node = std::exchange(other.m_Node, nullptr);
-		m_Document = std::exchange(other.m_Document, nullptr);
+		m_Document = std::exchange(other.m_Document, nullptr) ? this : nullptr;
 
 		// HTMLDocument
 		m_Buffer = std::move(other.m_Buffer);
 		m_ParserOptions = std::move(other.m_ParserOptions);
 		m_ParserOutput = std::exchange(other.m_ParserOutput, nullptr);
+		m_Flags = other.m_Flags;
+		m_Subtrees = std::move(other.m_Subtrees);
+		m_RetiredSubtrees = std::move(other.m_RetiredSubtrees);
+		m_IsParsePending = std::exchange(other.m_IsParsePending, false);
 
 		return *this;
 	}
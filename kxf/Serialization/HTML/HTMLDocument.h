@@ -7,13 +7,133 @@ namespace kxf::HTML
 	enum class NodeType;
 	enum class TagType;
 }
+namespace kxf::HTML::Private
+{
+	struct TagToken;
+}
 
 namespace kxf
 {
 	class HTMLDocument;
+	class HTMLDocumentNode;
 
 	class IInputStream;
 	class IOutputStream;
+
+	enum class HTMLDocumentFlag: uint32_t
+	{
+		None = 0,
+
+		// Keep the source text and run the parser only once the document tree is actually needed. CSS selector queries
+		// on the document itself scan the source text instead and parse only the subtrees of the elements they find, one at
+		// a time, reusing the subtrees parsed before for the elements inside of them. Queries which the source text alone
+		// can't answer (combinators, pseudo-classes, the elements the parser can create without a tag, such as 'body' or
+		// 'tbody') parse the whole document.
+		// The nodes found this way belong to their parsed subtree only: the parent and the siblings of its root element
+		// are null and 'GetXPath' starts from it. Call 'Parse' and query again for the nodes of the whole document tree.
+		LazyParse = 1u << 0
+	};
+	kxf_FlagSet_Declare(HTMLDocumentFlag);
+}
+
+namespace kxf
+{
+	// Compiled CSS selector list. Supported are the type, universal, ID and class selectors, the attribute selectors
+	// with all the standard operators and the 'i' flag, the four combinators and the structural pseudo-classes:
+	// ':root', ':empty', ':first-child', ':last-child', ':only-child', ':first-of-type', ':last-of-type', ':only-of-type',
+	// ':nth-child()', ':nth-last-child()', ':nth-of-type()' and ':nth-last-of-type()'.
+	class KXF_API HTMLSelector final
+	{
+		friend class HTMLDocument;
+		friend class HTMLDocumentNode;
+
+		private:
+			enum class Combinator
+			{
+				None = -1,
+
+				Descendant,
+				Child,
+				NextSibling,
+				SubsequentSibling
+			};
+			enum class PseudoClass
+			{
+				Root,
+				Empty,
+				NthChild,
+				NthLastChild,
+				NthOfType,
+				NthLastOfType
+			};
+
+			struct AttributeTest final
+			{
+				std::string Name;
+				std::string Value;
+				char Operator = 0; // Zero to test for presence only, the first character of the operator otherwise
+				bool IgnoreCase = false;
+			};
+			struct PseudoClassTest final
+			{
+				PseudoClass Type = PseudoClass::Root;
+
+				// Matches the elements at (A * n + B)th position for any n >= 0
+				int A = 0;
+				int B = 0;
+			};
+			struct Compound final
+			{
+				// Relation to the previous compound selector of the complex selector
+				Combinator Relation = Combinator::None;
+
+				std::string Tag;
+				std::vector<AttributeTest> Attributes;
+				std::vector<PseudoClassTest> PseudoClasses;
+			};
+			struct Complex final
+			{
+				std::vector<Compound> Items;
+			};
+
+		private:
+			std::vector<Complex> m_Selectors;
+
+		private:
+			void Compile(const String& selector);
+
+			template<class TGetAttribute>
+			static bool MatchCompound(const Compound& compound, std::string_view tagName, TGetAttribute&& getAttribute);
+			static bool MatchComplex(const Complex& complex, size_t index, const void* node);
+
+			// Whether the selectors can be matched against the tags alone, without the knowledge of the tree structure
+			bool CanMatchTokens() const noexcept;
+			bool MatchToken(const HTML::Private::TagToken& token) const;
+			bool MatchNode(const void* node) const;
+
+		public:
+			HTMLSelector() = default;
+			HTMLSelector(const String& selector)
+			{
+				Compile(selector);
+			}
+
+		public:
+			bool IsEmpty() const noexcept
+			{
+				return m_Selectors.empty();
+			}
+
+		public:
+			explicit operator bool() const noexcept
+			{
+				return !IsEmpty();
+			}
+			bool operator!() const noexcept
+			{
+				return IsEmpty();
+			}
+	};
 }
 
 namespace kxf
@@ -106,6 +226,9 @@ namespace kxf
 			// XDocument::ROAttribute
 			std::optional<String> XDocument_QueryAttribute(const String& name) const;
 
+			// HTMLDocumentNode
+			const void* DoGetNode() const;
+
 		public:
 			HTMLDocumentNode() = default;
 		protected:
@@ -158,6 +281,18 @@ namespace kxf
 			}
 			HTMLDocumentNode QueryElementByName(TagType tagType) const;
 			HTMLDocumentNode QueryElementByName(const String& tagName) const;
+
+			// CSS selector queries over the descendants of this node, in document order
+			HTMLDocumentNode QuerySelector(const HTMLSelector& selector) const;
+			HTMLDocumentNode QuerySelector(const String& selector) const
+			{
+				return QuerySelector(HTMLSelector(selector));
+			}
+			CallbackResult<void> QuerySelectorAll(const HTMLSelector& selector, CallbackFunction<HTMLDocumentNode> func) const;
+			CallbackResult<void> QuerySelectorAll(const String& selector, CallbackFunction<HTMLDocumentNode> func) const
+			{
+				return QuerySelectorAll(HTMLSelector(selector), std::move(func));
+			}
 		
 			HTMLDocumentNode GetParent() const;
 			HTMLDocumentNode GetPreviousSibling() const;
@@ -205,19 +340,45 @@ namespace kxf
 		friend class HTMLDocumentNode;
 		friend class HTMLDocumentAttribute;
 
+		private:
+			struct Subtree final
+			{
+				std::string Buffer;
+				void* ParserOutput = nullptr;
+				void* Root = nullptr;
+
+				// Source range of the root element in the document and its offset in the buffer, after the recreated context
+				size_t Begin = 0;
+				size_t End = 0;
+				size_t RootOffset = 0;
+			};
+
 		private:
 			std::string m_Buffer;
 			std::unique_ptr<ImplOptions> m_ParserOptions;
 			void* m_ParserOutput = nullptr;
+			FlagSet<HTMLDocumentFlag> m_Flags;
+
+			// Parsed subtrees of the elements found by the selector queries before the whole document is parsed, by the start
+			// of the element in the source. A subtree which encloses the earlier ones takes their place here, they're kept aside
+			// until the document is unloaded because the nodes found in them can still be in use.
+			std::map<size_t, Subtree> m_Subtrees;
+			std::vector<Subtree> m_RetiredSubtrees;
+			bool m_IsParsePending = false;
 
 		private:
 			bool DoLoad();
+			bool DoParse();
 			void DoUnload();
 
+			Subtree* DoAddSubtree(const HTML::Private::TagToken& token, size_t end);
+			const void* DoParseSubtree(const HTML::Private::TagToken& token, size_t end, const HTMLSelector& selector);
+			CallbackResult<void> DoQuerySelectorSource(const HTMLSelector& selector, CallbackFunction<HTMLDocumentNode> func);
+
 		public:
-			HTMLDocument();
-			HTMLDocument(const String& html)
-				:HTMLDocument()
+			HTMLDocument(FlagSet<HTMLDocumentFlag> flags = {});
+			HTMLDocument(const String& html, FlagSet<HTMLDocumentFlag> flags = {})
+				:HTMLDocument(flags)
 			{
 				LoadDocument(html);
 			}
@@ -241,6 +402,22 @@ namespace kxf
 			bool LoadDocument(const String& html);
 			String SaveDocument() const;
 
+			FlagSet<HTMLDocumentFlag> GetFlags() const noexcept
+			{
+				return m_Flags;
+			}
+			void SetFlags(FlagSet<HTMLDocumentFlag> flags) noexcept
+			{
+				m_Flags = flags;
+			}
+
+			// Parses the whole document if its parsing has been deferred
+			bool IsParsed() const noexcept
+			{
+				return m_ParserOutput != nullptr;
+			}
+			bool Parse();
+
 		public:
 			HTMLDocument& operator=(const HTMLDocument&) = delete;
 			HTMLDocument& operator=(HTMLDocument&& other) noexcept;
@@ -205,7 +205,7 @@ namespace kxf
 		if (m_Attribute && m_Owner)
 		{
 			size_t attributeCount = 0;
-			if (auto attributes = HTML::Private::GetAttributes(CastGumboNode(m_Owner->m_Node), &attributeCount))
+			if (auto attributes = HTML::Private::GetAttributes(CastGumboNode(m_Owner->DoGetNode()), &attributeCount))
 			{
 				for (size_t i = 0; i < attributeCount; i++)
 				{
@@ -246,7 +246,7 @@ namespace kxf
 		if (m_Attribute && m_Owner)
 		{
 			size_t attributeCount = 0;
-			if (auto attributes = HTML::Private::GetAttributes(CastGumboNode(m_Owner->m_Node), &attributeCount))
+			if (auto attributes = HTML::Private::GetAttributes(CastGumboNode(m_Owner->DoGetNode()), &attributeCount))
 			{
 				for (size_t i = 0; i < attributeCount; i++)
 				{
@@ -270,7 +270,7 @@ namespace kxf
 	// XDocument::ROValue
 	std::optional<String> HTMLDocumentNode::XDocument_QueryValue() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			if (HTML::Private::IsFullNode(node))
 			{
@@ -291,7 +291,7 @@ namespace kxf
 	// XDocument::ROAttribute
 	std::optional<String> HTMLDocumentNode::XDocument_QueryAttribute(const String& name) const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			auto attribute = HTML::Private::GetAttribute(node, name);
 			if (attribute && attribute->value)
@@ -302,14 +302,26 @@ namespace kxf
 		return {};
 	}
 
+	// HTMLDocumentNode
+	const void* HTMLDocumentNode::DoGetNode() const
+	{
+		// Only the document itself can be without a node while being valid, if its parsing has been deferred
+		if (!m_Node && m_Document && m_Document->m_IsParsePending)
+		{
+			m_Document->DoParse();
+			return m_Document->m_Node;
+		}
+		return m_Node;
+	}
+
 	// IXDocument
 	bool HTMLDocumentNode::IsNull() const
 	{
-		return !m_Node || !m_Document;
+		return !m_Document || (!m_Node && !m_Document->m_IsParsePending);
 	}
 	String HTMLDocumentNode::GetXPath() const
 	{
-		if (m_Document && m_Node)
+		if (m_Document && DoGetNode())
 		{
 			return XDocument::BacktrackXPath(*m_Document, *this);
 		}
@@ -318,7 +330,7 @@ namespace kxf
 
 	String HTMLDocumentNode::GetName() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			// While the document's root node does have a name, we don't want to return it
 			if (node->type == GumboNodeType::GUMBO_NODE_ELEMENT)
@@ -330,7 +342,7 @@ namespace kxf
 	}
 	size_t HTMLDocumentNode::GetIndexWithinParent() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			return node->index_within_parent;
 		}
@@ -338,7 +350,7 @@ namespace kxf
 	}
 	size_t HTMLDocumentNode::GetRelativeIndexWithinParent() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			if (!node->parent)
 			{
@@ -384,7 +396,7 @@ namespace kxf
 	// HTMLDocumentNode: Navigation
 	HTMLDocumentNode HTMLDocumentNode::QueryElement(const String& xPath) const
 	{
-		if (m_Document && m_Node)
+		if (m_Document && DoGetNode())
 		{
 			HTMLDocumentNode currentNode = *this;
 			HTMLDocumentNode previousNode = currentNode;
@@ -433,32 +445,86 @@ namespace kxf
 	}
 	HTMLDocumentNode HTMLDocumentNode::QueryElementByAttribute(const String& name, const String& value) const
 	{
-		if (m_Document && m_Node)
+		if (m_Document && DoGetNode())
 		{
-			return HTMLDocumentNode(*m_Document, HTML::Private::GetElementByAttribute(CastGumboNode(m_Node), name, value));
+			return HTMLDocumentNode(*m_Document, HTML::Private::GetElementByAttribute(CastGumboNode(DoGetNode()), name, value));
 		}
 		return {};
 	}
 	HTMLDocumentNode HTMLDocumentNode::QueryElementByName(TagType tagType) const
 	{
-		if (m_Document && m_Node)
+		if (m_Document && DoGetNode())
 		{
-			return HTMLDocumentNode(*m_Document, HTML::Private::GetElementByTag(CastGumboNode(m_Node), HTML::Private::GetTagName(static_cast<GumboTag>(tagType))));
+			return HTMLDocumentNode(*m_Document, HTML::Private::GetElementByTag(CastGumboNode(DoGetNode()), HTML::Private::GetTagName(static_cast<GumboTag>(tagType))));
 		}
 		return {};
 	}
 	HTMLDocumentNode HTMLDocumentNode::QueryElementByName(const String& tagName) const
 	{
-		if (m_Document && m_Node)
+		if (m_Document && DoGetNode())
+		{
+			return HTMLDocumentNode(*m_Document, HTML::Private::GetElementByTag(CastGumboNode(DoGetNode()), tagName.ToLower()));
+		}
+		return {};
+	}
+
+	HTMLDocumentNode HTMLDocumentNode::QuerySelector(const HTMLSelector& selector) const
+	{
+		HTMLDocumentNode result;
+		QuerySelectorAll(selector, [&](HTMLDocumentNode node)
+		{
+			result = std::move(node);
+			return CallbackCommand::Terminate;
+		});
+		return result;
+	}
+	CallbackResult<void> HTMLDocumentNode::QuerySelectorAll(const HTMLSelector& selector, CallbackFunction<HTMLDocumentNode> func) const
+	{
+		if (!selector)
+		{
+			return {};
+		}
+
+		// Scan the source text instead of parsing the whole document if possible
+		if (!m_Node && m_Document && m_Document->m_IsParsePending && selector.CanMatchTokens())
 		{
-			return HTMLDocumentNode(*m_Document, HTML::Private::GetElementByTag(CastGumboNode(m_Node), tagName.ToLower()));
+			return m_Document->DoQuerySelectorSource(selector, std::move(func));
+		}
+
+		if (auto root = CastGumboNode(DoGetNode()))
+		{
+			// Pre-order walk over the descendants which never leaves the subtree of 'root'
+			auto Next = [&](const GumboNode* node) -> const GumboNode*
+			{
+				if (auto children = HTML::Private::GetChildren(node); children && children->length != 0)
+				{
+					return HTML::Private::GetNodeAt(children, 0);
+				}
+				for (; node != root && node->parent; node = node->parent)
+				{
+					if (auto siblings = HTML::Private::GetChildren(node->parent); siblings && node->index_within_parent + 1 < siblings->length)
+					{
+						return HTML::Private::GetNodeAt(siblings, node->index_within_parent + 1);
+					}
+				}
+				return nullptr;
+			};
+
+			for (auto node = Next(root); node; node = Next(node))
+			{
+				if (selector.MatchNode(node) && func.Invoke(HTMLDocumentNode(*m_Document, node)).ShouldTerminate())
+				{
+					break;
+				}
+			}
+			return func.Finalize();
 		}
 		return {};
 	}
 
 	HTMLDocumentNode HTMLDocumentNode::GetParent() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			return HTMLDocumentNode(*m_Document, node->parent);
 		}
@@ -466,7 +532,7 @@ namespace kxf
 	}
 	HTMLDocumentNode HTMLDocumentNode::GetPreviousSibling() const
 	{
-		if (auto node = CastGumboNode(m_Node); node && node->parent && node->index_within_parent != npos && node->index_within_parent > 0)
+		if (auto node = CastGumboNode(DoGetNode()); node && node->parent && node->index_within_parent != npos && node->index_within_parent > 0)
 		{
 			if (auto children = HTML::Private::GetChildren(node->parent))
 			{
@@ -477,7 +543,7 @@ namespace kxf
 	}
 	HTMLDocumentNode HTMLDocumentNode::GetPreviousSiblingElement(const String& name) const
 	{
-		if (auto node = CastGumboNode(m_Node); node && node->parent && node->index_within_parent != npos && node->index_within_parent > 0)
+		if (auto node = CastGumboNode(DoGetNode()); node && node->parent && node->index_within_parent != npos && node->index_within_parent > 0)
 		{
 			if (auto children = HTML::Private::GetChildren(node->parent))
 			{
@@ -506,7 +572,7 @@ namespace kxf
 	}
 	HTMLDocumentNode HTMLDocumentNode::GetNextSibling() const
 	{
-		if (auto node = CastGumboNode(m_Node); node && node->parent && node->index_within_parent != npos)
+		if (auto node = CastGumboNode(DoGetNode()); node && node->parent && node->index_within_parent != npos)
 		{
 			auto childCount = HTML::Private::GetChildrenCount(node->parent);
 			if (node->index_within_parent + 1 < childCount)
@@ -526,7 +592,7 @@ namespace kxf
 	}
 	HTMLDocumentNode HTMLDocumentNode::GetNextSiblingElement(const String& name) const
 	{
-		if (auto node = CastGumboNode(m_Node); node && node->parent && node->index_within_parent != npos)
+		if (auto node = CastGumboNode(DoGetNode()); node && node->parent && node->index_within_parent != npos)
 		{
 			if (auto children = HTML::Private::GetChildren(node->parent))
 			{
@@ -548,7 +614,7 @@ namespace kxf
 	}
 	HTMLDocumentNode HTMLDocumentNode::GetFirstChild() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			if (auto children = HTML::Private::GetChildren(node); children && children->length != 0)
 			{
@@ -559,7 +625,7 @@ namespace kxf
 	}
 	HTMLDocumentNode HTMLDocumentNode::GetFirstChildElement(const String& name) const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			if (auto children = HTML::Private::GetChildren(node))
 			{
@@ -581,7 +647,7 @@ namespace kxf
 	}
 	HTMLDocumentNode HTMLDocumentNode::GetLastChild() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			if (auto children = HTML::Private::GetChildren(node); children && children->length != 0)
 			{
@@ -592,7 +658,7 @@ namespace kxf
 	}
 	HTMLDocumentNode HTMLDocumentNode::GetLastChildElement(const String& name) const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			if (auto children = HTML::Private::GetChildren(node); children && children->length != 0)
 			{
@@ -623,7 +689,7 @@ namespace kxf
 	// HTMLDocumentNode: Children
 	size_t HTMLDocumentNode::GetChildrenCount() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			return HTML::Private::GetChildrenCount(node);
 		}
@@ -631,7 +697,7 @@ namespace kxf
 	}
 	CallbackResult<void> HTMLDocumentNode::EnumChildren(CallbackFunction<HTMLDocumentNode> func) const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			if (auto children = HTML::Private::GetChildren(node))
 			{
@@ -651,7 +717,7 @@ namespace kxf
 	// HTMLDocumentNode: Attributes
 	size_t HTMLDocumentNode::GetAttributeCount() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			return HTML::Private::GetAttributeCount(node);
 		}
@@ -659,7 +725,7 @@ namespace kxf
 	}
 	bool HTMLDocumentNode::HasAttribute(const String& name) const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			return HTML::Private::GetAttribute(node, name);
 		}
@@ -668,7 +734,7 @@ namespace kxf
 
 	HTMLDocumentAttribute HTMLDocumentNode::GetAttributeObject(const String& name) const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			return HTMLDocumentAttribute(*this, HTML::Private::GetAttribute(node, name));
 		}
@@ -676,7 +742,7 @@ namespace kxf
 	}
 	CallbackResult<void> HTMLDocumentNode::EnumAttributeNames(CallbackFunction<String> func) const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			size_t attributeCount = 0;
 			if (auto attributes = HTML::Private::GetAttributes(node, &attributeCount))
@@ -695,7 +761,7 @@ namespace kxf
 	}
 	CallbackResult<void> HTMLDocumentNode::EnumAttributes(CallbackFunction<HTMLDocumentAttribute> func) const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			size_t attributeCount = 0;
 			if (auto attributes = HTML::Private::GetAttributes(node, &attributeCount))
@@ -716,7 +782,7 @@ namespace kxf
 	// HTMLDocumentNode: Properties
 	HTML::NodeType HTMLDocumentNode::GetType() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			return static_cast<NodeType>(node->type);
 		}
@@ -724,7 +790,7 @@ namespace kxf
 	}
 	HTML::TagType HTMLDocumentNode::GetTagType() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			switch (node->type)
 			{
@@ -752,11 +818,11 @@ namespace kxf
 	// HTMLDocumentNode: Serialization
 	bool HTMLDocumentNode::SerializeSubtree(IOutputStream& stream) const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
-			if (HTML::Private::IsFullNode(CastGumboNode(m_Node)))
+			if (HTML::Private::IsFullNode(CastGumboNode(DoGetNode())))
 			{
-				auto buffer = HTML::Private::gumbo_ex_serialize(const_cast<GumboNode*>(CastGumboNode(m_Node)));
+				auto buffer = HTML::Private::gumbo_ex_serialize(const_cast<GumboNode*>(CastGumboNode(DoGetNode())));
 				return stream.WriteAll(buffer.data(), buffer.size());
 			}
 			else
@@ -771,7 +837,7 @@ namespace kxf
 	}
 	String HTMLDocumentNode::SerializeSubtree() const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			if (HTML::Private::IsFullNode(node))
 			{
@@ -786,7 +852,7 @@ namespace kxf
 	}
 	String HTMLDocumentNode::SerializeSubtreeText(const String& separator) const
 	{
-		if (auto node = CastGumboNode(m_Node))
+		if (auto node = CastGumboNode(DoGetNode()))
 		{
 			if (node->type == GUMBO_NODE_TEXT)
 			{
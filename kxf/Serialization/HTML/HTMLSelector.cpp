@@ -0,0 +1,793 @@
+#include "kxf-pch.h"
+#include "HTMLDocument.h"
+#include "Private/TagTokenizer.h"
+#include <charconv>
+
+#pragma warning(disable: 4005) // macro redefinition
+#include "gumbo.h"
+
+namespace
+{
+	const GumboNode* CastGumboNode(const void* node) noexcept
+	{
+		return reinterpret_cast<const GumboNode*>(node);
+	}
+
+	bool IsWhitespace(char c) noexcept
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+	}
+	bool IsIdentifierChar(char c) noexcept
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || static_cast<uint8_t>(c) >= 0x80;
+	}
+	char ToLower(char c) noexcept
+	{
+		return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+	}
+	std::string ToLower(std::string value)
+	{
+		std::transform(value.begin(), value.end(), value.begin(), [](char c)
+		{
+			return ToLower(c);
+		});
+		return value;
+	}
+	bool IsSame(std::string_view left, std::string_view right, bool ignoreCase) noexcept
+	{
+		if (ignoreCase)
+		{
+			return left.size() == right.size() && std::equal(left.begin(), left.end(), right.begin(), [](char l, char r)
+			{
+				return ToLower(l) == ToLower(r);
+			});
+		}
+		return left == right;
+	}
+
+	bool MatchAttributeValue(char operation, std::string_view expected, std::string_view value, bool ignoreCase) noexcept
+	{
+		switch (operation)
+		{
+			case 0:
+			{
+				return true;
+			}
+			case '=':
+			{
+				return IsSame(value, expected, ignoreCase);
+			}
+			case '~':
+			{
+				// One of the whitespace separated words, like the class names
+				if (expected.empty())
+				{
+					return false;
+				}
+
+				size_t start = 0;
+				while (start < value.size())
+				{
+					while (start < value.size() && IsWhitespace(value[start]))
+					{
+						start++;
+					}
+					size_t end = start;
+					while (end < value.size() && !IsWhitespace(value[end]))
+					{
+						end++;
+					}
+
+					if (end != start && IsSame(value.substr(start, end - start), expected, ignoreCase))
+					{
+						return true;
+					}
+					start = end;
+				}
+				return false;
+			}
+			case '|':
+			{
+				return IsSame(value, expected, ignoreCase) || (value.size() > expected.size() && value[expected.size()] == '-' && IsSame(value.substr(0, expected.size()), expected, ignoreCase));
+			}
+			case '^':
+			{
+				return !expected.empty() && value.size() >= expected.size() && IsSame(value.substr(0, expected.size()), expected, ignoreCase);
+			}
+			case '$':
+			{
+				return !expected.empty() && value.size() >= expected.size() && IsSame(value.substr(value.size() - expected.size()), expected, ignoreCase);
+			}
+			case '*':
+			{
+				if (expected.empty() || value.size() < expected.size())
+				{
+					return false;
+				}
+				for (size_t i = 0; i + expected.size() <= value.size(); i++)
+				{
+					if (IsSame(value.substr(i, expected.size()), expected, ignoreCase))
+					{
+						return true;
+					}
+				}
+				return false;
+			}
+		};
+		return false;
+	}
+
+	// Parses the argument of the ':nth-*()' pseudo-classes: 'odd', 'even', 'B', 'An' or 'An+B'
+	bool ParseNth(std::string_view text, int& a, int& b)
+	{
+		std::string value;
+		for (char c: text)
+		{
+			if (!IsWhitespace(c))
+			{
+				value += ToLower(c);
+			}
+		}
+
+		if (value == "odd")
+		{
+			a = 2;
+			b = 1;
+			return true;
+		}
+		else if (value == "even")
+		{
+			a = 2;
+			b = 0;
+			return true;
+		}
+
+		auto ParseInt = [](std::string_view text, int& result)
+		{
+			if (!text.empty() && text.front() == '+')
+			{
+				text.remove_prefix(1);
+			}
+			auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), result);
+			return !text.empty() && ec == std::errc() && ptr == text.data() + text.size();
+		};
+
+		const size_t n = value.find('n');
+		if (n == std::string::npos)
+		{
+			a = 0;
+			return ParseInt(value, b);
+		}
+
+		std::string_view aPart = std::string_view(value).substr(0, n);
+		if (aPart.empty() || aPart == "+")
+		{
+			a = 1;
+		}
+		else if (aPart == "-")
+		{
+			a = -1;
+		}
+		else if (!ParseInt(aPart, a))
+		{
+			return false;
+		}
+
+		std::string_view bPart = std::string_view(value).substr(n + 1);
+		if (bPart.empty())
+		{
+			b = 0;
+			return true;
+		}
+		return (bPart.front() == '+' || bPart.front() == '-') && ParseInt(bPart, b);
+	}
+	bool MatchNth(int a, int b, size_t position) noexcept
+	{
+		const int64_t offset = static_cast<int64_t>(position) - b;
+		if (a == 0)
+		{
+			return offset == 0;
+		}
+		return offset / a >= 0 && offset % a == 0;
+	}
+
+	bool IsElement(const GumboNode* node) noexcept
+	{
+		return node->type == GUMBO_NODE_ELEMENT || node->type == GUMBO_NODE_TEMPLATE;
+	}
+	const GumboVector* GetChildren(const GumboNode* node) noexcept
+	{
+		if (node->type == GUMBO_NODE_DOCUMENT)
+		{
+			return &node->v.document.children;
+		}
+		else if (IsElement(node))
+		{
+			return &node->v.element.children;
+		}
+		return nullptr;
+	}
+	const GumboNode* GetParentElement(const GumboNode* node) noexcept
+	{
+		if (node->parent && IsElement(node->parent))
+		{
+			return node->parent;
+		}
+		return nullptr;
+	}
+	const GumboNode* GetPreviousSiblingElement(const GumboNode* node) noexcept
+	{
+		if (auto siblings = node->parent ? GetChildren(node->parent) : nullptr)
+		{
+			for (size_t i = std::min<size_t>(node->index_within_parent, siblings->length); i != 0; i--)
+			{
+				auto sibling = static_cast<const GumboNode*>(siblings->data[i - 1]);
+				if (IsElement(sibling))
+				{
+					return sibling;
+				}
+			}
+		}
+		return nullptr;
+	}
+}
+
+namespace kxf::HTML::Private
+{
+	std::string_view GetElementName(const GumboNode* node, std::string& buffer)
+	{
+		if (node->v.element.tag != GUMBO_TAG_UNKNOWN)
+		{
+			return gumbo_normalized_tagname(node->v.element.tag);
+		}
+
+		GumboStringPiece stringPiece = node->v.element.original_tag;
+		if (stringPiece.data && stringPiece.length != 0)
+		{
+			gumbo_tag_from_original_text(&stringPiece);
+			buffer = ToLower(std::string(stringPiece.data, stringPiece.length));
+			return buffer;
+		}
+		return {};
+	}
+}
+
+namespace
+{
+	// One-based position of the element among its element siblings, optionally counting only the ones with the same name
+	size_t GetElementPosition(const GumboNode* node, bool fromEnd, bool ofType)
+	{
+		auto siblings = node->parent ? GetChildren(node->parent) : nullptr;
+		if (!siblings)
+		{
+			return 1;
+		}
+
+		std::string nameBuffer;
+		std::string siblingNameBuffer;
+		std::string_view name = ofType ? kxf::HTML::Private::GetElementName(node, nameBuffer) : std::string_view();
+
+		size_t position = 1;
+		for (size_t i = 0; i < siblings->length; i++)
+		{
+			auto sibling = static_cast<const GumboNode*>(siblings->data[fromEnd ? siblings->length - i - 1 : i]);
+			if (sibling == node)
+			{
+				break;
+			}
+			else if (IsElement(sibling) && (!ofType || kxf::HTML::Private::GetElementName(sibling, siblingNameBuffer) == name))
+			{
+				position++;
+			}
+		}
+		return position;
+	}
+}
+
+namespace kxf
+{
+	void HTMLSelector::Compile(const String& selector)
+	{
+		m_Selectors.clear();
+
+		const std::string source = selector.ToUTF8();
+		size_t i = 0;
+
+		auto Peek = [&]() -> char
+		{
+			return i < source.size() ? source[i] : 0;
+		};
+		auto SkipWhitespace = [&]()
+		{
+			const size_t start = i;
+			while (i < source.size() && IsWhitespace(source[i]))
+			{
+				i++;
+			}
+			return i != start;
+		};
+		auto ReadIdentifier = [&](std::string& result)
+		{
+			result.clear();
+			while (i < source.size())
+			{
+				if (source[i] == '\\' && i + 1 < source.size())
+				{
+					// Only the plain character escapes
+					result += source[i + 1];
+					i += 2;
+				}
+				else if (IsIdentifierChar(source[i]))
+				{
+					result += source[i++];
+				}
+				else
+				{
+					break;
+				}
+			}
+			return !result.empty();
+		};
+		auto ReadString = [&](std::string& result)
+		{
+			result.clear();
+
+			const char quote = source[i++];
+			while (i < source.size())
+			{
+				if (source[i] == quote)
+				{
+					i++;
+					return true;
+				}
+				else if (source[i] == '\\' && i + 1 < source.size())
+				{
+					result += source[i + 1];
+					i += 2;
+				}
+				else
+				{
+					result += source[i++];
+				}
+			}
+			return false;
+		};
+
+		auto ParseAttribute = [&](Compound& compound)
+		{
+			// We're after the opening bracket
+			AttributeTest& test = compound.Attributes.emplace_back();
+
+			SkipWhitespace();
+			if (!ReadIdentifier(test.Name))
+			{
+				return false;
+			}
+			test.Name = ToLower(std::move(test.Name));
+			SkipWhitespace();
+
+			if (Peek() == ']')
+			{
+				i++;
+				return true;
+			}
+
+			const char c = Peek();
+			if (c == '=')
+			{
+				test.Operator = '=';
+				i++;
+			}
+			else if ((c == '~' || c == '|' || c == '^' || c == '$' || c == '*') && i + 1 < source.size() && source[i + 1] == '=')
+			{
+				test.Operator = c;
+				i += 2;
+			}
+			else
+			{
+				return false;
+			}
+
+			SkipWhitespace();
+			if (Peek() == '"' || Peek() == '\'')
+			{
+				if (!ReadString(test.Value))
+				{
+					return false;
+				}
+			}
+			else if (!ReadIdentifier(test.Value))
+			{
+				return false;
+			}
+			SkipWhitespace();
+
+			if (Peek() == 'i' || Peek() == 'I' || Peek() == 's' || Peek() == 'S')
+			{
+				test.IgnoreCase = ToLower(Peek()) == 'i';
+				i++;
+				SkipWhitespace();
+			}
+
+			if (Peek() == ']')
+			{
+				i++;
+				return true;
+			}
+			return false;
+		};
+		auto ParsePseudoClass = [&](Compound& compound)
+		{
+			// We're after the colon
+			std::string name;
+			if (!ReadIdentifier(name))
+			{
+				return false;
+			}
+			name = ToLower(std::move(name));
+
+			constexpr std::pair<std::string_view, PseudoClass> nthPseudoClasses[] =
+			{
+				{"nth-child", PseudoClass::NthChild},
+				{"nth-last-child", PseudoClass::NthLastChild},
+				{"nth-of-type", PseudoClass::NthOfType},
+				{"nth-last-of-type", PseudoClass::NthLastOfType}
+			};
+			if (auto it = std::find_if(std::begin(nthPseudoClasses), std::end(nthPseudoClasses), [&](const auto& item)
+			{
+				return item.first == name;
+			}); it != std::end(nthPseudoClasses))
+			{
+				if (Peek() != '(')
+				{
+					return false;
+				}
+
+				const size_t end = source.find(')', i);
+				if (end == std::string::npos)
+				{
+					return false;
+				}
+
+				PseudoClassTest& test = compound.PseudoClasses.emplace_back();
+				test.Type = it->second;
+				if (!ParseNth(std::string_view(source).substr(i + 1, end - i - 1), test.A, test.B))
+				{
+					return false;
+				}
+				i = end + 1;
+				return true;
+			}
+
+			auto AddNth = [&](PseudoClass type)
+			{
+				PseudoClassTest& test = compound.PseudoClasses.emplace_back();
+				test.Type = type;
+				test.B = 1;
+			};
+			if (name == "root")
+			{
+				compound.PseudoClasses.emplace_back().Type = PseudoClass::Root;
+			}
+			else if (name == "empty")
+			{
+				compound.PseudoClasses.emplace_back().Type = PseudoClass::Empty;
+			}
+			else if (name == "first-child")
+			{
+				AddNth(PseudoClass::NthChild);
+			}
+			else if (name == "last-child")
+			{
+				AddNth(PseudoClass::NthLastChild);
+			}
+			else if (name == "only-child")
+			{
+				AddNth(PseudoClass::NthChild);
+				AddNth(PseudoClass::NthLastChild);
+			}
+			else if (name == "first-of-type")
+			{
+				AddNth(PseudoClass::NthOfType);
+			}
+			else if (name == "last-of-type")
+			{
+				AddNth(PseudoClass::NthLastOfType);
+			}
+			else if (name == "only-of-type")
+			{
+				AddNth(PseudoClass::NthOfType);
+				AddNth(PseudoClass::NthLastOfType);
+			}
+			else
+			{
+				return false;
+			}
+			return true;
+		};
+		auto ParseCompound = [&](Compound& compound)
+		{
+			bool isEmpty = true;
+			if (Peek() == '*')
+			{
+				i++;
+				isEmpty = false;
+			}
+			else if (IsIdentifierChar(Peek()) || Peek() == '\\')
+			{
+				ReadIdentifier(compound.Tag);
+				compound.Tag = ToLower(std::move(compound.Tag));
+				isEmpty = false;
+			}
+
+			while (i < source.size())
+			{
+				const char c = source[i];
+				if (c == '#' || c == '.')
+				{
+					i++;
+
+					AttributeTest& test = compound.Attributes.emplace_back();
+					test.Name = c == '#' ? "id" : "class";
+					test.Operator = c == '#' ? '=' : '~';
+					if (!ReadIdentifier(test.Value))
+					{
+						return false;
+					}
+				}
+				else if (c == '[')
+				{
+					i++;
+					if (!ParseAttribute(compound))
+					{
+						return false;
+					}
+				}
+				else if (c == ':')
+				{
+					// No pseudo-elements
+					i++;
+					if (Peek() == ':' || !ParsePseudoClass(compound))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					break;
+				}
+				isEmpty = false;
+			}
+			return !isEmpty;
+		};
+
+		std::vector<Complex> selectors;
+		while (true)
+		{
+			Complex& complex = selectors.emplace_back();
+			Combinator relation = Combinator::None;
+
+			while (true)
+			{
+				SkipWhitespace();
+
+				Compound& compound = complex.Items.emplace_back();
+				compound.Relation = relation;
+				if (!ParseCompound(compound))
+				{
+					return;
+				}
+
+				const bool hasWhitespace = SkipWhitespace();
+				const char c = Peek();
+				if (c == '>' || c == '+' || c == '~')
+				{
+					relation = c == '>' ? Combinator::Child : (c == '+' ? Combinator::NextSibling : Combinator::SubsequentSibling);
+					i++;
+				}
+				else if (c == ',' || c == 0)
+				{
+					break;
+				}
+				else if (hasWhitespace)
+				{
+					relation = Combinator::Descendant;
+				}
+				else
+				{
+					return;
+				}
+			}
+
+			if (Peek() == ',')
+			{
+				i++;
+			}
+			else if (i == source.size())
+			{
+				break;
+			}
+			else
+			{
+				return;
+			}
+		}
+		m_Selectors = std::move(selectors);
+	}
+
+	template<class TGetAttribute>
+	bool HTMLSelector::MatchCompound(const Compound& compound, std::string_view tagName, TGetAttribute&& getAttribute)
+	{
+		if (!compound.Tag.empty() && compound.Tag != tagName)
+		{
+			return false;
+		}
+
+		for (const AttributeTest& test: compound.Attributes)
+		{
+			std::optional<std::string_view> value = std::invoke(getAttribute, test.Name);
+			if (!value || !MatchAttributeValue(test.Operator, test.Value, *value, test.IgnoreCase))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	bool HTMLSelector::MatchComplex(const Complex& complex, size_t index, const void* nodePtr)
+	{
+		const GumboNode* node = CastGumboNode(nodePtr);
+		const Compound& compound = complex.Items[index];
+
+		std::string nameBuffer;
+		if (!MatchCompound(compound, HTML::Private::GetElementName(node, nameBuffer), [&](const std::string& name) -> std::optional<std::string_view>
+		{
+			if (auto attribute = gumbo_get_attribute(&node->v.element.attributes, name.c_str()))
+			{
+				return attribute->value;
+			}
+			return {};
+		}))
+		{
+			return false;
+		}
+
+		for (const PseudoClassTest& test: compound.PseudoClasses)
+		{
+			switch (test.Type)
+			{
+				case PseudoClass::Root:
+				{
+					if (!node->parent || node->parent->type != GUMBO_NODE_DOCUMENT)
+					{
+						return false;
+					}
+					break;
+				}
+				case PseudoClass::Empty:
+				{
+					auto children = GetChildren(node);
+					for (size_t i = 0; children && i < children->length; i++)
+					{
+						if (static_cast<const GumboNode*>(children->data[i])->type != GUMBO_NODE_COMMENT)
+						{
+							return false;
+						}
+					}
+					break;
+				}
+				case PseudoClass::NthChild:
+				case PseudoClass::NthLastChild:
+				case PseudoClass::NthOfType:
+				case PseudoClass::NthLastOfType:
+				{
+					const bool fromEnd = test.Type == PseudoClass::NthLastChild || test.Type == PseudoClass::NthLastOfType;
+					const bool ofType = test.Type == PseudoClass::NthOfType || test.Type == PseudoClass::NthLastOfType;
+					if (!MatchNth(test.A, test.B, GetElementPosition(node, fromEnd, ofType)))
+					{
+						return false;
+					}
+					break;
+				}
+			};
+		}
+
+		if (index == 0)
+		{
+			return true;
+		}
+		switch (compound.Relation)
+		{
+			case Combinator::Descendant:
+			{
+				for (auto parent = GetParentElement(node); parent; parent = GetParentElement(parent))
+				{
+					if (MatchComplex(complex, index - 1, parent))
+					{
+						return true;
+					}
+				}
+				return false;
+			}
+			case Combinator::Child:
+			{
+				auto parent = GetParentElement(node);
+				return parent && MatchComplex(complex, index - 1, parent);
+			}
+			case Combinator::NextSibling:
+			{
+				auto sibling = GetPreviousSiblingElement(node);
+				return sibling && MatchComplex(complex, index - 1, sibling);
+			}
+			case Combinator::SubsequentSibling:
+			{
+				for (auto sibling = GetPreviousSiblingElement(node); sibling; sibling = GetPreviousSiblingElement(sibling))
+				{
+					if (MatchComplex(complex, index - 1, sibling))
+					{
+						return true;
+					}
+				}
+				return false;
+			}
+		};
+		return false;
+	}
+
+	bool HTMLSelector::CanMatchTokens() const noexcept
+	{
+		return !m_Selectors.empty() && std::all_of(m_Selectors.begin(), m_Selectors.end(), [](const Complex& complex)
+		{
+			if (complex.Items.size() != 1)
+			{
+				return false;
+			}
+
+			const Compound& compound = complex.Items.front();
+			if (!compound.PseudoClasses.empty())
+			{
+				return false;
+			}
+
+			// The parser creates some elements without a tag in the source, these have no attributes. Without the tag name
+			// or any attribute test the compound matches all the elements, including such implied ones.
+			if (compound.Tag.empty())
+			{
+				return !compound.Attributes.empty();
+			}
+			for (std::string_view name: {"html", "head", "body", "tbody", "tr", "colgroup"})
+			{
+				if (compound.Tag == name)
+				{
+					return false;
+				}
+			}
+			return true;
+		});
+	}
+	bool HTMLSelector::MatchToken(const HTML::Private::TagToken& token) const
+	{
+		return std::any_of(m_Selectors.begin(), m_Selectors.end(), [&](const Complex& complex)
+		{
+			return MatchCompound(complex.Items.front(), token.Name, [&](const std::string& name) -> std::optional<std::string_view>
+			{
+				if (auto value = token.FindAttribute(name))
+				{
+					return *value;
+				}
+				return {};
+			});
+		});
+	}
+	bool HTMLSelector::MatchNode(const void* node) const
+	{
+		if (!IsElement(CastGumboNode(node)))
+		{
+			return false;
+		}
+
+		return std::any_of(m_Selectors.begin(), m_Selectors.end(), [&](const Complex& complex)
+		{
+			return MatchComplex(complex, complex.Items.size() - 1, node);
+		});
+	}
+}
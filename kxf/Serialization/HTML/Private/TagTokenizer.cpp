@@ -0,0 +1,377 @@
+#include "kxf-pch.h"
+#include "TagTokenizer.h"
+#include <charconv>
+
+namespace
+{
+	bool IsWhitespace(char c) noexcept
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+	}
+	bool IsAlpha(char c) noexcept
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+	}
+	char ToLower(char c) noexcept
+	{
+		return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+	}
+	bool IsSameNoCase(std::string_view left, std::string_view right) noexcept
+	{
+		return left.size() == right.size() && std::equal(left.begin(), left.end(), right.begin(), [](char l, char r)
+		{
+			return ToLower(l) == ToLower(r);
+		});
+	}
+
+	void AppendUTF8(std::string& result, uint32_t c)
+	{
+		if (c == 0 || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+		{
+			c = 0xFFFD;
+		}
+
+		if (c < 0x80)
+		{
+			result += static_cast<char>(c);
+		}
+		else if (c < 0x800)
+		{
+			result += static_cast<char>(0xC0 | (c >> 6));
+			result += static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000)
+		{
+			result += static_cast<char>(0xE0 | (c >> 12));
+			result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			result += static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			result += static_cast<char>(0xF0 | (c >> 18));
+			result += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+			result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			result += static_cast<char>(0x80 | (c & 0x3F));
+		}
+	}
+
+	// Only the numeric and the most common named references, anything else is kept as is
+	std::string DecodeCharacterReferences(std::string_view value)
+	{
+		if (value.find('&') == std::string_view::npos)
+		{
+			return std::string(value);
+		}
+
+		std::string result;
+		result.reserve(value.size());
+		for (size_t i = 0; i < value.size(); i++)
+		{
+			if (value[i] != '&')
+			{
+				result += value[i];
+				continue;
+			}
+
+			const size_t end = value.find(';', i);
+			if (end == std::string_view::npos || end - i > 10)
+			{
+				result += value[i];
+				continue;
+			}
+
+			std::string_view name = value.substr(i + 1, end - i - 1);
+			if (name.size() > 1 && name[0] == '#')
+			{
+				int base = 10;
+				name.remove_prefix(1);
+				if (name[0] == 'x' || name[0] == 'X')
+				{
+					base = 16;
+					name.remove_prefix(1);
+				}
+
+				uint32_t c = 0;
+				if (auto [ptr, ec] = std::from_chars(name.data(), name.data() + name.size(), c, base); ec == std::errc() && ptr == name.data() + name.size())
+				{
+					AppendUTF8(result, c);
+					i = end;
+					continue;
+				}
+			}
+			else
+			{
+				constexpr std::pair<std::string_view, char> references[] =
+				{
+					{"amp", '&'},
+					{"lt", '<'},
+					{"gt", '>'},
+					{"quot", '"'},
+					{"apos", '\''}
+				};
+				auto it = std::find_if(std::begin(references), std::end(references), [&](const auto& item)
+				{
+					return item.first == name;
+				});
+				if (it != std::end(references))
+				{
+					result += it->second;
+					i = end;
+					continue;
+				}
+			}
+			result += value[i];
+		}
+		return result;
+	}
+}
+
+namespace kxf::HTML::Private
+{
+	bool TagTokenizer::IsVoidElement(std::string_view name) noexcept
+	{
+		constexpr std::string_view elements[] =
+		{
+			"area", "base", "basefont", "bgsound", "br", "col", "embed", "frame", "hr", "image", "img",
+			"input", "keygen", "link", "meta", "param", "source", "track", "wbr"
+		};
+		return std::find(std::begin(elements), std::end(elements), name) != std::end(elements);
+	}
+	bool TagTokenizer::IsRawTextElement(std::string_view name) noexcept
+	{
+		constexpr std::string_view elements[] =
+		{
+			"script", "style", "textarea", "title", "xmp", "iframe", "noembed", "noframes", "plaintext"
+		};
+		return std::find(std::begin(elements), std::end(elements), name) != std::end(elements);
+	}
+
+	void TagTokenizer::SkipRawText()
+	{
+		if (m_RawTextElement == "plaintext")
+		{
+			m_Position = m_Buffer.size();
+		}
+		else
+		{
+			// The contents end at the first matching end tag, no matter what's inside
+			while (m_Position < m_Buffer.size())
+			{
+				const size_t index = m_Buffer.find("</", m_Position);
+				if (index == std::string_view::npos)
+				{
+					m_Position = m_Buffer.size();
+					break;
+				}
+
+				const size_t nameEnd = index + 2 + m_RawTextElement.size();
+				if (nameEnd <= m_Buffer.size() && IsSameNoCase(m_Buffer.substr(index + 2, m_RawTextElement.size()), m_RawTextElement))
+				{
+					if (nameEnd == m_Buffer.size() || IsWhitespace(m_Buffer[nameEnd]) || m_Buffer[nameEnd] == '/' || m_Buffer[nameEnd] == '>')
+					{
+						m_Position = index;
+						break;
+					}
+				}
+				m_Position = index + 2;
+			}
+		}
+		m_RawTextElement.clear();
+	}
+	void TagTokenizer::ReadAttributes(TagToken& token)
+	{
+		while (m_Position < m_Buffer.size())
+		{
+			const char c = m_Buffer[m_Position];
+			if (c == '>')
+			{
+				m_Position++;
+				return;
+			}
+			else if (c == '/')
+			{
+				m_Position++;
+				if (m_Position < m_Buffer.size() && m_Buffer[m_Position] == '>')
+				{
+					token.IsSelfClosing = true;
+				}
+				continue;
+			}
+			else if (IsWhitespace(c))
+			{
+				m_Position++;
+				continue;
+			}
+
+			// Attribute name, the first character can be anything else including '='
+			const size_t nameStart = m_Position++;
+			while (m_Position < m_Buffer.size())
+			{
+				const char c = m_Buffer[m_Position];
+				if (IsWhitespace(c) || c == '/' || c == '>' || c == '=')
+				{
+					break;
+				}
+				m_Position++;
+			}
+
+			std::string name(m_Buffer.substr(nameStart, m_Position - nameStart));
+			std::transform(name.begin(), name.end(), name.begin(), ToLower);
+
+			while (m_Position < m_Buffer.size() && IsWhitespace(m_Buffer[m_Position]))
+			{
+				m_Position++;
+			}
+
+			std::string_view value;
+			if (m_Position < m_Buffer.size() && m_Buffer[m_Position] == '=')
+			{
+				m_Position++;
+				while (m_Position < m_Buffer.size() && IsWhitespace(m_Buffer[m_Position]))
+				{
+					m_Position++;
+				}
+
+				if (m_Position < m_Buffer.size() && (m_Buffer[m_Position] == '"' || m_Buffer[m_Position] == '\''))
+				{
+					const char quote = m_Buffer[m_Position++];
+					const size_t valueEnd = std::min(m_Buffer.find(quote, m_Position), m_Buffer.size());
+
+					value = m_Buffer.substr(m_Position, valueEnd - m_Position);
+					m_Position = std::min(valueEnd + 1, m_Buffer.size());
+				}
+				else
+				{
+					const size_t valueStart = m_Position;
+					while (m_Position < m_Buffer.size() && !IsWhitespace(m_Buffer[m_Position]) && m_Buffer[m_Position] != '>')
+					{
+						m_Position++;
+					}
+					value = m_Buffer.substr(valueStart, m_Position - valueStart);
+				}
+			}
+
+			// Only the first one counts if an attribute is repeated
+			if (!token.FindAttribute(name))
+			{
+				token.Attributes.emplace_back(std::move(name), DecodeCharacterReferences(value));
+			}
+		}
+	}
+
+	bool TagTokenizer::Next(TagToken& token)
+	{
+		if (!m_RawTextElement.empty())
+		{
+			SkipRawText();
+		}
+
+		while (m_Position < m_Buffer.size())
+		{
+			const size_t begin = m_Buffer.find('<', m_Position);
+			if (begin == std::string_view::npos || begin + 1 >= m_Buffer.size())
+			{
+				break;
+			}
+
+			std::string_view rest = m_Buffer.substr(begin + 1);
+			if (rest.starts_with("!--"))
+			{
+				const size_t end = m_Buffer.find("-->", begin + 4);
+				m_Position = end != std::string_view::npos ? end + 3 : m_Buffer.size();
+			}
+			else if (rest[0] == '!' || rest[0] == '?')
+			{
+				// Doctype and the bogus comments
+				const size_t end = m_Buffer.find('>', begin + 2);
+				m_Position = end != std::string_view::npos ? end + 1 : m_Buffer.size();
+			}
+			else if (IsAlpha(rest[0]) || (rest[0] == '/' && rest.size() > 1 && IsAlpha(rest[1])))
+			{
+				token.Name.clear();
+				token.Attributes.clear();
+				token.Begin = begin;
+				token.IsEndTag = rest[0] == '/';
+				token.IsSelfClosing = false;
+
+				m_Position = begin + (token.IsEndTag ? 2 : 1);
+				while (m_Position < m_Buffer.size())
+				{
+					const char c = m_Buffer[m_Position];
+					if (IsWhitespace(c) || c == '/' || c == '>')
+					{
+						break;
+					}
+					token.Name += ToLower(c);
+					m_Position++;
+				}
+
+				// The parser renames it to 'img', the token is named after the element it becomes
+				if (token.Name == "image")
+				{
+					token.Name = "img";
+				}
+
+				if (token.IsEndTag)
+				{
+					const size_t end = m_Buffer.find('>', m_Position);
+					m_Position = end != std::string_view::npos ? end + 1 : m_Buffer.size();
+				}
+				else
+				{
+					ReadAttributes(token);
+					if (IsRawTextElement(token.Name))
+					{
+						m_RawTextElement = token.Name;
+					}
+				}
+				token.End = m_Position;
+
+				return true;
+			}
+			else
+			{
+				// Just a text
+				m_Position = begin + 1;
+			}
+		}
+
+		m_Position = m_Buffer.size();
+		return false;
+	}
+	size_t TagTokenizer::FindElementEnd(const TagToken& token) const
+	{
+		if (token.IsEndTag || IsVoidElement(token.Name))
+		{
+			return token.End;
+		}
+
+		// Self-closing syntax has no effect on the HTML elements so it isn't taken into account here
+		TagTokenizer tokenizer(m_Buffer, token.End);
+		if (IsRawTextElement(token.Name))
+		{
+			tokenizer.m_RawTextElement = token.Name;
+		}
+
+		size_t depth = 1;
+		TagToken item;
+		while (tokenizer.Next(item))
+		{
+			if (item.Name == token.Name)
+			{
+				if (item.IsEndTag)
+				{
+					if (--depth == 0)
+					{
+						return item.End;
+					}
+				}
+				else
+				{
+					depth++;
+				}
+			}
+		}
+		return m_Buffer.size();
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "kxf/Serialization/Common.h"
+
+namespace kxf::HTML::Private
+{
+	struct TagToken final
+	{
+		// Lower case name and the attributes with lower case names and decoded values, in source order
+		std::string Name;
+		std::vector<std::pair<std::string, std::string>> Attributes;
+
+		// Source range of the tag itself
+		size_t Begin = 0;
+		size_t End = 0;
+
+		bool IsEndTag = false;
+		bool IsSelfClosing = false;
+
+		const std::string* FindAttribute(std::string_view name) const noexcept
+		{
+			for (const auto& [attributeName, value]: Attributes)
+			{
+				if (attributeName == name)
+				{
+					return &value;
+				}
+			}
+			return nullptr;
+		}
+	};
+
+	// Forward-only scanner of the start and end tags of an HTML buffer. It skips the text, comments, doctype and the
+	// contents of the raw text elements (script, style and alike) but doesn't build any tree and doesn't apply any
+	// of the HTML tree construction rules, so it's much cheaper than the full parser.
+	class TagTokenizer final
+	{
+		public:
+			static bool IsVoidElement(std::string_view name) noexcept;
+			static bool IsRawTextElement(std::string_view name) noexcept;
+
+		private:
+			std::string_view m_Buffer;
+			size_t m_Position = 0;
+			std::string m_RawTextElement;
+
+		private:
+			void SkipRawText();
+			void ReadAttributes(TagToken& token);
+
+		public:
+			TagTokenizer(std::string_view buffer, size_t position = 0) noexcept
+				:m_Buffer(buffer), m_Position(position)
+			{
+			}
+
+		public:
+			bool Next(TagToken& token);
+
+			// Finds the end of the source range of the element started by 'token', including its end tag if it has one.
+			// Elements closed implicitly extend up to the end tag of the same name which balances them or up to the end of the buffer.
+			size_t FindElementEnd(const TagToken& token) const;
+
+			size_t GetPosition() const noexcept
+			{
+				return m_Position;
+			}
+	};
+}
@@ -3,6 +3,9 @@
 #include "kxf/Core/ILibraryInfo.h"
 #include "kxf/IO/MemoryStream.h"
 #include "kxf/Serialization/StringTokenizer.h"
+#include "kxf/Serialization/BinarySerializer.h"
+#include "kxf/Serialization/Private/CompiledDocument.h"
+#include "kxf/Serialization/Private/IncrementalSave.h"
 #include "kxf/Utility/SoftwareLicenseDB.h"
 
 namespace SimpleINI
@@ -17,6 +20,10 @@ namespace
 	constexpr int g_VersionPatch = 0;
 
 	constexpr char g_EscapeCharacters[] = "\"=";
+
+	constexpr uint32_t g_CompiledFormat = 0x494e4900; // 'INI'
+	constexpr uint32_t g_CompiledVersion = 1;
+	constexpr uint32_t g_JournalFormat = 0x494e4900; // 'INI'
 }
 
 namespace kxf
@@ -102,6 +109,669 @@ namespace kxf
 				return {};
 			}
 	};
+
+	// Flat image of a parsed document: a header, the section table, the key table and the string data. Sections and keys
+	// are sorted case insensitively, the same way SimpleIni compares them, keys are grouped by section and the duplicates
+	// of a key keep their load order. The text of the document is stored as well to recreate the SimpleIni representation.
+	class INICompiledDocument final
+	{
+		private:
+			struct Header final
+			{
+				uint32_t SectionCount = 0;
+				uint32_t KeyCount = 0;
+				uint32_t Options = 0;
+				uint32_t Reserved = 0;
+				uint64_t StringsSize = 0;
+				uint64_t SourceOffset = 0;
+				uint64_t SourceSize = 0;
+			};
+			struct Section final
+			{
+				uint32_t NameOffset = 0;
+				uint32_t NameLength = 0;
+				uint32_t FirstKey = 0;
+				uint32_t KeyCount = 0;
+			};
+			struct Key final
+			{
+				uint32_t NameOffset = 0;
+				uint32_t NameLength = 0;
+				uint32_t ValueOffset = 0;
+				uint32_t ValueLength = 0;
+			};
+			static_assert(sizeof(Header) % alignof(Section) == 0 && sizeof(Section) % alignof(Key) == 0);
+
+		public:
+			// SimpleIni only folds the ASCII letters
+			static int Compare(std::string_view left, std::string_view right) noexcept
+			{
+				auto ToLower = [](char c) -> uint8_t
+				{
+					return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : static_cast<uint8_t>(c);
+				};
+
+				const size_t length = std::min(left.length(), right.length());
+				for (size_t i = 0; i < length; i++)
+				{
+					const uint8_t l = ToLower(left[i]);
+					const uint8_t r = ToLower(right[i]);
+					if (l != r)
+					{
+						return l < r ? -1 : 1;
+					}
+				}
+				return left.length() == right.length() ? 0 : (left.length() < right.length() ? -1 : 1);
+			}
+
+			static std::vector<std::byte> Build(const INIDocumentImpl& document, FlagSet<INIDocumentOption> options)
+			{
+				struct KeyItem final
+				{
+					std::string_view Name;
+					std::string_view Value;
+				};
+				struct SectionItem final
+				{
+					std::string_view Name;
+					std::vector<KeyItem> Keys;
+				};
+
+				INIDocumentImpl::TNamesDepend sectionNames;
+				document.GetAllSections(sectionNames);
+
+				std::vector<SectionItem> sections;
+				sections.reserve(sectionNames.size());
+
+				size_t keyCount = 0;
+				for (const auto& sectionName: sectionNames)
+				{
+					SectionItem& section = sections.emplace_back();
+					section.Name = sectionName.pItem;
+
+					if (auto keys = document.GetSection(sectionName.pItem))
+					{
+						section.Keys.reserve(keys->size());
+						for (const auto& [name, value]: *keys)
+						{
+							section.Keys.emplace_back(KeyItem{name.pItem, value ? value : ""});
+						}
+
+						// Stable sort keeps the load order of the duplicate keys
+						std::stable_sort(section.Keys.begin(), section.Keys.end(), [](const KeyItem& left, const KeyItem& right)
+						{
+							return Compare(left.Name, right.Name) < 0;
+						});
+						keyCount += section.Keys.size();
+					}
+				}
+				std::sort(sections.begin(), sections.end(), [](const SectionItem& left, const SectionItem& right)
+				{
+					return Compare(left.Name, right.Name) < 0;
+				});
+
+				std::string source;
+				document.Save(source, false);
+
+				// Lay out the strings first, the tables refer to them with 32-bit offsets
+				std::string strings;
+				auto AddString = [&](std::string_view value, uint32_t& offset, uint32_t& length)
+				{
+					offset = static_cast<uint32_t>(strings.size());
+					length = static_cast<uint32_t>(value.size());
+					strings.append(value);
+				};
+
+				std::vector<Section> sectionTable;
+				std::vector<Key> keyTable;
+				sectionTable.reserve(sections.size());
+				keyTable.reserve(keyCount);
+
+				for (const SectionItem& sectionItem: sections)
+				{
+					Section& section = sectionTable.emplace_back();
+					AddString(sectionItem.Name, section.NameOffset, section.NameLength);
+					section.FirstKey = static_cast<uint32_t>(keyTable.size());
+					section.KeyCount = static_cast<uint32_t>(sectionItem.Keys.size());
+
+					for (const KeyItem& keyItem: sectionItem.Keys)
+					{
+						Key& key = keyTable.emplace_back();
+						AddString(keyItem.Name, key.NameOffset, key.NameLength);
+						AddString(keyItem.Value, key.ValueOffset, key.ValueLength);
+					}
+				}
+				if (strings.size() > std::numeric_limits<uint32_t>::max())
+				{
+					return {};
+				}
+
+				Header header;
+				header.SectionCount = static_cast<uint32_t>(sectionTable.size());
+				header.KeyCount = static_cast<uint32_t>(keyTable.size());
+				header.Options = options.ToInt();
+				header.SourceOffset = strings.size();
+				header.SourceSize = source.size();
+				header.StringsSize = strings.size() + source.size();
+
+				std::vector<std::byte> data;
+				data.resize(sizeof(Header) + sectionTable.size() * sizeof(Section) + keyTable.size() * sizeof(Key) + header.StringsSize);
+
+				std::byte* ptr = data.data();
+				auto Append = [&](const void* buffer, size_t size)
+				{
+					if (size != 0)
+					{
+						std::memcpy(ptr, buffer, size);
+						ptr += size;
+					}
+				};
+				Append(&header, sizeof(header));
+				Append(sectionTable.data(), sectionTable.size() * sizeof(Section));
+				Append(keyTable.data(), keyTable.size() * sizeof(Key));
+				Append(strings.data(), strings.size());
+				Append(source.data(), source.size());
+
+				return data;
+			}
+
+		private:
+			std::vector<std::byte> m_Data;
+			const Header* m_Header = nullptr;
+			const Section* m_Sections = nullptr;
+			const Key* m_Keys = nullptr;
+			const char* m_Strings = nullptr;
+
+		private:
+			std::string_view GetString(uint32_t offset, uint32_t length) const noexcept
+			{
+				return {m_Strings + offset, length};
+			}
+
+		public:
+			// Validates the layout, the data has already been checked against its hash but it could have been produced by a broken writer
+			bool Open(std::vector<std::byte> data)
+			{
+				if (data.size() < sizeof(Header))
+				{
+					return false;
+				}
+
+				const Header* header = reinterpret_cast<const Header*>(data.data());
+				const uint64_t tablesSize = sizeof(Header) + uint64_t(header->SectionCount) * sizeof(Section) + uint64_t(header->KeyCount) * sizeof(Key);
+				if (tablesSize > data.size() || data.size() - tablesSize != header->StringsSize)
+				{
+					return false;
+				}
+				if (header->SourceOffset > header->StringsSize || header->StringsSize - header->SourceOffset < header->SourceSize)
+				{
+					return false;
+				}
+
+				auto sections = reinterpret_cast<const Section*>(data.data() + sizeof(Header));
+				auto keys = reinterpret_cast<const Key*>(sections + header->SectionCount);
+				auto IsValidString = [&](uint32_t offset, uint32_t length)
+				{
+					return uint64_t(offset) + length <= header->StringsSize;
+				};
+
+				for (uint32_t i = 0; i < header->SectionCount; i++)
+				{
+					const Section& section = sections[i];
+					if (!IsValidString(section.NameOffset, section.NameLength) || uint64_t(section.FirstKey) + section.KeyCount > header->KeyCount)
+					{
+						return false;
+					}
+				}
+				for (uint32_t i = 0; i < header->KeyCount; i++)
+				{
+					const Key& key = keys[i];
+					if (!IsValidString(key.NameOffset, key.NameLength) || !IsValidString(key.ValueOffset, key.ValueLength))
+					{
+						return false;
+					}
+				}
+
+				m_Data = std::move(data);
+				m_Header = reinterpret_cast<const Header*>(m_Data.data());
+				m_Sections = reinterpret_cast<const Section*>(m_Data.data() + sizeof(Header));
+				m_Keys = reinterpret_cast<const Key*>(m_Sections + m_Header->SectionCount);
+				m_Strings = reinterpret_cast<const char*>(m_Keys + m_Header->KeyCount);
+
+				return true;
+			}
+
+			std::span<const std::byte> GetData() const noexcept
+			{
+				return m_Data;
+			}
+			FlagSet<INIDocumentOption> GetOptions() const noexcept
+			{
+				return FlagSet<INIDocumentOption>().FromInt(m_Header->Options);
+			}
+			std::string_view GetSource() const noexcept
+			{
+				return {m_Strings + m_Header->SourceOffset, static_cast<size_t>(m_Header->SourceSize)};
+			}
+			size_t GetSectionCount() const noexcept
+			{
+				return m_Header->SectionCount;
+			}
+
+			const Section* FindSection(std::string_view name) const noexcept
+			{
+				auto end = m_Sections + m_Header->SectionCount;
+				auto it = std::lower_bound(m_Sections, end, name, [&](const Section& section, std::string_view name)
+				{
+					return Compare(GetString(section.NameOffset, section.NameLength), name) < 0;
+				});
+				if (it != end && Compare(GetString(it->NameOffset, it->NameLength), name) == 0)
+				{
+					return it;
+				}
+				return nullptr;
+			}
+			std::optional<std::string_view> FindValue(std::string_view sectionName, std::string_view keyName) const noexcept
+			{
+				if (auto section = FindSection(sectionName))
+				{
+					// The first one in load order if the key is duplicated, like SimpleIni does
+					auto begin = m_Keys + section->FirstKey;
+					auto end = begin + section->KeyCount;
+					auto it = std::lower_bound(begin, end, keyName, [&](const Key& key, std::string_view name)
+					{
+						return Compare(GetString(key.NameOffset, key.NameLength), name) < 0;
+					});
+					if (it != end && Compare(GetString(it->NameOffset, it->NameLength), keyName) == 0)
+					{
+						return GetString(it->ValueOffset, it->ValueLength);
+					}
+				}
+				return {};
+			}
+	};
+}
+
+namespace kxf
+{
+	// Ordered log of the modifications made since the last incremental save and the positions of the key lines in the image
+	// written by the last full or patch save. The log keeps the exact SimpleIni calls, so the journal replays them in the same
+	// order, consecutive assignments of the same key are merged into one.
+	class INIChangeTracker final
+	{
+		private:
+			enum class OperationType: uint8_t
+			{
+				Reset,
+				SetValue,
+				Delete
+			};
+			struct Operation final
+			{
+				OperationType Type = OperationType::SetValue;
+				bool RemoveEmpty = false;
+
+				std::string Section;
+				std::string Key;
+				std::string Value;
+				std::string Comment;
+			};
+			struct Line final
+			{
+				uint64_t Offset = 0;
+				size_t Capacity = 0;
+				bool IsUnique = true;
+			};
+
+		private:
+			static std::string_view Trim(std::string_view value) noexcept
+			{
+				constexpr std::string_view whitespace = " \t\r\n";
+
+				const size_t begin = value.find_first_not_of(whitespace);
+				if (begin == std::string_view::npos)
+				{
+					return {};
+				}
+				return value.substr(begin, value.find_last_not_of(whitespace) - begin + 1);
+			}
+			static std::string MakeKey(std::string_view sectionName, std::string_view keyName)
+			{
+				// Same case folding as SimpleIni does
+				std::string key;
+				key.reserve(sectionName.size() + keyName.size() + 1);
+				key.append(sectionName);
+				key.push_back('\n');
+				key.append(keyName);
+
+				for (char& c: key)
+				{
+					if (c >= 'A' && c <= 'Z')
+					{
+						c = c - 'A' + 'a';
+					}
+				}
+				return key;
+			}
+			static const char* ToArgument(const std::string& value) noexcept
+			{
+				return !value.empty() ? value.c_str() : nullptr;
+			}
+
+			static std::string GetImage(const INIDocument& document)
+			{
+				if (document.m_Compiled)
+				{
+					return std::string(document.m_Compiled->GetSource());
+				}
+
+				std::string buffer;
+				document.m_Document->Save(buffer, false);
+				return buffer;
+			}
+			static std::optional<std::string> PrintLine(const INIDocumentImpl& document, const std::string& sectionName, const std::string& keyName)
+			{
+				INIDocumentImpl::TNamesDepend values;
+				if (!document.GetAllValues(sectionName.c_str(), keyName.c_str(), values) || values.size() != 1)
+				{
+					return {};
+				}
+
+				// Print the key the same way the whole document is printed, with its original name
+				auto keys = document.GetSection(sectionName.c_str());
+				auto it = keys->find(INIDocumentImpl::Entry(keyName.c_str()));
+
+				INIDocumentImpl line;
+				line.SetUnicode(true);
+				line.SetMultiLine(false);
+				line.SetSpaces(document.UsingSpaces());
+				line.SetQuotes(document.UsingQuotes());
+				line.SetValue("", it->first.pItem, values.front().pItem, nullptr, true);
+
+				std::string buffer;
+				line.Save(buffer, false);
+
+				auto text = Trim(buffer);
+				if (text.find_first_of("\r\n") != std::string_view::npos)
+				{
+					return {};
+				}
+				return std::string(text);
+			}
+
+		private:
+			std::vector<Operation> m_Operations;
+			std::unordered_map<std::string, size_t> m_PendingValues;
+
+			// Anything a patch can't express: a reset, removed keys or sections, sections and comments and the changed options
+			bool m_StructureChanged = false;
+
+			std::unordered_map<std::string, Line> m_Layout;
+			uint64_t m_ImageSize = 0;
+			bool m_HasImage = false;
+
+			// A torn batch ends the journal, nothing can be appended after it until the next full save
+			bool m_IsJournalTorn = false;
+
+		private:
+			void BuildLayout(std::string_view image)
+			{
+				m_Layout.clear();
+
+				std::string_view sectionName;
+				size_t offset = 0;
+				while (offset < image.size())
+				{
+					size_t end = image.find('\n', offset);
+					if (end == std::string_view::npos)
+					{
+						end = image.size();
+					}
+
+					std::string_view line = image.substr(offset, end - offset);
+					if (!line.empty() && line.back() == '\r')
+					{
+						line.remove_suffix(1);
+					}
+
+					const std::string_view content = Trim(line);
+					if (content.empty() || content.front() == ';' || content.front() == '#')
+					{
+						// Empty line or a comment
+					}
+					else if (content.front() == '[')
+					{
+						const size_t close = content.find(']');
+						sectionName = Trim(content.substr(1, close != std::string_view::npos ? close - 1 : std::string_view::npos));
+					}
+					else if (const size_t separator = content.find('='); separator != std::string_view::npos)
+					{
+						// Duplicate keys are written on several lines and can't be patched one by one
+						auto [it, inserted] = m_Layout.try_emplace(MakeKey(sectionName, Trim(content.substr(0, separator))), Line{offset, line.size()});
+						if (!inserted)
+						{
+							it->second.IsUnique = false;
+						}
+					}
+					offset = end + 1;
+				}
+			}
+			void OnSaved() noexcept
+			{
+				m_Operations.clear();
+				m_PendingValues.clear();
+				m_StructureChanged = false;
+			}
+
+		public:
+			bool IsModified() const noexcept
+			{
+				return m_StructureChanged || !m_Operations.empty();
+			}
+
+			// Notifications from the mutating operations, called after a successful call to SimpleIni with the same arguments
+			void OnValueSet(const char* sectionName, const char* keyName, const char* value, const char* comment)
+			{
+				Operation operation;
+				operation.Type = OperationType::SetValue;
+				operation.Section = sectionName ? sectionName : "";
+				operation.Key = keyName ? keyName : "";
+				operation.Value = value ? value : "";
+				operation.Comment = comment ? comment : "";
+
+				if (keyName && !comment)
+				{
+					auto [it, inserted] = m_PendingValues.try_emplace(MakeKey(operation.Section, operation.Key), m_Operations.size());
+					if (!inserted)
+					{
+						m_Operations[it->second].Value = std::move(operation.Value);
+						return;
+					}
+				}
+				else
+				{
+					m_StructureChanged = true;
+				}
+				m_Operations.emplace_back(std::move(operation));
+			}
+			void OnDeleted(const char* sectionName, const char* keyName, bool removeEmpty)
+			{
+				Operation& operation = m_Operations.emplace_back();
+				operation.Type = OperationType::Delete;
+				operation.Section = sectionName ? sectionName : "";
+				operation.Key = keyName ? keyName : "";
+				operation.RemoveEmpty = removeEmpty;
+
+				// The assignments made before the removal can't be merged with the ones after it
+				m_PendingValues.clear();
+				m_StructureChanged = true;
+			}
+			void OnFormatChanged() noexcept
+			{
+				m_StructureChanged = true;
+			}
+			void OnCleared()
+			{
+				OnSaved();
+				m_Operations.emplace_back().Type = OperationType::Reset;
+				m_StructureChanged = true;
+
+				m_Layout.clear();
+				m_HasImage = false;
+			}
+			void OnLoaded() noexcept
+			{
+				OnSaved();
+
+				m_Layout.clear();
+				m_HasImage = false;
+				m_IsJournalTorn = false;
+			}
+
+			bool SaveFull(const INIDocument& document, IOutputStream& stream)
+			{
+				const std::string image = GetImage(document);
+				if (XDocument::Private::RewriteStream(stream, std::as_bytes(std::span(image))))
+				{
+					BuildLayout(image);
+					m_ImageSize = image.size();
+					m_HasImage = stream.IsSeekable();
+					m_IsJournalTorn = false;
+					OnSaved();
+
+					return true;
+				}
+
+				m_Layout.clear();
+				m_HasImage = false;
+				return false;
+			}
+			bool SavePatch(const INIDocument& document, IOutputStream& stream)
+			{
+				if (!m_HasImage || m_StructureChanged || !XDocument::Private::CanPatchStream(stream, m_ImageSize))
+				{
+					return SaveFull(document, stream);
+				}
+
+				// Only the values of the existing keys have changed, print all the lines first and write nothing unless they fit
+				std::vector<std::pair<const Line*, std::string>> patches;
+				patches.reserve(m_Operations.size());
+
+				for (const Operation& operation: m_Operations)
+				{
+					auto it = m_Layout.find(MakeKey(operation.Section, operation.Key));
+					if (it == m_Layout.end() || !it->second.IsUnique)
+					{
+						return SaveFull(document, stream);
+					}
+
+					auto text = PrintLine(*document.m_Document, operation.Section, operation.Key);
+					if (!text || text->size() > it->second.Capacity)
+					{
+						return SaveFull(document, stream);
+					}
+					patches.emplace_back(&it->second, *std::move(text));
+				}
+
+				// SimpleIni trims the values when loading them, so the padding after the value is ignored
+				for (const auto& [line, text]: patches)
+				{
+					if (!XDocument::Private::PatchStream(stream, line->Offset, text, line->Capacity))
+					{
+						// The image is in an unknown state now
+						return SaveFull(document, stream);
+					}
+				}
+
+				stream.SeekO(static_cast<int64_t>(m_ImageSize), IOStreamSeek::FromStart);
+				OnSaved();
+				return true;
+			}
+			bool SaveJournal(const INIDocument& document, IOutputStream& stream)
+			{
+				if (!IsModified())
+				{
+					return true;
+				}
+				if (m_IsJournalTorn)
+				{
+					return false;
+				}
+
+				MemoryOutputStream payload;
+				for (const Operation& operation: m_Operations)
+				{
+					Serialization::WriteObject(payload, static_cast<uint8_t>(operation.Type));
+					Serialization::WriteObject(payload, operation.RemoveEmpty);
+					Serialization::WriteObject(payload, operation.Section);
+					Serialization::WriteObject(payload, operation.Key);
+					Serialization::WriteObject(payload, operation.Value);
+					Serialization::WriteObject(payload, operation.Comment);
+				}
+
+				const auto& buffer = payload.GetStreamBuffer();
+				switch (XDocument::Private::WriteJournalBatch(stream, g_JournalFormat, {static_cast<const std::byte*>(buffer.GetBufferStart()), buffer.GetBufferSize()}))
+				{
+					case XDocument::Private::JournalWriteResult::Written:
+					{
+						// The image written by the last full or patch save doesn't have these changes
+						m_HasImage = false;
+						OnSaved();
+
+						return true;
+					}
+					case XDocument::Private::JournalWriteResult::Torn:
+					{
+						m_IsJournalTorn = true;
+						break;
+					}
+				};
+				return false;
+			}
+			static bool ApplyJournal(INIDocumentImpl& document, IInputStream& stream)
+			{
+				std::vector<std::byte> payload;
+				while (XDocument::Private::ReadJournalBatch(stream, g_JournalFormat, payload))
+				{
+					MemoryInputStream records(payload.data(), payload.size());
+					while (static_cast<size_t>(records.TellI().ToBytes()) < payload.size())
+					{
+						uint8_t type = 0;
+						Operation operation;
+						Serialization::ReadObject(records, type);
+						Serialization::ReadObject(records, operation.RemoveEmpty);
+						Serialization::ReadObject(records, operation.Section);
+						Serialization::ReadObject(records, operation.Key);
+						Serialization::ReadObject(records, operation.Value);
+						Serialization::ReadObject(records, operation.Comment);
+
+						switch (static_cast<OperationType>(type))
+						{
+							case OperationType::Reset:
+							{
+								document.Reset();
+								break;
+							}
+							case OperationType::SetValue:
+							{
+								document.SetValue(operation.Section.c_str(), ToArgument(operation.Key), ToArgument(operation.Value), ToArgument(operation.Comment), true);
+								break;
+							}
+							case OperationType::Delete:
+							{
+								document.Delete(operation.Section.c_str(), ToArgument(operation.Key), operation.RemoveEmpty);
+								break;
+							}
+							default:
+							{
+								return false;
+							}
+						};
+					}
+				}
+				return true;
+			}
+	};
 }
 
 namespace kxf
@@ -435,6 +1105,8 @@ namespace kxf
 	{
 		if (m_Ref)
 		{
+			m_Ref->DoMaterialize();
+
 			size_t index = npos;
 			m_Ref->m_Document->ForEachSection([&](const INIDocumentImpl::Entry& entry)
 			{
@@ -488,6 +1160,8 @@ namespace kxf
 	{
 		if (m_Ref && m_Ref->m_Document)
 		{
+			m_Ref->DoMaterialize();
+
 			auto count = m_Ref->m_Document->GetSectionSize(m_SectionName.utf8_str());
 			return count >= 0 ? count : 0;
 		}
@@ -625,7 +1299,15 @@ namespace kxf
 		{
 			Init();
 		}
-		return m_Document->LoadData(ini, length) == SimpleINI::SI_OK;
+		m_Compiled = nullptr;
+		m_IsMaterialized = false;
+
+		const bool result = m_Document->LoadData(ini, length) == SimpleINI::SI_OK;
+		if (m_Tracker)
+		{
+			m_Tracker->OnLoaded();
+		}
+		return result;
 	}
 	void INIDocument::DoUnload()
 	{
@@ -633,11 +1315,40 @@ namespace kxf
 		{
 			m_Document->Reset();
 		}
+		if (m_Tracker)
+		{
+			m_Tracker->OnCleared();
+		}
+		m_Compiled = nullptr;
+		m_IsMaterialized = false;
+	}
+	void INIDocument::DoMaterialize() const
+	{
+		// The const functions can be called concurrently, so the document is parsed from the text of the image only once and
+		// the image itself is kept for the readers which may still be using it. It's discarded before the first modification.
+		if (m_Compiled && !m_IsMaterialized.load(std::memory_order_acquire))
+		{
+			std::unique_lock lock(m_MaterializeLock);
+			if (!m_IsMaterialized.load(std::memory_order_relaxed))
+			{
+				auto source = m_Compiled->GetSource();
+				m_Document->Reset();
+				m_Document->LoadData(source.data(), source.size());
+
+				m_IsMaterialized.store(true, std::memory_order_release);
+			}
+		}
+	}
+	void INIDocument::DoDiscardCompiled()
+	{
+		DoMaterialize();
+		m_Compiled = nullptr;
+		m_IsMaterialized = false;
 	}
 
 	std::optional<String> INIDocument::IniDoGetValue(const String& sectionName, const String& keyName, String* comment, size_t* order) const
 	{
-		if (m_Document && !m_Document->IsEmpty())
+		if (!IsNull())
 		{
 			const auto options = GetOptions();
 			if (options.Contains(INIDocumentOption::InlineComments) && StartsWithInlineComment(keyName))
@@ -653,8 +1364,21 @@ namespace kxf
 			}
 
 			std::optional<String> value;
-			if (comment || order)
+			if (m_Compiled && !comment && !order)
 			{
+				// The compiled tables don't have the comments and the order
+				if (!keyName2.IsEmpty())
+				{
+					if (auto item = m_Compiled->FindValue(sectionName.ToUTF8(), keyName2.ToUTF8()))
+					{
+						value = String::FromUTF8(*item);
+					}
+				}
+			}
+			else if (comment || order)
+			{
+				DoMaterialize();
+
 				// Single key only for now
 				m_Document->ForEachValue([&](const INIDocumentImpl::Entry& entry)
 				{
@@ -694,16 +1418,49 @@ namespace kxf
 		{
 			Init();
 		}
+		DoDiscardCompiled();
 
 		String keyName2 = keyName;
 		keyName2.TrimBoth();
 
-		auto status = m_Document->SetValue(sectionName.utf8_str(),
-										   (!keyName2.IsEmpty() ? keyName2.utf8_str() : nullptr),
-										   (!value.IsEmpty() ? value.utf8_str() : nullptr),
-										   (!comment.IsEmpty() ? comment.utf8_str() : nullptr),
-										   true);
-		return status == SimpleINI::SI_UPDATED || status == SimpleINI::SI_INSERTED;
+		auto sectionNameUTF8 = sectionName.ToUTF8();
+		auto keyNameUTF8 = keyName2.ToUTF8();
+		auto valueUTF8 = value.ToUTF8();
+		auto commentUTF8 = comment.ToUTF8();
+
+		const char* args[] =
+		{
+			(!keyName2.IsEmpty() ? keyNameUTF8.c_str() : nullptr),
+			(!value.IsEmpty() ? valueUTF8.c_str() : nullptr),
+			(!comment.IsEmpty() ? commentUTF8.c_str() : nullptr)
+		};
+		auto status = m_Document->SetValue(sectionNameUTF8.c_str(), args[0], args[1], args[2], true);
+		if (status == SimpleINI::SI_UPDATED || status == SimpleINI::SI_INSERTED)
+		{
+			if (m_Tracker)
+			{
+				m_Tracker->OnValueSet(sectionNameUTF8.c_str(), args[0], args[1], args[2]);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	bool INIDocument::DoDelete(const String& sectionName, const String& keyName, bool removeEmpty)
+	{
+		auto sectionNameUTF8 = sectionName.ToUTF8();
+		auto keyNameUTF8 = keyName.ToUTF8();
+		const char* key = !keyName.IsEmpty() ? keyNameUTF8.c_str() : nullptr;
+
+		if (m_Document->Delete(sectionNameUTF8.c_str(), key, removeEmpty))
+		{
+			if (m_Tracker)
+			{
+				m_Tracker->OnDeleted(sectionNameUTF8.c_str(), key, removeEmpty);
+			}
+			return true;
+		}
+		return false;
 	}
 
 	bool INIDocument::RemoveQuotes(String& value) const
@@ -800,13 +1557,17 @@ namespace kxf
 	}
 	INIDocument::INIDocument(INIDocument&& other) noexcept
 	{
-		*this = std::move(*this);
+		*this = std::move(other);
 	}
 	INIDocument::~INIDocument() = default;
 
 	// IXDocument
 	bool INIDocument::IsNull() const
 	{
+		if (m_Compiled)
+		{
+			return m_Compiled->GetSectionCount() == 0;
+		}
 		return !m_Document || m_Document->IsEmpty();
 	}
 	String INIDocument::GetDocumentMeta() const
@@ -826,7 +1587,12 @@ namespace kxf
 	}
 	bool INIDocument::SaveDocument(IOutputStream& stream) const
 	{
-		if (m_Document)
+		if (m_Compiled)
+		{
+			auto source = m_Compiled->GetSource();
+			return stream.WriteAll(source.data(), source.size());
+		}
+		else if (m_Document)
 		{
 			std::string buffer;
 			m_Document->Save(buffer, false);
@@ -860,7 +1626,11 @@ namespace kxf
 	}
 	String INIDocument::SaveDocument() const
 	{
-		if (m_Document)
+		if (m_Compiled)
+		{
+			return String::FromUTF8(m_Compiled->GetSource());
+		}
+		else if (m_Document)
 		{
 			std::string buffer;
 			m_Document->Save(buffer, false);
@@ -870,9 +1640,57 @@ namespace kxf
 		return {};
 	}
 
+	bool INIDocument::Compile(IOutputStream& stream, uint64_t sourceHash) const
+	{
+		if (m_Compiled)
+		{
+			return XDocument::Private::WriteCompiledDocument(stream, g_CompiledFormat, g_CompiledVersion, sourceHash, m_Compiled->GetData());
+		}
+		else if (m_Document)
+		{
+			auto payload = INICompiledDocument::Build(*m_Document, GetOptions());
+			return !payload.empty() && XDocument::Private::WriteCompiledDocument(stream, g_CompiledFormat, g_CompiledVersion, sourceHash, payload);
+		}
+		return false;
+	}
+	bool INIDocument::LoadCompiled(IInputStream& stream, uint64_t sourceHash)
+	{
+		DoUnload();
+		if (!m_Document)
+		{
+			Init();
+		}
+
+		std::vector<std::byte> payload;
+		if (XDocument::Private::ReadCompiledDocument(stream, g_CompiledFormat, g_CompiledVersion, sourceHash, payload))
+		{
+			// The options affect how the text is parsed, so an image made with different ones can't be used
+			auto compiled = std::make_unique<INICompiledDocument>();
+			if (compiled->Open(std::move(payload)) && compiled->GetOptions() == GetOptions())
+			{
+				m_Compiled = std::move(compiled);
+				if (m_Tracker)
+				{
+					m_Tracker->OnLoaded();
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
 	INIDocument INIDocument::Clone() const
 	{
-		if (m_Document)
+		if (m_Compiled)
+		{
+			auto source = m_Compiled->GetSource();
+
+			INIDocument document;
+			document.SetOptions(m_Options);
+			document.DoLoad(source.data(), source.size());
+			return document;
+		}
+		else if (m_Document)
 		{
 			std::string buffer;
 			m_Document->Save(buffer, false);
@@ -906,10 +1724,17 @@ namespace kxf
 	{
 		if (m_Document)
 		{
+			DoDiscardCompiled();
+
 			m_Options = options;
 			m_Document->SetSpaces(options.Contains(INIDocumentOption::Spaces));
 			m_Document->SetQuotes(options.Contains(INIDocumentOption::Quotes));
 			m_Document->SetMultiKey(options.Contains(INIDocumentOption::MultiKey));
+
+			if (m_Tracker)
+			{
+				m_Tracker->OnFormatChanged();
+			}
 		}
 	}
 
@@ -938,6 +1763,8 @@ namespace kxf
 	{
 		if (m_Document)
 		{
+			DoMaterialize();
+
 			return m_Document->ForEachSection([&](const INIDocumentImpl::Entry& entry)
 			{
 				return func.Invoke(INIDocumentImpl::ToSection(*this, entry)).GetLastCommand();
@@ -949,6 +1776,8 @@ namespace kxf
 	{
 		if (m_Document)
 		{
+			DoMaterialize();
+
 			return m_Document->ForEachSection([&, options = GetOptions()](const INIDocumentImpl::Entry& entry)
 			{
 				return func.Invoke(String::FromUTF8(entry.pItem)).GetLastCommand();
@@ -960,6 +1789,8 @@ namespace kxf
 	{
 		if (m_Document)
 		{
+			DoMaterialize();
+
 			return m_Document->ForEachSectionItem([&, options = GetOptions()](const INIDocumentImpl::Entry& nameEntry, const char* rawValue)
 			{
 				auto keyName = ProcessItem(nameEntry.pItem, options);
@@ -977,7 +1808,11 @@ namespace kxf
 
 	size_t INIDocument::GetSectionCount() const
 	{
-		if (m_Document && !m_Document->IsEmpty())
+		if (m_Compiled)
+		{
+			return m_Compiled->GetSectionCount();
+		}
+		else if (m_Document && !m_Document->IsEmpty())
 		{
 			INIDocumentImpl::TNamesDepend sections;
 			m_Document->GetAllSections(sections);
@@ -988,7 +1823,11 @@ namespace kxf
 	}
 	bool INIDocument::HasSection(const String& sectionName) const
 	{
-		if (m_Document)
+		if (m_Compiled)
+		{
+			return m_Compiled->FindSection(sectionName.ToUTF8()) != nullptr;
+		}
+		else if (m_Document)
 		{
 			return m_Document->GetSection(sectionName.utf8_str()) != nullptr;
 		}
@@ -998,7 +1837,9 @@ namespace kxf
 	{
 		if (m_Document)
 		{
-			return m_Document->Delete(sectionName.utf8_str(), nullptr, false);
+			DoDiscardCompiled();
+
+			return DoDelete(sectionName, {}, false);
 		}
 		return false;
 	}
@@ -1006,7 +1847,9 @@ namespace kxf
 	{
 		if (m_Document)
 		{
-			return m_Document->Delete(sectionName.utf8_str(), nullptr, true);
+			DoDiscardCompiled();
+
+			return DoDelete(sectionName, {}, true);
 		}
 		return false;
 	}
@@ -1024,6 +1867,8 @@ namespace kxf
 	{
 		if (m_Document)
 		{
+			DoMaterialize();
+
 			if (uniqueOnly)
 			{
 				return m_Document->ForEachKey([&, options = GetOptions()](const INIDocumentImpl::Entry& entry)
@@ -1053,6 +1898,8 @@ namespace kxf
 	{
 		if (m_Document)
 		{
+			DoMaterialize();
+
 			return m_Document->ForEachValue([&, options = GetOptions()](const INIDocumentImpl::Entry& entry)
 			{
 				if (auto value = ProcessItem(entry.pItem, options))
@@ -1067,7 +1914,11 @@ namespace kxf
 
 	bool INIDocument::HasSectionAttribute(const String& sectionName, const String& keyName) const
 	{
-		if (m_Document)
+		if (m_Compiled)
+		{
+			return m_Compiled->FindValue(sectionName.ToUTF8(), keyName.ToUTF8()).has_value();
+		}
+		else if (m_Document)
 		{
 			return m_Document->GetValue(sectionName.utf8_str(), keyName.utf8_str()) != nullptr;
 		}
@@ -1077,15 +1928,90 @@ namespace kxf
 	{
 		if (m_Document)
 		{
-			return m_Document->Delete(sectionName.utf8_str(), keyName.utf8_str(), false);
+			DoDiscardCompiled();
+
+			return DoDelete(sectionName, keyName, false);
 		}
 		return false;
 	}
 
+	void INIDocument::EnableChangeTracking(bool enable)
+	{
+		if (enable && !m_Tracker)
+		{
+			m_Tracker = std::make_unique<INIChangeTracker>();
+		}
+		else if (!enable)
+		{
+			m_Tracker = nullptr;
+		}
+	}
+	bool INIDocument::IsModified() const noexcept
+	{
+		return m_Tracker && m_Tracker->IsModified();
+	}
+	bool INIDocument::SaveChanges(IOutputStream& stream, XDocument::SaveMode mode)
+	{
+		if (!m_Document)
+		{
+			return false;
+		}
+
+		if (m_Tracker)
+		{
+			switch (mode)
+			{
+				case XDocument::SaveMode::Full:
+				{
+					return m_Tracker->SaveFull(*this, stream);
+				}
+				case XDocument::SaveMode::Patch:
+				{
+					return m_Tracker->SavePatch(*this, stream);
+				}
+				case XDocument::SaveMode::Journal:
+				{
+					return m_Tracker->SaveJournal(*this, stream);
+				}
+			};
+		}
+		else if (mode == XDocument::SaveMode::Full)
+		{
+			if (m_Compiled)
+			{
+				return XDocument::Private::RewriteStream(stream, std::as_bytes(std::span(m_Compiled->GetSource())));
+			}
+
+			std::string buffer;
+			m_Document->Save(buffer, false);
+
+			return XDocument::Private::RewriteStream(stream, std::as_bytes(std::span(buffer)));
+		}
+		return false;
+	}
+	bool INIDocument::ApplyJournal(IInputStream& stream)
+	{
+		if (!m_Document)
+		{
+			Init();
+		}
+		DoDiscardCompiled();
+
+		const bool result = INIChangeTracker::ApplyJournal(*m_Document, stream);
+		if (m_Tracker)
+		{
+			m_Tracker->OnLoaded();
+		}
+		return result;
+	}
+
 	INIDocument& INIDocument::operator=(INIDocument&& other) noexcept
 	{
 		m_Document = std::move(other.m_Document);
+		m_Compiled = std::move(other.m_Compiled);
+		m_IsMaterialized = other.m_IsMaterialized.exchange(false);
 		m_Options = std::move(other.m_Options);
+		m_Tracker = std::move(other.m_Tracker);
 
 		return *this;
 	}
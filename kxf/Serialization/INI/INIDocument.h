@@ -4,12 +4,15 @@
 #include "kxf/Core/Version.h"
 #include "kxf/RTTI/RTTI.h"
 #include "kxf/IO/IStream.h"
+#include <mutex>
 
 namespace kxf
 {
 	class INIDocument;
 	class INIDocumentImpl;
 	class INIDocumentSection;
+	class INICompiledDocument;
+	class INIChangeTracker;
 
 	enum class INIDocumentOption: uint32_t
 	{
@@ -241,9 +244,14 @@ namespace kxf
 
 		friend class INIDocumentValue;
 		friend class INIDocumentSection;
+		friend class INIChangeTracker;
 
 		private:
 			std::unique_ptr<INIDocumentImpl> m_Document;
+			std::unique_ptr<INICompiledDocument> m_Compiled;
+			mutable std::atomic<bool> m_IsMaterialized = false;
+			mutable std::mutex m_MaterializeLock;
+			std::unique_ptr<INIChangeTracker> m_Tracker;
 			FlagSet<INIDocumentOption> m_Options;
 
 		private:
@@ -258,9 +266,12 @@ namespace kxf
 			void Init();
 			bool DoLoad(const char* ini, size_t length);
 			void DoUnload();
+			void DoMaterialize() const;
+			void DoDiscardCompiled();
 
 			std::optional<String> IniDoGetValue(const String& sectionName, const String& keyName, String* comment = nullptr, size_t* order = nullptr) const;
 			bool IniDoSetValue(const String& sectionName, const String& keyName, const String& value, const String& comment = {}, AsCDATA asCDATA = AsCDATA::Auto);
+			bool DoDelete(const String& sectionName, const String& keyName, bool removeEmpty);
 
 			bool RemoveQuotes(String& value) const;
 			bool RemoveInlineComments(String& value, String* comment = nullptr) const;
@@ -289,11 +300,36 @@ namespace kxf
 			bool LoadDocument(IInputStream& stream);
 			bool SaveDocument(IOutputStream& stream) const;
 
+			// Fields of the root object are the keys outside of any section and the objects in it are the sections,
+			// deeper objects and arrays aren't supported.
+			std::unique_ptr<XDocument::ISchemaWriter> CreateSchemaWriter() override;
+			std::unique_ptr<XDocument::ISchemaReader> CreateSchemaReader() const override;
+
 			// INIDocument
 			bool LoadDocument(const String& ini);
 			bool LoadDocument(std::span<const char8_t> utf8Data);
 			String SaveDocument() const;
 
+			// Binary image of the parsed document, with sorted section and key tables that are searched directly after
+			// loading it back. The document is parsed from the text stored in the image only when it's modified or enumerated.
+			// 'sourceHash' identifies the source the document was loaded from, see 'XDocument::HashSource'.
+			bool Compile(IOutputStream& stream, uint64_t sourceHash) const;
+			bool LoadCompiled(IInputStream& stream, uint64_t sourceHash);
+
+			// Tracking of the modified keys for the incremental saves, enabling it makes the current state of the document the base
+			// for the first one. A patch rewrites the lines of the modified values in place while the new lines fit into the old ones,
+			// added or removed keys and sections, comments and changed options require a full save.
+			bool IsChangeTrackingEnabled() const noexcept
+			{
+				return m_Tracker != nullptr;
+			}
+			void EnableChangeTracking(bool enable = true);
+			bool IsModified() const noexcept;
+
+			// Only 'SaveMode::Full' can be used without the change tracking
+			bool SaveChanges(IOutputStream& stream, XDocument::SaveMode mode);
+			bool ApplyJournal(IInputStream& stream);
+
 			INIDocument Clone() const;
 			void Clear();
 
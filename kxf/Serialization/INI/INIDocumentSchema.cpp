@@ -0,0 +1,121 @@
+#include "kxf-pch.h"
+#include "INIDocument.h"
+#include "../XDocumentSchema.h"
+
+namespace
+{
+	using namespace kxf;
+	using XDocument::FieldKind;
+
+	// INI has only one level of nesting: the fields of the root object are the keys without a section
+	// and the objects in it are the sections. Deeper objects and arrays can't be represented.
+	class INISchemaWriter final: public XDocument::ISchemaWriter
+	{
+		private:
+			INIDocument& m_Document;
+			String m_Section;
+			bool m_InSection = false;
+
+		public:
+			INISchemaWriter(INIDocument& document)
+				:m_Document(document)
+			{
+			}
+
+		public:
+			bool BeginObject(StringView name) override
+			{
+				if (!m_InSection && !name.empty())
+				{
+					m_Section = String(name);
+					m_InSection = true;
+					return true;
+				}
+				return false;
+			}
+			void EndObject() override
+			{
+				m_Section.clear();
+				m_InSection = false;
+			}
+			bool BeginArray(StringView name) override
+			{
+				return false;
+			}
+			void EndArray() override
+			{
+			}
+
+			bool WriteString(StringView name, const String& value, FieldKind kind) override
+			{
+				return !name.empty() && m_Document.SetSectionAttribute(m_Section, String(name), value);
+			}
+	};
+
+	class INISchemaReader final: public XDocument::ISchemaReader
+	{
+		private:
+			const INIDocument& m_Document;
+			String m_Section;
+			bool m_InSection = false;
+
+		public:
+			INISchemaReader(const INIDocument& document)
+				:m_Document(document)
+			{
+			}
+
+		public:
+			bool EnterObject(StringView name) override
+			{
+				if (!m_InSection && !name.empty())
+				{
+					String section(name);
+					if (m_Document.HasSection(section))
+					{
+						m_Section = std::move(section);
+						m_InSection = true;
+						return true;
+					}
+				}
+				return false;
+			}
+			void LeaveObject() override
+			{
+				m_Section.clear();
+				m_InSection = false;
+			}
+			bool EnterArray(StringView name) override
+			{
+				return false;
+			}
+			bool NextItem() override
+			{
+				return false;
+			}
+			void LeaveArray() override
+			{
+			}
+
+			std::optional<String> ReadString(StringView name, FieldKind kind) override
+			{
+				if (!name.empty())
+				{
+					return m_Document.QuerySectionAttribute(m_Section, String(name));
+				}
+				return {};
+			}
+	};
+}
+
+namespace kxf
+{
+	std::unique_ptr<XDocument::ISchemaWriter> INIDocument::CreateSchemaWriter()
+	{
+		return std::make_unique<INISchemaWriter>(*this);
+	}
+	std::unique_ptr<XDocument::ISchemaReader> INIDocument::CreateSchemaReader() const
+	{
+		return std::make_unique<INISchemaReader>(*this);
+	}
+}
@@ -1,2 +1,4 @@
 #pragma once
 #include "JSON/JSONDocument.h"
+#include "JSON/JSONStreamReader.h"
+#include "JSON/JSONStreamWriter.h"
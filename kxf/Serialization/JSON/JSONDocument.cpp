@@ -5,10 +5,14 @@
 #include "kxf/IO/StreamReaderWriter.h"
 #include "kxf/Core/ILibraryInfo.h"
 #include "kxf/Utility/SoftwareLicenseDB.h"
+#include "../Private/CompiledDocument.h"
 
 namespace
 {
 	constexpr char g_Copyright[] = "Copyright© 2013-2025 Niels Lohmann";
+
+	constexpr uint32_t g_CompiledFormat = 0x4e534a00; // 'JSN'
+	constexpr uint32_t g_CompiledVersion = 1;
 }
 
 namespace kxf
@@ -130,6 +134,39 @@ namespace kxf
 		}
 	}
 
+	bool JSONDocument::Compile(IOutputStream& stream, uint64_t sourceHash) const
+	{
+		try
+		{
+			std::vector<uint8_t> payload;
+			nlohmann::json::to_msgpack(m_Impl, payload);
+
+			return XDocument::Private::WriteCompiledDocument(stream, g_CompiledFormat, g_CompiledVersion, sourceHash, std::as_bytes(std::span(payload)));
+		}
+		catch (...)
+		{
+			return false;
+		}
+	}
+	bool JSONDocument::LoadCompiled(IInputStream& stream, uint64_t sourceHash)
+	{
+		m_Impl.clear();
+
+		std::vector<std::byte> payload;
+		if (XDocument::Private::ReadCompiledDocument(stream, g_CompiledFormat, g_CompiledVersion, sourceHash, payload))
+		{
+			auto data = reinterpret_cast<const uint8_t*>(payload.data());
+			m_Impl = nlohmann::json::from_msgpack(data, data + payload.size(), true, false);
+			if (m_Impl.is_discarded())
+			{
+				m_Impl.clear();
+				return false;
+			}
+			return !m_Impl.empty();
+		}
+		return false;
+	}
+
 	void JSONDocument::ClearDocument()
 	{
 		m_Impl.clear();
@@ -33,6 +33,10 @@ namespace kxf
 			bool LoadDocument(IInputStream& stream) override;
 			bool SaveDocument(IOutputStream& stream) const override;
 
+			// Objects and arrays are mapped directly, the values keep their types
+			std::unique_ptr<XDocument::ISchemaWriter> CreateSchemaWriter() override;
+			std::unique_ptr<XDocument::ISchemaReader> CreateSchemaReader() const override;
+
 			// JSONDocument
 			const nlohmann::json& json() const noexcept
 			{
@@ -46,6 +50,11 @@ namespace kxf
 			bool LoadDocument(const String& json);
 			String SaveDocument() const;
 
+			// Binary image of the document (MessagePack) which is loaded without parsing the text.
+			// 'sourceHash' identifies the source the document was loaded from, see 'XDocument::HashSource'.
+			bool Compile(IOutputStream& stream, uint64_t sourceHash) const;
+			bool LoadCompiled(IInputStream& stream, uint64_t sourceHash);
+
 			void ClearDocument();
 	};
 }
@@ -0,0 +1,257 @@
+#include "kxf-pch.h"
+#include "JSONDocument.h"
+#include "../XDocumentSchema.h"
+
+namespace
+{
+	using namespace kxf;
+	using XDocument::FieldKind;
+
+	class JSONSchemaWriter final: public XDocument::ISchemaWriter
+	{
+		private:
+			std::vector<nlohmann::json*> m_Stack;
+
+		private:
+			// New value for the field of the current object or the next item of the current array
+			nlohmann::json* NewValue(StringView name)
+			{
+				nlohmann::json& current = *m_Stack.back();
+				if (name.empty())
+				{
+					if (current.is_array() || current.is_null())
+					{
+						return &current.emplace_back();
+					}
+				}
+				else if (current.is_object() || current.is_null())
+				{
+					return &current[String(name).ToUTF8()];
+				}
+				return nullptr;
+			}
+
+			template<class T>
+			bool Write(StringView name, T&& value)
+			{
+				if (auto json = NewValue(name))
+				{
+					*json = std::forward<T>(value);
+					return true;
+				}
+				return false;
+			}
+
+		public:
+			JSONSchemaWriter(JSONDocument& document)
+			{
+				m_Stack.emplace_back(&document.json());
+			}
+
+		public:
+			bool BeginObject(StringView name) override
+			{
+				if (auto json = NewValue(name))
+				{
+					*json = nlohmann::json::object();
+					m_Stack.emplace_back(json);
+					return true;
+				}
+				return false;
+			}
+			void EndObject() override
+			{
+				m_Stack.pop_back();
+			}
+			bool BeginArray(StringView name) override
+			{
+				if (auto json = NewValue(name))
+				{
+					*json = nlohmann::json::array();
+					m_Stack.emplace_back(json);
+					return true;
+				}
+				return false;
+			}
+			void EndArray() override
+			{
+				m_Stack.pop_back();
+			}
+
+			bool WriteString(StringView name, const String& value, FieldKind kind) override
+			{
+				return Write(name, value.ToUTF8());
+			}
+			bool WriteInteger(StringView name, int64_t value, FieldKind kind) override
+			{
+				return Write(name, value);
+			}
+			bool WriteUnsigned(StringView name, uint64_t value, FieldKind kind) override
+			{
+				return Write(name, value);
+			}
+			bool WriteFloat(StringView name, double value, FieldKind kind) override
+			{
+				return Write(name, value);
+			}
+			bool WriteBool(StringView name, bool value, FieldKind kind) override
+			{
+				return Write(name, value);
+			}
+	};
+
+	class JSONSchemaReader final: public XDocument::ISchemaReader
+	{
+		private:
+			struct Frame final
+			{
+				const nlohmann::json* Node = nullptr;
+				const nlohmann::json* Item = nullptr;
+				size_t NextIndex = 0;
+			};
+
+		private:
+			std::vector<Frame> m_Stack;
+
+		private:
+			const nlohmann::json* FindValue(StringView name) const
+			{
+				const Frame& frame = m_Stack.back();
+				if (name.empty())
+				{
+					return frame.Item;
+				}
+				else if (frame.Node->is_object())
+				{
+					if (auto it = frame.Node->find(String(name).ToUTF8()); it != frame.Node->end())
+					{
+						return &*it;
+					}
+				}
+				return nullptr;
+			}
+
+		public:
+			JSONSchemaReader(const JSONDocument& document)
+			{
+				m_Stack.emplace_back().Node = &document.json();
+			}
+
+		public:
+			bool EnterObject(StringView name) override
+			{
+				if (auto json = FindValue(name); json && json->is_object())
+				{
+					m_Stack.emplace_back().Node = json;
+					return true;
+				}
+				return false;
+			}
+			void LeaveObject() override
+			{
+				m_Stack.pop_back();
+			}
+			bool EnterArray(StringView name) override
+			{
+				if (auto json = FindValue(name); json && json->is_array())
+				{
+					m_Stack.emplace_back().Node = json;
+					return true;
+				}
+				return false;
+			}
+			bool NextItem() override
+			{
+				Frame& frame = m_Stack.back();
+				if (frame.NextIndex < frame.Node->size())
+				{
+					frame.Item = &(*frame.Node)[frame.NextIndex++];
+					return true;
+				}
+
+				frame.Item = nullptr;
+				return false;
+			}
+			void LeaveArray() override
+			{
+				m_Stack.pop_back();
+			}
+
+			// Numbers and booleans stored as strings are still accepted by the typed functions through the base implementation
+			std::optional<String> ReadString(StringView name, FieldKind kind) override
+			{
+				if (auto json = FindValue(name))
+				{
+					if (json->is_string())
+					{
+						return String::FromUTF8(json->get_ref<const std::string&>());
+					}
+					else if (json->is_number() || json->is_boolean())
+					{
+						return String::FromUTF8(json->dump());
+					}
+				}
+				return {};
+			}
+			std::optional<int64_t> ReadInteger(StringView name, FieldKind kind) override
+			{
+				if (auto json = FindValue(name); json && json->is_number_integer())
+				{
+					if (json->is_number_unsigned())
+					{
+						if (const auto value = json->get<uint64_t>(); std::in_range<int64_t>(value))
+						{
+							return static_cast<int64_t>(value);
+						}
+						return {};
+					}
+					return json->get<int64_t>();
+				}
+				return ISchemaReader::ReadInteger(name, kind);
+			}
+			std::optional<uint64_t> ReadUnsigned(StringView name, FieldKind kind) override
+			{
+				if (auto json = FindValue(name); json && json->is_number_integer())
+				{
+					if (json->is_number_unsigned())
+					{
+						return json->get<uint64_t>();
+					}
+					else if (const auto value = json->get<int64_t>(); std::in_range<uint64_t>(value))
+					{
+						return static_cast<uint64_t>(value);
+					}
+					return {};
+				}
+				return ISchemaReader::ReadUnsigned(name, kind);
+			}
+			std::optional<double> ReadFloat(StringView name, FieldKind kind) override
+			{
+				if (auto json = FindValue(name); json && json->is_number())
+				{
+					return json->get<double>();
+				}
+				return ISchemaReader::ReadFloat(name, kind);
+			}
+			std::optional<bool> ReadBool(StringView name, FieldKind kind) override
+			{
+				if (auto json = FindValue(name); json && json->is_boolean())
+				{
+					return json->get<bool>();
+				}
+				return ISchemaReader::ReadBool(name, kind);
+			}
+	};
+}
+
+namespace kxf
+{
+	std::unique_ptr<XDocument::ISchemaWriter> JSONDocument::CreateSchemaWriter()
+	{
+		return std::make_unique<JSONSchemaWriter>(*this);
+	}
+	std::unique_ptr<XDocument::ISchemaReader> JSONDocument::CreateSchemaReader() const
+	{
+		return std::make_unique<JSONSchemaReader>(*this);
+	}
+}
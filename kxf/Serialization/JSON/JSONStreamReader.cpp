@@ -0,0 +1,713 @@
+#include "kxf-pch.h"
+#include "JSONStreamReader.h"
+#include <charconv>
+
+namespace
+{
+	constexpr bool IsWhitespace(int c) noexcept
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+	constexpr bool IsDigit(int c) noexcept
+	{
+		return c >= '0' && c <= '9';
+	}
+	constexpr bool IsNumberChar(int c) noexcept
+	{
+		return IsDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+	}
+	constexpr int GetHexDigitValue(int c) noexcept
+	{
+		if (c >= '0' && c <= '9')
+		{
+			return c - '0';
+		}
+		else if (c >= 'a' && c <= 'f')
+		{
+			return c - 'a' + 10;
+		}
+		else if (c >= 'A' && c <= 'F')
+		{
+			return c - 'A' + 10;
+		}
+		return -1;
+	}
+
+	// Checks the number against the JSON grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+	bool IsValidNumber(std::string_view value) noexcept
+	{
+		size_t i = 0;
+		auto SkipDigits = [&]()
+		{
+			const size_t start = i;
+			while (i < value.size() && IsDigit(value[i]))
+			{
+				i++;
+			}
+			return i != start;
+		};
+
+		if (i < value.size() && value[i] == '-')
+		{
+			i++;
+		}
+		if (i < value.size() && value[i] == '0')
+		{
+			i++;
+		}
+		else if (!SkipDigits())
+		{
+			return false;
+		}
+
+		if (i < value.size() && value[i] == '.')
+		{
+			i++;
+			if (!SkipDigits())
+			{
+				return false;
+			}
+		}
+		if (i < value.size() && (value[i] == 'e' || value[i] == 'E'))
+		{
+			i++;
+			if (i < value.size() && (value[i] == '+' || value[i] == '-'))
+			{
+				i++;
+			}
+			if (!SkipDigits())
+			{
+				return false;
+			}
+		}
+		return i == value.size();
+	}
+
+	void AppendUTF8(std::string& buffer, uint32_t codePoint)
+	{
+		if (codePoint < 0x80)
+		{
+			buffer.push_back(static_cast<char>(codePoint));
+		}
+		else if (codePoint < 0x800)
+		{
+			buffer.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+			buffer.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+		else if (codePoint < 0x10000)
+		{
+			buffer.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+			buffer.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+			buffer.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+		else
+		{
+			buffer.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+			buffer.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+			buffer.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+			buffer.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+	}
+}
+
+namespace kxf
+{
+	int JSONStreamReader::PeekChar()
+	{
+		const auto buffer = m_Stream.GetReadBuffer();
+		return !buffer.empty() ? buffer.front() : -1;
+	}
+	int JSONStreamReader::ReadChar()
+	{
+		const auto buffer = m_Stream.GetReadBuffer();
+		if (!buffer.empty())
+		{
+			const int c = buffer.front();
+			m_Stream.Consume(1);
+			m_Offset++;
+
+			return c;
+		}
+		return -1;
+	}
+	bool JSONStreamReader::SkipWhitespace()
+	{
+		while (true)
+		{
+			const auto buffer = m_Stream.GetReadBuffer();
+			if (buffer.empty())
+			{
+				return false;
+			}
+
+			size_t count = 0;
+			while (count < buffer.size() && IsWhitespace(buffer[count]))
+			{
+				count++;
+			}
+			m_Stream.Consume(count);
+			m_Offset += count;
+
+			if (count != buffer.size())
+			{
+				return true;
+			}
+		}
+	}
+	bool JSONStreamReader::ExpectChar(char c)
+	{
+		if (PeekChar() == c)
+		{
+			ReadChar();
+			return true;
+		}
+
+		SetError(Format("Expected '{}'", c));
+		return false;
+	}
+	JSONStreamToken JSONStreamReader::SetError(String message)
+	{
+		m_ErrorMessage = Format("{} at offset {}", message, m_Offset);
+		m_Value.clear();
+		m_Token = JSONStreamToken::Error;
+
+		return m_Token;
+	}
+
+	JSONStreamToken JSONStreamReader::ParseValue()
+	{
+		if (!m_Stack.empty())
+		{
+			auto& container = m_Stack.back();
+			container.HasItems = true;
+			container.ExpectValue = false;
+		}
+
+		switch (const int c = PeekChar())
+		{
+			case '{':
+			case '[':
+			{
+				if (m_Stack.size() >= m_MaxDepth)
+				{
+					return SetError("Maximum nesting depth exceeded");
+				}
+				ReadChar();
+
+				Container& container = m_Stack.emplace_back();
+				container.IsObject = c == '{';
+
+				m_Token = container.IsObject ? JSONStreamToken::BeginObject : JSONStreamToken::BeginArray;
+				return m_Token;
+			}
+			case '"':
+			{
+				return ParseString(JSONStreamToken::String);
+			}
+			case 't':
+			{
+				m_Boolean = true;
+				return ParseLiteral("true", JSONStreamToken::Boolean);
+			}
+			case 'f':
+			{
+				m_Boolean = false;
+				return ParseLiteral("false", JSONStreamToken::Boolean);
+			}
+			case 'n':
+			{
+				return ParseLiteral("null", JSONStreamToken::Null);
+			}
+			default:
+			{
+				if (c == '-' || IsDigit(c))
+				{
+					return ParseNumber();
+				}
+				return SetError("Unexpected character");
+			}
+		};
+	}
+	JSONStreamToken JSONStreamReader::ParseString(JSONStreamToken token)
+	{
+		// Skip the opening quote
+		ReadChar();
+		m_Value.clear();
+
+		while (true)
+		{
+			const auto buffer = m_Stream.GetReadBuffer();
+			if (buffer.empty())
+			{
+				return SetError("Unterminated string");
+			}
+
+			// Copy everything up to the next special character in one go
+			size_t count = 0;
+			while (count < buffer.size() && buffer[count] != '"' && buffer[count] != '\\' && buffer[count] >= 0x20)
+			{
+				count++;
+			}
+			if (m_Value.size() + count > m_MaxValueLength)
+			{
+				return SetError("String is too long");
+			}
+
+			m_Value.append(reinterpret_cast<const char*>(buffer.data()), count);
+			m_Stream.Consume(count);
+			m_Offset += count;
+
+			if (count == buffer.size())
+			{
+				continue;
+			}
+
+			const int c = ReadChar();
+			if (c == '"')
+			{
+				m_Token = token;
+				return m_Token;
+			}
+			else if (c != '\\')
+			{
+				return SetError("Unescaped control character in a string");
+			}
+
+			auto ReadCodeUnit = [&]() -> int32_t
+			{
+				int32_t value = 0;
+				for (size_t i = 0; i < 4; i++)
+				{
+					const int digit = GetHexDigitValue(ReadChar());
+					if (digit < 0)
+					{
+						return -1;
+					}
+					value = (value << 4) | digit;
+				}
+				return value;
+			};
+
+			switch (ReadChar())
+			{
+				case '"':
+				{
+					m_Value.push_back('"');
+					break;
+				}
+				case '\\':
+				{
+					m_Value.push_back('\\');
+					break;
+				}
+				case '/':
+				{
+					m_Value.push_back('/');
+					break;
+				}
+				case 'b':
+				{
+					m_Value.push_back('\b');
+					break;
+				}
+				case 'f':
+				{
+					m_Value.push_back('\f');
+					break;
+				}
+				case 'n':
+				{
+					m_Value.push_back('\n');
+					break;
+				}
+				case 'r':
+				{
+					m_Value.push_back('\r');
+					break;
+				}
+				case 't':
+				{
+					m_Value.push_back('\t');
+					break;
+				}
+				case 'u':
+				{
+					int32_t codePoint = ReadCodeUnit();
+					if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+					{
+						// High surrogate, must be followed by the low one
+						if (ReadChar() != '\\' || ReadChar() != 'u')
+						{
+							return SetError("Unpaired surrogate in a string");
+						}
+
+						const int32_t low = ReadCodeUnit();
+						if (low < 0xDC00 || low > 0xDFFF)
+						{
+							return SetError("Unpaired surrogate in a string");
+						}
+						codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+					}
+					else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+					{
+						return SetError("Unpaired surrogate in a string");
+					}
+					else if (codePoint < 0)
+					{
+						return SetError("Invalid Unicode escape sequence");
+					}
+
+					AppendUTF8(m_Value, static_cast<uint32_t>(codePoint));
+					break;
+				}
+				default:
+				{
+					return SetError("Invalid escape sequence");
+				}
+			};
+
+			// An escape sequence appends at most four bytes, so the string can't grow past the limit by more than that
+			if (m_Value.size() > m_MaxValueLength)
+			{
+				return SetError("String is too long");
+			}
+		}
+	}
+	JSONStreamToken JSONStreamReader::ParseNumber()
+	{
+		m_Value.clear();
+		while (IsNumberChar(PeekChar()))
+		{
+			if (m_Value.size() >= m_MaxValueLength)
+			{
+				return SetError("Number is too long");
+			}
+			m_Value.push_back(static_cast<char>(ReadChar()));
+		}
+		if (!IsValidNumber(m_Value))
+		{
+			return SetError("Invalid number");
+		}
+
+		const char* begin = m_Value.data();
+		const char* end = m_Value.data() + m_Value.size();
+		if (m_Value.find_first_of(".eE") == std::string::npos)
+		{
+			if (auto [ptr, ec] = std::from_chars(begin, end, m_Integer); ec == std::errc() && ptr == end)
+			{
+				m_UnsignedInteger = static_cast<uint64_t>(m_Integer);
+				m_Float = static_cast<double>(m_Integer);
+				m_Token = JSONStreamToken::Integer;
+				return m_Token;
+			}
+			if (auto [ptr, ec] = std::from_chars(begin, end, m_UnsignedInteger); ec == std::errc() && ptr == end)
+			{
+				m_Float = static_cast<double>(m_UnsignedInteger);
+				m_Token = JSONStreamToken::UnsignedInteger;
+				return m_Token;
+			}
+
+			// Integers too large for 64 bits are stored as floating point values
+		}
+
+		if (auto [ptr, ec] = std::from_chars(begin, end, m_Float); ec == std::errc() && ptr == end)
+		{
+			m_Token = JSONStreamToken::Float;
+			return m_Token;
+		}
+		return SetError("Number is out of range");
+	}
+	JSONStreamToken JSONStreamReader::ParseLiteral(std::string_view literal, JSONStreamToken token)
+	{
+		for (char c: literal)
+		{
+			if (ReadChar() != c)
+			{
+				return SetError("Invalid literal");
+			}
+		}
+
+		m_Value = literal;
+		m_Token = token;
+		return m_Token;
+	}
+	bool JSONStreamReader::DoReadValue(nlohmann::json& json)
+	{
+		auto GetScalar = [&]() -> nlohmann::json
+		{
+			switch (m_Token)
+			{
+				case JSONStreamToken::String:
+				{
+					return std::move(m_Value);
+				}
+				case JSONStreamToken::Integer:
+				{
+					return m_Integer;
+				}
+				case JSONStreamToken::UnsignedInteger:
+				{
+					return m_UnsignedInteger;
+				}
+				case JSONStreamToken::Float:
+				{
+					return m_Float;
+				}
+				case JSONStreamToken::Boolean:
+				{
+					return m_Boolean;
+				}
+			};
+			return nullptr;
+		};
+		auto MakeContainer = [&]()
+		{
+			return m_Token == JSONStreamToken::BeginObject ? nlohmann::json::object() : nlohmann::json::array();
+		};
+
+		if (IsValueToken())
+		{
+			json = GetScalar();
+			return true;
+		}
+		else if (m_Token != JSONStreamToken::BeginObject && m_Token != JSONStreamToken::BeginArray)
+		{
+			return false;
+		}
+
+		// Pointers to the enclosing containers. Only the innermost one is modified at any time, so adding items to it
+		// can't invalidate pointers to its ancestors.
+		json = MakeContainer();
+		std::vector<nlohmann::json*> stack = {&json};
+		std::string key;
+
+		while (!stack.empty())
+		{
+			switch (Next())
+			{
+				case JSONStreamToken::Key:
+				{
+					key = std::move(m_Value);
+					break;
+				}
+				case JSONStreamToken::EndObject:
+				case JSONStreamToken::EndArray:
+				{
+					stack.pop_back();
+					break;
+				}
+				case JSONStreamToken::EndOfDocument:
+				case JSONStreamToken::Error:
+				{
+					return false;
+				}
+				default:
+				{
+					nlohmann::json& parent = *stack.back();
+					nlohmann::json* item = nullptr;
+					if (parent.is_object())
+					{
+						item = &parent[key];
+					}
+					else
+					{
+						parent.push_back(nullptr);
+						item = &parent.back();
+					}
+
+					if (m_Token == JSONStreamToken::BeginObject || m_Token == JSONStreamToken::BeginArray)
+					{
+						*item = MakeContainer();
+						stack.push_back(item);
+					}
+					else
+					{
+						*item = GetScalar();
+					}
+					break;
+				}
+			};
+		}
+		return true;
+	}
+
+	JSONStreamReader::JSONStreamReader(IInputStream& stream, size_t bufferSize)
+		:m_Stream(stream, bufferSize)
+	{
+	}
+	JSONStreamReader::JSONStreamReader(std::shared_ptr<IInputStream> stream, size_t bufferSize)
+		:m_Stream(std::move(stream), bufferSize)
+	{
+	}
+
+	JSONStreamToken JSONStreamReader::Next()
+	{
+		if (m_Token == JSONStreamToken::Error || m_Token == JSONStreamToken::EndOfDocument)
+		{
+			return m_Token;
+		}
+		m_Value.clear();
+
+		if (!m_IsStarted)
+		{
+			// Skip the UTF-8 BOM
+			m_IsStarted = true;
+			if (auto data = m_Stream.Peek(3); data.size() == 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF)
+			{
+				m_Stream.Consume(3);
+				m_Offset += 3;
+			}
+		}
+
+		if (!SkipWhitespace())
+		{
+			if (m_Stack.empty())
+			{
+				m_Token = JSONStreamToken::EndOfDocument;
+				return m_Token;
+			}
+			return SetError("Unexpected end of input");
+		}
+		else if (m_Stack.empty())
+		{
+			return ParseValue();
+		}
+
+		Container& container = m_Stack.back();
+		const int c = PeekChar();
+		if (container.IsObject)
+		{
+			if (container.ExpectValue)
+			{
+				return ParseValue();
+			}
+			else if (c == '}')
+			{
+				ReadChar();
+				m_Stack.pop_back();
+
+				m_Token = JSONStreamToken::EndObject;
+				return m_Token;
+			}
+			else if (container.HasItems && (!ExpectChar(',') || !SkipWhitespace()))
+			{
+				return m_Token == JSONStreamToken::Error ? m_Token : SetError("Unexpected end of input");
+			}
+
+			if (PeekChar() != '"')
+			{
+				return SetError("Expected an object key");
+			}
+			if (ParseString(JSONStreamToken::Key) == JSONStreamToken::Error)
+			{
+				return m_Token;
+			}
+			if (!SkipWhitespace() || !ExpectChar(':'))
+			{
+				return m_Token == JSONStreamToken::Error ? m_Token : SetError("Unexpected end of input");
+			}
+
+			container.HasItems = true;
+			container.ExpectValue = true;
+			return m_Token;
+		}
+		else
+		{
+			if (c == ']')
+			{
+				ReadChar();
+				m_Stack.pop_back();
+
+				m_Token = JSONStreamToken::EndArray;
+				return m_Token;
+			}
+			else if (container.HasItems && (!ExpectChar(',') || !SkipWhitespace()))
+			{
+				return m_Token == JSONStreamToken::Error ? m_Token : SetError("Unexpected end of input");
+			}
+			return ParseValue();
+		}
+	}
+
+	String JSONStreamReader::GetString() const
+	{
+		if (m_Token == JSONStreamToken::Key || IsValueToken())
+		{
+			return String::FromUTF8(m_Value);
+		}
+		return {};
+	}
+	std::optional<int64_t> JSONStreamReader::GetInteger() const noexcept
+	{
+		if (m_Token == JSONStreamToken::Integer)
+		{
+			return m_Integer;
+		}
+		return {};
+	}
+	std::optional<uint64_t> JSONStreamReader::GetUnsignedInteger() const noexcept
+	{
+		if ((m_Token == JSONStreamToken::Integer && m_Integer >= 0) || m_Token == JSONStreamToken::UnsignedInteger)
+		{
+			return m_UnsignedInteger;
+		}
+		return {};
+	}
+	std::optional<double> JSONStreamReader::GetFloat() const noexcept
+	{
+		if (m_Token == JSONStreamToken::Integer || m_Token == JSONStreamToken::UnsignedInteger || m_Token == JSONStreamToken::Float)
+		{
+			return m_Float;
+		}
+		return {};
+	}
+	std::optional<bool> JSONStreamReader::GetBoolean() const noexcept
+	{
+		if (m_Token == JSONStreamToken::Boolean)
+		{
+			return m_Boolean;
+		}
+		return {};
+	}
+
+	bool JSONStreamReader::SkipValue()
+	{
+		if (m_Token == JSONStreamToken::None || m_Token == JSONStreamToken::Key)
+		{
+			Next();
+		}
+
+		if (m_Token == JSONStreamToken::BeginObject || m_Token == JSONStreamToken::BeginArray)
+		{
+			const size_t depth = m_Stack.size();
+			while (m_Stack.size() >= depth)
+			{
+				const JSONStreamToken token = Next();
+				if (token == JSONStreamToken::Error || token == JSONStreamToken::EndOfDocument)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		return IsValueToken();
+	}
+	bool JSONStreamReader::ReadValue(nlohmann::json& json)
+	{
+		if (m_Token == JSONStreamToken::None || m_Token == JSONStreamToken::Key)
+		{
+			Next();
+		}
+
+		if (!DoReadValue(json))
+		{
+			json = nullptr;
+			return false;
+		}
+		return true;
+	}
+	bool JSONStreamReader::ReadValue(JSONDocument& document)
+	{
+		return ReadValue(document.json());
+	}
+}
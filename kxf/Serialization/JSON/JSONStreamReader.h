@@ -0,0 +1,166 @@
+#pragma once
+#include "../Common.h"
+#include "kxf/IO/IStream.h"
+#include "kxf/IO/BufferedStream.h"
+#include "JSONDocument.h"
+
+namespace kxf
+{
+	enum class JSONStreamToken
+	{
+		None = -1,
+
+		BeginObject,
+		EndObject,
+		BeginArray,
+		EndArray,
+		Key,
+
+		String,
+		Integer,
+		UnsignedInteger,
+		Float,
+		Boolean,
+		Null,
+
+		EndOfDocument,
+		Error
+	};
+}
+
+namespace kxf
+{
+	// Pull parser reading JSON incrementally from a stream. Only the current token is kept in memory, so the
+	// memory use is bounded by the read buffer, the nesting depth and the longest string or key in the input.
+	// The input can contain a sequence of root values (like JSON Lines), each of them is reported in turn.
+	class KXF_API JSONStreamReader final
+	{
+		public:
+			static constexpr size_t DefaultBufferSize = DataSize::FromKB(64).ToBytes();
+			static constexpr size_t DefaultMaxDepth = 512;
+			static constexpr size_t DefaultMaxValueLength = DataSize::FromMB(64).ToBytes();
+
+		private:
+			struct Container final
+			{
+				bool IsObject = false;
+				bool HasItems = false;
+				bool ExpectValue = false;
+			};
+
+		private:
+			BufferedInputStream m_Stream;
+			std::vector<Container> m_Stack;
+			size_t m_MaxDepth = DefaultMaxDepth;
+			size_t m_MaxValueLength = DefaultMaxValueLength;
+
+			JSONStreamToken m_Token = JSONStreamToken::None;
+			std::string m_Value;
+			uint64_t m_Offset = 0;
+			bool m_IsStarted = false;
+
+			int64_t m_Integer = 0;
+			uint64_t m_UnsignedInteger = 0;
+			double m_Float = 0;
+			bool m_Boolean = false;
+			String m_ErrorMessage;
+
+		private:
+			int PeekChar();
+			int ReadChar();
+			bool SkipWhitespace();
+			bool ExpectChar(char c);
+			JSONStreamToken SetError(String message);
+
+			JSONStreamToken ParseValue();
+			JSONStreamToken ParseString(JSONStreamToken token);
+			JSONStreamToken ParseNumber();
+			JSONStreamToken ParseLiteral(std::string_view literal, JSONStreamToken token);
+			bool DoReadValue(nlohmann::json& json);
+
+		public:
+			JSONStreamReader(IInputStream& stream, size_t bufferSize = DefaultBufferSize);
+			JSONStreamReader(std::shared_ptr<IInputStream> stream, size_t bufferSize = DefaultBufferSize);
+			JSONStreamReader(const JSONStreamReader&) = delete;
+
+		public:
+			// Advances to the next token and returns it. Reading stops at the first error, 'EndOfDocument' is returned
+			// once the input is exhausted. A key is always followed by its value.
+			JSONStreamToken Next();
+
+			JSONStreamToken GetToken() const noexcept
+			{
+				return m_Token;
+			}
+			bool IsValueToken() const noexcept
+			{
+				return m_Token >= JSONStreamToken::String && m_Token <= JSONStreamToken::Null;
+			}
+
+			// Number of containers open after the current token, so the beginning of a container is inside it and its end is outside
+			size_t GetDepth() const noexcept
+			{
+				return m_Stack.size();
+			}
+
+			// Number of bytes of the input consumed so far
+			uint64_t GetOffset() const noexcept
+			{
+				return m_Offset;
+			}
+			const String& GetErrorMessage() const noexcept
+			{
+				return m_ErrorMessage;
+			}
+
+			// Raw UTF-8 text of the current key or string, the textual form of a number for numeric tokens
+			std::string_view GetRawValue() const noexcept
+			{
+				return m_Value;
+			}
+			String GetString() const;
+			std::optional<int64_t> GetInteger() const noexcept;
+			std::optional<uint64_t> GetUnsignedInteger() const noexcept;
+			std::optional<double> GetFloat() const noexcept;
+			std::optional<bool> GetBoolean() const noexcept;
+
+			// Skips the current value, including all of its content if it's the beginning of a container. If the current
+			// token is a key (or nothing has been read yet) the next value is skipped. Afterwards the current token is
+			// the last one of the value, so the following 'Next' call moves to whatever comes after it.
+			bool SkipValue();
+
+			// Same as 'SkipValue' but materializes the value with all its content
+			bool ReadValue(nlohmann::json& json);
+			bool ReadValue(JSONDocument& document);
+
+			size_t GetMaxDepth() const noexcept
+			{
+				return m_MaxDepth;
+			}
+			void SetMaxDepth(size_t depth) noexcept
+			{
+				m_MaxDepth = std::max<size_t>(depth, 1);
+			}
+
+			size_t GetMaxValueLength() const noexcept
+			{
+				return m_MaxValueLength;
+			}
+			void SetMaxValueLength(size_t length) noexcept
+			{
+				m_MaxValueLength = std::max<size_t>(length, 1);
+			}
+
+		public:
+			explicit operator bool() const noexcept
+			{
+				return m_Token != JSONStreamToken::Error;
+			}
+			bool operator!() const noexcept
+			{
+				return m_Token == JSONStreamToken::Error;
+			}
+
+			JSONStreamReader& operator=(const JSONStreamReader&) = delete;
+	};
+}
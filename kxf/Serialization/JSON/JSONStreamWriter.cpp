@@ -0,0 +1,323 @@
+#include "kxf-pch.h"
+#include "JSONStreamWriter.h"
+#include <charconv>
+#include <cmath>
+
+namespace
+{
+	using namespace kxf;
+
+	bool WriteJSON(JSONStreamWriter& writer, const nlohmann::json& json)
+	{
+		switch (json.type())
+		{
+			case nlohmann::json::value_t::object:
+			{
+				if (!writer.BeginObject())
+				{
+					return false;
+				}
+				for (auto it = json.begin(); it != json.end(); ++it)
+				{
+					if (!writer.Key(std::string_view(it.key())) || !WriteJSON(writer, it.value()))
+					{
+						return false;
+					}
+				}
+				return writer.EndObject();
+			}
+			case nlohmann::json::value_t::array:
+			{
+				if (!writer.BeginArray())
+				{
+					return false;
+				}
+				for (const auto& value: json)
+				{
+					if (!WriteJSON(writer, value))
+					{
+						return false;
+					}
+				}
+				return writer.EndArray();
+			}
+			case nlohmann::json::value_t::string:
+			{
+				return writer.Value(std::string_view(json.get_ref<const nlohmann::json::string_t&>()));
+			}
+			case nlohmann::json::value_t::boolean:
+			{
+				return writer.Value(json.get<bool>());
+			}
+			case nlohmann::json::value_t::number_integer:
+			{
+				return writer.Value(json.get<int64_t>());
+			}
+			case nlohmann::json::value_t::number_unsigned:
+			{
+				return writer.Value(json.get<uint64_t>());
+			}
+			case nlohmann::json::value_t::number_float:
+			{
+				return writer.Value(json.get<double>());
+			}
+		};
+		return writer.Value(nullptr);
+	}
+}
+
+namespace kxf
+{
+	bool JSONStreamWriter::DoWrite(std::string_view text)
+	{
+		if (!m_HasError && !m_Stream.WriteAll(text.data(), text.size()))
+		{
+			m_HasError = true;
+		}
+		return !m_HasError;
+	}
+	bool JSONStreamWriter::DoWriteIndent(size_t depth)
+	{
+		if (m_Flags.Contains(JSONStreamWriterFlag::Indent))
+		{
+			char buffer[64] = {'\n'};
+			depth = std::min(depth, std::size(buffer) - 1);
+			std::fill_n(buffer + 1, depth, '\t');
+
+			return DoWrite({buffer, depth + 1});
+		}
+		return true;
+	}
+	bool JSONStreamWriter::DoWriteString(std::string_view value)
+	{
+		if (!DoWrite("\""))
+		{
+			return false;
+		}
+
+		size_t start = 0;
+		for (size_t i = 0; i < value.size(); i++)
+		{
+			const uint8_t c = value[i];
+			if (c != '"' && c != '\\' && c >= 0x20)
+			{
+				continue;
+			}
+
+			// Write out the plain part and then the escape sequence for the current character
+			if (!DoWrite(value.substr(start, i - start)))
+			{
+				return false;
+			}
+			start = i + 1;
+
+			switch (c)
+			{
+				case '"':
+				{
+					DoWrite("\\\"");
+					break;
+				}
+				case '\\':
+				{
+					DoWrite("\\\\");
+					break;
+				}
+				case '\b':
+				{
+					DoWrite("\\b");
+					break;
+				}
+				case '\f':
+				{
+					DoWrite("\\f");
+					break;
+				}
+				case '\n':
+				{
+					DoWrite("\\n");
+					break;
+				}
+				case '\r':
+				{
+					DoWrite("\\r");
+					break;
+				}
+				case '\t':
+				{
+					DoWrite("\\t");
+					break;
+				}
+				default:
+				{
+					constexpr char hexDigits[] = "0123456789abcdef";
+					const char buffer[] = {'\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF]};
+					DoWrite({buffer, std::size(buffer)});
+					break;
+				}
+			};
+		}
+		return DoWrite(value.substr(start)) && DoWrite("\"");
+	}
+	bool JSONStreamWriter::DoBeginValue()
+	{
+		if (m_HasError)
+		{
+			return false;
+		}
+		else if (m_Stack.empty())
+		{
+			if (m_HasRootValue && !DoWrite("\n"))
+			{
+				return false;
+			}
+			m_HasRootValue = true;
+			return true;
+		}
+
+		Container& container = m_Stack.back();
+		if (container.IsObject)
+		{
+			// The separator and the indentation have been written together with the key
+			if (!container.ExpectValue)
+			{
+				return false;
+			}
+			container.ExpectValue = false;
+			return true;
+		}
+		else
+		{
+			if (container.HasItems && !DoWrite(","))
+			{
+				return false;
+			}
+			container.HasItems = true;
+			return DoWriteIndent(m_Stack.size());
+		}
+	}
+	bool JSONStreamWriter::DoWriteScalar(std::string_view text)
+	{
+		return DoBeginValue() && DoWrite(text);
+	}
+	bool JSONStreamWriter::DoBeginContainer(char c, bool isObject)
+	{
+		if (DoBeginValue() && DoWrite({&c, 1}))
+		{
+			Container& container = m_Stack.emplace_back();
+			container.IsObject = isObject;
+
+			return true;
+		}
+		return false;
+	}
+	bool JSONStreamWriter::DoEndContainer(char c, bool isObject)
+	{
+		if (m_HasError || m_Stack.empty() || m_Stack.back().IsObject != isObject || m_Stack.back().ExpectValue)
+		{
+			return false;
+		}
+
+		const bool hasItems = m_Stack.back().HasItems;
+		m_Stack.pop_back();
+
+		return (!hasItems || DoWriteIndent(m_Stack.size())) && DoWrite({&c, 1});
+	}
+
+	JSONStreamWriter::JSONStreamWriter(IOutputStream& stream, FlagSet<JSONStreamWriterFlag> flags, size_t bufferSize)
+		:m_Stream(stream, bufferSize), m_Flags(flags)
+	{
+	}
+	JSONStreamWriter::JSONStreamWriter(std::shared_ptr<IOutputStream> stream, FlagSet<JSONStreamWriterFlag> flags, size_t bufferSize)
+		:m_Stream(std::move(stream), bufferSize), m_Flags(flags)
+	{
+	}
+
+	bool JSONStreamWriter::Key(std::string_view utf8)
+	{
+		if (m_HasError || m_Stack.empty() || !m_Stack.back().IsObject || m_Stack.back().ExpectValue)
+		{
+			return false;
+		}
+
+		Container& container = m_Stack.back();
+		if (container.HasItems && !DoWrite(","))
+		{
+			return false;
+		}
+		container.HasItems = true;
+		container.ExpectValue = true;
+
+		return DoWriteIndent(m_Stack.size()) && DoWriteString(utf8) && DoWrite(m_Flags.Contains(JSONStreamWriterFlag::Indent) ? ": " : ":");
+	}
+
+	bool JSONStreamWriter::Value(std::string_view utf8)
+	{
+		return DoBeginValue() && DoWriteString(utf8);
+	}
+	bool JSONStreamWriter::Value(int64_t value)
+	{
+		char buffer[32] = {};
+		auto [ptr, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+
+		return DoWriteScalar({buffer, ptr});
+	}
+	bool JSONStreamWriter::Value(uint64_t value)
+	{
+		char buffer[32] = {};
+		auto [ptr, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+
+		return DoWriteScalar({buffer, ptr});
+	}
+	bool JSONStreamWriter::Value(double value)
+	{
+		// JSON has no representation for infinities and NaNs
+		if (!std::isfinite(value))
+		{
+			return DoWriteScalar("null");
+		}
+
+		char buffer[64] = {};
+		auto [ptr, ec] = std::to_chars(std::begin(buffer), std::end(buffer) - 2, value);
+
+		// Keep the value a floating point one when it's read back
+		std::string_view text(buffer, ptr);
+		if (text.find_first_of(".eE") == std::string_view::npos)
+		{
+			*ptr++ = '.';
+			*ptr++ = '0';
+			text = {buffer, ptr};
+		}
+		return DoWriteScalar(text);
+	}
+	bool JSONStreamWriter::Value(bool value)
+	{
+		return DoWriteScalar(value ? "true" : "false");
+	}
+	bool JSONStreamWriter::Value(std::nullptr_t)
+	{
+		return DoWriteScalar("null");
+	}
+
+	bool JSONStreamWriter::Value(const nlohmann::json& json)
+	{
+		return WriteJSON(*this, json);
+	}
+	bool JSONStreamWriter::Value(const JSONDocument& document)
+	{
+		return WriteJSON(*this, document.json());
+	}
+
+	bool JSONStreamWriter::Finish()
+	{
+		return m_Stack.empty() && Flush();
+	}
+	bool JSONStreamWriter::Flush()
+	{
+		if (!m_HasError && !m_Stream.FlushBuffer())
+		{
+			m_HasError = true;
+		}
+		return !m_HasError;
+	}
+}
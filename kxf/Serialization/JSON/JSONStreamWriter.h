@@ -0,0 +1,157 @@
+#pragma once
+#include "../Common.h"
+#include "kxf/IO/IStream.h"
+#include "kxf/IO/BufferedStream.h"
+#include "JSONDocument.h"
+
+namespace kxf
+{
+	enum class JSONStreamWriterFlag: uint32_t
+	{
+		None = 0,
+
+		// Puts every item on its own line indented with tabs, the same way 'JSONDocument::SaveDocument' does
+		Indent = 1u << 0
+	};
+	kxf_FlagSet_Declare(JSONStreamWriterFlag);
+}
+
+namespace kxf
+{
+	// Writes JSON incrementally into a stream, only the nesting state is kept in memory. Calls that would produce
+	// invalid JSON (a value without a key inside an object, unbalanced containers and so on) fail and write nothing.
+	// Several root values can be written, they're separated by line breaks (as in JSON Lines).
+	class KXF_API JSONStreamWriter final
+	{
+		public:
+			static constexpr size_t DefaultBufferSize = DataSize::FromKB(64).ToBytes();
+
+		private:
+			struct Container final
+			{
+				bool IsObject = false;
+				bool HasItems = false;
+				bool ExpectValue = false;
+			};
+
+		private:
+			BufferedOutputStream m_Stream;
+			std::vector<Container> m_Stack;
+			FlagSet<JSONStreamWriterFlag> m_Flags;
+			bool m_HasRootValue = false;
+			bool m_HasError = false;
+
+		private:
+			bool DoWrite(std::string_view text);
+			bool DoWriteIndent(size_t depth);
+			bool DoWriteString(std::string_view value);
+			bool DoBeginValue();
+			bool DoWriteScalar(std::string_view text);
+			bool DoBeginContainer(char c, bool isObject);
+			bool DoEndContainer(char c, bool isObject);
+
+		public:
+			JSONStreamWriter(IOutputStream& stream, FlagSet<JSONStreamWriterFlag> flags = {}, size_t bufferSize = DefaultBufferSize);
+			JSONStreamWriter(std::shared_ptr<IOutputStream> stream, FlagSet<JSONStreamWriterFlag> flags = {}, size_t bufferSize = DefaultBufferSize);
+			JSONStreamWriter(const JSONStreamWriter&) = delete;
+
+		public:
+			bool BeginObject()
+			{
+				return DoBeginContainer('{', true);
+			}
+			bool EndObject()
+			{
+				return DoEndContainer('}', true);
+			}
+			bool BeginArray()
+			{
+				return DoBeginContainer('[', false);
+			}
+			bool EndArray()
+			{
+				return DoEndContainer(']', false);
+			}
+
+			// Keys are only allowed inside objects and must be followed by exactly one value
+			bool Key(std::string_view utf8);
+			bool Key(const std::string& utf8)
+			{
+				return Key(std::string_view(utf8));
+			}
+			bool Key(const char* utf8)
+			{
+				return Key(std::string_view(utf8 ? utf8 : ""));
+			}
+			bool Key(const String& key)
+			{
+				return Key(std::string_view(key.ToUTF8()));
+			}
+
+			bool Value(std::string_view utf8);
+			bool Value(const std::string& utf8)
+			{
+				return Value(std::string_view(utf8));
+			}
+			bool Value(const String& value)
+			{
+				return Value(std::string_view(value.ToUTF8()));
+			}
+			bool Value(const char* utf8)
+			{
+				return Value(std::string_view(utf8 ? utf8 : ""));
+			}
+			bool Value(const wchar_t* value)
+			{
+				return Value(String(value));
+			}
+			bool Value(int64_t value);
+			bool Value(uint64_t value);
+			bool Value(double value);
+			bool Value(bool value);
+			bool Value(std::nullptr_t);
+
+			template<class T>
+			requires(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+			bool Value(T value)
+			{
+				if constexpr(std::is_signed_v<T>)
+				{
+					return Value(static_cast<int64_t>(value));
+				}
+				else
+				{
+					return Value(static_cast<uint64_t>(value));
+				}
+			}
+
+			// Writes a whole subtree, streaming it item by item instead of serializing it into a string first
+			bool Value(const nlohmann::json& json);
+			bool Value(const JSONDocument& document);
+
+			// Checks that the document is complete (all the containers are closed) and writes out the buffered data
+			bool Finish();
+			bool Flush();
+
+			size_t GetDepth() const noexcept
+			{
+				return m_Stack.size();
+			}
+			bool HasError() const noexcept
+			{
+				return m_HasError;
+			}
+
+		public:
+			explicit operator bool() const noexcept
+			{
+				return !m_HasError;
+			}
+			bool operator!() const noexcept
+			{
+				return m_HasError;
+			}
+
+			JSONStreamWriter& operator=(const JSONStreamWriter&) = delete;
+	};
+}
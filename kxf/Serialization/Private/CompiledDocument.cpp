@@ -0,0 +1,100 @@
+#include "kxf-pch.h"
+#include "CompiledDocument.h"
+#include "kxf/IO/IStream.h"
+#include "kxf/IO/IDirectStream.h"
+
+// The hashing functions live in the crypto module which depends on this one, so xxHash is used directly here
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+namespace
+{
+	constexpr uint32_t g_Signature = 0x4643584b; // 'KXCF'
+	constexpr size_t g_BufferSize = kxf::DataSize::FromKB(64).ToBytes<size_t>();
+}
+
+namespace kxf::XDocument::Private
+{
+	uint64_t HashData(std::span<const std::byte> data) noexcept
+	{
+		return XXH3_64bits(data.data(), data.size());
+	}
+	uint64_t HashStream(IInputStream& stream)
+	{
+		XXH3_state_t state;
+		XXH3_64bits_reset(&state);
+
+		if (auto directStream = stream.QueryInterface<IDirectInputStream>())
+		{
+			for (auto data = directStream->GetReadBuffer(); !data.empty(); data = directStream->GetReadBuffer())
+			{
+				XXH3_64bits_update(&state, data.data(), data.size());
+				directStream->Consume(data.size());
+			}
+		}
+		else
+		{
+			auto buffer = std::make_unique<uint8_t[]>(g_BufferSize);
+			while (true)
+			{
+				const DataSize read = stream.Read(buffer.get(), g_BufferSize).LastRead();
+				if (!read.IsPositive())
+				{
+					break;
+				}
+				XXH3_64bits_update(&state, buffer.get(), static_cast<size_t>(read.ToBytes()));
+
+				if (stream.GetLastError().IsFail() || stream.GetLastError() == StreamErrorCode::EndOfStream)
+				{
+					break;
+				}
+			}
+		}
+		return XXH3_64bits_digest(&state);
+	}
+
+	bool WriteCompiledDocument(IOutputStream& stream, uint32_t format, uint32_t version, uint64_t sourceHash, std::span<const std::byte> payload)
+	{
+		CompiledDocumentHeader header;
+		header.Signature = g_Signature;
+		header.Format = format;
+		header.Version = version;
+		header.SourceHash = sourceHash;
+		header.PayloadSize = payload.size();
+		header.PayloadHash = HashData(payload);
+
+		return stream.WriteAll(&header, sizeof(header)) && stream.WriteAll(payload.data(), payload.size());
+	}
+	bool ReadCompiledDocument(IInputStream& stream, uint32_t format, uint32_t version, uint64_t sourceHash, std::vector<std::byte>& payload)
+	{
+		CompiledDocumentHeader header;
+		if (!stream.ReadAll(&header, sizeof(header)))
+		{
+			return false;
+		}
+		if (header.Signature != g_Signature || header.Format != format || header.Version != version || header.SourceHash != sourceHash)
+		{
+			return false;
+		}
+
+		// Don't trust the size from the header to allocate memory if the actual size is known
+		const DataSize size = stream.GetSize();
+		const DataSize offset = stream.TellI();
+		if (size.IsValid() && offset.IsValid() && static_cast<uint64_t>((size - offset).ToBytes()) < header.PayloadSize)
+		{
+			return false;
+		}
+		if (header.PayloadSize > std::numeric_limits<size_t>::max())
+		{
+			return false;
+		}
+
+		payload.resize(static_cast<size_t>(header.PayloadSize));
+		if (!stream.ReadAll(payload.data(), payload.size()) || HashData(payload) != header.PayloadHash)
+		{
+			payload.clear();
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "kxf/Serialization/Common.h"
+
+namespace kxf
+{
+	class IInputStream;
+	class IOutputStream;
+}
+
+namespace kxf::XDocument::Private
+{
+	// Envelope of the compiled documents: a fixed header followed by the format specific payload. The header identifies
+	// the format, ties the payload to the source it was compiled from and protects the payload against corruption.
+	struct CompiledDocumentHeader final
+	{
+		uint32_t Signature = 0;
+		uint32_t Format = 0;
+		uint32_t Version = 0;
+		uint32_t Reserved = 0;
+		uint64_t SourceHash = 0;
+		uint64_t PayloadSize = 0;
+		uint64_t PayloadHash = 0;
+	};
+	static_assert(sizeof(CompiledDocumentHeader) == 40);
+
+	uint64_t HashData(std::span<const std::byte> data) noexcept;
+	uint64_t HashStream(IInputStream& stream);
+
+	bool WriteCompiledDocument(IOutputStream& stream, uint32_t format, uint32_t version, uint64_t sourceHash, std::span<const std::byte> payload);
+	bool ReadCompiledDocument(IInputStream& stream, uint32_t format, uint32_t version, uint64_t sourceHash, std::vector<std::byte>& payload);
+}
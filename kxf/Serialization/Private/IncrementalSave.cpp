@@ -0,0 +1,98 @@
+#include "kxf-pch.h"
+#include "IncrementalSave.h"
+#include "CompiledDocument.h"
+#include "kxf/IO/IStream.h"
+
+namespace
+{
+	constexpr uint32_t g_Signature = 0x424a584b; // 'KXJB'
+}
+
+namespace kxf::XDocument::Private
+{
+	JournalWriteResult WriteJournalBatch(IOutputStream& stream, uint32_t format, std::span<const std::byte> payload)
+	{
+		JournalBatchHeader header;
+		header.Signature = g_Signature;
+		header.Format = format;
+		header.PayloadSize = payload.size();
+		header.PayloadHash = HashData(payload);
+
+		// Header and the payload are written at once, so the batch is either complete or easily recognized as broken
+		const DataSize start = stream.IsSeekable() ? stream.TellO() : DataSize();
+		const std::span<const std::byte> buffers[] = {std::as_bytes(std::span(&header, 1)), payload};
+
+		const DataSize written = stream.WriteV(buffers).LastWrite();
+		if (written.ToBytes() == static_cast<int64_t>(sizeof(header) + payload.size()))
+		{
+			return JournalWriteResult::Written;
+		}
+		if (written.ToBytes() <= 0)
+		{
+			return JournalWriteResult::Failed;
+		}
+
+		// Cut the partial batch off, otherwise it would hide all the batches appended after it
+		if (start.IsValid() && stream.SeekO(start, IOStreamSeek::FromStart).IsValid() && stream.SetAllocationSize(start))
+		{
+			return JournalWriteResult::Failed;
+		}
+		return JournalWriteResult::Torn;
+	}
+	bool ReadJournalBatch(IInputStream& stream, uint32_t format, std::vector<std::byte>& payload)
+	{
+		JournalBatchHeader header;
+		if (!stream.ReadAll(&header, sizeof(header)) || header.Signature != g_Signature || header.Format != format)
+		{
+			return false;
+		}
+
+		const DataSize size = stream.GetSize();
+		const DataSize offset = stream.TellI();
+		if (size.IsValid() && offset.IsValid() && static_cast<uint64_t>((size - offset).ToBytes()) < header.PayloadSize)
+		{
+			return false;
+		}
+		if (header.PayloadSize > std::numeric_limits<size_t>::max())
+		{
+			return false;
+		}
+
+		payload.resize(static_cast<size_t>(header.PayloadSize));
+		if (!stream.ReadAll(payload.data(), payload.size()) || HashData(payload) != header.PayloadHash)
+		{
+			payload.clear();
+			return false;
+		}
+		return true;
+	}
+
+	bool RewriteStream(IOutputStream& stream, std::span<const std::byte> image)
+	{
+		if (stream.IsSeekable())
+		{
+			return stream.RewindO().IsValid() && stream.WriteAll(image.data(), image.size()) && stream.SetAllocationSize(static_cast<int64_t>(image.size()));
+		}
+		return stream.WriteAll(image.data(), image.size());
+	}
+	bool PatchStream(IOutputStream& stream, uint64_t offset, std::string_view data, size_t capacity)
+	{
+		if (data.size() > capacity || !stream.SeekO(static_cast<int64_t>(offset), IOStreamSeek::FromStart).IsValid())
+		{
+			return false;
+		}
+
+		std::string padding(capacity - data.size(), ' ');
+		const std::span<const std::byte> buffers[] = {std::as_bytes(std::span(data)), std::as_bytes(std::span(padding))};
+		return stream.WriteV(buffers).LastWrite().ToBytes() == static_cast<int64_t>(capacity);
+	}
+	bool CanPatchStream(const IOutputStream& stream, uint64_t imageSize)
+	{
+		if (stream.IsSeekable())
+		{
+			const DataSize size = stream.GetSize();
+			return !size.IsValid() || static_cast<uint64_t>(size.ToBytes()) == imageSize;
+		}
+		return false;
+	}
+}
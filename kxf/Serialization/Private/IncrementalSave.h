@@ -0,0 +1,45 @@
+#pragma once
+#include "kxf/Serialization/Common.h"
+
+namespace kxf
+{
+	class IInputStream;
+	class IOutputStream;
+}
+
+namespace kxf::XDocument::Private
+{
+	// Journal of the incremental saves is a sequence of independent batches, each one holds the format specific records
+	// of the changes made since the previous one. A batch which was cut short by an interrupted write ends the journal.
+	struct JournalBatchHeader final
+	{
+		uint32_t Signature = 0;
+		uint32_t Format = 0;
+		uint64_t PayloadSize = 0;
+		uint64_t PayloadHash = 0;
+	};
+	static_assert(sizeof(JournalBatchHeader) == 24);
+
+	enum class JournalWriteResult
+	{
+		Written,
+
+		// Nothing was appended to the journal, or a partially written batch was cut off the stream
+		Failed,
+
+		// A part of the batch is left in the journal and every batch appended after it would be ignored when reading
+		Torn
+	};
+
+	JournalWriteResult WriteJournalBatch(IOutputStream& stream, uint32_t format, std::span<const std::byte> payload);
+	bool ReadJournalBatch(IInputStream& stream, uint32_t format, std::vector<std::byte>& payload);
+
+	// Writes the whole image from the start of the stream and truncates it after the image if the stream is seekable
+	bool RewriteStream(IOutputStream& stream, std::span<const std::byte> image);
+
+	// Overwrites a part of the image written earlier, the data is padded with spaces up to 'capacity'
+	bool PatchStream(IOutputStream& stream, uint64_t offset, std::string_view data, size_t capacity);
+
+	// True if the stream can be patched and still has the size of the image written to it by the previous save
+	bool CanPatchStream(const IOutputStream& stream, uint64_t imageSize);
+}
@@ -1,9 +1,26 @@
 #include "kxf-pch.h"
 #include "StringTokenizer.h"
+#include "kxf/Core/Private/StringScan.h"
 #include "kxf/Utility/ScopeGuard.h"
 
 namespace kxf
 {
+	bool StringTokenizer::ScanUntilIndex(size_t index, size_t skip) noexcept
+	{
+		SavePrevPosition();
+		Utility::ScopeGuard atExit = [&]()
+		{
+			UpdateCurrentToken();
+		};
+
+		if (index != StringView::npos)
+		{
+			m_CurrentPosition = m_Source.begin() + index + skip;
+			return true;
+		}
+		m_CurrentPosition = m_Source.end();
+		return false;
+	}
 	void StringTokenizer::UpdateCurrentToken()
 	{
 		if (m_PreviousPosition < m_Source.end())
@@ -72,47 +89,75 @@ namespace kxf
 	}
 	bool StringTokenizer::ScanUntil(UniChar c) noexcept
 	{
-		return ScanUntil([&](UniChar a)
+		if (auto utf16 = c.ToUTF16())
+		{
+			return ScanUntilIndex(Private::FindCharacter(m_Source, static_cast<XChar>(*utf16), GetCurrentPosition(), false), 0);
+		}
+		else if (!c.IsNull())
 		{
-			return a == c ? CallbackCommand::Terminate : CallbackCommand::Continue;
-		});
+			char16_t pair[2] = {};
+			c.ToUTF16(pair[1], pair[0]);
+			return ScanUntilIndex(m_Source.find(StringView(reinterpret_cast<const XChar*>(pair), 2), GetCurrentPosition()), 0);
+		}
+		return ScanUntilIndex(StringView::npos, 0);
 	}
 	bool StringTokenizer::ScanUntil(StringView pattern) noexcept
 	{
 		if (!pattern.empty())
 		{
-			return ScanUntil([&](UniChar a)
-			{
-				size_t index = m_Source.find(pattern, GetCurrentPosition());
-				if (index != StringView::npos)
-				{
-					m_CurrentPosition = m_Source.begin() + index + pattern.size();
-					return CallbackCommand::Terminate;
-				}
-				return CallbackCommand::Continue;
-			});
+			// The position is moved past the pattern if it's found
+			return ScanUntilIndex(m_Source.find(pattern, GetCurrentPosition()), pattern.length());
 		}
 		return false;
 	}
+	bool StringTokenizer::ScanUntilAny(StringView characters) noexcept
+	{
+		return ScanUntilIndex(Private::FindAnyCharacter(m_Source, characters, GetCurrentPosition(), false), 0);
+	}
+	bool StringTokenizer::ScanLine() noexcept
+	{
+		if (EndReached())
+		{
+			m_CurrentToken = {};
+			return false;
+		}
+
+		SavePrevPosition();
+		auto lineEnd = m_Source.end();
+		if (size_t index = Private::FindCharacter(m_Source, '\n', GetCurrentPosition(), false); index != StringView::npos)
+		{
+			lineEnd = m_Source.begin() + index;
+			m_CurrentPosition = lineEnd + 1;
+		}
+		else
+		{
+			m_CurrentPosition = m_Source.end();
+		}
+
+		if (lineEnd != m_PreviousPosition && *(lineEnd - 1) == '\r')
+		{
+			--lineEnd;
+		}
+		m_CurrentToken = StringView(m_PreviousPosition, lineEnd);
+		return true;
+	}
 	void StringTokenizer::Skip(UniChar c) noexcept
 	{
-		for (; m_CurrentPosition != m_Source.end(); ++m_CurrentPosition)
+		if (auto utf16 = c.ToUTF16(); utf16 && !EndReached())
 		{
-			if (*m_CurrentPosition != c)
-			{
-				break;
-			}
+			const XChar value = static_cast<XChar>(*utf16);
+			const size_t index = Private::FindAnyCharacter(m_Source, {&value, 1}, GetCurrentPosition(), false, true);
+			m_CurrentPosition = index != StringView::npos ? m_Source.begin() + index : m_Source.end();
 		}
 		m_PreviousPosition = m_CurrentPosition;
 	}
 	void StringTokenizer::SkipWhitespace() noexcept
 	{
-		for (; m_CurrentPosition != m_Source.end(); ++m_CurrentPosition)
+		if (!EndReached())
 		{
-			if (!UniChar(*m_CurrentPosition).IsWhitespace())
-			{
-				break;
-			}
+			const size_t offset = GetCurrentPosition();
+			const size_t index = Private::FindNonWhitespace(m_Source.substr(offset));
+			m_CurrentPosition = index != StringView::npos ? m_Source.begin() + offset + index : m_Source.end();
 		}
 		m_PreviousPosition = m_CurrentPosition;
 	}
@@ -20,6 +20,7 @@ namespace kxf
 				m_PreviousPosition = m_CurrentPosition;
 			}
 			void UpdateCurrentToken();
+			bool ScanUntilIndex(size_t index, size_t skip) noexcept;
 
 		public:
 			StringTokenizer(StringView ref) noexcept
@@ -63,6 +64,11 @@ namespace kxf
 			bool ScanUntil(CallbackFunction<UniChar> func) noexcept;
 			bool ScanUntil(UniChar c) noexcept;
 			bool ScanUntil(StringView pattern) noexcept;
+			bool ScanUntilAny(StringView characters) noexcept;
+
+			// Scans up to the next line break (LF or CRLF) and moves past it, the current token is the line without the line break.
+			// Returns false only if the end was already reached, the last line doesn't need to be terminated.
+			bool ScanLine() noexcept;
 			void Skip(UniChar c) noexcept;
 			void SkipWhitespace() noexcept;
 
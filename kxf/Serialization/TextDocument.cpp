@@ -2,8 +2,14 @@
 #include "TextDocument.h"
 #include "kxf/FileSystem/NativeFileSystem.h"
 #include "kxf/IO/StreamReaderWriter.h"
+#include "kxf/IO/MappedFileStream.h"
+#include "kxf/IO/LineReader.h"
+#include "kxf/Application/ICoreApplication.h"
 #include "kxf/Utility/ScopeGuard.h"
 #include <wx/textfile.h>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 namespace
 {
@@ -28,6 +34,249 @@ namespace
 		}
 		return wxTextFileType::wxTextFileType_None;
 	}
+
+	bool ReadLine(kxf::IO::LineReader& reader, std::string_view& line)
+	{
+		return reader.ReadLineUTF8(line);
+	}
+	bool ReadLine(kxf::IO::LineReader& reader, kxf::StringView& line)
+	{
+		return reader.ReadLine(line);
+	}
+
+	template<class TChar>
+	size_t DoReadLines(const kxf::FSPath& filePath, const std::function<bool(std::basic_string_view<TChar>)>& func)
+	{
+		using namespace kxf;
+
+		// Mapping fails for empty files, they're opened the usual way
+		NativeFileSystem fileSystem;
+		std::shared_ptr<IInputStream> stream;
+		if (auto mappedStream = fileSystem.CreateStream(filePath, IOStreamAccess::Read, IOStreamDisposition::OpenExisting, IOStreamShare::Read, IOStreamFlag::MemoryMapped))
+		{
+			stream = mappedStream->QueryInterface<IInputStream>();
+		}
+		if (!stream)
+		{
+			stream = fileSystem.OpenToRead(filePath);
+		}
+
+		size_t count = 0;
+		if (stream)
+		{
+			IO::LineReader reader(*stream);
+			std::basic_string_view<TChar> line;
+			while (ReadLine(reader, line))
+			{
+				count++;
+				if (!std::invoke(func, line))
+				{
+					break;
+				}
+			}
+		}
+		return count;
+	}
+
+	// State of a parallel read shared between the executor tasks. The chunks are claimed by the tasks one at a time, so a task
+	// which starts late (or never, if the executor is busy) doesn't hold anything up: the others, including the calling thread, take its share.
+	template<class TChar>
+	class ParallelLineReader final
+	{
+		public:
+			using TFunc = std::function<bool(std::basic_string_view<TChar>)>;
+
+		private:
+			kxf::FSPath m_FilePath;
+			TFunc m_Func;
+			uint64_t m_FileSize = 0;
+			uint64_t m_ChunkSize = 0;
+			size_t m_ChunkCount = 0;
+
+			std::atomic<size_t> m_NextChunk = 0;
+			std::atomic<size_t> m_LineCount = 0;
+			std::atomic<bool> m_Stop = false;
+
+			std::mutex m_Lock;
+			std::condition_variable m_Condition;
+			size_t m_CompletedCount = 0;
+			std::vector<size_t> m_FailedChunks;
+			std::exception_ptr m_Exception;
+
+		private:
+			// Returns false if the stream can't be positioned at the chunk, nothing is read then
+			bool ReadChunk(kxf::IInputStream& stream, size_t index)
+			{
+				using namespace kxf;
+
+				const uint64_t begin = index * m_ChunkSize;
+				const uint64_t end = std::min(begin + m_ChunkSize, m_FileSize);
+
+				// A line belongs to the chunk it starts in. Every chunk but the first one starts reading at the last byte of the previous
+				// chunk and skips the first line it reads, which is either the end of a line owned by the previous chunk or just its line break.
+				const uint64_t start = begin != 0 ? begin - 1 : 0;
+				if (!stream.SeekI(static_cast<int64_t>(start), IOStreamSeek::FromStart).IsValid())
+				{
+					return false;
+				}
+
+				IO::LineReader reader(stream);
+				std::basic_string_view<TChar> line;
+				if (begin != 0 && !ReadLine(reader, line))
+				{
+					return true;
+				}
+
+				while (!m_Stop && ReadLine(reader, line) && start + reader.GetLineOffset() < end)
+				{
+					m_LineCount++;
+					if (!std::invoke(m_Func, line))
+					{
+						m_Stop = true;
+					}
+				}
+				return true;
+			}
+			bool ReadMappedChunk(size_t index)
+			{
+				using namespace kxf;
+
+				MappedFileStream stream(m_FilePath, IOStreamAccess::Read, IOStreamDisposition::OpenExisting, IOStreamShare::Read);
+				if (!stream)
+				{
+					return false;
+				}
+				stream.SetMaxViewSize(static_cast<size_t>(m_ChunkSize));
+
+				return ReadChunk(stream, index);
+			}
+
+		public:
+			ParallelLineReader(kxf::FSPath filePath, TFunc func, uint64_t fileSize, size_t concurrency)
+				:m_FilePath(std::move(filePath)), m_Func(std::move(func)), m_FileSize(fileSize)
+			{
+				using namespace kxf;
+
+				// A few chunks per thread to even out the load, but not too small for the mapping overhead to matter
+				constexpr uint64_t minChunkSize = DataSize::FromMB(1).ToBytes();
+				constexpr uint64_t maxChunkSize = DataSize::FromMB(64).ToBytes();
+
+				m_ChunkSize = std::clamp<uint64_t>(fileSize / (std::max<size_t>(concurrency, 1) * 4), minChunkSize, maxChunkSize);
+				m_ChunkCount = static_cast<size_t>((fileSize + m_ChunkSize - 1) / m_ChunkSize);
+			}
+
+		public:
+			size_t GetChunkCount() const noexcept
+			{
+				return m_ChunkCount;
+			}
+
+			void Run()
+			{
+				for (size_t index = m_NextChunk++; index < m_ChunkCount; index = m_NextChunk++)
+				{
+					try
+					{
+						if (!m_Stop && !ReadMappedChunk(index))
+						{
+							std::lock_guard lock(m_Lock);
+							m_FailedChunks.push_back(index);
+						}
+					}
+					catch (...)
+					{
+						std::lock_guard lock(m_Lock);
+						if (!m_Exception)
+						{
+							m_Exception = std::current_exception();
+						}
+						m_Stop = true;
+					}
+
+					std::lock_guard lock(m_Lock);
+					if (++m_CompletedCount == m_ChunkCount)
+					{
+						m_Condition.notify_all();
+					}
+				}
+			}
+			size_t Wait()
+			{
+				using namespace kxf;
+
+				if (std::unique_lock lock(m_Lock); true)
+				{
+					m_Condition.wait(lock, [&]()
+					{
+						return m_CompletedCount == m_ChunkCount;
+					});
+
+					if (m_Exception)
+					{
+						std::rethrow_exception(m_Exception);
+					}
+				}
+
+				// The chunks which couldn't be mapped are read here from a regular stream, so a failed mapping costs the
+				// parallelism and not the lines. The count would look complete otherwise.
+				if (!m_FailedChunks.empty() && !m_Stop)
+				{
+					std::sort(m_FailedChunks.begin(), m_FailedChunks.end());
+
+					auto stream = NativeFileSystem().OpenToRead(m_FilePath);
+					for (size_t index: m_FailedChunks)
+					{
+						if (m_Stop)
+						{
+							break;
+						}
+						if (!stream || !ReadChunk(*stream, index))
+						{
+							throw std::runtime_error(__FUNCTION__ ": Failed to read a chunk of the file");
+						}
+					}
+				}
+				return m_LineCount;
+			}
+	};
+
+	template<class TChar>
+	size_t DoReadLinesParallel(const kxf::FSPath& filePath, std::function<bool(std::basic_string_view<TChar>)> func, std::shared_ptr<kxf::IAsyncTaskExecutor> taskExecutor)
+	{
+		using namespace kxf;
+
+		const DataSize fileSize = NativeFileSystem().GetItem(filePath).GetSize();
+		if (!fileSize.IsPositive())
+		{
+			return 0;
+		}
+
+		if (!taskExecutor)
+		{
+			if (auto app = ICoreApplication::GetInstance())
+			{
+				taskExecutor = RTTI::assume_non_owned(app->GetTaskExecutor());
+			}
+		}
+
+		const size_t concurrency = std::max(std::thread::hardware_concurrency(), 1u);
+		auto reader = std::make_shared<ParallelLineReader<TChar>>(filePath, std::move(func), static_cast<uint64_t>(fileSize.ToBytes()), concurrency);
+
+		if (taskExecutor && taskExecutor->IsRunning())
+		{
+			const size_t taskCount = std::min(reader->GetChunkCount(), concurrency) - 1;
+			for (size_t i = 0; i < taskCount; i++)
+			{
+				taskExecutor->QueueTask([reader]()
+				{
+					reader->Run();
+				});
+			}
+		}
+		reader->Run();
+
+		return reader->Wait();
+	}
 }
 
 namespace kxf::TextDocument
@@ -55,6 +304,24 @@ namespace kxf::TextDocument
 		}
 		return 0;
 	}
+	size_t ReadLines(const FSPath& filePath, std::function<bool(StringView)> func)
+	{
+		return DoReadLines<XChar>(filePath, func);
+	}
+	size_t ReadLinesUTF8(const FSPath& filePath, std::function<bool(std::string_view)> func)
+	{
+		return DoReadLines<char>(filePath, func);
+	}
+
+	size_t ReadLinesParallel(const FSPath& filePath, std::function<bool(StringView)> func, std::shared_ptr<IAsyncTaskExecutor> taskExecutor)
+	{
+		return DoReadLinesParallel<XChar>(filePath, std::move(func), std::move(taskExecutor));
+	}
+	size_t ReadLinesParallelUTF8(const FSPath& filePath, std::function<bool(std::string_view)> func, std::shared_ptr<IAsyncTaskExecutor> taskExecutor)
+	{
+		return DoReadLinesParallel<char>(filePath, std::move(func), std::move(taskExecutor));
+	}
+
 	String Read(const FSPath& filePath, LineBreakFormat lineBreakFormat)
 	{
 		String result;
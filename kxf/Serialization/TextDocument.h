@@ -2,12 +2,25 @@
 #include "Common.h"
 #include "String.h"
 #include "kxf/FileSystem/FSPath.h"
+#include "kxf/Core/IAsyncTaskExecutor.h"
 
 namespace kxf::TextDocument
 {
 	size_t Read(const FSPath& filePath, std::function<bool(String)> func);
 	String Read(const FSPath& filePath, LineBreakFormat lineBreakFormat = LineBreakFormat::Windows);
 
+	// Reads the file as UTF-8 text line by line without converting the whole file first, see 'IO::LineReader' for the details.
+	// The lines are views into a buffer which is reused for the next line. Returns the number of lines passed to the callback.
+	size_t ReadLines(const FSPath& filePath, std::function<bool(StringView)> func);
+	size_t ReadLinesUTF8(const FSPath& filePath, std::function<bool(std::string_view)> func);
+
+	// Splits the memory mapped file into chunks at the line boundaries and reads them in parallel on the task executor (the application one
+	// if not specified), the calling thread reads its share of the chunks too. The callback is called concurrently and the lines keep their
+	// order only within a chunk. Returning false from the callback stops reading all the chunks as soon as possible.
+	// The chunks which can't be mapped are read afterwards on the calling thread, an exception is thrown if that fails too.
+	size_t ReadLinesParallel(const FSPath& filePath, std::function<bool(StringView)> func, std::shared_ptr<IAsyncTaskExecutor> taskExecutor = {});
+	size_t ReadLinesParallelUTF8(const FSPath& filePath, std::function<bool(std::string_view)> func, std::shared_ptr<IAsyncTaskExecutor> taskExecutor = {});
+
 	bool Write(const FSPath& filePath, const String& text, bool append = false, LineBreakFormat lineBreakFormat = LineBreakFormat::Windows);
 	bool Write(const FSPath& filePath, std::function<String()> func, bool append = false, LineBreakFormat lineBreakFormat = LineBreakFormat::Windows);
 }
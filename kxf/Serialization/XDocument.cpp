@@ -1,5 +1,7 @@
 #include "kxf-pch.h"
 #include "XDocument.h"
+#include "XDocumentSchema.h"
+#include "Private/CompiledDocument.h"
 
 namespace kxf::XDocument
 {
@@ -23,4 +25,78 @@ namespace kxf::XDocument
 		}
 		return {elementName, index};
 	}
+
+	uint64_t HashSource(std::span<const std::byte> data) noexcept
+	{
+		return Private::HashData(data);
+	}
+	uint64_t HashSource(IInputStream& stream)
+	{
+		return Private::HashStream(stream);
+	}
+}
+
+namespace kxf
+{
+	std::unique_ptr<XDocument::ISchemaWriter> IXDocument::CreateSchemaWriter()
+	{
+		return nullptr;
+	}
+	std::unique_ptr<XDocument::ISchemaReader> IXDocument::CreateSchemaReader() const
+	{
+		return nullptr;
+	}
+}
+
+namespace kxf::XDocument
+{
+	bool ISchemaWriter::WriteInteger(StringView name, int64_t value, FieldKind kind)
+	{
+		return WriteString(name, String::FromInteger(value), kind);
+	}
+	bool ISchemaWriter::WriteUnsigned(StringView name, uint64_t value, FieldKind kind)
+	{
+		return WriteString(name, String::FromInteger(value), kind);
+	}
+	bool ISchemaWriter::WriteFloat(StringView name, double value, FieldKind kind)
+	{
+		return WriteString(name, String::FromFloatingPoint(value), kind);
+	}
+	bool ISchemaWriter::WriteBool(StringView name, bool value, FieldKind kind)
+	{
+		return WriteString(name, String::FromBoolean(value), kind);
+	}
+
+	std::optional<int64_t> ISchemaReader::ReadInteger(StringView name, FieldKind kind)
+	{
+		if (auto value = ReadString(name, kind))
+		{
+			return value->ParseInteger<int64_t>();
+		}
+		return {};
+	}
+	std::optional<uint64_t> ISchemaReader::ReadUnsigned(StringView name, FieldKind kind)
+	{
+		if (auto value = ReadString(name, kind))
+		{
+			return value->ParseInteger<uint64_t>();
+		}
+		return {};
+	}
+	std::optional<double> ISchemaReader::ReadFloat(StringView name, FieldKind kind)
+	{
+		if (auto value = ReadString(name, kind))
+		{
+			return value->ParseFloatingPoint<double>();
+		}
+		return {};
+	}
+	std::optional<bool> ISchemaReader::ReadBool(StringView name, FieldKind kind)
+	{
+		if (auto value = ReadString(name, kind))
+		{
+			return value->ParseBoolean();
+		}
+		return {};
+	}
 }
@@ -11,6 +11,11 @@ namespace kxf
 	class IOutputStream;
 }
 namespace kxf::XDocument
+{
+	class ISchemaWriter;
+	class ISchemaReader;
+}
+namespace kxf::XDocument
 {
 	enum class AsCDATA
 	{
@@ -18,9 +23,26 @@ namespace kxf::XDocument
 		Always = 1,
 		Never = 0,
 	};
+	enum class SaveMode
+	{
+		// The whole document is written from the start of the stream which is truncated after it
+		Full,
+
+		// Only the parts of the image written by the previous save into the same stream which have changed since then
+		// are rewritten in place. Falls back to a full save if there is no such image or the changes don't fit into it.
+		Patch,
+
+		// The changes made since the previous save are appended to a separate journal stream. The journal is replayed on top of
+		// the document loaded from the last full or patch save and becomes obsolete after the next one.
+		Journal
+	};
 
 	std::pair<kxf::StringView, int> ExtractIndexFromElementName(kxf::StringView elementName, kxf::XChar indexSeparator);
 	std::pair<kxf::StringView, int> ExtractIndexFromElementName(kxf::StringView elementName, kxf::StringView indexSeparator);
+
+	// Content hash of a document source, compiled documents are only loaded back if it matches the one they were compiled for
+	KXF_API uint64_t HashSource(std::span<const std::byte> data) noexcept;
+	KXF_API uint64_t HashSource(IInputStream& stream);
 }
 
 namespace kxf
@@ -51,6 +73,10 @@ namespace kxf
 			virtual bool LoadDocument(IInputStream& stream) = 0;
 			virtual bool SaveDocument(IOutputStream& stream) const = 0;
 
+			// Cursors for the schema-driven serialization (see 'XDocument::SerializeObject'), null if the format doesn't support it
+			virtual std::unique_ptr<XDocument::ISchemaWriter> CreateSchemaWriter();
+			virtual std::unique_ptr<XDocument::ISchemaReader> CreateSchemaReader() const;
+
 		public:
 			explicit operator bool() const
 			{
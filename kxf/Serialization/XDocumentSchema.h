@@ -0,0 +1,379 @@
+#pragma once
+#include "Common.h"
+#include "XDocument.h"
+#include "BinarySerializer.h"
+#include <tuple>
+
+namespace kxf::XDocument
+{
+	enum class FieldKind
+	{
+		// Child element for XML, member for JSON and a key for INI
+		Value,
+
+		// Attribute of the enclosing element for XML, the same as 'Value' for the other formats
+		Attribute
+	};
+
+	template<class TClass, class TValue>
+	struct FieldDescriptor final
+	{
+		using ClassType = TClass;
+		using ValueType = TValue;
+
+		StringView Name;
+		TValue TClass::* Member = nullptr;
+		FieldKind Kind = FieldKind::Value;
+	};
+
+	template<class TClass, class TValue>
+	constexpr FieldDescriptor<TClass, TValue> Field(StringView name, TValue TClass::* member) noexcept
+	{
+		return {name, member, FieldKind::Value};
+	}
+
+	template<class TClass, class TValue>
+	constexpr FieldDescriptor<TClass, TValue> AttributeField(StringView name, TValue TClass::* member) noexcept
+	{
+		return {name, member, FieldKind::Attribute};
+	}
+
+	// Specialize for a type to make it serializable as a whole with 'SerializeObject' and 'BinarySerializer':
+	//
+	// template<>
+	// struct kxf::XDocument::Schema<Point> final
+	// {
+	// 	static constexpr auto Fields = std::tuple(XDocument::Field(L"X", &Point::X), XDocument::Field(L"Y", &Point::Y));
+	// };
+	//
+	// Supported field types are bool, integers, enumerations, floating point numbers, 'String', other types with
+	// a schema and 'std::vector' of any of these. The character types are stored as their codes, same as the integers.
+	// The fields are processed in the order they're listed in.
+	template<class T>
+	struct Schema;
+
+	template<class T>
+	concept HasSchema = requires
+	{
+		std::tuple_size<std::remove_cvref_t<decltype(Schema<T>::Fields)>>::value;
+	};
+}
+
+namespace kxf::XDocument
+{
+	// Cursor which builds a document as the serialization engine walks the object. Fields are written into the
+	// current object, an empty name refers to the next item of the current array. Returning false from 'Begin*'
+	// means the format can't represent the object or the array at this place and its contents are skipped.
+	class KXF_API ISchemaWriter
+	{
+		public:
+			virtual ~ISchemaWriter() = default;
+
+		public:
+			virtual bool BeginObject(StringView name) = 0;
+			virtual void EndObject() = 0;
+			virtual bool BeginArray(StringView name) = 0;
+			virtual void EndArray() = 0;
+
+			// The text formats only need to implement the string variant, the rest of them format their values with the same rules
+			// the 'SetValue' functions of the document nodes use.
+			virtual bool WriteString(StringView name, const String& value, FieldKind kind) = 0;
+			virtual bool WriteInteger(StringView name, int64_t value, FieldKind kind);
+			virtual bool WriteUnsigned(StringView name, uint64_t value, FieldKind kind);
+			virtual bool WriteFloat(StringView name, double value, FieldKind kind);
+			virtual bool WriteBool(StringView name, bool value, FieldKind kind);
+	};
+
+	// Cursor which reads a document as the serialization engine walks the object. Missing values leave the fields unchanged.
+	// Inside of an array, 'NextItem' moves to the next item which is then read with an empty name or entered as an object.
+	class KXF_API ISchemaReader
+	{
+		public:
+			virtual ~ISchemaReader() = default;
+
+		public:
+			virtual bool EnterObject(StringView name) = 0;
+			virtual void LeaveObject() = 0;
+			virtual bool EnterArray(StringView name) = 0;
+			virtual bool NextItem() = 0;
+			virtual void LeaveArray() = 0;
+
+			virtual std::optional<String> ReadString(StringView name, FieldKind kind) = 0;
+			virtual std::optional<int64_t> ReadInteger(StringView name, FieldKind kind);
+			virtual std::optional<uint64_t> ReadUnsigned(StringView name, FieldKind kind);
+			virtual std::optional<double> ReadFloat(StringView name, FieldKind kind);
+			virtual std::optional<bool> ReadBool(StringView name, FieldKind kind);
+	};
+}
+
+namespace kxf::XDocument::Private
+{
+	template<class T>
+	struct IsVector: std::false_type {};
+
+	template<class T, class TAllocator>
+	struct IsVector<std::vector<T, TAllocator>>: std::true_type {};
+
+	template<class T, class TSource>
+	bool AssignInteger(T& value, const std::optional<TSource>& source)
+	{
+		// 'std::in_range' doesn't accept the character types, they have the range of the integer of the same size and signedness
+		using TRange = std::conditional_t<std::is_signed_v<T>, std::make_signed_t<T>, std::make_unsigned_t<T>>;
+
+		if (source && std::in_range<TRange>(*source))
+		{
+			value = static_cast<T>(*source);
+			return true;
+		}
+		return false;
+	}
+
+	template<class T>
+	bool WriteField(ISchemaWriter& writer, StringView name, const T& value, FieldKind kind);
+
+	template<class T>
+	bool ReadField(ISchemaReader& reader, StringView name, T& value, FieldKind kind);
+
+	template<class T>
+	bool WriteFields(ISchemaWriter& writer, const T& object)
+	{
+		// Every field is written even if some of them fail, in the schema order
+		bool result = true;
+		std::apply([&](const auto&... fields)
+		{
+			((result = WriteField(writer, fields.Name, object.*(fields.Member), fields.Kind) && result), ...);
+		}, Schema<T>::Fields);
+
+		return result;
+	}
+
+	template<class T>
+	bool ReadFields(ISchemaReader& reader, T& object)
+	{
+		bool result = false;
+		std::apply([&](const auto&... fields)
+		{
+			((result = ReadField(reader, fields.Name, object.*(fields.Member), fields.Kind) || result), ...);
+		}, Schema<T>::Fields);
+
+		return result;
+	}
+
+	template<class T>
+	bool WriteField(ISchemaWriter& writer, StringView name, const T& value, FieldKind kind)
+	{
+		if constexpr(HasSchema<T>)
+		{
+			if (writer.BeginObject(name))
+			{
+				const bool result = WriteFields(writer, value);
+				writer.EndObject();
+
+				return result;
+			}
+			return false;
+		}
+		else if constexpr(IsVector<T>::value)
+		{
+			if (writer.BeginArray(name))
+			{
+				bool result = true;
+				for (const auto& item: value)
+				{
+					result = WriteField(writer, {}, item, FieldKind::Value) && result;
+				}
+				writer.EndArray();
+
+				return result;
+			}
+			return false;
+		}
+		else if constexpr(std::is_same_v<T, bool>)
+		{
+			return writer.WriteBool(name, value, kind);
+		}
+		else if constexpr(std::is_enum_v<T>)
+		{
+			return WriteField(writer, name, static_cast<std::underlying_type_t<T>>(value), kind);
+		}
+		else if constexpr(std::is_integral_v<T> && std::is_signed_v<T>)
+		{
+			return writer.WriteInteger(name, value, kind);
+		}
+		else if constexpr(std::is_integral_v<T>)
+		{
+			return writer.WriteUnsigned(name, value, kind);
+		}
+		else if constexpr(std::is_floating_point_v<T>)
+		{
+			return writer.WriteFloat(name, value, kind);
+		}
+		else if constexpr(std::is_same_v<T, String>)
+		{
+			return writer.WriteString(name, value, kind);
+		}
+		else
+		{
+			static_assert(sizeof(T) == 0, "XDocument: unsupported field type");
+		}
+	}
+
+	template<class T>
+	bool ReadField(ISchemaReader& reader, StringView name, T& value, FieldKind kind)
+	{
+		if constexpr(HasSchema<T>)
+		{
+			if (reader.EnterObject(name))
+			{
+				const bool result = ReadFields(reader, value);
+				reader.LeaveObject();
+
+				return result;
+			}
+			return false;
+		}
+		else if constexpr(IsVector<T>::value)
+		{
+			if (reader.EnterArray(name))
+			{
+				value.clear();
+				while (reader.NextItem())
+				{
+					if (typename T::value_type item{}; ReadField(reader, {}, item, FieldKind::Value))
+					{
+						value.emplace_back(std::move(item));
+					}
+				}
+				reader.LeaveArray();
+
+				return true;
+			}
+			return false;
+		}
+		else if constexpr(std::is_same_v<T, bool>)
+		{
+			if (auto result = reader.ReadBool(name, kind))
+			{
+				value = *result;
+				return true;
+			}
+			return false;
+		}
+		else if constexpr(std::is_enum_v<T>)
+		{
+			std::underlying_type_t<T> result = {};
+			if (ReadField(reader, name, result, kind))
+			{
+				value = static_cast<T>(result);
+				return true;
+			}
+			return false;
+		}
+		else if constexpr(std::is_integral_v<T> && std::is_signed_v<T>)
+		{
+			return AssignInteger(value, reader.ReadInteger(name, kind));
+		}
+		else if constexpr(std::is_integral_v<T>)
+		{
+			return AssignInteger(value, reader.ReadUnsigned(name, kind));
+		}
+		else if constexpr(std::is_floating_point_v<T>)
+		{
+			if (auto result = reader.ReadFloat(name, kind))
+			{
+				value = static_cast<T>(*result);
+				return true;
+			}
+			return false;
+		}
+		else if constexpr(std::is_same_v<T, String>)
+		{
+			if (auto result = reader.ReadString(name, kind))
+			{
+				value = std::move(*result);
+				return true;
+			}
+			return false;
+		}
+		else
+		{
+			static_assert(sizeof(T) == 0, "XDocument: unsupported field type");
+		}
+	}
+}
+
+namespace kxf::XDocument
+{
+	// Serializes the whole object in a single pass over its schema. With a non-empty name the object is written as a child object
+	// (the root element for XML) of that name, otherwise its fields go right into the current object of the writer.
+	template<HasSchema T>
+	bool SerializeObject(ISchemaWriter& writer, const T& object, StringView name = {})
+	{
+		if (!name.empty())
+		{
+			return Private::WriteField(writer, name, object, FieldKind::Value);
+		}
+		return Private::WriteFields(writer, object);
+	}
+
+	// Returns true if at least one field has been read
+	template<HasSchema T>
+	bool DeserializeObject(ISchemaReader& reader, T& object, StringView name = {})
+	{
+		if (!name.empty())
+		{
+			return Private::ReadField(reader, name, object, FieldKind::Value);
+		}
+		return Private::ReadFields(reader, object);
+	}
+
+	template<HasSchema T>
+	bool SerializeObject(IXDocument& document, const T& object, StringView name = {})
+	{
+		if (auto writer = document.CreateSchemaWriter())
+		{
+			return SerializeObject(*writer, object, name);
+		}
+		return false;
+	}
+
+	template<HasSchema T>
+	bool DeserializeObject(const IXDocument& document, T& object, StringView name = {})
+	{
+		if (auto reader = document.CreateSchemaReader())
+		{
+			return DeserializeObject(*reader, object, name);
+		}
+		return false;
+	}
+}
+
+namespace kxf
+{
+	// Binary form of a type with a schema is just its fields in the schema order, without any names
+	template<class T>
+	requires(XDocument::HasSchema<T>)
+	struct BinarySerializer<T> final
+	{
+		uint64_t Serialize(IOutputStream& stream, const T& value) const
+		{
+			uint64_t written = 0;
+			std::apply([&](const auto&... fields)
+			{
+				((written += Serialization::WriteObject(stream, value.*(fields.Member))), ...);
+			}, XDocument::Schema<T>::Fields);
+
+			return written;
+		}
+		uint64_t Deserialize(IInputStream& stream, T& value) const
+		{
+			uint64_t read = 0;
+			std::apply([&](const auto&... fields)
+			{
+				((read += Serialization::ReadObject(stream, value.*(fields.Member))), ...);
+			}, XDocument::Schema<T>::Fields);
+
+			return read;
+		}
+	};
+}
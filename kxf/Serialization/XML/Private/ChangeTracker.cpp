@@ -0,0 +1,457 @@
+#include "kxf-pch.h"
+#include "ChangeTracker.h"
+#include "XMLPrinter.h"
+#include "kxf/IO/MemoryStream.h"
+#include "kxf/Serialization/BinarySerializer.h"
+#include "kxf/Serialization/Private/IncrementalSave.h"
+
+namespace
+{
+	using namespace kxf;
+	using kxf::XML::Private::ChangeTracker;
+
+	constexpr uint32_t g_JournalFormat = 0x4c4d5800; // 'XML'
+
+	// Default printer which also records where every element ends up in the printed text. The recorded range of an element
+	// spans from its opening '<' to the end of its closing tag, without the indentation before and the line break after it.
+	class XMLLayoutPrinter final: public XML::Private::XMLPrinterDefault
+	{
+		private:
+			struct Item final
+			{
+				const tinyxml2::XMLElement* Element = nullptr;
+				size_t Offset = 0;
+				bool IsInline = false;
+			};
+
+		private:
+			ChangeTracker::Layout& m_Layout;
+			uint64_t m_BaseOffset = 0;
+			int m_BaseDepth = 0;
+
+			std::vector<Item> m_Stack;
+			size_t m_ElementOffset = 0;
+
+			// Mirrors the text depth of the base printer: the level of the element which got a text child and
+			// prints the rest of its content without line breaks.
+			int m_TextDepth = -1;
+
+		private:
+			size_t GetLength() const noexcept
+			{
+				return static_cast<size_t>(CStrSize()) - 1;
+			}
+
+		public:
+			XMLLayoutPrinter(ChangeTracker::Layout& layout, uint64_t baseOffset = 0, int depth = 0)
+				:XMLPrinterDefault(nullptr, false, depth), m_Layout(layout), m_BaseOffset(baseOffset), m_BaseDepth(depth)
+			{
+			}
+
+		public:
+			std::string_view GetText() const noexcept
+			{
+				return {CStr(), GetLength()};
+			}
+
+		public:
+			// tinyxml2::XMLVisitor
+			using XMLPrinterDefault::VisitEnter;
+			using XMLPrinterDefault::VisitExit;
+			using XMLPrinterDefault::Visit;
+
+			bool VisitEnter(const tinyxml2::XMLElement& element, const tinyxml2::XMLAttribute* attribute) override
+			{
+				const bool isInline = m_TextDepth >= 0;
+				const bool result = XMLPrinterDefault::VisitEnter(element, attribute);
+				m_Stack.push_back({&element, m_ElementOffset, isInline});
+
+				return result;
+			}
+			bool VisitExit(const tinyxml2::XMLElement& element) override
+			{
+				const bool result = XMLPrinterDefault::VisitExit(element);
+				const Item item = m_Stack.back();
+				m_Stack.pop_back();
+
+				// The elements at the top level are followed by a line break
+				const int depth = m_BaseDepth + static_cast<int>(m_Stack.size());
+				const size_t end = GetLength() - (depth == 0 ? 1 : 0);
+				if (m_TextDepth == static_cast<int>(m_Stack.size()))
+				{
+					m_TextDepth = -1;
+				}
+
+				ChangeTracker::Range range;
+				range.Offset = m_BaseOffset + item.Offset;
+				range.Length = end - item.Offset;
+				range.Capacity = range.Length;
+				range.Depth = depth;
+				range.IsInline = item.IsInline;
+				m_Layout.insert_or_assign(&element, range);
+
+				return result;
+			}
+			bool Visit(const tinyxml2::XMLText& text) override
+			{
+				m_TextDepth = static_cast<int>(m_Stack.size()) - 1;
+				return XMLPrinterDefault::Visit(text);
+			}
+
+		protected:
+			// tinyxml2::XMLPrinter
+			void OpenElement(const char* name, bool compactMode) override
+			{
+				XMLPrinterDefault::OpenElement(name, compactMode);
+				m_ElementOffset = GetLength() - std::strlen(name) - 1;
+			}
+	};
+
+	template<class TNode>
+	std::string PrintCompact(const TNode& node)
+	{
+		XML::Private::XMLPrinterDefault printer(nullptr, true);
+		node.Accept(&printer);
+
+		return {printer.CStr(), static_cast<size_t>(printer.CStrSize()) - 1};
+	}
+
+	// Position of the node as the indices of it and its ancestors among their siblings, starting from the top level
+	std::vector<uint32_t> GetNodePath(const tinyxml2::XMLNode& node)
+	{
+		std::vector<uint32_t> path;
+		for (auto item = &node; item->Parent(); item = item->Parent())
+		{
+			uint32_t index = 0;
+			for (auto sibling = item->PreviousSibling(); sibling; sibling = sibling->PreviousSibling())
+			{
+				index++;
+			}
+			path.push_back(index);
+		}
+		std::reverse(path.begin(), path.end());
+
+		return path;
+	}
+	tinyxml2::XMLNode* FindNode(tinyxml2::XMLDocument& document, const std::vector<uint32_t>& path)
+	{
+		tinyxml2::XMLNode* node = &document;
+		for (uint32_t index: path)
+		{
+			node = node->FirstChild();
+			for (uint32_t i = 0; node && i < index; i++)
+			{
+				node = node->NextSibling();
+			}
+
+			if (!node)
+			{
+				return nullptr;
+			}
+		}
+		return node;
+	}
+}
+
+namespace kxf::XML::Private
+{
+	void ChangeTracker::Forget(const tinyxml2::XMLNode& node)
+	{
+		m_Modified.erase(&node);
+		m_Layout.erase(&node);
+
+		for (auto child = node.FirstChild(); child; child = child->NextSibling())
+		{
+			Forget(*child);
+		}
+	}
+	bool ChangeTracker::CollectModified(std::vector<const tinyxml2::XMLElement*>& elements, bool forPatch) const
+	{
+		// A patch replaces the printed range of an element, so an element without one is covered by its closest ancestor which has it
+		std::unordered_set<const tinyxml2::XMLNode*> candidates;
+		for (const tinyxml2::XMLNode* node: m_Modified)
+		{
+			if (forPatch)
+			{
+				while (node && node->ToElement())
+				{
+					if (auto it = m_Layout.find(node); it != m_Layout.end() && !it->second.IsInline)
+					{
+						break;
+					}
+					node = node->Parent();
+				}
+				if (!node || !node->ToElement())
+				{
+					return false;
+				}
+			}
+			candidates.insert(node);
+		}
+
+		// The subtrees of the modified elements are written as a whole, so the modified elements inside of them are skipped
+		elements.clear();
+		for (const tinyxml2::XMLNode* node: candidates)
+		{
+			auto parent = node->Parent();
+			while (parent && !candidates.contains(parent))
+			{
+				parent = parent->Parent();
+			}
+
+			if (!parent)
+			{
+				elements.push_back(node->ToElement());
+			}
+		}
+		return true;
+	}
+	void ChangeTracker::OnSaved() noexcept
+	{
+		m_Modified.clear();
+		m_DocumentModified = false;
+	}
+
+	void ChangeTracker::OnNodeChanged(const tinyxml2::XMLNode& node)
+	{
+		// Changes of the nodes which aren't in the document yet are picked up when they're inserted
+		const tinyxml2::XMLNode* element = nullptr;
+		const tinyxml2::XMLNode* item = &node;
+		for (; item && !item->ToDocument(); item = item->Parent())
+		{
+			if (!element && item->ToElement())
+			{
+				element = item;
+			}
+		}
+
+		if (item)
+		{
+			if (element)
+			{
+				m_Modified.insert(element);
+			}
+			else
+			{
+				m_DocumentModified = true;
+			}
+		}
+	}
+	void ChangeTracker::OnSubtreeAdded(const tinyxml2::XMLNode& node)
+	{
+		if (auto parent = node.Parent())
+		{
+			OnNodeChanged(*parent);
+		}
+	}
+	void ChangeTracker::OnSubtreeRemoved(const tinyxml2::XMLNode& node)
+	{
+		if (auto parent = node.Parent())
+		{
+			OnNodeChanged(*parent);
+		}
+		Forget(node);
+	}
+	void ChangeTracker::OnChildrenRemoved(const tinyxml2::XMLNode& node)
+	{
+		OnNodeChanged(node);
+		for (auto child = node.FirstChild(); child; child = child->NextSibling())
+		{
+			Forget(*child);
+		}
+	}
+	void ChangeTracker::OnCleared() noexcept
+	{
+		m_Modified.clear();
+		m_Layout.clear();
+		m_HasImage = false;
+		m_DocumentModified = true;
+	}
+	void ChangeTracker::OnLoaded() noexcept
+	{
+		m_Modified.clear();
+		m_Layout.clear();
+		m_HasImage = false;
+		m_IsJournalTorn = false;
+		m_DocumentModified = false;
+	}
+
+	bool ChangeTracker::SaveFull(const tinyxml2::XMLDocument& document, IOutputStream& stream)
+	{
+		Layout layout;
+		XMLLayoutPrinter printer(layout);
+		document.Print(&printer);
+
+		const std::string_view image = printer.GetText();
+		if (XDocument::Private::RewriteStream(stream, std::as_bytes(std::span(image))))
+		{
+			m_Layout = std::move(layout);
+			m_ImageSize = image.size();
+			m_HasImage = stream.IsSeekable();
+			m_IsJournalTorn = false;
+			OnSaved();
+
+			return true;
+		}
+
+		m_Layout.clear();
+		m_HasImage = false;
+		return false;
+	}
+	bool ChangeTracker::SavePatch(const tinyxml2::XMLDocument& document, IOutputStream& stream)
+	{
+		if (!m_HasImage || m_DocumentModified || !XDocument::Private::CanPatchStream(stream, m_ImageSize))
+		{
+			return SaveFull(document, stream);
+		}
+
+		std::vector<const tinyxml2::XMLElement*> elements;
+		if (!CollectModified(elements, true))
+		{
+			return SaveFull(document, stream);
+		}
+
+		// Print every modified subtree at its original depth first, nothing is written unless all of them fit into their old places
+		struct Patch final
+		{
+			const tinyxml2::XMLElement* Element = nullptr;
+			Layout Ranges;
+			std::string Text;
+		};
+		std::vector<Patch> patches;
+		patches.reserve(elements.size());
+
+		for (const tinyxml2::XMLElement* element: elements)
+		{
+			const Range& range = m_Layout.at(element);
+
+			Patch& patch = patches.emplace_back();
+			patch.Element = element;
+
+			XMLLayoutPrinter printer(patch.Ranges, range.Offset, range.Depth);
+			element->Accept(&printer);
+			patch.Text = printer.GetText().substr(0, patch.Ranges.at(element).Length);
+
+			// Padding is only invisible when it's followed by markup, next to a text node it would become a part of the text
+			if (patch.Text.size() > range.Capacity)
+			{
+				return SaveFull(document, stream);
+			}
+			else if (auto next = element->NextSibling(); patch.Text.size() != range.Capacity && next && next->ToText())
+			{
+				return SaveFull(document, stream);
+			}
+		}
+
+		for (Patch& patch: patches)
+		{
+			const size_t capacity = m_Layout.at(patch.Element).Capacity;
+			if (!XDocument::Private::PatchStream(stream, patch.Ranges.at(patch.Element).Offset, patch.Text, capacity))
+			{
+				// The image is in an unknown state now
+				return SaveFull(document, stream);
+			}
+
+			for (auto& [node, range]: patch.Ranges)
+			{
+				m_Layout.insert_or_assign(node, range);
+			}
+			m_Layout.at(patch.Element).Capacity = capacity;
+		}
+
+		stream.SeekO(static_cast<int64_t>(m_ImageSize), IOStreamSeek::FromStart);
+		OnSaved();
+		return true;
+	}
+	bool ChangeTracker::SaveJournal(const tinyxml2::XMLDocument& document, IOutputStream& stream)
+	{
+		if (!IsModified())
+		{
+			return true;
+		}
+		if (m_IsJournalTorn)
+		{
+			return false;
+		}
+
+		// Every record replaces the node at the given path with the serialized subtree, an empty path stands for the whole document
+		MemoryOutputStream payload;
+		if (m_DocumentModified)
+		{
+			Serialization::WriteObject(payload, std::vector<uint32_t>());
+			Serialization::WriteObject(payload, PrintCompact(document));
+		}
+		else
+		{
+			std::vector<const tinyxml2::XMLElement*> elements;
+			CollectModified(elements, false);
+
+			for (const tinyxml2::XMLElement* element: elements)
+			{
+				Serialization::WriteObject(payload, GetNodePath(*element));
+				Serialization::WriteObject(payload, PrintCompact(*element));
+			}
+		}
+
+		const auto& buffer = payload.GetStreamBuffer();
+		switch (XDocument::Private::WriteJournalBatch(stream, g_JournalFormat, {static_cast<const std::byte*>(buffer.GetBufferStart()), buffer.GetBufferSize()}))
+		{
+			case XDocument::Private::JournalWriteResult::Written:
+			{
+				// The image written by the last full or patch save doesn't have these changes
+				m_HasImage = false;
+				OnSaved();
+
+				return true;
+			}
+			case XDocument::Private::JournalWriteResult::Torn:
+			{
+				m_IsJournalTorn = true;
+				break;
+			}
+		};
+		return false;
+	}
+	bool ChangeTracker::ApplyJournal(tinyxml2::XMLDocument& document, IInputStream& stream)
+	{
+		std::vector<std::byte> payload;
+		while (XDocument::Private::ReadJournalBatch(stream, g_JournalFormat, payload))
+		{
+			MemoryInputStream records(payload.data(), payload.size());
+			while (static_cast<size_t>(records.TellI().ToBytes()) < payload.size())
+			{
+				std::vector<uint32_t> path;
+				std::string xml;
+				Serialization::ReadObject(records, path);
+				Serialization::ReadObject(records, xml);
+
+				if (path.empty())
+				{
+					document.Parse(xml.data(), xml.size());
+					if (document.Error())
+					{
+						return false;
+					}
+					continue;
+				}
+
+				tinyxml2::XMLNode* node = FindNode(document, path);
+				if (!node)
+				{
+					return false;
+				}
+
+				tinyxml2::XMLDocument fragment;
+				fragment.Parse(xml.data(), xml.size());
+				if (fragment.Error() || !fragment.RootElement())
+				{
+					return false;
+				}
+
+				node->Parent()->InsertAfterChild(node, fragment.RootElement()->DeepClone(&document));
+				document.DeleteNode(node);
+			}
+		}
+		return true;
+	}
+}
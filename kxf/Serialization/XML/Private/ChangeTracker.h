@@ -0,0 +1,73 @@
+#pragma once
+#include "../../Common.h"
+
+namespace tinyxml2
+{
+	class XMLNode;
+	class XMLElement;
+	class XMLDocument;
+}
+namespace kxf
+{
+	class IInputStream;
+	class IOutputStream;
+}
+
+namespace kxf::XML::Private
+{
+	// Records which elements have been modified since the last incremental save and where every element is located in the
+	// image written by the last full or patch save. Changes are tracked per element: a modified text node, comment or a list
+	// of children marks the enclosing element, or the document itself for the nodes at the top level.
+	class ChangeTracker final
+	{
+		public:
+			struct Range final
+			{
+				uint64_t Offset = 0;
+				size_t Length = 0;
+				size_t Capacity = 0;
+				int Depth = 0;
+
+				// Elements printed inside of a text run don't start on their own line and can't be reprinted separately
+				bool IsInline = false;
+			};
+			using Layout = std::unordered_map<const tinyxml2::XMLNode*, Range>;
+
+		private:
+			std::unordered_set<const tinyxml2::XMLNode*> m_Modified;
+			bool m_DocumentModified = false;
+
+			Layout m_Layout;
+			uint64_t m_ImageSize = 0;
+			bool m_HasImage = false;
+
+			// A torn batch ends the journal, nothing can be appended after it until the next full save
+			bool m_IsJournalTorn = false;
+
+		private:
+			void Forget(const tinyxml2::XMLNode& node);
+			bool CollectModified(std::vector<const tinyxml2::XMLElement*>& elements, bool forPatch) const;
+			void OnSaved() noexcept;
+
+		public:
+			bool IsModified() const noexcept
+			{
+				return m_DocumentModified || !m_Modified.empty();
+			}
+
+			// Notifications from the mutating operations, they must be called before the subtree is detached or destroyed
+			// and after it's attached. 'OnCleared' is called when all the nodes are destroyed, 'OnLoaded' after a new document
+			// is loaded which becomes the base of the next incremental save.
+			void OnNodeChanged(const tinyxml2::XMLNode& node);
+			void OnSubtreeAdded(const tinyxml2::XMLNode& node);
+			void OnSubtreeRemoved(const tinyxml2::XMLNode& node);
+			void OnChildrenRemoved(const tinyxml2::XMLNode& node);
+			void OnCleared() noexcept;
+			void OnLoaded() noexcept;
+
+			bool SaveFull(const tinyxml2::XMLDocument& document, IOutputStream& stream);
+			bool SavePatch(const tinyxml2::XMLDocument& document, IOutputStream& stream);
+			bool SaveJournal(const tinyxml2::XMLDocument& document, IOutputStream& stream);
+			static bool ApplyJournal(tinyxml2::XMLDocument& document, IInputStream& stream);
+	};
+}
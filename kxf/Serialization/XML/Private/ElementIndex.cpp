@@ -0,0 +1,295 @@
+#include "kxf-pch.h"
+#include "ElementIndex.h"
+#include "../TinyXML2.h"
+
+namespace
+{
+	// Visits the elements of the subtree in document order, 'root' itself included if it's an element
+	template<class TFunc>
+	void ForEachElement(const tinyxml2::XMLNode& root, TFunc&& func)
+	{
+		const tinyxml2::XMLNode* node = &root;
+		while (node)
+		{
+			if (auto element = node->ToElement())
+			{
+				if (!std::invoke(func, const_cast<tinyxml2::XMLElement&>(*element)))
+				{
+					return;
+				}
+			}
+
+			if (auto child = node->FirstChildElement())
+			{
+				node = child;
+				continue;
+			}
+			while (node != &root && !node->NextSiblingElement())
+			{
+				node = node->Parent();
+			}
+			node = node != &root ? node->NextSiblingElement() : nullptr;
+		}
+	}
+
+	bool IsWithin(const tinyxml2::XMLNode& node, const tinyxml2::XMLNode& scope) noexcept
+	{
+		for (auto item = &node; item; item = item->Parent())
+		{
+			if (item == &scope)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Cheap check for the common case of appending elements to the end of a branch, it's true if 'node' is a descendant
+	// of 'last' or lies in the last element branch after it. Anything else is conservatively treated as out of order.
+	bool IsAppendedAfter(const tinyxml2::XMLNode& last, const tinyxml2::XMLNode& node) noexcept
+	{
+		for (auto child = &node; child; child = child->Parent())
+		{
+			if (IsWithin(last, *child))
+			{
+				return child == &last;
+			}
+			else if (auto parent = child->Parent(); parent && IsWithin(last, *parent))
+			{
+				return parent == &last || !child->NextSiblingElement();
+			}
+		}
+		return false;
+	}
+}
+
+namespace kxf::XML::Private
+{
+	std::string ElementIndex::MakeAttributeKey(std::string_view name, std::string_view value) const
+	{
+		// Attribute names can't contain null characters so the key is unambiguous
+		std::string key;
+		key.reserve(name.size() + value.size() + 1);
+		key.append(name);
+		key.push_back('\0');
+		key.append(value);
+
+		return key;
+	}
+	void ElementIndex::AddToEntry(std::unordered_map<std::string, Entry>& map, std::string key, tinyxml2::XMLElement& element, bool isOrdered)
+	{
+		Entry& entry = map[std::move(key)];
+		if (entry.IsOrdered && !isOrdered && !entry.Elements.empty() && !IsAppendedAfter(*entry.Elements.back(), element))
+		{
+			entry.IsOrdered = false;
+		}
+		entry.Elements.emplace_back(&element);
+	}
+	void ElementIndex::RemoveFromEntry(std::unordered_map<std::string, Entry>& map, const std::string& key, const tinyxml2::XMLElement& element)
+	{
+		if (auto it = map.find(key); it != map.end())
+		{
+			auto& elements = it->second.Elements;
+			if (auto itElement = std::find(elements.begin(), elements.end(), &element); itElement != elements.end())
+			{
+				elements.erase(itElement);
+			}
+			if (elements.empty())
+			{
+				map.erase(it);
+			}
+		}
+	}
+	tinyxml2::XMLElement* ElementIndex::FindInEntry(std::unordered_map<std::string, Entry>& map, const std::string& key, const tinyxml2::XMLNode& scope)
+	{
+		auto it = map.find(key);
+		if (it == map.end())
+		{
+			return nullptr;
+		}
+
+		Entry& entry = it->second;
+		if (!entry.IsOrdered)
+		{
+			// Restore the document order with a single pass over the document, stopping once all the elements are found
+			std::unordered_map<const tinyxml2::XMLElement*, size_t> order;
+			order.reserve(entry.Elements.size());
+			for (const auto element: entry.Elements)
+			{
+				order.emplace(element, std::numeric_limits<size_t>::max());
+			}
+
+			size_t ordinal = 0;
+			size_t found = 0;
+			ForEachElement(*m_Root, [&](tinyxml2::XMLElement& element)
+			{
+				if (auto it = order.find(&element); it != order.end())
+				{
+					it->second = ordinal;
+					found++;
+				}
+				ordinal++;
+				return found != order.size();
+			});
+
+			std::stable_sort(entry.Elements.begin(), entry.Elements.end(), [&](const tinyxml2::XMLElement* left, const tinyxml2::XMLElement* right)
+			{
+				return order[left] < order[right];
+			});
+			entry.IsOrdered = true;
+		}
+
+		for (const auto element: entry.Elements)
+		{
+			if (IsWithin(*element, scope))
+			{
+				return element;
+			}
+		}
+		return nullptr;
+	}
+
+	void ElementIndex::AddElement(tinyxml2::XMLElement& element, bool isOrdered)
+	{
+		AddToEntry(m_Names, element.Name(), element, isOrdered);
+		for (auto attribute = element.FirstAttribute(); attribute; attribute = attribute->Next())
+		{
+			AddToEntry(m_Attributes, MakeAttributeKey(attribute->Name(), attribute->Value()), element, isOrdered);
+		}
+		element.SetUserData(this);
+	}
+	void ElementIndex::RemoveElements(const tinyxml2::XMLNode& root, bool includeRoot)
+	{
+		std::unordered_set<const tinyxml2::XMLElement*> elements;
+		std::unordered_set<std::string> names;
+		std::unordered_set<std::string> attributes;
+
+		ForEachElement(root, [&](tinyxml2::XMLElement& element)
+		{
+			if ((includeRoot || &element != &root) && element.GetUserData() == this)
+			{
+				elements.emplace(&element);
+				names.emplace(element.Name());
+				for (auto attribute = element.FirstAttribute(); attribute; attribute = attribute->Next())
+				{
+					attributes.emplace(MakeAttributeKey(attribute->Name(), attribute->Value()));
+				}
+				element.SetUserData(nullptr);
+			}
+			return true;
+		});
+
+		// Remove all the elements from each affected list in one pass, so that clearing large subtrees stays linear
+		auto RemoveFromMap = [&](std::unordered_map<std::string, Entry>& map, const std::unordered_set<std::string>& keys)
+		{
+			for (const auto& key: keys)
+			{
+				if (auto it = map.find(key); it != map.end())
+				{
+					std::erase_if(it->second.Elements, [&](const tinyxml2::XMLElement* element)
+					{
+						return elements.contains(element);
+					});
+					if (it->second.Elements.empty())
+					{
+						map.erase(it);
+					}
+				}
+			}
+		};
+		if (!elements.empty())
+		{
+			RemoveFromMap(m_Names, names);
+			RemoveFromMap(m_Attributes, attributes);
+		}
+	}
+
+	void ElementIndex::Build(const tinyxml2::XMLNode& root)
+	{
+		Clear();
+
+		m_Root = &root;
+		ForEachElement(root, [&](tinyxml2::XMLElement& element)
+		{
+			AddElement(element, true);
+			return true;
+		});
+	}
+	void ElementIndex::Clear() noexcept
+	{
+		m_Names.clear();
+		m_Attributes.clear();
+		m_Root = nullptr;
+	}
+
+	bool ElementIndex::Contains(const tinyxml2::XMLNode& node) const noexcept
+	{
+		return m_Root && IsWithin(node, *m_Root);
+	}
+
+	tinyxml2::XMLElement* ElementIndex::FindByName(std::string_view name, const tinyxml2::XMLNode& scope)
+	{
+		return FindInEntry(m_Names, std::string(name), scope);
+	}
+	tinyxml2::XMLElement* ElementIndex::FindByAttribute(std::string_view name, std::string_view value, const tinyxml2::XMLNode& scope)
+	{
+		return FindInEntry(m_Attributes, MakeAttributeKey(name, value), scope);
+	}
+
+	void ElementIndex::OnSubtreeAdded(tinyxml2::XMLNode& node)
+	{
+		if (Contains(node))
+		{
+			// The subtree could have been moved from another place in the document
+			RemoveElements(node, true);
+			ForEachElement(node, [&](tinyxml2::XMLElement& element)
+			{
+				AddElement(element, false);
+				return true;
+			});
+		}
+	}
+	void ElementIndex::OnSubtreeRemoved(const tinyxml2::XMLNode& node)
+	{
+		if (m_Root)
+		{
+			RemoveElements(node, true);
+		}
+	}
+	void ElementIndex::OnChildrenRemoved(const tinyxml2::XMLNode& node)
+	{
+		if (m_Root)
+		{
+			RemoveElements(node, false);
+		}
+	}
+	void ElementIndex::OnNameChanged(tinyxml2::XMLElement& element, std::string_view oldName)
+	{
+		if (m_Root && element.GetUserData() == this)
+		{
+			RemoveFromEntry(m_Names, std::string(oldName), element);
+			AddToEntry(m_Names, element.Name(), element, false);
+		}
+	}
+	void ElementIndex::OnAttributeChanged(tinyxml2::XMLElement& element, std::string_view name, std::optional<std::string_view> oldValue)
+	{
+		if (m_Root && element.GetUserData() == this)
+		{
+			if (oldValue)
+			{
+				RemoveFromEntry(m_Attributes, MakeAttributeKey(name, *oldValue), element);
+			}
+			if (auto value = element.Attribute(std::string(name).c_str()))
+			{
+				AddToEntry(m_Attributes, MakeAttributeKey(name, value), element, false);
+			}
+		}
+	}
+	void ElementIndex::OnAttributeRemoved(const tinyxml2::XMLElement& element, std::string_view name, std::string_view value)
+	{
+		if (m_Root && element.GetUserData() == this)
+		{
+			RemoveFromEntry(m_Attributes, MakeAttributeKey(name, value), element);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "../../Common.h"
+
+namespace tinyxml2
+{
+	class XMLNode;
+	class XMLElement;
+}
+
+namespace kxf::XML::Private
+{
+	// Maps element names and attribute name/value pairs to the elements having them. Lists are kept in document
+	// order where possible, a list that got an element appended out of order is sorted again on its next lookup.
+	class ElementIndex final
+	{
+		private:
+			struct Entry final
+			{
+				std::vector<tinyxml2::XMLElement*> Elements;
+				bool IsOrdered = true;
+			};
+
+		private:
+			std::unordered_map<std::string, Entry> m_Names;
+			std::unordered_map<std::string, Entry> m_Attributes;
+			const tinyxml2::XMLNode* m_Root = nullptr;
+
+		private:
+			std::string MakeAttributeKey(std::string_view name, std::string_view value) const;
+			void AddToEntry(std::unordered_map<std::string, Entry>& map, std::string key, tinyxml2::XMLElement& element, bool isOrdered);
+			void RemoveFromEntry(std::unordered_map<std::string, Entry>& map, const std::string& key, const tinyxml2::XMLElement& element);
+			tinyxml2::XMLElement* FindInEntry(std::unordered_map<std::string, Entry>& map, const std::string& key, const tinyxml2::XMLNode& scope);
+
+			void AddElement(tinyxml2::XMLElement& element, bool isOrdered);
+			void RemoveElements(const tinyxml2::XMLNode& root, bool includeRoot);
+
+		public:
+			bool IsBuilt() const noexcept
+			{
+				return m_Root != nullptr;
+			}
+			void Build(const tinyxml2::XMLNode& root);
+			bool Contains(const tinyxml2::XMLNode& node) const noexcept;
+			void Clear() noexcept;
+
+			// Lookups return the first matching element in document order inside the subtree of 'scope' (including itself)
+			tinyxml2::XMLElement* FindByName(std::string_view name, const tinyxml2::XMLNode& scope);
+			tinyxml2::XMLElement* FindByAttribute(std::string_view name, std::string_view value, const tinyxml2::XMLNode& scope);
+
+			// Notifications from the mutating operations, they must be called before the subtree is detached
+			// or destroyed and after it's attached or renamed.
+			void OnSubtreeAdded(tinyxml2::XMLNode& node);
+			void OnSubtreeRemoved(const tinyxml2::XMLNode& node);
+			void OnChildrenRemoved(const tinyxml2::XMLNode& node);
+			void OnNameChanged(tinyxml2::XMLElement& element, std::string_view oldName);
+			void OnAttributeChanged(tinyxml2::XMLElement& element, std::string_view name, std::optional<std::string_view> oldValue);
+			void OnAttributeRemoved(const tinyxml2::XMLElement& element, std::string_view name, std::string_view value);
+	};
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "../../Common.h"
+#include "../TinyXML2.h"
+
+namespace kxf::XML::Private
+{
+	// Printer for the default serialization format, indents with tabs
+	class XMLPrinterDefault: public tinyxml2::XMLPrinter
+	{
+		public:
+			XMLPrinterDefault(FILE* file = nullptr, bool compact = false, int depth = 0)
+				:XMLPrinter(file, compact, depth)
+			{
+			}
+
+		protected:
+			// tinyxml2::XMLPrinter
+			void PrintSpace(int depth) override
+			{
+				for (int i = 0; i < depth; i++)
+				{
+					Write("\t");
+				}
+			}
+	};
+}
@@ -1,10 +1,15 @@
 #include "kxf-pch.h"
 #include "XMLDocument.h"
 #include "kxf/IO/IStream.h"
+#include "kxf/IO/IDirectStream.h"
 #include "kxf/Network/URI.h"
 #include "kxf/Core/ILibraryInfo.h"
+#include "kxf/Serialization/Private/IncrementalSave.h"
 #include "kxf/Utility/SoftwareLicenseDB.h"
 #include "TinyXML2.h"
+#include "Private/ElementIndex.h"
+#include "Private/ChangeTracker.h"
+#include "Private/XMLPrinter.h"
 
 namespace
 {
@@ -70,6 +75,11 @@ namespace kxf
 
 		String declaration = Format(R"(xml version="1.0" encoding="{}")", g_DefaultDeclaredEncoding);
 		m_Impl->InsertFirstChild(m_Impl->NewDeclaration(declaration.utf8_str()));
+
+		if (m_Tracker)
+		{
+			m_Tracker->OnNodeChanged(*m_Impl);
+		}
 	}
 
 	bool XMLDocument::DoLoad(const char* xml, size_t length)
@@ -78,12 +88,36 @@ namespace kxf
 		m_Impl->Parse(xml, length);
 		m_Impl->SetBOM(false);
 
+		if (m_Tracker)
+		{
+			m_Tracker->OnLoaded();
+		}
 		return !m_Impl->Error();
 	}
 	void XMLDocument::DoUnload()
 	{
+		if (m_Index)
+		{
+			m_Index->Clear();
+		}
+		if (m_Tracker)
+		{
+			m_Tracker->OnCleared();
+		}
 		m_Impl->Clear();
 	}
+	XML::Private::ElementIndex* XMLDocument::GetElementIndex(bool build) const
+	{
+		if (m_Index)
+		{
+			if (build && !m_Index->IsBuilt())
+			{
+				m_Index->Build(*m_Impl);
+			}
+			return m_Index->IsBuilt() ? m_Index.get() : nullptr;
+		}
+		return nullptr;
+	}
 
 	XMLDocumentNode XMLDocument::CreateNewElement(const String& name)
 	{
@@ -144,11 +178,51 @@ namespace kxf
 
 	bool XMLDocument::LoadDocument(IInputStream& stream)
 	{
+		const DataSize size = stream.GetSize();
+		const DataSize offset = stream.TellI();
+
+		// Parse right from the memory of memory and mapped file streams if they expose the rest of the document at once,
+		// TinyXML2 still makes its own copy to parse in but the intermediate buffer isn't needed.
+		if (size.IsValid() && offset.IsValid())
+		{
+			if (auto directStream = stream.QueryInterface<IDirectInputStream>())
+			{
+				const auto data = directStream->GetReadBuffer();
+				if (static_cast<int64_t>(data.size()) == (size - offset).ToBytes())
+				{
+					const bool result = DoLoad(reinterpret_cast<const char*>(data.data()), data.size());
+					directStream->Consume(data.size());
+
+					return result;
+				}
+			}
+		}
+
 		std::vector<std::byte> buffer;
-		buffer.resize(stream.GetSize().ToBytes());
-		stream.ReadAll(buffer.data(), buffer.size());
-		buffer.resize(stream.LastRead().ToBytes());
+		if (size.IsValid())
+		{
+			buffer.resize(static_cast<size_t>((size - std::max(offset, DataSize(0))).ToBytes()));
+			stream.ReadAll(buffer.data(), buffer.size());
+			buffer.resize(static_cast<size_t>(stream.LastRead().ToBytes()));
+		}
+		else
+		{
+			// The size isn't known, read until the end of the stream
+			constexpr size_t chunkSize = DataSize::FromKB(64).ToBytes();
+			while (true)
+			{
+				const size_t used = buffer.size();
+				buffer.resize(used + chunkSize);
 
+				const DataSize read = stream.Read(buffer.data() + used, chunkSize).LastRead();
+				buffer.resize(used + static_cast<size_t>(std::max<int64_t>(read.ToBytes(), 0)));
+
+				if (!read.IsPositive() || stream.GetLastError().IsFail() || stream.GetLastError() == StreamErrorCode::EndOfStream)
+				{
+					break;
+				}
+			}
+		}
 		return DoLoad(reinterpret_cast<const char*>(buffer.data()), buffer.size());
 	}
 	bool XMLDocument::SaveDocument(IOutputStream& stream) const
@@ -175,9 +249,89 @@ namespace kxf
 	{
 		if (node)
 		{
+			if (auto index = GetElementIndex())
+			{
+				index->OnSubtreeRemoved(*node.m_Node);
+			}
+			if (m_Tracker)
+			{
+				m_Tracker->OnSubtreeRemoved(*node.m_Node);
+			}
 			m_Impl->DeleteNode(node.m_Node);
 		}
 	}
+	void XMLDocument::EnableElementIndex(bool enable)
+	{
+		if (enable && !m_Index)
+		{
+			m_Index = std::make_unique<XML::Private::ElementIndex>();
+		}
+		else if (!enable)
+		{
+			m_Index = nullptr;
+		}
+	}
+
+	void XMLDocument::EnableChangeTracking(bool enable)
+	{
+		if (enable && !m_Tracker)
+		{
+			m_Tracker = std::make_unique<XML::Private::ChangeTracker>();
+		}
+		else if (!enable)
+		{
+			m_Tracker = nullptr;
+		}
+	}
+	bool XMLDocument::IsModified() const noexcept
+	{
+		return m_Tracker && m_Tracker->IsModified();
+	}
+	bool XMLDocument::SaveChanges(IOutputStream& stream, XDocument::SaveMode mode)
+	{
+		if (m_Tracker)
+		{
+			switch (mode)
+			{
+				case XDocument::SaveMode::Full:
+				{
+					return m_Tracker->SaveFull(*m_Impl, stream);
+				}
+				case XDocument::SaveMode::Patch:
+				{
+					return m_Tracker->SavePatch(*m_Impl, stream);
+				}
+				case XDocument::SaveMode::Journal:
+				{
+					return m_Tracker->SaveJournal(*m_Impl, stream);
+				}
+			};
+		}
+		else if (mode == XDocument::SaveMode::Full)
+		{
+			XML::Private::XMLPrinterDefault printer;
+			m_Impl->Print(&printer);
+
+			return XDocument::Private::RewriteStream(stream, {reinterpret_cast<const std::byte*>(printer.CStr()), static_cast<size_t>(printer.CStrSize()) - 1});
+		}
+		return false;
+	}
+	bool XMLDocument::ApplyJournal(IInputStream& stream)
+	{
+		const bool result = XML::Private::ChangeTracker::ApplyJournal(*m_Impl, stream);
+		m_Impl->SetBOM(false);
+
+		// The replaced subtrees aren't known to the index and the document no longer matches the image of the last save
+		if (m_Index)
+		{
+			m_Index->Clear();
+		}
+		if (m_Tracker)
+		{
+			m_Tracker->OnLoaded();
+		}
+		return result;
+	}
 
 	XMLDocument& XMLDocument::operator=(XMLDocument&&) noexcept = default;
 }
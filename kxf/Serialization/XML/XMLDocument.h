@@ -12,6 +12,7 @@ namespace tinyxml2
 
 namespace kxf
 {
+	class XMLPath;
 	class XMLDocumentNode;
 	class XMLDocument;
 	class XMLDocumentAttribute;
@@ -19,6 +20,11 @@ namespace kxf
 	class IInputStream;
 	class IOutputStream;
 }
+namespace kxf::XML::Private
+{
+	class ElementIndex;
+	class ChangeTracker;
+}
 
 namespace kxf::XML
 {
@@ -108,6 +114,62 @@ namespace kxf
 	};
 }
 
+namespace kxf
+{
+	// Compiled form of an XPath expression: the path is split into elements, indices are extracted and names are converted
+	// to UTF-8 once, so the same object can be used for any number of queries without parsing the path again.
+	class KXF_API XMLPath final
+	{
+		friend class XMLDocumentNode;
+
+		private:
+			struct Item final
+			{
+				std::string Name;
+				int Index = 0;
+			};
+
+		private:
+			std::vector<Item> m_Items;
+
+		private:
+			void Compile(const String& xPath, UniChar separator, UniChar indexSeparator);
+
+		public:
+			XMLPath() = default;
+			XMLPath(const String& xPath, UniChar separator = '/', UniChar indexSeparator = ':')
+			{
+				Compile(xPath, separator, indexSeparator);
+			}
+			XMLPath(const IXDocument& document, const String& xPath)
+			{
+				UniChar indexSeparator;
+				UniChar separator = document.GetXPathSeparator(&indexSeparator);
+				Compile(xPath, separator, indexSeparator);
+			}
+
+		public:
+			bool IsEmpty() const noexcept
+			{
+				return m_Items.empty();
+			}
+			size_t GetItemCount() const noexcept
+			{
+				return m_Items.size();
+			}
+
+		public:
+			explicit operator bool() const noexcept
+			{
+				return !IsEmpty();
+			}
+			bool operator!() const noexcept
+			{
+				return IsEmpty();
+			}
+	};
+}
+
 namespace kxf
 {
 	class KXF_API XMLDocumentNode: public IXDocumentNode,
@@ -143,7 +205,10 @@ namespace kxf
 			bool XDocument_WriteAttribute(const String& name, const String& value, AsCDATA asCDATA);
 
 			// XMLDocumentNode
-			XMLDocumentNode QueryOrCreateElement(const String& xPath, bool allowCreate);
+			void OnNodeChanged(const tinyxml2::XMLNode& node);
+			void OnSubtreeInserting(const tinyxml2::XMLNode& node);
+			bool OnSubtreeAdded(tinyxml2::XMLNode* node);
+			XMLDocumentNode QueryOrCreateElement(const XMLPath& xPath, bool allowCreate);
 
 		public:
 			XMLDocumentNode() = default;
@@ -191,7 +256,9 @@ namespace kxf
 
 			// XMLDocumentNode: Navigation
 			XMLDocumentNode QueryElement(const String& xPath) const;
+			XMLDocumentNode QueryElement(const XMLPath& xPath) const;
 			XMLDocumentNode CreateElement(const String& xPath);
+			XMLDocumentNode CreateElement(const XMLPath& xPath);
 			XMLDocumentNode QueryElementByAttribute(const String& name, const String& value) const;
 			XMLDocumentNode QueryElementByName(const String& name) const;
 
@@ -261,9 +328,12 @@ namespace kxf
 		kxf_RTTI_DeclareIID(XMLDocument, {0xdafcb16, 0xb15c, 0x4c8e, {0x90, 0xfa, 0x9f, 0x24, 0x3f, 0x13, 0x69, 0x12}});
 
 		friend class XMLDocumentNode;
+		friend class XMLDocumentAttribute;
 
 		private:
 			std::unique_ptr<tinyxml2::XMLDocument> m_Impl;
+			std::unique_ptr<XML::Private::ElementIndex> m_Index;
+			std::unique_ptr<XML::Private::ChangeTracker> m_Tracker;
 
 		private:
 			// IObject
@@ -274,6 +344,11 @@ namespace kxf
 			
 			bool DoLoad(const char* xml, size_t length);
 			void DoUnload();
+			XML::Private::ElementIndex* GetElementIndex(bool build = false) const;
+			XML::Private::ChangeTracker* GetChangeTracker() const noexcept
+			{
+				return m_Tracker.get();
+			}
 
 		private:
 			XMLDocumentNode CreateNewElement(const String& name);
@@ -301,6 +376,11 @@ namespace kxf
 			bool LoadDocument(IInputStream& stream) override;
 			bool SaveDocument(IOutputStream& stream) const override;
 
+			// Objects are written as elements appended to the document, their fields become child elements
+			// or attributes and arrays are the repeated child elements named after the array.
+			std::unique_ptr<XDocument::ISchemaWriter> CreateSchemaWriter() override;
+			std::unique_ptr<XDocument::ISchemaReader> CreateSchemaReader() const override;
+
 			// XMLDocument
 			bool LoadDocument(const String& xml);
 			String SaveDocument() const;
@@ -308,6 +388,28 @@ namespace kxf
 			void ClearDocument();
 			void RemoveNode(XMLDocumentNode& node);
 
+			// Secondary index of the elements by their names and attribute values used by 'QueryElementByName' and
+			// 'QueryElementByAttribute'. It's built on the first lookup and kept up to date by the modifying functions.
+			bool IsElementIndexEnabled() const noexcept
+			{
+				return m_Index != nullptr;
+			}
+			void EnableElementIndex(bool enable = true);
+
+			// Tracking of the modified elements for the incremental saves, enabling it makes the current state of the document the
+			// base for the first one. A patch rewrites the printed ranges of the modified elements which still fit into their places
+			// and a journal stores the modified subtrees, so the amount of data written depends on the size of the changes.
+			bool IsChangeTrackingEnabled() const noexcept
+			{
+				return m_Tracker != nullptr;
+			}
+			void EnableChangeTracking(bool enable = true);
+			bool IsModified() const noexcept;
+
+			// Only 'SaveMode::Full' can be used without the change tracking
+			bool SaveChanges(IOutputStream& stream, XDocument::SaveMode mode);
+			bool ApplyJournal(IInputStream& stream);
+
 		public:
 			XMLDocument& operator=(const XMLDocument&) = delete;
 			XMLDocument& operator=(XMLDocument&&) noexcept;
@@ -1,6 +1,8 @@
 #include "kxf-pch.h"
 #include "XMLDocument.h"
 #include "TinyXML2.h"
+#include "Private/ElementIndex.h"
+#include "Private/ChangeTracker.h"
 
 namespace kxf
 {
@@ -17,7 +19,23 @@ namespace kxf
 	{
 		if (m_Attribute)
 		{
-			m_Attribute->SetAttribute(value.utf8_str());
+			auto index = m_Owner->m_Document ? m_Owner->m_Document->GetElementIndex() : nullptr;
+			auto element = m_Owner->m_Node ? m_Owner->m_Node->ToElement() : nullptr;
+			if (index && element)
+			{
+				std::string oldValue = m_Attribute->Value();
+				m_Attribute->SetAttribute(value.utf8_str());
+				index->OnAttributeChanged(*element, m_Attribute->Name(), oldValue);
+			}
+			else
+			{
+				m_Attribute->SetAttribute(value.utf8_str());
+			}
+
+			if (auto tracker = m_Owner->m_Document ? m_Owner->m_Document->GetChangeTracker() : nullptr; tracker && element)
+			{
+				tracker->OnNodeChanged(*element);
+			}
 			return true;
 		}
 		return false;
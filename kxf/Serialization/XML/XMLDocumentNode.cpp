@@ -1,29 +1,14 @@
 #include "kxf-pch.h"
 #include "XMLDocument.h"
 #include "kxf/IO/IStream.h"
-#include "kxf/Core/IEncodingConverter.h"
 #include "TinyXML2.h"
+#include "Private/ElementIndex.h"
+#include "Private/ChangeTracker.h"
+#include "Private/XMLPrinter.h"
 
 namespace
 {
-	class XMLPrinterDefault: public tinyxml2::XMLPrinter
-	{
-		public:
-			XMLPrinterDefault(FILE* file = nullptr, bool compact = false, int depth = 0)
-				:XMLPrinter(file, compact, depth)
-			{
-			}
-
-		protected:
-			// tinyxml2::XMLPrinter
-			void PrintSpace(int depth) override
-			{
-				for (int i = 0; i < depth; i++)
-				{
-					Write("\t");
-				}
-			}
-	};
+	using kxf::XML::Private::XMLPrinterDefault;
 
 	class XMLPrinterHTML5: public XMLPrinterDefault
 	{
@@ -175,6 +160,14 @@ namespace kxf
 				if (!textNode)
 				{
 					textNode = m_Document->m_Impl->NewText(value.utf8_str());
+					if (auto index = m_Document->GetElementIndex())
+					{
+						index->OnChildrenRemoved(*m_Node);
+					}
+					if (auto tracker = m_Document->GetChangeTracker())
+					{
+						tracker->OnChildrenRemoved(*m_Node);
+					}
 					m_Node->DeleteChildren();
 					m_Node->InsertFirstChild(textNode);
 				}
@@ -197,11 +190,15 @@ namespace kxf
 						break;
 					}
 				};
+				OnNodeChanged(*m_Node);
+
 				return true;
 			}
 			else if (m_Node->ToText() || m_Node->ToComment() || m_Node->ToDeclaration() || m_Node->ToUnknown())
 			{
 				m_Node->SetValue(value.utf8_str());
+				OnNodeChanged(*m_Node);
+
 				return true;
 			}
 		}
@@ -229,77 +226,109 @@ namespace kxf
 		{
 			if (auto element = m_Node->ToElement())
 			{
-				element->SetAttribute(name.utf8_str(), value.utf8_str());
+				auto nameUTF8 = name.utf8_str();
+				if (auto index = m_Document->GetElementIndex())
+				{
+					std::optional<std::string> oldValue;
+					if (auto currentValue = element->Attribute(nameUTF8.data()))
+					{
+						oldValue = currentValue;
+					}
+
+					element->SetAttribute(nameUTF8.data(), value.utf8_str());
+					index->OnAttributeChanged(*element, nameUTF8.data(), oldValue);
+				}
+				else
+				{
+					element->SetAttribute(nameUTF8.data(), value.utf8_str());
+				}
+				OnNodeChanged(*element);
+
 				return true;
 			}
 		}
 		return false;
 	}
 
-	XMLDocumentNode XMLDocumentNode::QueryOrCreateElement(const String& xPath, bool allowCreate)
+	void XMLDocumentNode::OnNodeChanged(const tinyxml2::XMLNode& node)
 	{
-		if (m_Document && m_Node)
+		if (auto tracker = m_Document->GetChangeTracker())
+		{
+			tracker->OnNodeChanged(node);
+		}
+	}
+	void XMLDocumentNode::OnSubtreeInserting(const tinyxml2::XMLNode& node)
+	{
+		// Inserting a node which is already in the tree moves it from its current place
+		if (auto tracker = m_Document->GetChangeTracker(); tracker && node.Parent())
+		{
+			tracker->OnSubtreeRemoved(node);
+		}
+	}
+	bool XMLDocumentNode::OnSubtreeAdded(tinyxml2::XMLNode* node)
+	{
+		if (node)
+		{
+			if (auto index = m_Document->GetElementIndex())
+			{
+				index->OnSubtreeAdded(*node);
+			}
+			if (auto tracker = m_Document->GetChangeTracker())
+			{
+				tracker->OnSubtreeAdded(*node);
+			}
+			return true;
+		}
+		return false;
+	}
+	XMLDocumentNode XMLDocumentNode::QueryOrCreateElement(const XMLPath& xPath, bool allowCreate)
+	{
+		if (m_Document && m_Node && !xPath.IsEmpty())
 		{
 			tinyxml2::XMLDocument& document = *m_Document->m_Impl;
 			tinyxml2::XMLNode* currentNode = m_Node;
-			tinyxml2::XMLNode* previousNode = currentNode;
 
-			UniChar indexSeparator;
-			UniChar xPathSeparator = m_Document->GetXPathSeparator(&indexSeparator);
-			size_t itemCount = xPath.SplitBySeparator(xPathSeparator.GetAs<XChar>(), [&](StringView name)
+			for (const XMLPath::Item& item: xPath.m_Items)
 			{
-				// Save previous element
-				if (!currentNode)
-				{
-					return false;
-				}
-				previousNode = currentNode;
-
-				// Extract index from name and remove it from path, zero-based
-				// point/x -> 0, point/x:1 -> 1, point/y:0 -> 0, point/z:-7 -> 0
-				auto [elementName, index] = XDocument::ExtractIndexFromElementName(name, indexSeparator.GetAs<XChar>());
-				auto elementNameUTF8 = EncodingConverter_UTF8.ToMultiByte(elementName);
-
 				// Get level 0
-				currentNode = previousNode->FirstChildElement(elementNameUTF8.data());
+				tinyxml2::XMLNode* parentNode = currentNode;
+				currentNode = parentNode->FirstChildElement(item.Name.c_str());
 				if (!currentNode)
 				{
 					if (allowCreate)
 					{
-						currentNode = document.NewElement(elementNameUTF8.data());
-						previousNode->InsertEndChild(currentNode);
+						currentNode = document.NewElement(item.Name.c_str());
+						parentNode->InsertEndChild(currentNode);
+						OnSubtreeAdded(currentNode);
 					}
 					else
 					{
-						return false;
+						return {};
 					}
 				}
 
 				// We need to go down by 'index' more elements
-				for (int level = 1; level <= index; level++)
+				for (int level = 1; level <= item.Index; level++)
 				{
 					// Get next level
-					currentNode = currentNode->NextSiblingElement(elementNameUTF8.data());
+					tinyxml2::XMLNode* previousSibling = currentNode;
+					currentNode = previousSibling->NextSiblingElement(item.Name.c_str());
 					if (!currentNode)
 					{
 						if (allowCreate)
 						{
-							currentNode = document.NewElement(elementNameUTF8.data());
-							previousNode->InsertAfterChild(previousNode, currentNode);
+							currentNode = document.NewElement(item.Name.c_str());
+							parentNode->InsertAfterChild(previousSibling, currentNode);
+							OnSubtreeAdded(currentNode);
 						}
 						else
 						{
-							return false;
+							return {};
 						}
 					}
 				}
-				return true;
-			});
-
-			if (currentNode && itemCount != 0)
-			{
-				return XMLDocumentNode(*m_Document, currentNode);
 			}
+			return XMLDocumentNode(*m_Document, currentNode);
 		}
 		return {};
 	}
@@ -390,7 +419,18 @@ namespace kxf
 		{
 			if (auto element = m_Node->ToElement())
 			{
-				element->SetName(name.utf8_str());
+				if (auto index = m_Document->GetElementIndex())
+				{
+					std::string oldName = element->Name();
+					element->SetName(name.utf8_str());
+					index->OnNameChanged(*element, oldName);
+				}
+				else
+				{
+					element->SetName(name.utf8_str());
+				}
+				OnNodeChanged(*element);
+
 				return true;
 			}
 		}
@@ -399,17 +439,39 @@ namespace kxf
 
 	// XMLDocumentNode: Navigation
 	XMLDocumentNode XMLDocumentNode::QueryElement(const String& xPath) const
+	{
+		if (m_Document)
+		{
+			return const_cast<XMLDocumentNode&>(*this).QueryOrCreateElement(XMLPath(*m_Document, xPath), false);
+		}
+		return {};
+	}
+	XMLDocumentNode XMLDocumentNode::QueryElement(const XMLPath& xPath) const
 	{
 		return const_cast<XMLDocumentNode&>(*this).QueryOrCreateElement(xPath, false);
 	}
 	XMLDocumentNode XMLDocumentNode::CreateElement(const String& xPath)
 	{
-		return const_cast<XMLDocumentNode&>(*this).QueryOrCreateElement(xPath, true);
+		if (m_Document)
+		{
+			return QueryOrCreateElement(XMLPath(*m_Document, xPath), true);
+		}
+		return {};
+	}
+	XMLDocumentNode XMLDocumentNode::CreateElement(const XMLPath& xPath)
+	{
+		return QueryOrCreateElement(xPath, true);
 	}
 	XMLDocumentNode XMLDocumentNode::QueryElementByAttribute(const String& name, const String& value) const
 	{
 		if (m_Node)
 		{
+			// An empty value also matches elements without the attribute, the index can't answer that
+			if (auto index = m_Document->GetElementIndex(true); index && !value.IsEmpty() && index->Contains(*m_Node))
+			{
+				return XMLDocumentNode(*m_Document, index->FindByAttribute(name.ToUTF8(), value.ToUTF8(), *m_Node));
+			}
+
 			if (GetAttribute(name) == value)
 			{
 				return XMLDocumentNode(*m_Document, m_Node);
@@ -431,6 +493,11 @@ namespace kxf
 	{
 		if (m_Node)
 		{
+			if (auto index = m_Document->GetElementIndex(true); index && !name.IsEmpty() && index->Contains(*m_Node))
+			{
+				return XMLDocumentNode(*m_Document, index->FindByName(name.ToUTF8(), *m_Node));
+			}
+
 			if (GetName() == name)
 			{
 				return XMLDocumentNode(*m_Document, m_Node);
@@ -576,6 +643,14 @@ namespace kxf
 	{
 		if (m_Node)
 		{
+			if (auto index = m_Document->GetElementIndex())
+			{
+				index->OnChildrenRemoved(*m_Node);
+			}
+			if (auto tracker = m_Document->GetChangeTracker())
+			{
+				tracker->OnChildrenRemoved(*m_Node);
+			}
 			m_Node->DeleteChildren();
 		}
 	}
@@ -654,7 +729,7 @@ namespace kxf
 		{
 			if (auto element = m_Node->ToElement())
 			{
-				return XMLDocumentAttribute(*m_Document, element->FindAttribute(name.utf8_str()));
+				return XMLDocumentAttribute(*this, element->FindAttribute(name.utf8_str()));
 			}
 		}
 		return {};
@@ -702,7 +777,17 @@ namespace kxf
 		{
 			if (auto element = m_Node->ToElement())
 			{
-				element->DeleteAttribute(name.utf8_str());
+				auto nameUTF8 = name.utf8_str();
+				if (auto index = m_Document->GetElementIndex())
+				{
+					if (auto value = element->Attribute(nameUTF8.data()))
+					{
+						index->OnAttributeRemoved(*element, nameUTF8.data(), value);
+					}
+				}
+				element->DeleteAttribute(nameUTF8.data());
+				OnNodeChanged(*element);
+
 				return true;
 			}
 		}
@@ -712,9 +797,15 @@ namespace kxf
 	{
 		if (m_Node)
 		{
-			if (auto element = m_Node->ToElement())
+			if (auto element = m_Node->ToElement(); element && attribute.m_Attribute)
 			{
+				if (auto index = m_Document->GetElementIndex())
+				{
+					index->OnAttributeRemoved(*element, attribute.m_Attribute->Name(), attribute.m_Attribute->Value());
+				}
 				element->DeleteAttribute(attribute.m_Attribute->Name());
+				OnNodeChanged(*element);
+
 				return true;
 			}
 		}
@@ -726,10 +817,17 @@ namespace kxf
 		{
 			if (auto element = m_Node->ToElement())
 			{
-				for (auto attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+				auto index = m_Document->GetElementIndex();
+				while (auto attribute = element->FirstAttribute())
 				{
+					if (index)
+					{
+						index->OnAttributeRemoved(*element, attribute->Name(), attribute->Value());
+					}
 					element->DeleteAttribute(attribute->Name());
 				}
+				OnNodeChanged(*element);
+
 				return true;
 			}
 		}
@@ -760,13 +858,14 @@ namespace kxf
 	{
 		if (m_Node && newNode)
 		{
+			OnSubtreeInserting(*newNode.m_Node);
 			if (afterThis)
 			{
-				return m_Node->InsertAfterChild(afterThis.m_Node, newNode.m_Node);
+				return OnSubtreeAdded(m_Node->InsertAfterChild(afterThis.m_Node, newNode.m_Node));
 			}
 			else
 			{
-				return m_Node->InsertAfterChild(m_Node, newNode.m_Node);
+				return OnSubtreeAdded(m_Node->InsertAfterChild(m_Node, newNode.m_Node));
 			}
 		}
 		return false;
@@ -775,7 +874,8 @@ namespace kxf
 	{
 		if (m_Node && newNode)
 		{
-			return m_Node->InsertFirstChild(newNode.m_Node);
+			OnSubtreeInserting(*newNode.m_Node);
+			return OnSubtreeAdded(m_Node->InsertFirstChild(newNode.m_Node));
 		}
 		return false;
 	}
@@ -783,7 +883,8 @@ namespace kxf
 	{
 		if (m_Node && newNode)
 		{
-			return m_Node->InsertEndChild(newNode.m_Node);
+			OnSubtreeInserting(*newNode.m_Node);
+			return OnSubtreeAdded(m_Node->InsertEndChild(newNode.m_Node));
 		}
 		return false;
 	}
@@ -868,6 +969,8 @@ namespace kxf
 			if (auto text = m_Node->ToText())
 			{
 				text->SetCData(value);
+				OnNodeChanged(*text);
+
 				return true;
 			}
 		}
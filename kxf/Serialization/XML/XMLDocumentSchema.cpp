@@ -0,0 +1,225 @@
+#include "kxf-pch.h"
+#include "XMLDocument.h"
+#include "../XDocumentSchema.h"
+
+namespace
+{
+	using namespace kxf;
+	using XDocument::FieldKind;
+
+	// An array inside of an array is an item element of the outer one, its own items can't be named after a field
+	constexpr XChar g_NestedItemName[] = kxfS("Item");
+
+	// Array items are the repeated child elements named after the array, in the element which contains the array
+	struct Frame final
+	{
+		XMLDocumentNode Node;
+		String ArrayName;
+		bool IsArray = false;
+
+		// Last element found in this one, the fields are usually in the same order as the elements
+		// so the next lookup starts from its next sibling. Or the current item if this is an array.
+		XMLDocumentNode Cursor;
+	};
+
+	class XMLSchemaWriter final: public XDocument::ISchemaWriter
+	{
+		private:
+			std::vector<Frame> m_Stack;
+
+		private:
+			Frame& GetCurrent() noexcept
+			{
+				return m_Stack.back();
+			}
+			String GetElementName(StringView name) const
+			{
+				return name.empty() ? m_Stack.back().ArrayName : String(name);
+			}
+
+		public:
+			XMLSchemaWriter(XMLDocument& document)
+			{
+				m_Stack.emplace_back().Node = document;
+			}
+
+		public:
+			bool BeginObject(StringView name) override
+			{
+				if (auto node = GetCurrent().Node.NewElement(GetElementName(name)))
+				{
+					m_Stack.emplace_back().Node = std::move(node);
+					return true;
+				}
+				return false;
+			}
+			void EndObject() override
+			{
+				m_Stack.pop_back();
+			}
+			bool BeginArray(StringView name) override
+			{
+				Frame frame;
+				if (name.empty())
+				{
+					frame.Node = GetCurrent().Node.NewElement(GetElementName(name));
+					frame.ArrayName = g_NestedItemName;
+				}
+				else
+				{
+					frame.Node = GetCurrent().Node;
+					frame.ArrayName = String(name);
+				}
+
+				if (frame.Node)
+				{
+					frame.IsArray = true;
+					m_Stack.emplace_back(std::move(frame));
+
+					return true;
+				}
+				return false;
+			}
+			void EndArray() override
+			{
+				m_Stack.pop_back();
+			}
+
+			bool WriteString(StringView name, const String& value, FieldKind kind) override
+			{
+				if (kind == FieldKind::Attribute && !name.empty())
+				{
+					return GetCurrent().Node.SetAttribute(String(name), value);
+				}
+				else if (auto node = GetCurrent().Node.NewElement(GetElementName(name)))
+				{
+					return node.SetValue(value);
+				}
+				return false;
+			}
+	};
+
+	class XMLSchemaReader final: public XDocument::ISchemaReader
+	{
+		private:
+			std::vector<Frame> m_Stack;
+
+		private:
+			Frame& GetCurrent() noexcept
+			{
+				return m_Stack.back();
+			}
+			XMLDocumentNode FindElement(StringView name)
+			{
+				Frame& frame = GetCurrent();
+				if (name.empty())
+				{
+					return frame.IsArray ? frame.Cursor : XMLDocumentNode();
+				}
+
+				const String elementName(name);
+				XMLDocumentNode node;
+				if (frame.Cursor)
+				{
+					node = frame.Cursor.GetNextSiblingElement(elementName);
+				}
+				if (!node)
+				{
+					node = frame.Node.GetFirstChildElement(elementName);
+				}
+
+				if (node)
+				{
+					frame.Cursor = node;
+				}
+				return node;
+			}
+
+		public:
+			XMLSchemaReader(const XMLDocument& document)
+			{
+				m_Stack.emplace_back().Node = document;
+			}
+
+		public:
+			bool EnterObject(StringView name) override
+			{
+				if (auto node = FindElement(name))
+				{
+					m_Stack.emplace_back().Node = std::move(node);
+					return true;
+				}
+				return false;
+			}
+			void LeaveObject() override
+			{
+				m_Stack.pop_back();
+			}
+			bool EnterArray(StringView name) override
+			{
+				// There's no element for the array itself, it's missing if there are no items
+				Frame frame;
+				if (name.empty())
+				{
+					frame.Node = FindElement(name);
+					frame.ArrayName = g_NestedItemName;
+				}
+				else if (GetCurrent().Node.GetFirstChildElement(String(name)))
+				{
+					frame.Node = GetCurrent().Node;
+					frame.ArrayName = String(name);
+				}
+
+				if (frame.Node)
+				{
+					frame.IsArray = true;
+					m_Stack.emplace_back(std::move(frame));
+
+					return true;
+				}
+				return false;
+			}
+			bool NextItem() override
+			{
+				Frame& frame = GetCurrent();
+				if (frame.Cursor)
+				{
+					frame.Cursor = frame.Cursor.GetNextSiblingElement(frame.ArrayName);
+				}
+				else
+				{
+					frame.Cursor = frame.Node.GetFirstChildElement(frame.ArrayName);
+				}
+				return !frame.Cursor.IsNull();
+			}
+			void LeaveArray() override
+			{
+				m_Stack.pop_back();
+			}
+
+			std::optional<String> ReadString(StringView name, FieldKind kind) override
+			{
+				if (kind == FieldKind::Attribute && !name.empty())
+				{
+					return GetCurrent().Node.QueryAttribute(String(name));
+				}
+				else if (auto node = FindElement(name))
+				{
+					return node.QueryValue();
+				}
+				return {};
+			}
+	};
+}
+
+namespace kxf
+{
+	std::unique_ptr<XDocument::ISchemaWriter> XMLDocument::CreateSchemaWriter()
+	{
+		return std::make_unique<XMLSchemaWriter>(*this);
+	}
+	std::unique_ptr<XDocument::ISchemaReader> XMLDocument::CreateSchemaReader() const
+	{
+		return std::make_unique<XMLSchemaReader>(*this);
+	}
+}
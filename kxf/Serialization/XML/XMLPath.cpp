@@ -0,0 +1,28 @@
+#include "kxf-pch.h"
+#include "XMLDocument.h"
+#include "kxf/Core/IEncodingConverter.h"
+
+namespace kxf
+{
+	void XMLPath::Compile(const String& xPath, UniChar separator, UniChar indexSeparator)
+	{
+		m_Items.clear();
+		if (xPath.IsEmpty())
+		{
+			return;
+		}
+
+		xPath.SplitBySeparator(separator.GetAs<XChar>(), [&](StringView name)
+		{
+			// Extract index from name and remove it from path, zero-based
+			// point/x -> 0, point/x:1 -> 1, point/y:0 -> 0, point/z:-7 -> 0
+			auto [elementName, index] = XDocument::ExtractIndexFromElementName(name, indexSeparator.GetAs<XChar>());
+
+			Item& item = m_Items.emplace_back();
+			item.Name = EncodingConverter_UTF8.ToMultiByte(elementName);
+			item.Index = index;
+
+			return true;
+		});
+	}
+}
@@ -10,4 +10,5 @@
 #include "kxf/Threading/SynchronizedCondition.h"
 #include "kxf/Threading/ThreadEvent.h"
 #include "kxf/Threading/IThreadPool.h"
+#include "kxf/Threading/Parallel.h"
 #include "kxf/Threading/ThreadPool.h"
@@ -1,12 +1,88 @@
 #pragma once
 #include "Common.h"
+#include "kxf/Core/IAsyncTaskExecutor.h"
 #include "kxf/RTTI/RTTI.h"
+#include <cmath>
 
 namespace kxf
 {
 	class IAsyncTask;
 }
 
+namespace kxf
+{
+	// Distribution of the time the tasks have spent in the queue before being started. Bucket N counts the latencies from
+	// 2^(N - 1) up to 2^N microseconds, the first one everything below a microsecond and the last one everything above.
+	class ThreadPoolLatencyHistogram final
+	{
+		public:
+			static constexpr size_t BucketCount = 32;
+
+			static constexpr size_t GetBucketIndex(uint64_t microseconds) noexcept
+			{
+				return std::min<size_t>(std::bit_width(microseconds), BucketCount - 1);
+			}
+			static constexpr uint64_t GetBucketUpperBound(size_t index) noexcept
+			{
+				return index + 1 < BucketCount ? uint64_t(1) << index : std::numeric_limits<uint64_t>::max();
+			}
+
+		private:
+			std::array<uint64_t, BucketCount> m_Buckets = {};
+
+		public:
+			uint64_t GetCount() const noexcept
+			{
+				uint64_t count = 0;
+				for (uint64_t value: m_Buckets)
+				{
+					count += value;
+				}
+				return count;
+			}
+			uint64_t GetBucket(size_t index) const noexcept
+			{
+				return index < BucketCount ? m_Buckets[index] : 0;
+			}
+
+			// Upper bound of the bucket containing the given percentile (0 to 100) in microseconds, zero if the histogram is empty
+			uint64_t GetPercentile(double percentile) const noexcept
+			{
+				const uint64_t count = GetCount();
+				if (count != 0)
+				{
+					const auto rank = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * count));
+
+					uint64_t seen = 0;
+					for (size_t i = 0; i < BucketCount; i++)
+					{
+						seen += m_Buckets[i];
+						if (seen != 0 && seen >= rank)
+						{
+							return GetBucketUpperBound(i);
+						}
+					}
+				}
+				return 0;
+			}
+
+			void Add(size_t index, uint64_t count = 1) noexcept
+			{
+				if (index < BucketCount)
+				{
+					m_Buckets[index] += count;
+				}
+			}
+			void Add(const ThreadPoolLatencyHistogram& other) noexcept
+			{
+				for (size_t i = 0; i < BucketCount; i++)
+				{
+					m_Buckets[i] += other.m_Buckets[i];
+				}
+			}
+	};
+}
+
 namespace kxf
 {
 	class KXF_API IThreadPool: public RTTI::Interface<IThreadPool>
@@ -23,5 +99,10 @@ namespace kxf
 			virtual bool SetConcurrency(size_t value) = 0;
 
 			virtual std::shared_ptr<IAsyncTask> AddTask(std::move_only_function<void()> task) = 0;
+
+			// Statistics per priority class: number of the tasks waiting to be started (approximate while the pool is running)
+			// and how long the started ones have been waiting.
+			virtual size_t GetQueueDepth(AsyncTaskPriority priority) const = 0;
+			virtual ThreadPoolLatencyHistogram GetLatencyHistogram(AsyncTaskPriority priority) const = 0;
 	};
 }
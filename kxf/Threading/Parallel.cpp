@@ -0,0 +1,131 @@
+#include "kxf-pch.h"
+#include "Parallel.h"
+
+namespace
+{
+	// Chunks per thread the automatic grain aims for, enough to even out the bodies of a different cost
+	constexpr size_t g_ChunksPerThread = 64;
+
+	// Blocks per thread for the algorithms working with the fixed blocks
+	constexpr size_t g_BlocksPerThread = 4;
+
+	size_t GetThreadCount(kxf::IThreadPool& pool)
+	{
+		// Tasks added to a stopped pool won't run until it's started, the calling thread would do all the work anyway
+		if (pool.IsRunning())
+		{
+			return std::max<size_t>(pool.GetConcurrency(), 1);
+		}
+		return 1;
+	}
+
+	// Shared with the helper tasks, a helper which starts after all the chunks have been taken returns right away, so the state
+	// has to outlive the call.
+	struct ParallelRangeState final
+	{
+		std::atomic<size_t> Next = 0;
+		std::atomic<size_t> Completed = 0;
+
+		size_t Count = 0;
+		size_t Grain = 0;
+		size_t ThreadCount = 0;
+		void* Context = nullptr;
+		kxf::Private::ParallelRangeFunc Func = nullptr;
+
+		bool Claim(size_t& first, size_t& last) noexcept
+		{
+			size_t next = Next.load(std::memory_order_relaxed);
+			while (next < Count)
+			{
+				const size_t remaining = Count - next;
+				const size_t size = std::min(remaining, std::max(Grain, remaining / (ThreadCount * 2)));
+				if (Next.compare_exchange_weak(next, next + size, std::memory_order_relaxed))
+				{
+					first = next;
+					last = next + size;
+					return true;
+				}
+			}
+			return false;
+		}
+		void Run()
+		{
+			size_t first = 0;
+			size_t last = 0;
+			while (Claim(first, last))
+			{
+				Func(Context, first, last);
+
+				const size_t size = last - first;
+				if (Completed.fetch_add(size, std::memory_order_acq_rel) + size == Count)
+				{
+					Completed.notify_all();
+				}
+			}
+		}
+	};
+}
+
+namespace kxf::Private
+{
+	void ParallelForRange(IThreadPool& pool, size_t count, size_t grain, void* context, ParallelRangeFunc func)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		const size_t threadCount = GetThreadCount(pool);
+		if (grain == 0)
+		{
+			grain = std::max<size_t>(count / (threadCount * g_ChunksPerThread), 1);
+		}
+		if (threadCount == 1 || count <= grain)
+		{
+			func(context, 0, count);
+			return;
+		}
+
+		auto state = std::make_shared<ParallelRangeState>();
+		state->Count = count;
+		state->Grain = grain;
+		state->ThreadCount = threadCount;
+		state->Context = context;
+		state->Func = func;
+
+		// The calling thread is one of the participants
+		const size_t helperCount = std::min(threadCount, (count + grain - 1) / grain) - 1;
+		for (size_t i = 0; i < helperCount; i++)
+		{
+			pool.AddTask([state]()
+			{
+				state->Run();
+			});
+		}
+		state->Run();
+
+		// Everything is taken, the remaining chunks are being run by the threads which have taken them
+		size_t completed = state->Completed.load(std::memory_order_acquire);
+		while (completed != count)
+		{
+			state->Completed.wait(completed, std::memory_order_acquire);
+			completed = state->Completed.load(std::memory_order_acquire);
+		}
+	}
+
+	size_t GetParallelBlockCount(IThreadPool& pool, size_t count, size_t grain)
+	{
+		const size_t threadCount = GetThreadCount(pool);
+		if (threadCount == 1 || count == 0)
+		{
+			return 1;
+		}
+
+		const size_t maxBlocks = threadCount * g_BlocksPerThread;
+		if (grain == 0)
+		{
+			grain = std::max<size_t>(count / maxBlocks, 1);
+		}
+		return std::clamp<size_t>(count / grain, 1, maxBlocks);
+	}
+}
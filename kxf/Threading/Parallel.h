@@ -0,0 +1,215 @@
+#pragma once
+#include "Common.h"
+#include "IThreadPool.h"
+#include <iterator>
+#include <ranges>
+
+namespace kxf::Private
+{
+	using ParallelRangeFunc = void(*)(void* context, size_t first, size_t last);
+
+	// Splits [0, count) into chunks and runs 'func' for each of them on the pool. The calling thread takes chunks as well and only
+	// waits for the chunks being run by the other threads, so it's safe to call from a worker of the same pool, or from inside of
+	// another parallel algorithm. With zero grain the chunks start large and shrink as the range runs out (guided scheduling).
+	KXF_API void ParallelForRange(IThreadPool& pool, size_t count, size_t grain, void* context, ParallelRangeFunc func);
+
+	template<class TFunc>
+	void ParallelForRange(IThreadPool& pool, size_t count, size_t grain, TFunc&& func)
+	{
+		ParallelForRange(pool, count, grain, &func, [](void* context, size_t first, size_t last)
+		{
+			std::invoke(*static_cast<std::remove_reference_t<TFunc>*>(context), first, last);
+		});
+	}
+
+	// Number of the fixed blocks for the algorithms which need the per-block results, a few per thread to balance the load
+	KXF_API size_t GetParallelBlockCount(IThreadPool& pool, size_t count, size_t grain);
+}
+
+namespace kxf::Parallel
+{
+	// Bodies are called concurrently on the pool threads and must not throw. Zero grain means to choose it automatically.
+
+	template<std::random_access_iterator TIterator, class TFunc>
+	void ForEach(IThreadPool& pool, TIterator first, TIterator last, TFunc&& func, size_t grain = 0)
+	{
+		Private::ParallelForRange(pool, static_cast<size_t>(last - first), grain, [&](size_t begin, size_t end)
+		{
+			std::for_each(first + begin, first + end, std::ref(func));
+		});
+	}
+
+	template<std::ranges::random_access_range TRange, class TFunc>
+	void ForEach(IThreadPool& pool, TRange&& range, TFunc&& func, size_t grain = 0)
+	{
+		ForEach(pool, std::ranges::begin(range), std::ranges::end(range), std::forward<TFunc>(func), grain);
+	}
+
+	template<std::random_access_iterator TInIterator, std::random_access_iterator TOutIterator, class TFunc>
+	TOutIterator Transform(IThreadPool& pool, TInIterator first, TInIterator last, TOutIterator out, TFunc&& func, size_t grain = 0)
+	{
+		const auto count = last - first;
+		Private::ParallelForRange(pool, static_cast<size_t>(count), grain, [&](size_t begin, size_t end)
+		{
+			std::transform(first + begin, first + end, out + begin, std::ref(func));
+		});
+		return out + count;
+	}
+
+	template<std::ranges::random_access_range TRange, std::random_access_iterator TOutIterator, class TFunc>
+	TOutIterator Transform(IThreadPool& pool, TRange&& range, TOutIterator out, TFunc&& func, size_t grain = 0)
+	{
+		return Transform(pool, std::ranges::begin(range), std::ranges::end(range), out, std::forward<TFunc>(func), grain);
+	}
+
+	// The operation must be associative, it doesn't have to be commutative: the blocks are reduced in order
+	template<std::random_access_iterator TIterator, class T, class TOperation = std::plus<>>
+	T Reduce(IThreadPool& pool, TIterator first, TIterator last, T init, TOperation&& operation = {}, size_t grain = 0)
+	{
+		const auto count = static_cast<size_t>(last - first);
+		const size_t blockCount = Private::GetParallelBlockCount(pool, count, grain);
+		if (blockCount <= 1)
+		{
+			return std::accumulate(first, last, std::move(init), std::ref(operation));
+		}
+
+		std::vector<std::optional<T>> partial(blockCount);
+		Private::ParallelForRange(pool, blockCount, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t block = begin; block != end; block++)
+			{
+				auto it = first + count * block / blockCount;
+				auto blockLast = first + count * (block + 1) / blockCount;
+
+				T value = *it;
+				while (++it != blockLast)
+				{
+					value = std::invoke(operation, std::move(value), *it);
+				}
+				partial[block] = std::move(value);
+			}
+		});
+
+		for (auto& value: partial)
+		{
+			init = std::invoke(operation, std::move(init), std::move(*value));
+		}
+		return init;
+	}
+
+	template<std::ranges::random_access_range TRange, class T, class TOperation = std::plus<>>
+	T Reduce(IThreadPool& pool, TRange&& range, T init, TOperation&& operation = {}, size_t grain = 0)
+	{
+		return Reduce(pool, std::ranges::begin(range), std::ranges::end(range), std::move(init), std::forward<TOperation>(operation), grain);
+	}
+
+	// Output can be the same as the input. The operation must be associative.
+	template<std::random_access_iterator TInIterator, std::random_access_iterator TOutIterator, class TOperation = std::plus<>>
+	TOutIterator InclusiveScan(IThreadPool& pool, TInIterator first, TInIterator last, TOutIterator out, TOperation&& operation = {}, size_t grain = 0)
+	{
+		using T = std::iter_value_t<TInIterator>;
+
+		const auto count = static_cast<size_t>(last - first);
+		const size_t blockCount = Private::GetParallelBlockCount(pool, count, grain);
+		if (blockCount <= 1)
+		{
+			return std::inclusive_scan(first, last, out, std::ref(operation));
+		}
+
+		// Sum up every block, then scan each of them again starting from the sum of all the blocks before it
+		std::vector<std::optional<T>> carry(blockCount);
+		auto ForEachBlock = [&](auto&& func)
+		{
+			Private::ParallelForRange(pool, blockCount, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t block = begin; block != end; block++)
+				{
+					func(block, count * block / blockCount, count * (block + 1) / blockCount);
+				}
+			});
+		};
+
+		ForEachBlock([&](size_t block, size_t begin, size_t end)
+		{
+			if (block + 1 != blockCount)
+			{
+				auto it = first + begin;
+				T value = *it;
+				while (++it != first + end)
+				{
+					value = std::invoke(operation, std::move(value), *it);
+				}
+				carry[block] = std::move(value);
+			}
+		});
+		for (size_t block = 1; block + 1 < blockCount; block++)
+		{
+			carry[block] = std::invoke(operation, *carry[block - 1], std::move(*carry[block]));
+		}
+		ForEachBlock([&](size_t block, size_t begin, size_t end)
+		{
+			if (block == 0)
+			{
+				std::inclusive_scan(first + begin, first + end, out + begin, std::ref(operation));
+			}
+			else
+			{
+				std::inclusive_scan(first + begin, first + end, out + begin, std::ref(operation), *carry[block - 1]);
+			}
+		});
+		return out + count;
+	}
+
+	template<std::ranges::random_access_range TRange, std::random_access_iterator TOutIterator, class TOperation = std::plus<>>
+	TOutIterator InclusiveScan(IThreadPool& pool, TRange&& range, TOutIterator out, TOperation&& operation = {}, size_t grain = 0)
+	{
+		return InclusiveScan(pool, std::ranges::begin(range), std::ranges::end(range), out, std::forward<TOperation>(operation), grain);
+	}
+
+	// Not stable. The blocks are sorted in parallel and then merged pairwise, every round of merges halves the number of blocks.
+	template<std::random_access_iterator TIterator, class TCompare = std::less<>>
+	void Sort(IThreadPool& pool, TIterator first, TIterator last, TCompare&& compare = {}, size_t grain = 0)
+	{
+		const auto count = static_cast<size_t>(last - first);
+		const size_t blockCount = Private::GetParallelBlockCount(pool, count, std::max<size_t>(grain, 2048));
+		if (blockCount <= 1)
+		{
+			std::sort(first, last, compare);
+			return;
+		}
+
+		auto GetBlockBoundary = [&](size_t block)
+		{
+			return first + count * std::min(block, blockCount) / blockCount;
+		};
+		Private::ParallelForRange(pool, blockCount, 1, [&](size_t begin, size_t end)
+		{
+			for (size_t block = begin; block != end; block++)
+			{
+				std::sort(GetBlockBoundary(block), GetBlockBoundary(block + 1), compare);
+			}
+		});
+
+		for (size_t width = 1; width < blockCount; width *= 2)
+		{
+			const size_t mergeCount = (blockCount + 2 * width - 1) / (2 * width);
+			Private::ParallelForRange(pool, mergeCount, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t merge = begin; merge != end; merge++)
+				{
+					const size_t block = merge * 2 * width;
+					if (block + width < blockCount)
+					{
+						std::inplace_merge(GetBlockBoundary(block), GetBlockBoundary(block + width), GetBlockBoundary(block + 2 * width), compare);
+					}
+				}
+			});
+		}
+	}
+
+	template<std::ranges::random_access_range TRange, class TCompare = std::less<>>
+	void Sort(IThreadPool& pool, TRange&& range, TCompare&& compare = {}, size_t grain = 0)
+	{
+		Sort(pool, std::ranges::begin(range), std::ranges::end(range), std::forward<TCompare>(compare), grain);
+	}
+}